@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+// affinetransform.cpp
+// ============
+// translation, quaternion rotation and scale transforms composed into
+// 3x4 affine matrices
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AffineTransform.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const float DEGREES_TO_HALF_RADIANS = 3.14159265358979f / 360.0f;
+
+	/***********************************************************
+	 *  ComposeEulerMat4()
+	 *
+	 *  This function is used for building the model matrix the
+	 *  way SceneManager::SetTransformations() did before the
+	 *  TRS path, as the baseline for the benchmark.
+	 ***********************************************************/
+	glm::mat4 ComposeEulerMat4(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ)
+	{
+		glm::mat4 scale = glm::scale(scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(positionXYZ);
+
+		return(translation * rotationX * rotationY * rotationZ * scale);
+	}
+}
+
+/***********************************************************
+ *  MakeTRS()
+ *
+ *  This function is used for building a transform from a
+ *  scale, Euler rotations in degrees and a position.  The
+ *  rotation is the product of the X, Y and Z quaternions,
+ *  which is the same as the product of the axis matrices,
+ *  expanded so only the half angle sines and cosines are
+ *  computed.
+ ***********************************************************/
+TRS MakeTRS(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	TRS transform;
+	transform.translation = positionXYZ;
+	transform.scale = scaleXYZ;
+	transform.flags = 0;
+
+	if ((XrotationDegrees == 0.0f) && (YrotationDegrees == 0.0f) && (ZrotationDegrees == 0.0f))
+	{
+		transform.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		transform.flags |= TRS_IDENTITY_ROTATION;
+	}
+	else
+	{
+		float sinX = std::sin(XrotationDegrees * DEGREES_TO_HALF_RADIANS);
+		float cosX = std::cos(XrotationDegrees * DEGREES_TO_HALF_RADIANS);
+		float sinY = std::sin(YrotationDegrees * DEGREES_TO_HALF_RADIANS);
+		float cosY = std::cos(YrotationDegrees * DEGREES_TO_HALF_RADIANS);
+		float sinZ = std::sin(ZrotationDegrees * DEGREES_TO_HALF_RADIANS);
+		float cosZ = std::cos(ZrotationDegrees * DEGREES_TO_HALF_RADIANS);
+
+		// X then Y
+		float w = cosX * cosY;
+		float x = sinX * cosY;
+		float y = cosX * sinY;
+		float z = sinX * sinY;
+
+		// then Z
+		transform.rotation = glm::quat(
+			w * cosZ - z * sinZ,
+			x * cosZ + y * sinZ,
+			y * cosZ - x * sinZ,
+			z * cosZ + w * sinZ);
+	}
+
+	if ((scaleXYZ.x == 1.0f) && (scaleXYZ.y == 1.0f) && (scaleXYZ.z == 1.0f))
+	{
+		transform.flags |= TRS_UNIT_SCALE;
+	}
+
+	return(transform);
+}
+
+/***********************************************************
+ *  ComposeAffine()
+ *
+ *  This function is used for composing the parts of a
+ *  transform into an affine matrix.  The rotation matrix is
+ *  built straight from the quaternion, and the identity
+ *  rotation and unit scale cases skip their part.
+ ***********************************************************/
+void ComposeAffine(const TRS& transform, AFFINE_3X4& affine)
+{
+	const glm::vec3& scale = transform.scale;
+	const glm::vec3& translation = transform.translation;
+
+	if (transform.flags & TRS_IDENTITY_ROTATION)
+	{
+		affine.rows[0] = glm::vec4(scale.x, 0.0f, 0.0f, translation.x);
+		affine.rows[1] = glm::vec4(0.0f, scale.y, 0.0f, translation.y);
+		affine.rows[2] = glm::vec4(0.0f, 0.0f, scale.z, translation.z);
+		return;
+	}
+
+	const glm::quat& q = transform.rotation;
+	float xx = q.x * q.x;
+	float yy = q.y * q.y;
+	float zz = q.z * q.z;
+	float xy = q.x * q.y;
+	float xz = q.x * q.z;
+	float yz = q.y * q.z;
+	float wx = q.w * q.x;
+	float wy = q.w * q.y;
+	float wz = q.w * q.z;
+
+	affine.rows[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy), translation.x);
+	affine.rows[1] = glm::vec4(2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx), translation.y);
+	affine.rows[2] = glm::vec4(2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy), translation.z);
+
+	// the scale is applied first, so it scales the columns
+	if (!(transform.flags & TRS_UNIT_SCALE))
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			affine.rows[row].x *= scale.x;
+			affine.rows[row].y *= scale.y;
+			affine.rows[row].z *= scale.z;
+		}
+	}
+}
+
+/***********************************************************
+ *  MultiplyAffine()
+ *
+ *  This function is used for multiplying two affine matrices,
+ *  treating the dropped bottom rows as (0, 0, 0, 1).
+ ***********************************************************/
+void MultiplyAffine(const AFFINE_3X4& parent, const AFFINE_3X4& child, AFFINE_3X4& result)
+{
+	AFFINE_3X4 product;
+
+	for (int row = 0; row < 3; row++)
+	{
+		const glm::vec4& p = parent.rows[row];
+		for (int column = 0; column < 4; column++)
+		{
+			product.rows[row][column] =
+				p.x * child.rows[0][column] +
+				p.y * child.rows[1][column] +
+				p.z * child.rows[2][column];
+		}
+		product.rows[row].w += p.w;
+	}
+
+	result = product;
+}
+
+/***********************************************************
+ *  AffineToMat4()
+ *
+ *  This function is used for widening an affine matrix into
+ *  a column major mat4 with the constant bottom row.
+ ***********************************************************/
+glm::mat4 AffineToMat4(const AFFINE_3X4& affine)
+{
+	return(glm::mat4(
+		glm::vec4(affine.rows[0].x, affine.rows[1].x, affine.rows[2].x, 0.0f),
+		glm::vec4(affine.rows[0].y, affine.rows[1].y, affine.rows[2].y, 0.0f),
+		glm::vec4(affine.rows[0].z, affine.rows[1].z, affine.rows[2].z, 0.0f),
+		glm::vec4(affine.rows[0].w, affine.rows[1].w, affine.rows[2].w, 1.0f)));
+}
+
+/***********************************************************
+ *  RunTransformBenchmark()
+ *
+ *  This function is used for timing the model matrix build
+ *  and the copy into an upload staging array for the mat4
+ *  Euler path and the TRS path, over a mix where most of the
+ *  objects have no rotation or a unit scale and over fully
+ *  general transforms.  The largest difference between the
+ *  two results is printed as a check.
+ ***********************************************************/
+void RunTransformBenchmark(int count, int iterations)
+{
+	struct EULER_INPUT
+	{
+		glm::vec3 scale;
+		glm::vec3 degrees;
+		glm::vec3 position;
+	};
+
+	const char* mixNames[2] = { "typical mix", "all general" };
+	std::vector<glm::mat4> mat4Staging(count);
+	std::vector<AFFINE_3X4> affineStaging(count);
+
+	std::cout << "INFO: Transform benchmark, " << count << " transforms x " << iterations << " iterations" << std::endl;
+	std::cout << "INFO: Upload size per object, mat4 " << sizeof(glm::mat4) << " bytes, 3x4 " << sizeof(AFFINE_3X4) << " bytes" << std::endl;
+
+	for (int mix = 0; mix < 2; mix++)
+	{
+		// in the typical mix half the objects are only placed,
+		// a quarter are scaled and a quarter also rotated
+		std::vector<EULER_INPUT> inputs(count);
+		srand(1234);
+		for (int i = 0; i < count; i++)
+		{
+			bool bScaled = (mix == 1) || (i % 4 >= 2);
+			bool bRotated = (mix == 1) || (i % 4 == 3);
+			inputs[i].scale = bScaled ? glm::vec3(0.5f + (rand() % 100) / 50.0f, 0.5f + (rand() % 100) / 50.0f, 0.5f + (rand() % 100) / 50.0f) : glm::vec3(1.0f);
+			inputs[i].degrees = bRotated ? glm::vec3((float)(rand() % 360), (float)(rand() % 360), (float)(rand() % 360)) : glm::vec3(0.0f);
+			inputs[i].position = glm::vec3((rand() % 200) / 10.0f, (rand() % 200) / 10.0f, (rand() % 200) / 10.0f);
+		}
+
+		std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const EULER_INPUT& input = inputs[i];
+				mat4Staging[i] = ComposeEulerMat4(input.scale, input.degrees.x, input.degrees.y, input.degrees.z, input.position);
+			}
+		}
+		double mat4Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		startTime = std::chrono::high_resolution_clock::now();
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const EULER_INPUT& input = inputs[i];
+				ComposeAffine(MakeTRS(input.scale, input.degrees.x, input.degrees.y, input.degrees.z, input.position), affineStaging[i]);
+			}
+		}
+		double affineSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		float largestError = 0.0f;
+		for (int i = 0; i < count; i++)
+		{
+			glm::mat4 widened = AffineToMat4(affineStaging[i]);
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					largestError = std::max(largestError, std::fabs(widened[column][row] - mat4Staging[i][column][row]));
+				}
+			}
+		}
+
+		double transforms = (double)count * iterations;
+		std::cout << "INFO: " << mixNames[mix]
+			<< ", mat4 Euler " << mat4Seconds * 1e9 / transforms << " ns"
+			<< ", TRS 3x4 " << affineSeconds * 1e9 / transforms << " ns"
+			<< " (" << mat4Seconds / std::max(affineSeconds, 1e-9) << "x)"
+			<< ", largest difference " << largestError << std::endl;
+	}
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// affinetransform.h
+// ============
+// translation, quaternion rotation and scale transforms composed into
+// 3x4 affine matrices
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// flags set by MakeTRS() for the common cases that can skip work
+enum TRS_FLAGS
+{
+	TRS_IDENTITY_ROTATION = 1,
+	TRS_UNIT_SCALE = 2
+};
+
+/***********************************************************
+ *  TRS
+ *
+ *  A transform kept as its parts - scale first, then the
+ *  rotation, then the translation.
+ ***********************************************************/
+struct TRS
+{
+	glm::vec3 translation;
+	glm::quat rotation;
+	glm::vec3 scale;
+	unsigned int flags;
+};
+
+/***********************************************************
+ *  AFFINE_3X4
+ *
+ *  The top three rows of an affine matrix, row major so each
+ *  row is one vec4 and the constant bottom row is dropped -
+ *  48 bytes instead of the 64 of a mat4.  A point is moved
+ *  with dot(row, vec4(point, 1.0)) for each row.
+ ***********************************************************/
+struct AFFINE_3X4
+{
+	glm::vec4 rows[3];
+};
+
+// build a transform from the arguments of SceneManager::SetTransformations,
+// with the X, Y then Z rotations applied in the same order
+TRS MakeTRS(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ);
+
+// compose the parts into an affine matrix
+void ComposeAffine(const TRS& transform, AFFINE_3X4& affine);
+// multiply two affine matrices, parent then child
+void MultiplyAffine(const AFFINE_3X4& parent, const AFFINE_3X4& child, AFFINE_3X4& result);
+// widen an affine matrix to a mat4 for the mat4 uniform path
+glm::mat4 AffineToMat4(const AFFINE_3X4& affine);
+
+// time the mat4 Euler path against the TRS path and print the results
+void RunTransformBenchmark(int count, int iterations);
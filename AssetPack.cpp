@@ -0,0 +1,757 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// read the textures, meshes and shaders from one memory mapped pack file
+// instead of opening each of them on its own
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+#include "Lz4Codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+// keep windows.h from defining min and max over std::min
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  ASSET_PACK_ENTRY
+ *
+ *  An asset in the index.  A compressed asset starts with the
+ *  stored size of each of its blocks, followed by the blocks.
+ ***********************************************************/
+struct ASSET_PACK_ENTRY
+{
+	uint64_t nameHash;
+	uint64_t dataOffset;
+	uint64_t storedSize;
+	uint64_t size;
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	uint32_t codec;
+	uint32_t blockCount;
+};
+
+// declaration of global variables
+namespace
+{
+	const char g_AssetPackMagic[4] = { 'A', 'P', 'A', 'K' };
+	const uint32_t ASSET_PACK_VERSION = 1;
+
+	// how an asset is stored
+	const uint32_t ASSET_CODEC_NONE = 0;
+	const uint32_t ASSET_CODEC_LZ4 = 1;
+
+	// size of the blocks a compressed asset is cut into, before
+	// compression - the last one may be shorter
+	const size_t ASSET_BLOCK_SIZE = 64 * 1024;
+	// set in the stored size of a block that did not compress
+	// and is kept as it is
+	const uint32_t ASSET_BLOCK_RAW = 0x80000000u;
+
+	// the asset data is aligned so an uncompressed asset can be
+	// read in place as an array of floats or indices
+	const size_t ASSET_DATA_ALIGNMENT = 16;
+
+	// assets with fewer blocks than this are decompressed on the
+	// calling thread, as starting threads would cost more
+	const uint32_t MIN_PARALLEL_BLOCKS = 4;
+	const unsigned int MAX_DECOMPRESS_THREADS = 8;
+
+	/***********************************************************
+	 *  ASSET_PACK_HEADER
+	 *
+	 *  The start of a pack file.  The index entries, the hash
+	 *  buckets and the names follow at the passed offsets, and
+	 *  the asset data after them.
+	 ***********************************************************/
+	struct ASSET_PACK_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t bucketCount;
+		uint64_t entriesOffset;
+		uint64_t bucketsOffset;
+		uint64_t namesOffset;
+		uint64_t namesSize;
+	};
+
+	// the pack read by LoadPackedAsset()
+	AssetPack g_MountedPack;
+
+	/***********************************************************
+	 *  HashName()
+	 *
+	 *  This function is used for hashing an asset name with
+	 *  64 bit FNV-1a.
+	 ***********************************************************/
+	uint64_t HashName(const std::string& name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < name.size(); i++)
+		{
+			hash ^= (unsigned char)name[i];
+			hash *= 1099511628211ull;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  AlignSize()
+	 *
+	 *  This function is used for rounding a size up to the
+	 *  asset data alignment.
+	 ***********************************************************/
+	size_t AlignSize(size_t size)
+	{
+		return((size + ASSET_DATA_ALIGNMENT - 1) & ~(ASSET_DATA_ALIGNMENT - 1));
+	}
+
+	/***********************************************************
+	 *  CompressAsset()
+	 *
+	 *  This function is used for cutting an asset into blocks
+	 *  and compressing each one, keeping a block as it is when
+	 *  compressing does not make it smaller.
+	 ***********************************************************/
+	void CompressAsset(const std::vector<unsigned char>& data, std::vector<unsigned char>& stored, uint32_t& blockCount)
+	{
+		blockCount = (uint32_t)((data.size() + ASSET_BLOCK_SIZE - 1) / ASSET_BLOCK_SIZE);
+		std::vector<uint32_t> blockSizes(blockCount);
+		std::vector<unsigned char> blocks;
+		std::vector<unsigned char> compressed(Lz4CompressBound(ASSET_BLOCK_SIZE));
+
+		for (uint32_t block = 0; block < blockCount; block++)
+		{
+			size_t start = block * ASSET_BLOCK_SIZE;
+			size_t size = std::min(ASSET_BLOCK_SIZE, data.size() - start);
+			size_t compressedSize = Lz4Compress(data.data() + start, size, compressed.data(), compressed.size());
+			if ((compressedSize == 0) || (compressedSize >= size))
+			{
+				blockSizes[block] = (uint32_t)size | ASSET_BLOCK_RAW;
+				blocks.insert(blocks.end(), data.begin() + start, data.begin() + start + size);
+			}
+			else
+			{
+				blockSizes[block] = (uint32_t)compressedSize;
+				blocks.insert(blocks.end(), compressed.begin(), compressed.begin() + compressedSize);
+			}
+		}
+
+		stored.assign((const unsigned char*)blockSizes.data(), (const unsigned char*)(blockSizes.data() + blockCount));
+		stored.insert(stored.end(), blocks.begin(), blocks.end());
+	}
+}
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pMapping = NULL;
+	m_mappedSize = 0;
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_pBuckets = NULL;
+	m_bucketCount = 0;
+	m_pNames = NULL;
+	m_namesSize = 0;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a pack file into memory
+ *  with a single open of the file, and checking that its
+ *  index lies inside it.  The pages are only read from disk
+ *  as the assets are touched.
+ ***********************************************************/
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	CloseHandle(file);
+	if (NULL == mapping)
+	{
+		std::cout << "Could not map asset pack:" << filename << std::endl;
+		return(false);
+	}
+	// the view keeps the mapping open after its handle is closed
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (NULL == view)
+	{
+		std::cout << "Could not map asset pack:" << filename << std::endl;
+		return(false);
+	}
+	m_pMapping = (const unsigned char*)view;
+	m_mappedSize = (size_t)fileSize.QuadPart;
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat fileStatus;
+	void* view = MAP_FAILED;
+	if ((0 == fstat(file, &fileStatus)) && (fileStatus.st_size > 0))
+	{
+		view = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	// the mapping keeps the file open after it is closed
+	close(file);
+	if (MAP_FAILED == view)
+	{
+		std::cout << "Could not map asset pack:" << filename << std::endl;
+		return(false);
+	}
+	m_pMapping = (const unsigned char*)view;
+	m_mappedSize = (size_t)fileStatus.st_size;
+#endif
+
+	ASSET_PACK_HEADER header;
+	bool bValid = (m_mappedSize >= sizeof(header));
+	if (bValid)
+	{
+		memcpy(&header, m_pMapping, sizeof(header));
+		bValid = (memcmp(header.magic, g_AssetPackMagic, sizeof(g_AssetPackMagic)) == 0) &&
+			(header.version == ASSET_PACK_VERSION) &&
+			(header.bucketCount > 0) &&
+			((header.bucketCount & (header.bucketCount - 1)) == 0) &&
+			(header.bucketCount > header.entryCount) &&
+			(header.entriesOffset % alignof(ASSET_PACK_ENTRY) == 0) &&
+			(header.bucketsOffset % alignof(uint32_t) == 0) &&
+			(header.entriesOffset + (uint64_t)header.entryCount * sizeof(ASSET_PACK_ENTRY) <= m_mappedSize) &&
+			(header.bucketsOffset + (uint64_t)header.bucketCount * sizeof(uint32_t) <= m_mappedSize) &&
+			(header.namesOffset + header.namesSize <= m_mappedSize);
+	}
+	if (!bValid)
+	{
+		std::cout << "Asset pack is damaged or out of date:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_pEntries = (const ASSET_PACK_ENTRY*)(m_pMapping + header.entriesOffset);
+	m_entryCount = header.entryCount;
+	m_pBuckets = (const unsigned int*)(m_pMapping + header.bucketsOffset);
+	m_bucketCount = header.bucketCount;
+	m_pNames = (const char*)(m_pMapping + header.namesOffset);
+	m_namesSize = (size_t)header.namesSize;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the pack file.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	if (NULL != m_pMapping)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pMapping);
+#else
+		munmap((void*)m_pMapping, m_mappedSize);
+#endif
+	}
+
+	m_pMapping = NULL;
+	m_mappedSize = 0;
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_pBuckets = NULL;
+	m_bucketCount = 0;
+	m_pNames = NULL;
+	m_namesSize = 0;
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for looking a normalized name up in
+ *  the hash index.  The buckets hold the entry number plus
+ *  one, probing forward from the hash until an empty bucket,
+ *  and the stored name is compared so a hash collision never
+ *  returns the wrong asset.
+ ***********************************************************/
+const ASSET_PACK_ENTRY* AssetPack::FindEntry(const std::string& name) const
+{
+	if (NULL == m_pMapping)
+	{
+		return(NULL);
+	}
+
+	uint64_t hash = HashName(name);
+	for (unsigned int probe = 0; probe < m_bucketCount; probe++)
+	{
+		unsigned int bucket = m_pBuckets[(hash + probe) & (m_bucketCount - 1)];
+		if ((0 == bucket) || (bucket > m_entryCount))
+		{
+			return(NULL);
+		}
+
+		const ASSET_PACK_ENTRY& entry = m_pEntries[bucket - 1];
+		if ((entry.nameHash == hash) &&
+			(entry.nameLength == name.size()) &&
+			((uint64_t)entry.nameOffset + entry.nameLength <= m_namesSize) &&
+			(memcmp(m_pNames + entry.nameOffset, name.data(), name.size()) == 0))
+		{
+			return(&entry);
+		}
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  Contains()
+ *
+ *  This method is used for checking whether an asset is in
+ *  the pack without reading it.
+ ***********************************************************/
+bool AssetPack::Contains(const char* name) const
+{
+	return(NULL != FindEntry(NormalizeName(name)));
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading an asset.  An asset stored
+ *  uncompressed is returned in place in the mapped file, and
+ *  a compressed one is decompressed into the storage of the
+ *  passed in asset data.
+ ***********************************************************/
+bool AssetPack::Load(const char* name, ASSET_DATA& asset) const
+{
+	asset.pData = NULL;
+	asset.size = 0;
+	asset.storage.clear();
+
+	const ASSET_PACK_ENTRY* pEntry = FindEntry(NormalizeName(name));
+	if (NULL == pEntry)
+	{
+		return(false);
+	}
+	if ((pEntry->dataOffset > m_mappedSize) || (pEntry->storedSize > m_mappedSize - pEntry->dataOffset))
+	{
+		std::cout << "Asset pack entry is damaged:" << name << std::endl;
+		return(false);
+	}
+
+	if (pEntry->codec == ASSET_CODEC_NONE)
+	{
+		if (pEntry->storedSize != pEntry->size)
+		{
+			std::cout << "Asset pack entry is damaged:" << name << std::endl;
+			return(false);
+		}
+		asset.pData = m_pMapping + pEntry->dataOffset;
+		asset.size = (size_t)pEntry->size;
+		return(true);
+	}
+
+	// LZ4 expands data at most about 255 times, so a size past
+	// that is damage and is not allocated
+	if ((pEntry->codec != ASSET_CODEC_LZ4) ||
+		(pEntry->size / 256 > pEntry->storedSize) ||
+		(pEntry->blockCount != (pEntry->size + ASSET_BLOCK_SIZE - 1) / ASSET_BLOCK_SIZE))
+	{
+		std::cout << "Asset pack entry is damaged:" << name << std::endl;
+		return(false);
+	}
+
+	asset.storage.resize((size_t)pEntry->size);
+	if (!Decompress(*pEntry, asset.storage.data()))
+	{
+		std::cout << "Asset pack entry is damaged:" << name << std::endl;
+		asset.storage.clear();
+		return(false);
+	}
+	asset.pData = asset.storage.data();
+	asset.size = asset.storage.size();
+	return(true);
+}
+
+/***********************************************************
+ *  Decompress()
+ *
+ *  This method is used for decompressing the blocks of an
+ *  asset.  The blocks do not refer to each other, so those of
+ *  a large asset are shared out over several threads, each
+ *  writing its own part of the output.
+ ***********************************************************/
+bool AssetPack::Decompress(const ASSET_PACK_ENTRY& entry, unsigned char* destination) const
+{
+	const unsigned char* stored = m_pMapping + entry.dataOffset;
+	uint64_t tableSize = (uint64_t)entry.blockCount * sizeof(uint32_t);
+	if (tableSize > entry.storedSize)
+	{
+		return(false);
+	}
+
+	// where each block starts, checked against the stored size
+	// before any thread reads it
+	std::vector<uint64_t> blockOffsets(entry.blockCount + 1);
+	blockOffsets[0] = tableSize;
+	for (uint32_t block = 0; block < entry.blockCount; block++)
+	{
+		uint32_t blockSize;
+		memcpy(&blockSize, stored + block * sizeof(uint32_t), sizeof(blockSize));
+		blockOffsets[block + 1] = blockOffsets[block] + (blockSize & ~ASSET_BLOCK_RAW);
+		if (blockOffsets[block + 1] > entry.storedSize)
+		{
+			return(false);
+		}
+	}
+
+	std::atomic<bool> bFailed(false);
+	auto decompressBlocks = [&](uint32_t first, uint32_t stride)
+	{
+		for (uint32_t block = first; (block < entry.blockCount) && !bFailed; block += stride)
+		{
+			uint32_t blockSize;
+			memcpy(&blockSize, stored + block * sizeof(uint32_t), sizeof(blockSize));
+			const unsigned char* input = stored + blockOffsets[block];
+			size_t inputSize = (size_t)(blockOffsets[block + 1] - blockOffsets[block]);
+			size_t start = block * ASSET_BLOCK_SIZE;
+			size_t outputSize = std::min(ASSET_BLOCK_SIZE, (size_t)entry.size - start);
+
+			bool bDecoded;
+			if (blockSize & ASSET_BLOCK_RAW)
+			{
+				bDecoded = (inputSize == outputSize);
+				if (bDecoded)
+				{
+					memcpy(destination + start, input, outputSize);
+				}
+			}
+			else
+			{
+				bDecoded = Lz4Decompress(input, inputSize, destination + start, outputSize);
+			}
+			if (!bDecoded)
+			{
+				bFailed = true;
+			}
+		}
+	};
+
+	unsigned int threadCount = 1;
+	if (entry.blockCount >= MIN_PARALLEL_BLOCKS)
+	{
+		threadCount = std::max(1u, std::min(MAX_DECOMPRESS_THREADS, std::thread::hardware_concurrency()));
+		threadCount = std::min(threadCount, (unsigned int)entry.blockCount);
+	}
+
+	std::vector<std::thread> threads;
+	for (unsigned int thread = 1; thread < threadCount; thread++)
+	{
+		threads.push_back(std::thread(decompressBlocks, thread, threadCount));
+	}
+	decompressBlocks(0, threadCount);
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	return(!bFailed);
+}
+
+/***********************************************************
+ *  ListAssets()
+ *
+ *  This method is used for getting the names of the assets
+ *  directly inside a directory of the pack.
+ ***********************************************************/
+void AssetPack::ListAssets(const char* directory, std::vector<std::string>& names) const
+{
+	names.clear();
+
+	std::string prefix = NormalizeName(directory);
+	if (!prefix.empty())
+	{
+		prefix += "/";
+	}
+	for (unsigned int i = 0; i < m_entryCount; i++)
+	{
+		const ASSET_PACK_ENTRY& entry = m_pEntries[i];
+		if ((uint64_t)entry.nameOffset + entry.nameLength > m_namesSize)
+		{
+			continue;
+		}
+		std::string name(m_pNames + entry.nameOffset, entry.nameLength);
+		if ((name.compare(0, prefix.size(), prefix) == 0) &&
+			(name.find('/', prefix.size()) == std::string::npos))
+		{
+			names.push_back(name.substr(prefix.size()));
+		}
+	}
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for writing a pack.  The file is
+ *  written under a temporary name and then renamed, so a
+ *  build that stops part way never leaves a half written
+ *  pack behind.
+ ***********************************************************/
+bool AssetPack::Write(const char* filename, const std::vector<ASSET_PACK_SOURCE>& sources)
+{
+	ASSET_PACK_HEADER header;
+	memcpy(header.magic, g_AssetPackMagic, sizeof(g_AssetPackMagic));
+	header.version = ASSET_PACK_VERSION;
+	header.entryCount = (uint32_t)sources.size();
+
+	// at most half the buckets are used, so the probes stay short
+	header.bucketCount = 1;
+	while (header.bucketCount < 2 * header.entryCount + 1)
+	{
+		header.bucketCount *= 2;
+	}
+
+	std::vector<ASSET_PACK_ENTRY> entries(sources.size());
+	std::vector<uint32_t> buckets(header.bucketCount, 0);
+	std::string names;
+	std::vector<std::vector<unsigned char> > stored(sources.size());
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		std::string name = NormalizeName(sources[i].name.c_str());
+		ASSET_PACK_ENTRY& entry = entries[i];
+		entry.nameHash = HashName(name);
+		entry.nameOffset = (uint32_t)names.size();
+		entry.nameLength = (uint32_t)name.size();
+		entry.size = sources[i].data.size();
+		entry.blockCount = 0;
+		names += name;
+
+		unsigned int bucket = (unsigned int)(entry.nameHash & (header.bucketCount - 1));
+		while (0 != buckets[bucket])
+		{
+			const ASSET_PACK_ENTRY& other = entries[buckets[bucket] - 1];
+			if (names.compare(other.nameOffset, other.nameLength, name) == 0)
+			{
+				std::cout << "Asset added to the pack twice:" << name << std::endl;
+				return(false);
+			}
+			bucket = (bucket + 1) & (header.bucketCount - 1);
+		}
+		buckets[bucket] = (uint32_t)i + 1;
+
+		if (sources[i].bCompress)
+		{
+			entry.codec = ASSET_CODEC_LZ4;
+			CompressAsset(sources[i].data, stored[i], entry.blockCount);
+		}
+		else
+		{
+			entry.codec = ASSET_CODEC_NONE;
+			stored[i] = sources[i].data;
+		}
+		entry.storedSize = stored[i].size();
+	}
+
+	header.entriesOffset = AlignSize(sizeof(header));
+	header.bucketsOffset = AlignSize(header.entriesOffset + entries.size() * sizeof(ASSET_PACK_ENTRY));
+	header.namesOffset = AlignSize(header.bucketsOffset + buckets.size() * sizeof(uint32_t));
+	header.namesSize = names.size();
+
+	uint64_t offset = AlignSize(header.namesOffset + header.namesSize);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		entries[i].dataOffset = offset;
+		offset = AlignSize(offset + entries[i].storedSize);
+	}
+
+	std::string temporaryName = std::string(filename) + ".tmp";
+	{
+		std::ofstream file(temporaryName.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			std::cout << "Could not write asset pack:" << filename << std::endl;
+			return(false);
+		}
+
+		// each part is padded out to the offset it was given
+		auto padTo = [&file](uint64_t position)
+		{
+			static const char zeros[ASSET_DATA_ALIGNMENT] = { 0 };
+			file.write(zeros, (std::streamsize)(position - (uint64_t)file.tellp()));
+		};
+
+		file.write((const char*)&header, sizeof(header));
+		padTo(header.entriesOffset);
+		file.write((const char*)entries.data(), entries.size() * sizeof(ASSET_PACK_ENTRY));
+		padTo(header.bucketsOffset);
+		file.write((const char*)buckets.data(), buckets.size() * sizeof(uint32_t));
+		padTo(header.namesOffset);
+		file.write(names.data(), names.size());
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			padTo(entries[i].dataOffset);
+			file.write((const char*)stored[i].data(), stored[i].size());
+		}
+		if (!file)
+		{
+			std::cout << "Could not write asset pack:" << filename << std::endl;
+			return(false);
+		}
+	}
+
+	// rename does not replace an existing file on every platform
+	std::remove(filename);
+	if (0 != std::rename(temporaryName.c_str(), filename))
+	{
+		std::cout << "Could not write asset pack:" << filename << std::endl;
+		std::remove(temporaryName.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  NormalizeName()
+ *
+ *  This method is used for turning the path an asset is
+ *  loaded by into the name it is stored under, so the paths
+ *  relative to different working directories find the same
+ *  asset.
+ ***********************************************************/
+std::string AssetPack::NormalizeName(const char* name)
+{
+	std::vector<std::string> segments;
+	std::string segment;
+	for (const char* character = name; ; character++)
+	{
+		if ((*character == '/') || (*character == '\\') || (*character == '\0'))
+		{
+			if (segment == "..")
+			{
+				if (!segments.empty())
+				{
+					segments.pop_back();
+				}
+			}
+			else if (!segment.empty() && (segment != "."))
+			{
+				segments.push_back(segment);
+			}
+			segment.clear();
+
+			if (*character == '\0')
+			{
+				break;
+			}
+		}
+		else
+		{
+			segment += *character;
+		}
+	}
+
+	std::string normalized;
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		if (i > 0)
+		{
+			normalized += '/';
+		}
+		normalized += segments[i];
+	}
+	return(normalized);
+}
+
+/***********************************************************
+ *  MountAssetPack()
+ *
+ *  This function is used for opening the pack that the asset
+ *  loads look in before the loose files.
+ ***********************************************************/
+bool MountAssetPack(const char* filename)
+{
+	return(g_MountedPack.Open(filename));
+}
+
+/***********************************************************
+ *  UnmountAssetPack()
+ *
+ *  This function is used for closing the mounted pack.
+ ***********************************************************/
+void UnmountAssetPack()
+{
+	g_MountedPack.Close();
+}
+
+/***********************************************************
+ *  LoadPackedAsset()
+ *
+ *  This function is used for reading an asset from the
+ *  mounted pack.  The pack is only read once it is mounted,
+ *  so any thread may call this.
+ ***********************************************************/
+bool LoadPackedAsset(const char* name, ASSET_DATA& asset)
+{
+	return(g_MountedPack.Load(name, asset));
+}
+
+/***********************************************************
+ *  ListPackedAssets()
+ *
+ *  This function is used for listing the assets of the
+ *  mounted pack inside a directory.
+ ***********************************************************/
+bool ListPackedAssets(const char* directory, std::vector<std::string>& names)
+{
+	names.clear();
+	if (!g_MountedPack.IsOpen())
+	{
+		return(false);
+	}
+	g_MountedPack.ListAssets(directory, names);
+	return(true);
+}
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// read the textures, meshes and shaders from one memory mapped pack file
+// instead of opening each of them on its own
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ASSET_DATA
+ *
+ *  The bytes of an asset read from a pack.  An asset stored
+ *  uncompressed points straight into the mapped file, which
+ *  stays valid until the pack is closed, and a compressed one
+ *  points at the storage it was decompressed into.
+ ***********************************************************/
+struct ASSET_DATA
+{
+	const unsigned char* pData;
+	size_t size;
+	std::vector<unsigned char> storage;
+};
+
+/***********************************************************
+ *  ASSET_PACK_SOURCE
+ *
+ *  An asset to be written to a pack, under the name it is
+ *  loaded by.
+ ***********************************************************/
+struct ASSET_PACK_SOURCE
+{
+	std::string name;
+	std::vector<unsigned char> data;
+	// already compressed formats such as JPEG gain nothing from
+	// LZ4 and are kept loadable without a copy
+	bool bCompress;
+};
+
+// layout of an entry in the pack index
+struct ASSET_PACK_ENTRY;
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class maps a pack file into memory and looks its
+ *  assets up by name in a hash index.  Compressed assets are
+ *  stored as independent LZ4 blocks, so a large one is
+ *  decompressed on several threads at once.  Names are
+ *  matched after NormalizeName(), so "./Source/brick.jpg"
+ *  and "Source\brick.jpg" find the same asset.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	// map a pack file and check its index
+	bool Open(const char* filename);
+	// unmap the file, leaving every uncompressed ASSET_DATA that
+	// points into it dangling
+	void Close();
+	bool IsOpen() const { return NULL != m_pMapping; }
+
+	bool Contains(const char* name) const;
+	// read an asset, false when it is not in the pack or is
+	// damaged
+	bool Load(const char* name, ASSET_DATA& asset) const;
+	// names of the assets directly inside a directory, without
+	// the directory
+	void ListAssets(const char* directory, std::vector<std::string>& names) const;
+
+	// write a pack holding the passed in assets
+	static bool Write(const char* filename, const std::vector<ASSET_PACK_SOURCE>& sources);
+	// the name an asset is stored under - slashes made forward,
+	// and "." and ".." segments resolved, with those that climb
+	// above the start dropped
+	static std::string NormalizeName(const char* name);
+
+private:
+	const unsigned char* m_pMapping;
+	size_t m_mappedSize;
+
+	const ASSET_PACK_ENTRY* m_pEntries;
+	unsigned int m_entryCount;
+	const unsigned int* m_pBuckets;
+	unsigned int m_bucketCount;
+	const char* m_pNames;
+	size_t m_namesSize;
+
+	const ASSET_PACK_ENTRY* FindEntry(const std::string& name) const;
+	bool Decompress(const ASSET_PACK_ENTRY& entry, unsigned char* destination) const;
+};
+
+// open the pack that LoadPackedAsset() reads from, before any thread
+// loads assets
+bool MountAssetPack(const char* filename);
+// close the mounted pack, once no thread loads assets
+void UnmountAssetPack();
+
+// read an asset from the mounted pack, false when no pack is mounted or
+// the asset is not in it so the caller falls back to the loose file
+bool LoadPackedAsset(const char* name, ASSET_DATA& asset);
+// list the mounted pack's assets directly inside a directory, false when
+// no pack is mounted
+bool ListPackedAssets(const char* directory, std::vector<std::string>& names);
@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetstreamer.cpp
+// ============
+// load the textures and meshes of the scene being rendered in the
+// background, drawing placeholders for them until they are in
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetStreamer.h"
+#include "AssetPack.h"
+#include "AsyncFileReader.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// reads the worker keeps in flight at once
+	const int READ_QUEUE_DEPTH = 16;
+	// passed with the read of the mesh cache, where the reads
+	// of the textures pass their index
+	const int MESH_CACHE_READ = -1;
+}
+
+/***********************************************************
+ *  AssetStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetStreamer::AssetStreamer()
+{
+	m_pSceneManager = NULL;
+	m_bBusy = false;
+	m_decodedCount = 0;
+	m_pUploader = NULL;
+	m_bMeshDataReady = false;
+	m_bMeshesLoaded = false;
+	m_bCancel = false;
+	m_nextUpload = 0;
+	m_startTime = std::chrono::steady_clock::now();
+	m_stats = STREAM_STATS();
+}
+
+/***********************************************************
+ *  ~AssetStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetStreamer::~AssetStreamer()
+{
+	Cancel();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting to load the assets of the
+ *  passed in scene.  The ones still in the resource cache are
+ *  put into the scene straight away and the rest are handed
+ *  to the worker thread.
+ ***********************************************************/
+bool AssetStreamer::Start(SceneManager* pSceneManager)
+{
+	if ((NULL == pSceneManager) || m_bBusy)
+	{
+		return(false);
+	}
+
+	m_pSceneManager = pSceneManager;
+	m_startTime = std::chrono::steady_clock::now();
+	m_stats = STREAM_STATS();
+	m_nextUpload = 0;
+
+	std::vector<SceneManager::TEXTURE_FILE> textures;
+	m_pSceneManager->GetSceneTextures(textures);
+	m_textureFiles.clear();
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		if (m_pSceneManager->AcquireCachedTexture(textures[i].filename.c_str(), textures[i].tag))
+		{
+			m_stats.cachedTextures++;
+		}
+		else
+		{
+			m_textureFiles.push_back(textures[i]);
+		}
+	}
+	m_decodedTextures.clear();
+	m_decodedTextures.resize(m_textureFiles.size());
+	m_uploadRequests.assign(m_textureFiles.size(), NULL);
+	m_decodedCount = 0;
+
+	m_meshData = MESH_DATA();
+	m_bMeshesLoaded = m_pSceneManager->AcquireCachedMeshes();
+	m_bMeshDataReady = false;
+
+	m_bCancel = false;
+	m_worker = std::thread(&AssetStreamer::LoadAssets, this);
+	m_bBusy = true;
+	return(true);
+}
+
+/***********************************************************
+ *  CreatePlaceholders()
+ *
+ *  This method is used for giving every asset that is still
+ *  loading a placeholder, so the scene can be drawn from the
+ *  first frame.  Anything the worker has already finished is
+ *  uploaded by the next Update() over its placeholder.
+ ***********************************************************/
+void AssetStreamer::CreatePlaceholders()
+{
+	if (!m_bBusy)
+	{
+		return;
+	}
+
+	for (size_t i = (size_t)m_nextUpload; i < m_textureFiles.size(); i++)
+	{
+		m_pSceneManager->CreatePlaceholderTexture(m_textureFiles[i].tag);
+	}
+	if (!m_bMeshesLoaded)
+	{
+		m_pSceneManager->CreatePlaceholderMeshes();
+	}
+	m_pSceneManager->BindGLTextures();
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for uploading the assets the worker has
+ *  finished, the meshes first, then the textures in order,
+ *  one at a time until the time budget is spent.  When all of
+ *  them are in, the impostors are baked.  An upload is never
+ *  split, so one larger than the budget runs over it.
+ ***********************************************************/
+bool AssetStreamer::Update(double budgetMilliseconds)
+{
+	if (!m_bBusy)
+	{
+		return(false);
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	m_stats.frames++;
+
+	bool bTexturesChanged = false;
+	bool bFinished = false;
+	double elapsedMilliseconds = 0.0;
+	while (elapsedMilliseconds < budgetMilliseconds)
+	{
+		if (!m_bMeshesLoaded)
+		{
+			// wait for the worker in the next frame
+			if (!m_bMeshDataReady.load())
+			{
+				break;
+			}
+			m_pSceneManager->UploadMeshes(m_meshData);
+			m_meshData = MESH_DATA();
+			m_bMeshesLoaded = true;
+		}
+		else if (m_nextUpload < (int)m_textureFiles.size())
+		{
+			if (m_nextUpload >= m_decodedCount.load())
+			{
+				break;
+			}
+
+			ResourceUploader::UPLOAD_REQUEST* pRequest = m_uploadRequests[m_nextUpload];
+			if (NULL != pRequest)
+			{
+				// the texture is put in once its upload is done,
+				// and is looked at again in the next frame until then
+				ResourceUploader::UPLOADED_TEXTURE uploaded;
+				ResourceUploader::UPLOAD_STATUS status = m_pUploader.load()->TakeUploadedTexture(pRequest, uploaded);
+				if (status == ResourceUploader::UPLOAD_PENDING)
+				{
+					break;
+				}
+				m_uploadRequests[m_nextUpload] = NULL;
+				if ((status == ResourceUploader::UPLOAD_READY) &&
+					m_pSceneManager->InstallTexture(uploaded.textureID, uploaded.bytes, uploaded.filename,
+						uploaded.decodeMilliseconds + uploaded.uploadMilliseconds, m_textureFiles[m_nextUpload].tag))
+				{
+					m_stats.streamedTextures++;
+				}
+			}
+			else
+			{
+				SceneManager::DECODED_TEXTURE& decoded = m_decodedTextures[m_nextUpload];
+				if (m_pSceneManager->UploadTexture(decoded, m_textureFiles[m_nextUpload].tag))
+				{
+					m_stats.streamedTextures++;
+				}
+				// the decoded levels are not needed after the upload
+				decoded = SceneManager::DECODED_TEXTURE();
+			}
+			m_nextUpload++;
+			bTexturesChanged = true;
+		}
+		else
+		{
+			// the impostors bake from the real assets, until then
+			// the distant props draw their full geometry
+			StopWorker();
+			m_pSceneManager->RunPrepareStep(SceneManager::PREPARE_IMPOSTORS);
+			bTexturesChanged = true;
+			bFinished = true;
+			break;
+		}
+		elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+	}
+
+	// the uploaded textures took over the slots of their
+	// placeholders, which are bound to the same units
+	if (bTexturesChanged)
+	{
+		m_pSceneManager->BindGLTextures();
+	}
+	m_stats.uploadMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+
+	if (bFinished)
+	{
+		m_stats.fullyLoadedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+		std::cout << "Assets loaded: " << m_stats.fullyLoadedMilliseconds << " ms over " << m_stats.frames << " frames"
+			<< ", textures streamed:" << m_stats.streamedTextures
+			<< ", cached:" << m_stats.cachedTextures
+			<< ", GL work:" << m_stats.uploadMilliseconds << " ms" << std::endl;
+		m_textureFiles.clear();
+		m_decodedTextures.clear();
+		m_uploadRequests.clear();
+		m_bBusy = false;
+	}
+	return(bFinished);
+}
+
+/***********************************************************
+ *  Cancel()
+ *
+ *  This method is used for stopping the loading.  The scene
+ *  keeps the placeholders of the assets that were not loaded
+ *  and frees them with its other textures and meshes.
+ ***********************************************************/
+void AssetStreamer::Cancel()
+{
+	StopWorker();
+	AbandonUploads();
+	m_pSceneManager = NULL;
+	m_textureFiles.clear();
+	m_decodedTextures.clear();
+	m_meshData = MESH_DATA();
+	m_bBusy = false;
+}
+
+/***********************************************************
+ *  LoadAssets()
+ *
+ *  This method is used for reading the mesh data and the
+ *  textures on the worker thread.  Every file that is not in
+ *  the asset pack is submitted to the reader at once, so the
+ *  reads overlap, and each one is decoded as soon as it is
+ *  in.  The textures are still handed to Update() in order.
+ ***********************************************************/
+void AssetStreamer::LoadAssets()
+{
+	AsyncFileReader reader;
+	reader.Initialize(READ_QUEUE_DEPTH);
+
+	std::vector<ASSET_DATA> packed(m_textureFiles.size());
+	std::vector<bool> bPacked(m_textureFiles.size(), false);
+	for (size_t i = 0; i < m_textureFiles.size(); i++)
+	{
+		bPacked[i] = LoadPackedAsset(m_textureFiles[i].filename.c_str(), packed[i]);
+		if (!bPacked[i])
+		{
+			reader.Submit(m_textureFiles[i].filename.c_str(), (int)i);
+		}
+	}
+
+	// the meshes go first, as the boxes standing in for them
+	// change the look of the scene the most
+	if (!m_bMeshesLoaded)
+	{
+		ASSET_DATA meshCache;
+		if (LoadPackedAsset(SceneManager::GetMeshCacheFile(), meshCache))
+		{
+			SceneManager::LoadMeshData(m_meshData, meshCache.pData, meshCache.size);
+			m_bMeshDataReady = true;
+		}
+		else
+		{
+			reader.Submit(SceneManager::GetMeshCacheFile(), MESH_CACHE_READ);
+		}
+	}
+
+	std::vector<bool> bDecoded(m_textureFiles.size(), false);
+	auto markDecoded = [this, &bDecoded](int texture)
+	{
+		// the upload thread takes the texture straight away, and
+		// its ticket is set before Update() can look for it
+		ResourceUploader* pUploader = m_pUploader.load();
+		if ((NULL != pUploader) && m_decodedTextures[texture].bDecoded)
+		{
+			m_uploadRequests[texture] = pUploader->Submit(m_decodedTextures[texture]);
+		}
+		bDecoded[texture] = true;
+		int decodedCount = m_decodedCount.load();
+		while ((decodedCount < (int)bDecoded.size()) && bDecoded[decodedCount])
+		{
+			decodedCount++;
+		}
+		m_decodedCount = decodedCount;
+	};
+
+	for (size_t i = 0; (i < m_textureFiles.size()) && !m_bCancel; i++)
+	{
+		if (bPacked[i])
+		{
+			SceneManager::DecodeTexture(m_textureFiles[i].filename.c_str(), m_decodedTextures[i], packed[i].pData, packed[i].size);
+			markDecoded((int)i);
+		}
+	}
+
+	AsyncFileReader::READ_COMPLETION completion;
+	while (!m_bCancel && reader.WaitCompletion(completion))
+	{
+		if (completion.userData == MESH_CACHE_READ)
+		{
+			// a cache that could not be read is generated again
+			SceneManager::LoadMeshData(m_meshData,
+				completion.bSucceeded ? completion.data.data() : NULL, completion.data.size());
+			m_bMeshDataReady = true;
+		}
+		else
+		{
+			// a texture that could not be read is left undecoded,
+			// which keeps its placeholder
+			if (completion.bSucceeded)
+			{
+				SceneManager::DecodeTexture(completion.filename.c_str(), m_decodedTextures[completion.userData],
+					completion.data.data(), completion.data.size());
+			}
+			markDecoded(completion.userData);
+		}
+		completion.data.clear();
+	}
+
+	if (!m_bCancel)
+	{
+		reader.PrintStats("Scene assets");
+	}
+}
+
+/***********************************************************
+ *  StopWorker()
+ *
+ *  This method is used for stopping the worker thread and
+ *  waiting for it to finish.
+ ***********************************************************/
+void AssetStreamer::StopWorker()
+{
+	m_bCancel = true;
+	if (m_worker.joinable())
+	{
+		m_worker.join();
+	}
+}
+
+/***********************************************************
+ *  AbandonUploads()
+ *
+ *  This method is used for giving up the uploads that were
+ *  handed to the uploader and not yet taken, once the worker
+ *  has stopped.
+ ***********************************************************/
+void AssetStreamer::AbandonUploads()
+{
+	for (size_t i = 0; i < m_uploadRequests.size(); i++)
+	{
+		if (NULL != m_uploadRequests[i])
+		{
+			m_pUploader.load()->Abandon(m_uploadRequests[i]);
+		}
+	}
+	m_uploadRequests.clear();
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetstreamer.h
+// ============
+// load the textures and meshes of the scene being rendered in the
+// background, drawing placeholders for them until they are in
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ResourceUploader.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  AssetStreamer
+ *
+ *  This class lets the first frame of a scene be drawn before
+ *  its assets are loaded.  Each texture starts as a 1x1
+ *  placeholder in the slot of its tag and each basic mesh as
+ *  a box of its bounds.  A worker thread reads the mesh data
+ *  and decodes the textures, and Update(), called once per
+ *  frame on the GL thread, uploads whatever has finished
+ *  within a time budget, each asset replacing its placeholder
+ *  in place.  With a resource uploader set, the worker hands
+ *  each decoded texture to its thread and Update() only puts
+ *  in the ones whose upload has finished.  The impostors are
+ *  baked from the real assets once everything is in.
+ ***********************************************************/
+class AssetStreamer
+{
+public:
+	// constructor
+	AssetStreamer();
+	// destructor
+	~AssetStreamer();
+
+	// timings of the loading, from Start()
+	struct STREAM_STATS
+	{
+		double fullyLoadedMilliseconds;
+		// GL work done in Update()
+		double uploadMilliseconds;
+		int frames;
+		int cachedTextures;
+		int streamedTextures;
+	};
+
+	// start reading the assets of the passed in scene on the
+	// worker thread - no GL calls are made, so this can run
+	// before the GL context exists
+	bool Start(SceneManager* pSceneManager);
+	// put the placeholders into the scene, on the GL thread
+	void CreatePlaceholders();
+	// called at the start of every frame on the GL thread, does
+	// GL work for up to the passed in time and returns true in
+	// the frame the last asset is loaded
+	bool Update(double budgetMilliseconds);
+	// stop loading, leaving the placeholders that are left
+	void Cancel();
+	// upload the textures decoded from here on with the passed
+	// in uploader, which outlives the loading
+	void SetUploader(ResourceUploader* pUploader) { m_pUploader = pUploader; }
+
+	bool IsBusy() const { return m_bBusy; }
+	const STREAM_STATS& GetStats() const { return m_stats; }
+
+private:
+	SceneManager* m_pSceneManager;
+	bool m_bBusy;
+	// textures not in the cache, decoded by the worker in the
+	// order their files are read and handed over in this order
+	std::vector<SceneManager::TEXTURE_FILE> m_textureFiles;
+	std::vector<SceneManager::DECODED_TEXTURE> m_decodedTextures;
+	std::atomic<int> m_decodedCount;
+	// the tickets of the textures handed to the uploader, NULL
+	// for the ones uploaded by Update()
+	std::atomic<ResourceUploader*> m_pUploader;
+	std::vector<ResourceUploader::UPLOAD_REQUEST*> m_uploadRequests;
+	// mesh data read by the worker before the textures
+	MESH_DATA m_meshData;
+	std::atomic<bool> m_bMeshDataReady;
+	bool m_bMeshesLoaded;
+	std::atomic<bool> m_bCancel;
+	std::thread m_worker;
+	// next texture to upload
+	int m_nextUpload;
+	std::chrono::steady_clock::time_point m_startTime;
+	STREAM_STATS m_stats;
+
+	void LoadAssets();
+	void StopWorker();
+	void AbandonUploads();
+};
@@ -0,0 +1,729 @@
+///////////////////////////////////////////////////////////////////////////////
+// asyncfilereader.cpp
+// ============
+// read many whole files at once, with io_uring where the kernel has it and
+// a pool of threads doing blocking reads where it does not
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AsyncFileReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// io_uring is called through its system calls, as liburing is not
+// a dependency of the project
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_READER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// size of each read sent to the kernel and of each of the
+	// buffers it reads into - large enough to keep a network
+	// disk streaming, small enough that the buffers can be
+	// locked in memory under the default limit of most systems
+	const size_t READ_CHUNK_SIZE = 256 * 1024;
+
+	/***********************************************************
+	 *  GetPercentile()
+	 *
+	 *  This function is used for getting the passed in fraction
+	 *  of the way through sorted values.
+	 ***********************************************************/
+	double GetPercentile(const std::vector<double>& sorted, double fraction)
+	{
+		if (sorted.empty())
+		{
+			return(0.0);
+		}
+		size_t index = (size_t)(fraction * (double)(sorted.size() - 1) + 0.5);
+		return(sorted[std::min(index, sorted.size() - 1)]);
+	}
+
+#ifdef ASYNC_FILE_READER_IO_URING
+	/***********************************************************
+	 *  EnterRing()
+	 *
+	 *  This function is used for handing entries to the kernel
+	 *  and waiting for completions, trying again when a signal
+	 *  interrupts the wait.
+	 ***********************************************************/
+	int EnterRing(int ringFile, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+	{
+		int result;
+		do
+		{
+			result = (int)syscall(__NR_io_uring_enter, ringFile, toSubmit, minComplete, flags, NULL, 0);
+		} while ((result < 0) && (errno == EINTR));
+		return(result);
+	}
+#endif
+}
+
+/***********************************************************
+ *  AsyncFileReader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AsyncFileReader::AsyncFileReader()
+{
+	m_queueDepth = 0;
+	m_pending = 0;
+	m_bStarted = false;
+	m_failedFiles = 0;
+	m_bytes = 0;
+	m_inFlight = 0;
+	m_maxQueueDepth = 0;
+
+	m_ringFile = -1;
+	m_pSubmitRing = NULL;
+	m_submitRingSize = 0;
+	m_pCompleteRing = NULL;
+	m_completeRingSize = 0;
+	m_pSubmitEntries = NULL;
+	m_submitEntriesSize = 0;
+	m_pSubmitTail = NULL;
+	m_submitMask = 0;
+	m_pSubmitArray = NULL;
+	m_pCompleteHead = NULL;
+	m_pCompleteTail = NULL;
+	m_completeMask = 0;
+	m_pCompletions = NULL;
+	m_unsubmitted = 0;
+	m_bRegisteredBuffers = false;
+
+	m_bStopping = false;
+}
+
+/***********************************************************
+ *  ~AsyncFileReader()
+ *
+ *  The destructor for the class.  The kernel may still be
+ *  writing into the buffers of the reads in flight, so they
+ *  are waited for before the buffers are freed.
+ ***********************************************************/
+AsyncFileReader::~AsyncFileReader()
+{
+	if (m_ringFile >= 0)
+	{
+		while (m_inFlight > 0)
+		{
+			ReapCompletions(true);
+		}
+		for (size_t i = 0; i < m_requests.size(); i++)
+		{
+#ifndef _WIN32
+			if (m_requests[i]->file >= 0)
+			{
+				close(m_requests[i]->file);
+			}
+#endif
+			delete m_requests[i];
+		}
+		m_requests.clear();
+		DestroyRing();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_queueChanged.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	for (size_t i = 0; i < m_queued.size(); i++)
+	{
+		delete m_queued[i];
+	}
+	for (size_t i = 0; i < m_completed.size(); i++)
+	{
+		delete m_completed[i];
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for setting up the reader.  io_uring
+ *  is tried first, and the thread pool, one thread for each
+ *  read allowed in flight, is started when the kernel does
+ *  not have it or does not allow it.
+ ***********************************************************/
+bool AsyncFileReader::Initialize(int queueDepth)
+{
+	m_queueDepth = std::max(1, queueDepth);
+
+	if (InitializeRing())
+	{
+		return(true);
+	}
+
+	for (int i = 0; i < m_queueDepth; i++)
+	{
+		m_threads.push_back(std::thread(&AsyncFileReader::ReadLoop, this));
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  InitializeRing()
+ *
+ *  This method is used for creating the io_uring queues,
+ *  mapping them into memory and registering the buffers.
+ *  When the buffers cannot be registered, as the locked
+ *  memory limit is too low, they are passed with each read
+ *  instead.
+ ***********************************************************/
+bool AsyncFileReader::InitializeRing()
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int ringFile = (int)syscall(__NR_io_uring_setup, (unsigned int)m_queueDepth, &params);
+	if (ringFile < 0)
+	{
+		return(false);
+	}
+	m_ringFile = ringFile;
+
+	m_submitRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	m_completeRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool bSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (bSingleMapping)
+	{
+		m_submitRingSize = std::max(m_submitRingSize, m_completeRingSize);
+		m_completeRingSize = m_submitRingSize;
+	}
+
+	m_pSubmitRing = mmap(NULL, m_submitRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQ_RING);
+	if (MAP_FAILED == m_pSubmitRing)
+	{
+		m_pSubmitRing = NULL;
+		DestroyRing();
+		return(false);
+	}
+	if (bSingleMapping)
+	{
+		m_pCompleteRing = m_pSubmitRing;
+	}
+	else
+	{
+		m_pCompleteRing = mmap(NULL, m_completeRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_CQ_RING);
+		if (MAP_FAILED == m_pCompleteRing)
+		{
+			m_pCompleteRing = NULL;
+			DestroyRing();
+			return(false);
+		}
+	}
+	m_submitEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	m_pSubmitEntries = mmap(NULL, m_submitEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFile, IORING_OFF_SQES);
+	if (MAP_FAILED == m_pSubmitEntries)
+	{
+		m_pSubmitEntries = NULL;
+		DestroyRing();
+		return(false);
+	}
+
+	unsigned char* submitRing = (unsigned char*)m_pSubmitRing;
+	unsigned char* completeRing = (unsigned char*)m_pCompleteRing;
+	m_pSubmitTail = (unsigned int*)(submitRing + params.sq_off.tail);
+	m_submitMask = *(unsigned int*)(submitRing + params.sq_off.ring_mask);
+	m_pSubmitArray = (unsigned int*)(submitRing + params.sq_off.array);
+	m_pCompleteHead = (unsigned int*)(completeRing + params.cq_off.head);
+	m_pCompleteTail = (unsigned int*)(completeRing + params.cq_off.tail);
+	m_completeMask = *(unsigned int*)(completeRing + params.cq_off.ring_mask);
+	m_pCompletions = completeRing + params.cq_off.cqes;
+
+	// no more chunks are in flight than there are buffers, so
+	// the queues never fill
+	int bufferCount = std::min(m_queueDepth, (int)params.sq_entries);
+	m_bufferMemory.resize((size_t)bufferCount * READ_CHUNK_SIZE);
+	std::vector<iovec> vectors(bufferCount);
+	for (int i = 0; i < bufferCount; i++)
+	{
+		vectors[i].iov_base = m_bufferMemory.data() + (size_t)i * READ_CHUNK_SIZE;
+		vectors[i].iov_len = READ_CHUNK_SIZE;
+		m_freeBuffers.push_back(bufferCount - 1 - i);
+	}
+	m_bufferRequests.assign(bufferCount, NULL);
+	m_bufferOffsets.assign(bufferCount, 0);
+	m_bufferLengths.assign(bufferCount, 0);
+	m_bRegisteredBuffers =
+		(0 == syscall(__NR_io_uring_register, ringFile, IORING_REGISTER_BUFFERS, vectors.data(), (unsigned int)bufferCount));
+
+	// a plain read into an unregistered buffer came with the same
+	// kernel as reads at the file position, so the thread pool
+	// is used on kernels older than that
+	if (!m_bRegisteredBuffers && !(params.features & IORING_FEAT_RW_CUR_POS))
+	{
+		DestroyRing();
+		return(false);
+	}
+
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  DestroyRing()
+ *
+ *  This method is used for unmapping the io_uring queues and
+ *  closing the ring, which also releases the buffers.
+ ***********************************************************/
+void AsyncFileReader::DestroyRing()
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	if (NULL != m_pSubmitEntries)
+	{
+		munmap(m_pSubmitEntries, m_submitEntriesSize);
+	}
+	if ((NULL != m_pCompleteRing) && (m_pCompleteRing != m_pSubmitRing))
+	{
+		munmap(m_pCompleteRing, m_completeRingSize);
+	}
+	if (NULL != m_pSubmitRing)
+	{
+		munmap(m_pSubmitRing, m_submitRingSize);
+	}
+	if (m_ringFile >= 0)
+	{
+		close(m_ringFile);
+	}
+#endif
+
+	m_ringFile = -1;
+	m_pSubmitRing = NULL;
+	m_pCompleteRing = NULL;
+	m_pSubmitEntries = NULL;
+	m_bRegisteredBuffers = false;
+	m_freeBuffers.clear();
+	m_bufferMemory.clear();
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for starting to read a whole file.
+ *  With io_uring the file is opened here and its first chunks
+ *  are handed to the kernel straight away, otherwise it is
+ *  queued for the thread pool.
+ ***********************************************************/
+void AsyncFileReader::Submit(const char* filename, int userData)
+{
+	READ_REQUEST* pRequest = new READ_REQUEST();
+	pRequest->filename = filename;
+	pRequest->userData = userData;
+	pRequest->file = -1;
+	pRequest->bFailed = false;
+	pRequest->size = 0;
+	pRequest->nextOffset = 0;
+	pRequest->chunksInFlight = 0;
+	pRequest->submitTime = std::chrono::steady_clock::now();
+
+	if (!m_bStarted)
+	{
+		m_firstSubmitTime = pRequest->submitTime;
+		m_bStarted = true;
+	}
+	m_pending++;
+
+	if (m_ringFile < 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queued.push_back(pRequest);
+		}
+		m_queueChanged.notify_one();
+		return;
+	}
+
+#ifndef _WIN32
+	pRequest->file = open(filename, O_RDONLY | O_CLOEXEC);
+	struct stat fileStatus;
+	if ((pRequest->file < 0) || (0 != fstat(pRequest->file, &fileStatus)))
+	{
+		pRequest->bFailed = true;
+	}
+	else
+	{
+		pRequest->size = (size_t)fileStatus.st_size;
+		pRequest->data.resize(pRequest->size);
+	}
+#endif
+	m_requests.push_back(pRequest);
+	SubmitChunks();
+}
+
+/***********************************************************
+ *  SubmitChunks()
+ *
+ *  This method is used for handing the kernel the next
+ *  chunks of the files being read, in the order the files
+ *  were submitted, for as long as there are free buffers.
+ ***********************************************************/
+void AsyncFileReader::SubmitChunks()
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	for (size_t i = 0; (i < m_requests.size()) && !m_freeBuffers.empty(); i++)
+	{
+		READ_REQUEST* pRequest = m_requests[i];
+		if (pRequest->bFailed)
+		{
+			continue;
+		}
+
+		while (!pRequest->retries.empty() && !m_freeBuffers.empty())
+		{
+			SubmitChunk(pRequest, pRequest->retries.back().first, pRequest->retries.back().second);
+			pRequest->retries.pop_back();
+		}
+		while ((pRequest->nextOffset < pRequest->size) && !m_freeBuffers.empty())
+		{
+			size_t length = std::min(READ_CHUNK_SIZE, pRequest->size - pRequest->nextOffset);
+			SubmitChunk(pRequest, pRequest->nextOffset, length);
+			pRequest->nextOffset += length;
+		}
+	}
+
+	if (m_unsubmitted > 0)
+	{
+		int submitted = EnterRing(m_ringFile, m_unsubmitted, 0, 0);
+		if (submitted > 0)
+		{
+			m_unsubmitted -= (unsigned int)submitted;
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  SubmitChunk()
+ *
+ *  This method is used for putting the read of one chunk of
+ *  a file into a free buffer in the submission queue.
+ ***********************************************************/
+void AsyncFileReader::SubmitChunk(READ_REQUEST* pRequest, size_t offset, size_t length)
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	int buffer = m_freeBuffers.back();
+	m_freeBuffers.pop_back();
+	m_bufferRequests[buffer] = pRequest;
+	m_bufferOffsets[buffer] = offset;
+	m_bufferLengths[buffer] = length;
+
+	unsigned int tail = *m_pSubmitTail;
+	unsigned int index = tail & m_submitMask;
+	io_uring_sqe* pEntry = (io_uring_sqe*)m_pSubmitEntries + index;
+	memset(pEntry, 0, sizeof(*pEntry));
+	pEntry->fd = pRequest->file;
+	pEntry->off = offset;
+	pEntry->user_data = (unsigned long long)buffer;
+	unsigned char* pBuffer = m_bufferMemory.data() + (size_t)buffer * READ_CHUNK_SIZE;
+	if (m_bRegisteredBuffers)
+	{
+		pEntry->opcode = IORING_OP_READ_FIXED;
+		pEntry->addr = (unsigned long long)(uintptr_t)pBuffer;
+		pEntry->len = (unsigned int)length;
+		pEntry->buf_index = (unsigned short)buffer;
+	}
+	else
+	{
+		pEntry->opcode = IORING_OP_READ;
+		pEntry->addr = (unsigned long long)(uintptr_t)pBuffer;
+		pEntry->len = (unsigned int)length;
+	}
+	m_pSubmitArray[index] = index;
+	__atomic_store_n(m_pSubmitTail, tail + 1, __ATOMIC_RELEASE);
+
+	m_unsubmitted++;
+	pRequest->chunksInFlight++;
+	m_inFlight++;
+	m_maxQueueDepth = std::max(m_maxQueueDepth, m_inFlight);
+#endif
+}
+
+/***********************************************************
+ *  ReapCompletions()
+ *
+ *  This method is used for taking the finished chunks off the
+ *  completion queue, copying each one into its file's data
+ *  and freeing its buffer.  A short read leaves the rest of
+ *  the chunk to be read again, and a failed one fails the
+ *  whole file.
+ ***********************************************************/
+void AsyncFileReader::ReapCompletions(bool bWait)
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	if (bWait || (m_unsubmitted > 0))
+	{
+		int submitted = EnterRing(m_ringFile, m_unsubmitted, bWait ? 1 : 0, bWait ? IORING_ENTER_GETEVENTS : 0);
+		if (submitted > 0)
+		{
+			m_unsubmitted -= (unsigned int)submitted;
+		}
+	}
+
+	unsigned int head = *m_pCompleteHead;
+	unsigned int tail = __atomic_load_n(m_pCompleteTail, __ATOMIC_ACQUIRE);
+	while (head != tail)
+	{
+		const io_uring_cqe* pCompletion = (const io_uring_cqe*)m_pCompletions + (head & m_completeMask);
+		int buffer = (int)pCompletion->user_data;
+		int result = pCompletion->res;
+		head++;
+
+		READ_REQUEST* pRequest = m_bufferRequests[buffer];
+		size_t offset = m_bufferOffsets[buffer];
+		size_t length = m_bufferLengths[buffer];
+		if (result <= 0)
+		{
+			// nothing read means the file shrank since it was opened
+			pRequest->bFailed = true;
+		}
+		else if (!pRequest->bFailed)
+		{
+			memcpy(pRequest->data.data() + offset, m_bufferMemory.data() + (size_t)buffer * READ_CHUNK_SIZE, (size_t)result);
+			if ((size_t)result < length)
+			{
+				pRequest->retries.push_back(std::make_pair(offset + (size_t)result, length - (size_t)result));
+			}
+		}
+
+		m_bufferRequests[buffer] = NULL;
+		m_freeBuffers.push_back(buffer);
+		pRequest->chunksInFlight--;
+		m_inFlight--;
+	}
+	__atomic_store_n(m_pCompleteHead, head, __ATOMIC_RELEASE);
+#else
+	(void)bWait;
+#endif
+}
+
+/***********************************************************
+ *  WaitCompletion()
+ *
+ *  This method is used for taking the next file that has been
+ *  read in full, waiting for one when none has.  With io_uring
+ *  the chunks freed while waiting are refilled at once, so
+ *  the queue stays full while the caller decodes.
+ ***********************************************************/
+bool AsyncFileReader::WaitCompletion(READ_COMPLETION& completion)
+{
+	if (m_pending <= 0)
+	{
+		return(false);
+	}
+
+	if (m_ringFile < 0)
+	{
+		READ_REQUEST* pRequest = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queueChanged.wait(lock, [this]() { return !m_completed.empty(); });
+			pRequest = m_completed.front();
+			m_completed.pop_front();
+		}
+		Complete(pRequest, completion);
+		return(true);
+	}
+
+	for (;;)
+	{
+		ReapCompletions(false);
+		SubmitChunks();
+
+		for (size_t i = 0; i < m_requests.size(); i++)
+		{
+			READ_REQUEST* pRequest = m_requests[i];
+			bool bDone = (pRequest->chunksInFlight == 0) &&
+				(pRequest->bFailed || ((pRequest->nextOffset >= pRequest->size) && pRequest->retries.empty()));
+			if (bDone)
+			{
+				m_requests.erase(m_requests.begin() + i);
+				Complete(pRequest, completion);
+				return(true);
+			}
+		}
+
+		ReapCompletions(true);
+	}
+}
+
+/***********************************************************
+ *  ReadLoop()
+ *
+ *  This method is used for reading the queued files on a
+ *  thread of the pool, each with blocking reads from start to
+ *  end.
+ ***********************************************************/
+void AsyncFileReader::ReadLoop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_queueChanged.wait(lock, [this]() { return m_bStopping || !m_queued.empty(); });
+		if (m_bStopping)
+		{
+			return;
+		}
+
+		READ_REQUEST* pRequest = m_queued.front();
+		m_queued.pop_front();
+		m_inFlight++;
+		m_maxQueueDepth = std::max(m_maxQueueDepth, m_inFlight);
+		lock.unlock();
+
+#ifdef _WIN32
+		std::ifstream file(pRequest->filename.c_str(), std::ios::binary | std::ios::ate);
+		pRequest->bFailed = !file.is_open();
+		if (!pRequest->bFailed)
+		{
+			pRequest->data.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read((char*)pRequest->data.data(), pRequest->data.size());
+			pRequest->bFailed = !file;
+		}
+#else
+		int file = open(pRequest->filename.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat fileStatus;
+		pRequest->bFailed = (file < 0) || (0 != fstat(file, &fileStatus));
+		if (!pRequest->bFailed)
+		{
+			pRequest->data.resize((size_t)fileStatus.st_size);
+			size_t offset = 0;
+			while (offset < pRequest->data.size())
+			{
+				ssize_t result = pread(file, pRequest->data.data() + offset, pRequest->data.size() - offset, (off_t)offset);
+				if ((result < 0) && (errno == EINTR))
+				{
+					continue;
+				}
+				if (result <= 0)
+				{
+					pRequest->bFailed = true;
+					break;
+				}
+				offset += (size_t)result;
+			}
+		}
+		if (file >= 0)
+		{
+			close(file);
+		}
+#endif
+
+		lock.lock();
+		m_inFlight--;
+		m_completed.push_back(pRequest);
+		m_queueChanged.notify_all();
+	}
+}
+
+/***********************************************************
+ *  Complete()
+ *
+ *  This method is used for handing a finished read to the
+ *  caller and adding it to the statistics.
+ ***********************************************************/
+void AsyncFileReader::Complete(READ_REQUEST* pRequest, READ_COMPLETION& completion)
+{
+#ifndef _WIN32
+	if (pRequest->file >= 0)
+	{
+		close(pRequest->file);
+	}
+#endif
+
+	m_lastCompletionTime = std::chrono::steady_clock::now();
+	completion.filename = pRequest->filename;
+	completion.userData = pRequest->userData;
+	completion.bSucceeded = !pRequest->bFailed;
+	completion.data.swap(pRequest->data);
+	completion.latencyMilliseconds = std::chrono::duration<double, std::milli>(m_lastCompletionTime - pRequest->submitTime).count();
+	if (!completion.bSucceeded)
+	{
+		std::cout << "Could not read file:" << pRequest->filename << std::endl;
+		completion.data.clear();
+		m_failedFiles++;
+	}
+
+	m_bytes += (long long)completion.data.size();
+	m_latencies.push_back(completion.latencyMilliseconds);
+	m_pending--;
+	delete pRequest;
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the statistics of the
+ *  reads taken so far.
+ ***********************************************************/
+AsyncFileReader::READ_STATS AsyncFileReader::GetStats() const
+{
+	READ_STATS stats;
+	stats.backend = (m_ringFile >= 0) ? (m_bRegisteredBuffers ? "io_uring, registered buffers" : "io_uring") : "thread pool";
+	stats.files = (int)m_latencies.size();
+	stats.failedFiles = m_failedFiles;
+	stats.bytes = m_bytes;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		stats.maxQueueDepth = m_maxQueueDepth;
+	}
+
+	double seconds = std::chrono::duration<double>(m_lastCompletionTime - m_firstSubmitTime).count();
+	stats.throughputMBps = (m_bStarted && (seconds > 0.0)) ? ((double)m_bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+
+	std::vector<double> sorted = m_latencies;
+	std::sort(sorted.begin(), sorted.end());
+	stats.latencyP50Milliseconds = GetPercentile(sorted, 0.50);
+	stats.latencyP90Milliseconds = GetPercentile(sorted, 0.90);
+	stats.latencyP99Milliseconds = GetPercentile(sorted, 0.99);
+	return(stats);
+}
+
+/***********************************************************
+ *  PrintStats()
+ *
+ *  This method is used for writing the statistics of the
+ *  reads to the console.
+ ***********************************************************/
+void AsyncFileReader::PrintStats(const char* name) const
+{
+	READ_STATS stats = GetStats();
+	std::cout << name << " read (" << stats.backend << "): " << stats.files << " files"
+		<< ", " << (double)stats.bytes / (1024.0 * 1024.0) << " MB at " << stats.throughputMBps << " MB/s"
+		<< ", queue depth:" << stats.maxQueueDepth
+		<< ", latency p50:" << stats.latencyP50Milliseconds << " ms"
+		<< " p90:" << stats.latencyP90Milliseconds << " ms"
+		<< " p99:" << stats.latencyP99Milliseconds << " ms";
+	if (stats.failedFiles > 0)
+	{
+		std::cout << ", failed:" << stats.failedFiles;
+	}
+	std::cout << std::endl;
+}
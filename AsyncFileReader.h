@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// asyncfilereader.h
+// ============
+// read many whole files at once, with io_uring where the kernel has it and
+// a pool of threads doing blocking reads where it does not
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/***********************************************************
+ *  AsyncFileReader
+ *
+ *  This class reads whole files without waiting on each one
+ *  in turn.  Every file of a scene is submitted up front and
+ *  the caller takes the finished reads from WaitCompletion()
+ *  in the order they finish, decoding one while the others
+ *  are still on their way from the disk.
+ *
+ *  With io_uring the files are read in chunks into a set of
+ *  buffers registered with the kernel once, so no pages are
+ *  pinned per read, with as many chunks in flight as there
+ *  are buffers.  Without it, a pool of threads each read one
+ *  file at a time with pread().
+ *
+ *  Submit() and WaitCompletion() are called from one thread.
+ ***********************************************************/
+class AsyncFileReader
+{
+public:
+	// constructor
+	AsyncFileReader();
+	// destructor, waits for the reads in flight
+	~AsyncFileReader();
+
+	// a finished read
+	struct READ_COMPLETION
+	{
+		std::string filename;
+		// passed to Submit() to tell the reads apart
+		int userData;
+		bool bSucceeded;
+		std::vector<unsigned char> data;
+		// from Submit() to the read finishing
+		double latencyMilliseconds;
+	};
+
+	// how the reads went, from the first Submit()
+	struct READ_STATS
+	{
+		const char* backend;
+		int files;
+		int failedFiles;
+		long long bytes;
+		// most reads the disk had queued at once
+		int maxQueueDepth;
+		// from the first Submit() to the last read finishing
+		double throughputMBps;
+		double latencyP50Milliseconds;
+		double latencyP90Milliseconds;
+		double latencyP99Milliseconds;
+	};
+
+	// set up io_uring, or the thread pool when io_uring is not
+	// available, with up to the passed in reads in flight
+	bool Initialize(int queueDepth);
+	bool IsUsingIoUring() const { return m_ringFile >= 0; }
+
+	// start reading a whole file
+	void Submit(const char* filename, int userData);
+	// wait for the next read to finish, false once every
+	// submitted read has been taken
+	bool WaitCompletion(READ_COMPLETION& completion);
+
+	READ_STATS GetStats() const;
+	// write the statistics to the console, after the passed in
+	// name of what was read
+	void PrintStats(const char* name) const;
+
+private:
+	struct READ_REQUEST
+	{
+		std::string filename;
+		int userData;
+		int file;
+		bool bFailed;
+		size_t size;
+		std::vector<unsigned char> data;
+		// chunks not yet submitted and still in flight, and the
+		// parts of chunks to read again after a short read
+		size_t nextOffset;
+		int chunksInFlight;
+		std::vector<std::pair<size_t, size_t> > retries;
+		std::chrono::steady_clock::time_point submitTime;
+	};
+
+	int m_queueDepth;
+	int m_pending;
+	bool m_bStarted;
+	std::chrono::steady_clock::time_point m_firstSubmitTime;
+	std::chrono::steady_clock::time_point m_lastCompletionTime;
+	std::vector<double> m_latencies;
+	int m_failedFiles;
+	long long m_bytes;
+	int m_inFlight;
+	int m_maxQueueDepth;
+
+	// io_uring, with the file descriptor of the ring at -1 when
+	// the thread pool is used
+	int m_ringFile;
+	void* m_pSubmitRing;
+	size_t m_submitRingSize;
+	void* m_pCompleteRing;
+	size_t m_completeRingSize;
+	void* m_pSubmitEntries;
+	size_t m_submitEntriesSize;
+	unsigned int* m_pSubmitTail;
+	unsigned int m_submitMask;
+	unsigned int* m_pSubmitArray;
+	unsigned int* m_pCompleteHead;
+	unsigned int* m_pCompleteTail;
+	unsigned int m_completeMask;
+	void* m_pCompletions;
+	// entries put in the ring that the kernel has not taken yet
+	unsigned int m_unsubmitted;
+	// the buffers, one chunk each, registered with the kernel
+	// when it allows, with the read each one is in use by
+	std::vector<unsigned char> m_bufferMemory;
+	bool m_bRegisteredBuffers;
+	std::vector<int> m_freeBuffers;
+	std::vector<READ_REQUEST*> m_bufferRequests;
+	std::vector<size_t> m_bufferOffsets;
+	std::vector<size_t> m_bufferLengths;
+	// requests still being read, in the order they were opened
+	std::deque<READ_REQUEST*> m_requests;
+
+	// the thread pool
+	std::vector<std::thread> m_threads;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_queueChanged;
+	std::deque<READ_REQUEST*> m_queued;
+	std::deque<READ_REQUEST*> m_completed;
+	bool m_bStopping;
+
+	bool InitializeRing();
+	void DestroyRing();
+	void SubmitChunks();
+	void SubmitChunk(READ_REQUEST* pRequest, size_t offset, size_t length);
+	void ReapCompletions(bool bWait);
+	void ReadLoop();
+	void Complete(READ_REQUEST* pRequest, READ_COMPLETION& completion);
+};
@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// basicmeshes.cpp
+// ============
+// geometry of the basic shapes the scene is built from, in the shared
+// vertex format of the mesh arena
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BasicMeshes.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// segments around the round shapes
+	const int CIRCLE_SLICES = 36;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  This function is used for appending one vertex.
+	 ***********************************************************/
+	void AddVertex(
+		std::vector<MESH_VERTEX>& vertices,
+		const glm::vec3& position,
+		const glm::vec3& normal,
+		const glm::vec2& textureCoordinate)
+	{
+		MESH_VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.textureCoordinate = textureCoordinate;
+		vertices.push_back(vertex);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  This function is used for appending a flat quad from its
+	 *  corners in counter clockwise order seen from the front,
+	 *  textured with the whole image.
+	 ***********************************************************/
+	void AddQuad(
+		std::vector<MESH_VERTEX>& vertices,
+		std::vector<GLuint>& indices,
+		const glm::vec3 corners[4],
+		const glm::vec3& normal)
+	{
+		GLuint first = (GLuint)vertices.size();
+		AddVertex(vertices, corners[0], normal, glm::vec2(0.0f, 0.0f));
+		AddVertex(vertices, corners[1], normal, glm::vec2(1.0f, 0.0f));
+		AddVertex(vertices, corners[2], normal, glm::vec2(1.0f, 1.0f));
+		AddVertex(vertices, corners[3], normal, glm::vec2(0.0f, 1.0f));
+
+		const GLuint quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int i = 0; i < 6; i++)
+		{
+			indices.push_back(first + quad[i]);
+		}
+	}
+
+	/***********************************************************
+	 *  AddCap()
+	 *
+	 *  This function is used for appending a flat disc at the
+	 *  passed in height, facing up or down, as a fan around its
+	 *  centre with the texture mapped across it.
+	 ***********************************************************/
+	void AddCap(
+		std::vector<MESH_VERTEX>& vertices,
+		std::vector<GLuint>& indices,
+		float height,
+		float radius,
+		bool bFacingUp)
+	{
+		glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+		GLuint center = (GLuint)vertices.size();
+		AddVertex(vertices, glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+
+		for (int i = 0; i <= CIRCLE_SLICES; i++)
+		{
+			float angle = 2.0f * 3.14159265f * (float)i / CIRCLE_SLICES;
+			float x = cosf(angle);
+			float z = sinf(angle);
+			AddVertex(vertices, glm::vec3(x * radius, height, z * radius), normal,
+				glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z));
+		}
+
+		// the angle turns clockwise seen from above
+		for (int i = 0; i < CIRCLE_SLICES; i++)
+		{
+			indices.push_back(center);
+			indices.push_back(center + 1 + (bFacingUp ? i + 1 : i));
+			indices.push_back(center + 1 + (bFacingUp ? i : i + 1));
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildBoxMesh()
+ *
+ *  This function is used for building a unit box centred on
+ *  the origin, with a flat normal and the whole texture on
+ *  each face.
+ ***********************************************************/
+void BuildBoxMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices)
+{
+	const glm::vec3 normals[6] =
+	{
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+	const glm::vec3 faces[6][4] =
+	{
+		{ glm::vec3(-0.5f, -0.5f,  0.5f), glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3( 0.5f,  0.5f,  0.5f), glm::vec3(-0.5f,  0.5f,  0.5f) },
+		{ glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f,  0.5f, -0.5f), glm::vec3( 0.5f,  0.5f, -0.5f) },
+		{ glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3( 0.5f,  0.5f, -0.5f), glm::vec3( 0.5f,  0.5f,  0.5f) },
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f,  0.5f), glm::vec3(-0.5f,  0.5f,  0.5f), glm::vec3(-0.5f,  0.5f, -0.5f) },
+		{ glm::vec3(-0.5f,  0.5f,  0.5f), glm::vec3( 0.5f,  0.5f,  0.5f), glm::vec3( 0.5f,  0.5f, -0.5f), glm::vec3(-0.5f,  0.5f, -0.5f) },
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3(-0.5f, -0.5f,  0.5f) }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		AddQuad(vertices, indices, faces[face], normals[face]);
+	}
+}
+
+/***********************************************************
+ *  BuildPlaneMesh()
+ *
+ *  This function is used for building a square from -1 to 1
+ *  along X and Z at a height of 0, facing up.
+ ***********************************************************/
+void BuildPlaneMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices)
+{
+	const glm::vec3 corners[4] =
+	{
+		glm::vec3(-1.0f, 0.0f,  1.0f), glm::vec3( 1.0f, 0.0f,  1.0f),
+		glm::vec3( 1.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, -1.0f)
+	};
+
+	AddQuad(vertices, indices, corners, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/***********************************************************
+ *  BuildCylinderMesh()
+ *
+ *  This function is used for building a cylinder from y = 0
+ *  to y = 1, narrowing from the bottom radius to the top
+ *  radius.  The side is one strip of quads wrapped once by
+ *  the texture, with normals tilted to follow the slope, and
+ *  the ends are flat discs.
+ ***********************************************************/
+void BuildCylinderMesh(
+	std::vector<MESH_VERTEX>& vertices,
+	std::vector<GLuint>& indices,
+	float bottomRadius,
+	float topRadius)
+{
+	AddCap(vertices, indices, 0.0f, bottomRadius, false);
+	if (topRadius > 0.0f)
+	{
+		AddCap(vertices, indices, 1.0f, topRadius, true);
+	}
+
+	// the side normal leans up by how much the radius shrinks
+	// over the unit height
+	GLuint first = (GLuint)vertices.size();
+	for (int i = 0; i <= CIRCLE_SLICES; i++)
+	{
+		float angle = 2.0f * 3.14159265f * (float)i / CIRCLE_SLICES;
+		float x = cosf(angle);
+		float z = sinf(angle);
+		float u = (float)i / CIRCLE_SLICES;
+		glm::vec3 normal = glm::normalize(glm::vec3(x, bottomRadius - topRadius, z));
+
+		AddVertex(vertices, glm::vec3(x * bottomRadius, 0.0f, z * bottomRadius), normal, glm::vec2(u, 0.0f));
+		AddVertex(vertices, glm::vec3(x * topRadius, 1.0f, z * topRadius), normal, glm::vec2(u, 1.0f));
+	}
+
+	for (int i = 0; i < CIRCLE_SLICES; i++)
+	{
+		GLuint bottom = first + 2 * i;
+		GLuint top = bottom + 1;
+		GLuint nextBottom = bottom + 2;
+		GLuint nextTop = bottom + 3;
+
+		indices.push_back(bottom);
+		indices.push_back(top);
+		indices.push_back(nextBottom);
+		// a cone has no area in the upper triangle
+		if (topRadius > 0.0f)
+		{
+			indices.push_back(nextBottom);
+			indices.push_back(top);
+			indices.push_back(nextTop);
+		}
+	}
+}
@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// basicmeshes.h
+// ============
+// geometry of the basic shapes the scene is built from, in the shared
+// vertex format of the mesh arena
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshArena.h"
+
+#include <vector>
+
+// version of the generated geometry, raise it whenever a function
+// below changes so a mesh cache written before is regenerated
+const unsigned int BASIC_MESHES_VERSION = 1;
+
+// a unit box centred on the origin
+void BuildBoxMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices);
+
+// a 2 x 2 square in the XZ plane facing up
+void BuildPlaneMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices);
+
+// radius at the top of the tapered cylinder
+const float TAPERED_CYLINDER_TOP_RADIUS = 0.5f;
+
+// a closed cylinder of unit height standing on the XZ plane, with the
+// passed in bottom and top radius - a top radius of 0 makes a cone
+void BuildCylinderMesh(
+	std::vector<MESH_VERTEX>& vertices,
+	std::vector<GLuint>& indices,
+	float bottomRadius,
+	float topRadius);
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandlist.cpp
+// ============
+// graphics API independent list of draw commands that can be recorded
+// on any thread and replayed later on the GL thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CommandList.h"
+
+/***********************************************************
+ *  CommandList()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CommandList::CommandList()
+{
+	m_drawCount = 0;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for clearing the recorded commands
+ *  before the list is recorded again.
+ ***********************************************************/
+void CommandList::Reset()
+{
+	m_commands.clear();
+	m_matrices.clear();
+	m_vectors.clear();
+	m_drawCount = 0;
+}
+
+/***********************************************************
+ *  AddCommand()
+ *
+ *  This method is used for appending a command to the list.
+ ***********************************************************/
+void CommandList::AddCommand(COMMAND_TYPE type, int value)
+{
+	COMMAND command;
+	command.type = type;
+	command.value = value;
+	m_commands.push_back(command);
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for recording the model matrix of the
+ *  draws that follow.
+ ***********************************************************/
+void CommandList::SetTransform(const glm::mat4& model)
+{
+	AddCommand(COMMAND_SET_TRANSFORM, (int)m_matrices.size());
+	m_matrices.push_back(model);
+}
+
+/***********************************************************
+ *  SetColor()
+ *
+ *  This method is used for recording a flat color, which
+ *  also turns texturing off for the draws that follow.
+ ***********************************************************/
+void CommandList::SetColor(const glm::vec4& color)
+{
+	AddCommand(COMMAND_SET_COLOR, (int)m_vectors.size());
+	m_vectors.push_back(color);
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method is used for recording the texture slot of the
+ *  draws that follow.
+ ***********************************************************/
+void CommandList::SetTexture(int textureSlot)
+{
+	AddCommand(COMMAND_SET_TEXTURE, textureSlot);
+}
+
+/***********************************************************
+ *  SetUVScale()
+ *
+ *  This method is used for recording the texture coordinate
+ *  scale of the draws that follow.
+ ***********************************************************/
+void CommandList::SetUVScale(const glm::vec2& UVscale)
+{
+	AddCommand(COMMAND_SET_UV_SCALE, (int)m_vectors.size());
+	m_vectors.push_back(glm::vec4(UVscale.x, UVscale.y, 0.0f, 0.0f));
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method is used for recording the material index of
+ *  the draws that follow.
+ ***********************************************************/
+void CommandList::SetMaterial(int materialIndex)
+{
+	AddCommand(COMMAND_SET_MATERIAL, materialIndex);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for recording a draw of the passed in
+ *  mesh with the current state.
+ ***********************************************************/
+void CommandList::DrawMesh(int mesh)
+{
+	AddCommand(COMMAND_DRAW_MESH, mesh);
+	m_drawCount++;
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandlist.h
+// ============
+// graphics API independent list of draw commands that can be recorded
+// on any thread and replayed later on the GL thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// kinds of recorded command
+enum COMMAND_TYPE
+{
+	COMMAND_SET_TRANSFORM,
+	COMMAND_SET_COLOR,
+	COMMAND_SET_TEXTURE,
+	COMMAND_SET_UV_SCALE,
+	COMMAND_SET_MATERIAL,
+	COMMAND_DRAW_MESH
+};
+
+/***********************************************************
+ *  COMMAND
+ *
+ *  One recorded command.  Small arguments such as a mesh,
+ *  texture slot or material index are kept in the value, and
+ *  matrices and vectors are indices into the payload arrays
+ *  of the list.
+ ***********************************************************/
+struct COMMAND
+{
+	COMMAND_TYPE type;
+	int value;
+};
+
+/***********************************************************
+ *  CommandList
+ *
+ *  This class records state changes and draws as plain data,
+ *  with no graphics API calls, so each thread can record into
+ *  its own list without locking.  Commands only change the
+ *  state they name, so replaying a set of lists in the same
+ *  order always gives the same result.  The storage is kept
+ *  across Reset() calls so recording a frame does not
+ *  allocate once the lists have grown to size.
+ ***********************************************************/
+class CommandList
+{
+public:
+	// constructor
+	CommandList();
+
+	// forget the recorded commands, keeping the storage
+	void Reset();
+
+	// record a state change or a draw
+	void SetTransform(const glm::mat4& model);
+	void SetColor(const glm::vec4& color);
+	// a slot of -1 turns texturing off
+	void SetTexture(int textureSlot);
+	void SetUVScale(const glm::vec2& UVscale);
+	void SetMaterial(int materialIndex);
+	void DrawMesh(int mesh);
+
+	// read the recorded commands back
+	size_t GetCommandCount() const { return m_commands.size(); }
+	const COMMAND& GetCommand(size_t index) const { return m_commands[index]; }
+	const glm::mat4& GetMatrix(int index) const { return m_matrices[index]; }
+	const glm::vec4& GetVector(int index) const { return m_vectors[index]; }
+	int GetDrawCount() const { return m_drawCount; }
+
+private:
+	std::vector<COMMAND> m_commands;
+	std::vector<glm::mat4> m_matrices;
+	std::vector<glm::vec4> m_vectors;
+	int m_drawCount;
+
+	void AddCommand(COMMAND_TYPE type, int value);
+};
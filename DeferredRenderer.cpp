@@ -0,0 +1,635 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredrenderer.cpp
+// ============
+// shade the opaque draws from a packed G-buffer instead of per draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DeferredRenderer.h"
+#include "FrameCapture.h"
+#include "GpuMemoryTracker.h"
+
+#include <cstring>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_SceneVertexShader = "./Source/shaders/sceneVertexShader.glsl";
+	const char* g_GBufferFragmentShader = "./Source/shaders/gbufferFragmentShader.glsl";
+	const char* g_FullscreenVertexShader = "./Source/shaders/fullscreenVertexShader.glsl";
+	const char* g_LightingFragmentShader = "./Source/shaders/deferredLightingFragmentShader.glsl";
+	const char* g_IndirectVertexShader = "./Source/shaders/indirectVertexShader.glsl";
+	const char* g_IndirectGBufferFragmentShader = "./Source/shaders/indirectGBufferFragmentShader.glsl";
+
+	// the G-buffer is sampled below the units used by the
+	// transparency renderer, above the scene textures
+	const int ALBEDO_TEXTURE_UNIT = 11;
+	const int NORMAL_TEXTURE_UNIT = 12;
+	const int DEPTH_TEXTURE_UNIT = 13;
+
+	// must match MAX_MATERIALS in the lighting shader, and the
+	// material slot is stored in 8 bits with 0 kept for no material
+	const int MAX_MATERIALS = 32;
+
+	// bytes written per pixel by the G-buffer pass
+	const int GBUFFER_BYTES_PER_PIXEL = 4 + 4 + 4;
+
+	// must match MAX_SCENE_TEXTURES and the shading buffer
+	// binding of the indirect G-buffer shader
+	const int MAX_SCENE_TEXTURES = ALBEDO_TEXTURE_UNIT;
+	const GLuint SHADING_BINDING = 4;
+
+	/***********************************************************
+	 *  IsSameData()
+	 *
+	 *  This function is used for comparing two arrays of plain
+	 *  structs without padding byte for byte.
+	 ***********************************************************/
+	template <typename T>
+	bool IsSameData(const std::vector<T>& first, const std::vector<T>& second)
+	{
+		return((first.size() == second.size()) &&
+			(first.empty() || (0 == memcmp(&first[0], &second[0], first.size() * sizeof(T)))));
+	}
+}
+
+/***********************************************************
+ *  DeferredRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DeferredRenderer::DeferredRenderer()
+{
+	m_pGeometryShader = NULL;
+	m_pLightingShader = NULL;
+	m_pCuller = NULL;
+	m_pIndirectShader = NULL;
+	m_shadingBuffer = 0;
+	m_shadingBytes = 0;
+	m_bGpuCulled = false;
+	m_bPyramidBuilt = false;
+	m_gBufferFramebuffer = 0;
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_depthTexture = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_fullscreenVAO = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		m_timestampQueries[i][0] = 0;
+		m_timestampQueries[i][1] = 0;
+		m_bQueryDeferred[i] = false;
+		m_bQueryPending[i] = false;
+	}
+	m_queryIndex = 0;
+	m_bMeasuring = false;
+	m_bLastDeferred = false;
+	m_stats[0] = DEFERRED_STATS();
+	m_stats[1] = DEFERRED_STATS();
+}
+
+/***********************************************************
+ *  ~DeferredRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DeferredRenderer::~DeferredRenderer()
+{
+	ShaderManager** shaders[2] = { &m_pGeometryShader, &m_pLightingShader };
+
+	DestroyGBuffer();
+
+	// the programs stay in the resource cache for the next scene
+	for (int i = 0; i < 2; i++)
+	{
+		if (NULL != *shaders[i])
+		{
+			delete *shaders[i];
+			*shaders[i] = NULL;
+		}
+		m_programs[i].Release();
+	}
+	if (NULL != m_pCuller)
+	{
+		delete m_pCuller;
+		m_pCuller = NULL;
+	}
+	if (NULL != m_pIndirectShader)
+	{
+		delete m_pIndirectShader;
+		m_pIndirectShader = NULL;
+	}
+	m_indirectProgram.Release();
+	if (0 != m_shadingBuffer)
+	{
+		glDeleteBuffers(1, &m_shadingBuffer);
+		m_shadingBuffer = 0;
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -m_shadingBytes);
+		m_shadingBytes = 0;
+	}
+	if (0 != m_fullscreenVAO)
+	{
+		glDeleteVertexArrays(1, &m_fullscreenVAO);
+		m_fullscreenVAO = 0;
+	}
+	if (0 != m_timestampQueries[0][0])
+	{
+		glDeleteQueries(4, &m_timestampQueries[0][0]);
+		m_timestampQueries[0][0] = m_timestampQueries[0][1] = 0;
+		m_timestampQueries[1][0] = m_timestampQueries[1][1] = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the shader programs and
+ *  setting the scene lights and the material table into the
+ *  lighting program.  The materials do not change after the
+ *  scene is prepared, so they are only set once.
+ ***********************************************************/
+bool DeferredRenderer::Initialize(SceneManager* pSceneManager)
+{
+	const std::vector<SceneManager::OBJECT_MATERIAL>& materials = pSceneManager->GetObjectMaterials();
+	if (materials.size() > MAX_MATERIALS)
+	{
+		std::cout << "Too many materials for the deferred lighting pass:" << materials.size() << std::endl;
+		return(false);
+	}
+
+	ResourceCache* pResourceCache = pSceneManager->GetResourceCache();
+	m_programs[0] = pResourceCache->AcquireProgram(g_SceneVertexShader, NULL, g_GBufferFragmentShader);
+	m_programs[1] = pResourceCache->AcquireProgram(g_FullscreenVertexShader, NULL, g_LightingFragmentShader);
+	if (!m_programs[0].IsValid() || !m_programs[1].IsValid())
+	{
+		m_programs[0].Release();
+		m_programs[1].Release();
+		return(false);
+	}
+
+	m_pGeometryShader = new ShaderManager();
+	m_pGeometryShader->m_programID = m_programs[0].GetID();
+	m_pLightingShader = new ShaderManager();
+	m_pLightingShader->m_programID = m_programs[1].GetID();
+
+	m_pLightingShader->use();
+	m_pLightingShader->setSampler2DValue("albedoTexture", ALBEDO_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("normalTexture", NORMAL_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("depthTexture", DEPTH_TEXTURE_UNIT);
+	m_pLightingShader->setIntValue("materialCount", (int)materials.size());
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		std::string name = "materials[" + std::to_string(i) + "].";
+		m_pLightingShader->setVec3Value(name + "ambientColor", materials[i].ambientColor);
+		m_pLightingShader->setFloatValue(name + "ambientStrength", materials[i].ambientStrength);
+		m_pLightingShader->setVec3Value(name + "diffuseColor", materials[i].diffuseColor);
+		m_pLightingShader->setVec3Value(name + "specularColor", materials[i].specularColor);
+		m_pLightingShader->setFloatValue(name + "shininess", materials[i].shininess);
+		m_pLightingShader->setFloatValue(name + "alpha", materials[i].alpha);
+	}
+
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+	pSceneManager->SetShaderManager(m_pLightingShader);
+	pSceneManager->SetupSceneLights();
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	glGenVertexArrays(1, &m_fullscreenVAO);
+	glGenQueries(4, &m_timestampQueries[0][0]);
+
+	InitializeGpuCulling(pResourceCache);
+
+	return(true);
+}
+
+/***********************************************************
+ *  InitializeGpuCulling()
+ *
+ *  This method is used for loading the GPU culling pass and
+ *  the G-buffer program its draws are made with.  The draws
+ *  need OpenGL 4.6 for the indirect count and the base
+ *  instance in the shader, and without it the opaque items
+ *  are culled on the CPU as before.
+ ***********************************************************/
+void DeferredRenderer::InitializeGpuCulling(ResourceCache* pResourceCache)
+{
+	if (NULL == glMultiDrawElementsIndirectCount)
+	{
+		std::cout << "OpenGL 4.6 not available, the deferred pass culls on the CPU" << std::endl;
+		return;
+	}
+
+	m_indirectProgram = pResourceCache->AcquireProgram(g_IndirectVertexShader, NULL, g_IndirectGBufferFragmentShader);
+	m_pCuller = new GpuCuller();
+	if (!m_indirectProgram.IsValid() || !m_pCuller->Initialize(pResourceCache))
+	{
+		std::cout << "GPU culling shaders not loaded, the deferred pass culls on the CPU" << std::endl;
+		delete m_pCuller;
+		m_pCuller = NULL;
+		m_indirectProgram.Release();
+		return;
+	}
+
+	m_pIndirectShader = new ShaderManager();
+	m_pIndirectShader->m_programID = m_indirectProgram.GetID();
+	m_pIndirectShader->use();
+	for (int i = 0; i < MAX_SCENE_TEXTURES; i++)
+	{
+		m_pIndirectShader->setSampler2DValue("objectTextures[" + std::to_string(i) + "]", i);
+	}
+
+	glGenBuffers(1, &m_shadingBuffer);
+}
+
+/***********************************************************
+ *  CreateGBuffer()
+ *
+ *  This method is used for creating the packed G-buffer.  The
+ *  depth format matches the default framebuffer so that it
+ *  can be copied out with a blit after the lighting pass.
+ ***********************************************************/
+bool DeferredRenderer::CreateGBuffer(int width, int height)
+{
+	if ((0 != m_gBufferFramebuffer) && (width == m_targetWidth) && (height == m_targetHeight))
+	{
+		return(true);
+	}
+
+	DestroyGBuffer();
+
+	glGenTextures(1, &m_albedoTexture);
+	glBindTexture(GL_TEXTURE_2D, m_albedoTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+
+	glGenTextures(1, &m_normalTexture);
+	glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16_SNORM, width, height);
+
+	glGenTextures(1, &m_depthTexture);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_gBufferFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_gBufferFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "G-buffer framebuffer is incomplete, status:" << status << std::endl;
+		DestroyGBuffer();
+		return(false);
+	}
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)width * height * GBUFFER_BYTES_PER_PIXEL);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyGBuffer()
+ *
+ *  This method is used for freeing the G-buffer.
+ ***********************************************************/
+void DeferredRenderer::DestroyGBuffer()
+{
+	GLuint* textures[3] = { &m_albedoTexture, &m_normalTexture, &m_depthTexture };
+
+	if (0 != m_gBufferFramebuffer)
+	{
+		glDeleteFramebuffers(1, &m_gBufferFramebuffer);
+		m_gBufferFramebuffer = 0;
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		if (0 != *textures[i])
+		{
+			glDeleteTextures(1, textures[i]);
+			*textures[i] = 0;
+		}
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)m_targetWidth * m_targetHeight * GBUFFER_BYTES_PER_PIXEL);
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for writing the opaque items into the
+ *  G-buffer and lighting them with one full screen triangle.
+ *  The scene lights have no falloff radius, so every light
+ *  covers the whole screen and bounded light volumes would
+ *  not cull anything - all lights are applied in one pass
+ *  that reads the G-buffer once per pixel instead.  Returns
+ *  false when the G-buffer cannot be created, so the caller
+ *  can fall back to forward shading.
+ ***********************************************************/
+bool DeferredRenderer::Render(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& opaqueItems,
+	bool bGpuCulling,
+	bool bOcclusion)
+{
+	m_bGpuCulled = false;
+	if ((NULL == pSceneManager) || (NULL == m_pGeometryShader))
+	{
+		return(false);
+	}
+
+	GLint viewport[4];
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	if (!CreateGBuffer(viewport[2], viewport[3]))
+	{
+		return(false);
+	}
+
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+
+	// geometry pass - only the surface attributes are written
+	glBindFramebuffer(GL_FRAMEBUFFER, m_gBufferFramebuffer);
+	glViewport(0, 0, viewport[2], viewport[3]);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearDepth = 1.0f;
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferfv(GL_COLOR, 1, clearColor);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+	glm::mat4 viewProjection = pSceneManager->GetProjectionMatrix() * pSceneManager->GetViewMatrix();
+	if (bGpuCulling && (NULL != m_pCuller))
+	{
+		m_bGpuCulled = DrawCulledItems(pSceneManager, drawList, opaqueItems, viewProjection, bOcclusion);
+	}
+	if (!m_bGpuCulled)
+	{
+		m_pGeometryShader->use();
+		pSceneManager->SetShaderManager(m_pGeometryShader);
+		pSceneManager->ApplyViewTransform();
+		for (size_t i = 0; i < opaqueItems.size(); i++)
+		{
+			const SceneManager::DRAW_ITEM& item = drawList[opaqueItems[i]];
+			m_pGeometryShader->setIntValue("materialIndex", item.materialIndex);
+			pSceneManager->SubmitDrawItem(item);
+		}
+	}
+	pSceneManager->SetShaderManager(pPreviousShader);
+
+	// the occlusion test of the next frame reads the depth of
+	// this one, and an older pyramid is not trusted
+	m_bPyramidBuilt = false;
+	if (m_bGpuCulled && bOcclusion)
+	{
+		m_pCuller->BuildDepthPyramid(m_depthTexture, viewport[2], viewport[3], viewProjection);
+		m_bPyramidBuilt = true;
+	}
+
+	// the transparent pass depth tests against the opaque
+	// surfaces, so the G-buffer depth is copied out first
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_gBufferFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+	glBlitFramebuffer(
+		0, 0, viewport[2], viewport[3],
+		viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3],
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	// lighting pass
+	glDepthFunc(GL_ALWAYS);
+	glDepthMask(GL_FALSE);
+
+	glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_albedoTexture);
+	glActiveTexture(GL_TEXTURE0 + NORMAL_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+	glActiveTexture(GL_TEXTURE0 + DEPTH_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	m_pLightingShader->use();
+	m_pLightingShader->setMat4Value("inverseViewProjection", glm::inverse(viewProjection));
+	m_pLightingShader->setVec3Value("viewPosition", pSceneManager->GetViewPosition());
+	m_pLightingShader->setVec2Value("viewportOrigin", (float)viewport[0], (float)viewport[1]);
+	// the scene meshes stay bound through the frame
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glBindVertexArray(m_fullscreenVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(previousVertexArray);
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawCulledItems()
+ *
+ *  This method is used for handing the opaque items to the
+ *  GPU culling pass and drawing the ones it keeps into the
+ *  bound G-buffer.  The objects are rebuilt from the draw
+ *  list every frame but only uploaded when they changed, so
+ *  a still scene costs the culling dispatch and one draw.
+ ***********************************************************/
+bool DeferredRenderer::DrawCulledItems(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& opaqueItems,
+	const glm::mat4& viewProjection,
+	bool bOcclusion)
+{
+	const MeshArena* pArena = pSceneManager->GetMeshArena();
+	if (NULL == pArena)
+	{
+		return(false);
+	}
+
+	// the placeholder boxes and the real meshes have their own
+	// ranges, and the arena holding them can change
+	m_frameMeshes.resize(pArena->GetMeshCount());
+	for (int mesh = 0; mesh < pArena->GetMeshCount(); mesh++)
+	{
+		const MESH_RANGE& range = pArena->GetRange(mesh);
+		m_frameMeshes[mesh].indexCount = range.indexCount;
+		m_frameMeshes[mesh].firstIndex = range.firstIndex;
+		m_frameMeshes[mesh].baseVertex = range.baseVertex;
+		m_frameMeshes[mesh].padding = 0;
+	}
+	if (!IsSameData(m_frameMeshes, m_cullMeshes))
+	{
+		m_cullMeshes.swap(m_frameMeshes);
+		m_pCuller->SetMeshes(m_cullMeshes);
+	}
+
+	m_frameObjects.clear();
+	m_frameShading.clear();
+	for (size_t i = 0; i < opaqueItems.size(); i++)
+	{
+		const SceneManager::DRAW_ITEM& item = drawList[opaqueItems[i]];
+		if ((int)item.mesh >= pArena->GetMeshCount())
+		{
+			continue;
+		}
+
+		CULL_OBJECT object;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		SceneManager::GetMeshBounds(item.mesh, boundsMin, boundsMax);
+		object.model = item.model;
+		object.boundsMin = glm::vec4(boundsMin, 0.0f);
+		object.boundsMax = glm::vec4(boundsMax, 0.0f);
+		object.mesh = (unsigned int)item.mesh;
+		object.padding[0] = object.padding[1] = object.padding[2] = 0;
+		m_frameObjects.push_back(object);
+
+		OBJECT_SHADING shading;
+		shading.color = item.color;
+		shading.UVscale = item.UVscale;
+		shading.textureSlot = (item.bUseTexture && (item.textureSlot < MAX_SCENE_TEXTURES)) ? item.textureSlot : -1;
+		shading.materialIndex = item.materialIndex;
+		m_frameShading.push_back(shading);
+	}
+	if (!IsSameData(m_frameObjects, m_cullObjects))
+	{
+		m_cullObjects.swap(m_frameObjects);
+		m_pCuller->SetObjects(m_cullObjects);
+	}
+	if (!IsSameData(m_frameShading, m_objectShading))
+	{
+		m_objectShading.swap(m_frameShading);
+		long long bytes = (long long)m_objectShading.size() * sizeof(OBJECT_SHADING);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_shadingBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, m_objectShading.empty() ? NULL : &m_objectShading[0], GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		TrackGpuMemory(GPU_MEMORY_BUFFER, bytes - m_shadingBytes);
+		m_shadingBytes = bytes;
+	}
+
+	m_pCuller->Cull(viewProjection, bOcclusion && m_bPyramidBuilt);
+
+	m_pIndirectShader->use();
+	pSceneManager->SetShaderManager(m_pIndirectShader);
+	pSceneManager->ApplyViewTransform();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SHADING_BINDING, m_shadingBuffer);
+	m_pCuller->Draw(GL_TRIANGLES);
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginMeasurement()
+ *
+ *  This method is used for writing the start timestamp of the
+ *  opaque pass.  Timestamps are used rather than an elapsed
+ *  time query, since the depth pre-pass measurement inside
+ *  the forward path already uses one and they cannot nest.
+ ***********************************************************/
+void DeferredRenderer::BeginMeasurement(bool bDeferred)
+{
+	CollectTimings(bDeferred);
+
+	// the query slot is only reused after its result was read
+	if ((0 == m_timestampQueries[0][0]) || m_bQueryPending[m_queryIndex])
+	{
+		return;
+	}
+
+	glQueryCounter(m_timestampQueries[m_queryIndex][0], GL_TIMESTAMP);
+	m_bQueryDeferred[m_queryIndex] = bDeferred;
+	m_bMeasuring = true;
+}
+
+/***********************************************************
+ *  EndMeasurement()
+ *
+ *  This method is used for writing the end timestamp of the
+ *  opaque pass.
+ ***********************************************************/
+void DeferredRenderer::EndMeasurement()
+{
+	if (m_bMeasuring)
+	{
+		glQueryCounter(m_timestampQueries[m_queryIndex][1], GL_TIMESTAMP);
+		m_bQueryPending[m_queryIndex] = true;
+		m_queryIndex = 1 - m_queryIndex;
+		m_bMeasuring = false;
+	}
+}
+
+/***********************************************************
+ *  CollectTimings()
+ *
+ *  This method is used for reading the finished timestamps
+ *  without waiting on the GPU, and for printing the cost of
+ *  both shading paths whenever the path is switched.
+ ***********************************************************/
+void DeferredRenderer::CollectTimings(bool bDeferred)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (!m_bQueryPending[i])
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timestampQueries[i][1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 startTime = 0;
+			GLuint64 endTime = 0;
+			glGetQueryObjectui64v(m_timestampQueries[i][0], GL_QUERY_RESULT, &startTime);
+			glGetQueryObjectui64v(m_timestampQueries[i][1], GL_QUERY_RESULT, &endTime);
+
+			DEFERRED_STATS& stats = m_stats[m_bQueryDeferred[i] ? 1 : 0];
+			stats.frames++;
+			stats.lastGpuMilliseconds = (endTime - startTime) / 1000000.0;
+			stats.gpuMilliseconds += stats.lastGpuMilliseconds;
+			m_bQueryPending[i] = false;
+		}
+	}
+
+	if (bDeferred != m_bLastDeferred)
+	{
+		const char* names[2] = { "forward", "deferred" };
+		std::cout << "INFO: Opaque pass per frame:";
+		for (int i = 0; i < 2; i++)
+		{
+			if (m_stats[i].frames > 0)
+			{
+				std::cout << " " << names[i]
+					<< " " << m_stats[i].gpuMilliseconds / m_stats[i].frames << " ms"
+					<< " (" << m_stats[i].frames << " frames)";
+			}
+		}
+		std::cout << ", G-buffer " << GBUFFER_BYTES_PER_PIXEL << " bytes per pixel at "
+			<< m_targetWidth << "x" << m_targetHeight << std::endl;
+		m_bLastDeferred = bDeferred;
+	}
+}
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredrenderer.h
+// ============
+// shade the opaque draws from a packed G-buffer instead of per draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "GpuCuller.h"
+
+#include <vector>
+
+/***********************************************************
+ *  DeferredRenderer
+ *
+ *  This class renders the opaque items into a G-buffer and
+ *  lights them in one full screen pass, so the lighting cost
+ *  is paid once per pixel instead of once per shaded
+ *  fragment.  The G-buffer is packed to 12 bytes per pixel -
+ *  RGBA8 albedo with the material slot in alpha, an RG16
+ *  octahedral normal and the depth buffer, which the lighting
+ *  pass uses to rebuild the position.  The opaque pass is
+ *  timed on the GPU for both paths so they can be compared.
+ *  When the GPU culling programs load, the opaque items can
+ *  instead be handed to a GpuCuller, which tests them against
+ *  the frustum and optionally the depth of the last frame and
+ *  writes the survivors into the G-buffer with one indirect
+ *  multi-draw.
+ ***********************************************************/
+class DeferredRenderer
+{
+public:
+	// constructor
+	DeferredRenderer();
+	// destructor
+	~DeferredRenderer();
+
+	// running cost of the opaque pass for one shading path
+	struct DEFERRED_STATS
+	{
+		int frames;
+		double gpuMilliseconds;
+		// cost of the most recently finished frame
+		double lastGpuMilliseconds;
+	};
+
+	// load the G-buffer and lighting programs and set the scene
+	// lights and materials into the lighting program
+	bool Initialize(SceneManager* pSceneManager);
+
+	// draw the opaque items into the G-buffer and light them
+	// into the current framebuffer, copying the depth across
+	// for the passes that follow - the items are culled on the
+	// GPU when asked and it is available, and are expected to
+	// be culled already otherwise
+	bool Render(
+		SceneManager* pSceneManager,
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& opaqueItems,
+		bool bGpuCulling,
+		bool bOcclusion);
+
+	// whether the opaque items can be culled on the GPU
+	bool HasGpuCulling() const { return (NULL != m_pCuller); }
+	// whether the last Render() culled the items on the GPU
+	bool WasGpuCulled() const { return m_bGpuCulled; }
+
+	// time the opaque pass with either shading path
+	void BeginMeasurement(bool bDeferred);
+	void EndMeasurement();
+
+	// measured cost with the deferred (true) or forward (false) path
+	const DEFERRED_STATS& GetStats(bool bDeferred) const { return m_stats[bDeferred ? 1 : 0]; }
+
+private:
+	// the color, texture and material of an object drawn by
+	// the GPU culling pass, laid out as the std430 struct of
+	// the indirect G-buffer shader
+	struct OBJECT_SHADING
+	{
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		// -1 for the flat color or no material
+		int textureSlot;
+		int materialIndex;
+	};
+
+	// shader managers for the G-buffer and lighting programs
+	ShaderManager* m_pGeometryShader;
+	ShaderManager* m_pLightingShader;
+	// references to the programs in the resource cache
+	ResourceHandle m_programs[2];
+	// the GPU culling pass and the G-buffer program of its
+	// draws, NULL when they could not be loaded
+	GpuCuller* m_pCuller;
+	ShaderManager* m_pIndirectShader;
+	ResourceHandle m_indirectProgram;
+	GLuint m_shadingBuffer;
+	long long m_shadingBytes;
+	// what was last uploaded to the culler, so a scene that did
+	// not change is not uploaded again
+	std::vector<CULL_MESH> m_cullMeshes;
+	std::vector<CULL_OBJECT> m_cullObjects;
+	std::vector<OBJECT_SHADING> m_objectShading;
+	// built each frame and compared with the uploaded ones
+	std::vector<CULL_MESH> m_frameMeshes;
+	std::vector<CULL_OBJECT> m_frameObjects;
+	std::vector<OBJECT_SHADING> m_frameShading;
+	bool m_bGpuCulled;
+	// the depth pyramid was built from the last frame
+	bool m_bPyramidBuilt;
+	// packed G-buffer render target
+	GLuint m_gBufferFramebuffer;
+	GLuint m_albedoTexture;
+	GLuint m_normalTexture;
+	GLuint m_depthTexture;
+	int m_targetWidth;
+	int m_targetHeight;
+	// empty vertex array for the full screen triangle
+	GLuint m_fullscreenVAO;
+	// start and end timestamps, alternated so the results are
+	// read a frame late without stalling
+	GLuint m_timestampQueries[2][2];
+	bool m_bQueryDeferred[2];
+	bool m_bQueryPending[2];
+	int m_queryIndex;
+	bool m_bMeasuring;
+	bool m_bLastDeferred;
+	DEFERRED_STATS m_stats[2];
+
+	// create or resize the G-buffer
+	bool CreateGBuffer(int width, int height);
+	void DestroyGBuffer();
+	// load the GPU culling pass, leaving it NULL on failure
+	void InitializeGpuCulling(ResourceCache* pResourceCache);
+	// cull the opaque items on the GPU and draw the survivors
+	// into the bound G-buffer, false when the meshes are not in
+	bool DrawCulledItems(
+		SceneManager* pSceneManager,
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& opaqueItems,
+		const glm::mat4& viewProjection,
+		bool bOcclusion);
+	// collect finished timings and report on a path switch
+	void CollectTimings(bool bDeferred);
+};
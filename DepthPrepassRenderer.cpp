@@ -0,0 +1,284 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthprepassrenderer.cpp
+// ============
+// lay down the opaque depth before shading to exploit early-Z
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DepthPrepassRenderer.h"
+
+// declaration of global variables
+namespace
+{
+	const char* g_DepthOnlyVertexShader = "./Source/shaders/depthOnlyVertexShader.glsl";
+	const char* g_DepthOnlyFragmentShader = "./Source/shaders/depthOnlyFragmentShader.glsl";
+	const char* g_SceneVertexShader = "./Source/shaders/sceneVertexShader.glsl";
+	const char* g_ForwardFragmentShader = "./Source/shaders/forwardFragmentShader.glsl";
+}
+
+/***********************************************************
+ *  DepthPrepassRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DepthPrepassRenderer::DepthPrepassRenderer()
+{
+	m_pDepthShader = NULL;
+	m_pShadingShader = NULL;
+	m_pPreviousShader = NULL;
+	m_fragmentQueries[0] = 0;
+	m_fragmentQueries[1] = 0;
+	m_timerQueries[0] = 0;
+	m_timerQueries[1] = 0;
+	m_bQueryPrepass[0] = false;
+	m_bQueryPrepass[1] = false;
+	m_bQueryPending[0] = false;
+	m_bQueryPending[1] = false;
+	m_queryIndex = 0;
+	m_bMeasuring = false;
+	m_bCountingFragments = false;
+	m_bDepthReadOnly = false;
+	m_bLastPrepass = false;
+	m_stats[0] = PREPASS_STATS();
+	m_stats[1] = PREPASS_STATS();
+}
+
+/***********************************************************
+ *  ~DepthPrepassRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DepthPrepassRenderer::~DepthPrepassRenderer()
+{
+	ShaderManager** shaders[2] = { &m_pDepthShader, &m_pShadingShader };
+
+	// the programs stay in the resource cache for the next scene
+	for (int i = 0; i < 2; i++)
+	{
+		if (NULL != *shaders[i])
+		{
+			delete *shaders[i];
+			*shaders[i] = NULL;
+		}
+		m_programs[i].Release();
+	}
+	if (0 != m_fragmentQueries[0])
+	{
+		glDeleteQueries(2, m_fragmentQueries);
+		glDeleteQueries(2, m_timerQueries);
+		m_fragmentQueries[0] = m_fragmentQueries[1] = 0;
+		m_timerQueries[0] = m_timerQueries[1] = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the depth-only and shading
+ *  programs, setting the scene lights into the shading program
+ *  and creating the statistics queries.
+ ***********************************************************/
+bool DepthPrepassRenderer::Initialize(SceneManager* pSceneManager)
+{
+	ResourceCache* pResourceCache = pSceneManager->GetResourceCache();
+	m_programs[0] = pResourceCache->AcquireProgram(g_DepthOnlyVertexShader, NULL, g_DepthOnlyFragmentShader);
+	m_programs[1] = pResourceCache->AcquireProgram(g_SceneVertexShader, NULL, g_ForwardFragmentShader);
+	if (!m_programs[0].IsValid() || !m_programs[1].IsValid())
+	{
+		m_programs[0].Release();
+		m_programs[1].Release();
+		return(false);
+	}
+
+	m_pDepthShader = new ShaderManager();
+	m_pDepthShader->m_programID = m_programs[0].GetID();
+	m_pShadingShader = new ShaderManager();
+	m_pShadingShader->m_programID = m_programs[1].GetID();
+
+	// uniforms belong to a program, so the lights are set into
+	// the shading program through the scene manager
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+	m_pShadingShader->use();
+	pSceneManager->SetShaderManager(m_pShadingShader);
+	pSceneManager->SetupSceneLights();
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	glGenQueries(2, m_fragmentQueries);
+	glGenQueries(2, m_timerQueries);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RenderDepth()
+ *
+ *  This method is used for drawing the opaque items without
+ *  color writes and leaving the depth state and program set
+ *  up for the shading pass - only fragments on or in front of
+ *  the stored depth pass, and depth writes are off since the
+ *  depth is final.  The shading program computes the same
+ *  invariant position as the depth-only one, which the main
+ *  program from outside the project does not.
+ ***********************************************************/
+void DepthPrepassRenderer::RenderDepth(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& opaqueItems)
+{
+	if ((NULL == pSceneManager) || (NULL == m_pDepthShader))
+	{
+		return;
+	}
+
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	m_pDepthShader->use();
+	pSceneManager->SetShaderManager(m_pDepthShader);
+	pSceneManager->ApplyViewTransform();
+	for (size_t i = 0; i < opaqueItems.size(); i++)
+	{
+		pSceneManager->SubmitDrawItemGeometry(drawList[opaqueItems[i]]);
+	}
+
+	// the main program is put back by EndMeasurement()
+	m_pPreviousShader = pPreviousShader;
+	m_pShadingShader->use();
+	pSceneManager->SetShaderManager(m_pShadingShader);
+	pSceneManager->ApplyViewTransform();
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthFunc(GL_LEQUAL);
+	glDepthMask(GL_FALSE);
+	m_bDepthReadOnly = true;
+}
+
+/***********************************************************
+ *  BeginMeasurement()
+ *
+ *  This method is used for starting the timer query around
+ *  the pre-pass and the opaque shading pass.
+ ***********************************************************/
+void DepthPrepassRenderer::BeginMeasurement(bool bPrepass)
+{
+	CollectStatistics(bPrepass);
+
+	// the query slot is only reused after its result was read
+	if ((0 == m_fragmentQueries[0]) || m_bQueryPending[m_queryIndex])
+	{
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_queryIndex]);
+	m_bQueryPrepass[m_queryIndex] = bPrepass;
+	m_bMeasuring = true;
+}
+
+/***********************************************************
+ *  BeginShadingPass()
+ *
+ *  This method is used for starting the fragment shader
+ *  invocation count for the shaded opaque draws.
+ ***********************************************************/
+void DepthPrepassRenderer::BeginShadingPass()
+{
+	if (m_bMeasuring)
+	{
+		glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, m_fragmentQueries[m_queryIndex]);
+		m_bCountingFragments = true;
+	}
+}
+
+/***********************************************************
+ *  EndMeasurement()
+ *
+ *  This method is used for ending the queries and restoring
+ *  the default depth state and the main program after the
+ *  shading pass.
+ ***********************************************************/
+void DepthPrepassRenderer::EndMeasurement(SceneManager* pSceneManager)
+{
+	if (m_bMeasuring && m_bCountingFragments)
+	{
+		glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+		glEndQuery(GL_TIME_ELAPSED);
+		m_bCountingFragments = false;
+		m_bQueryPending[m_queryIndex] = true;
+		m_queryIndex = 1 - m_queryIndex;
+		m_bMeasuring = false;
+	}
+
+	if (m_bDepthReadOnly)
+	{
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+		m_bDepthReadOnly = false;
+	}
+
+	if (NULL != m_pPreviousShader)
+	{
+		pSceneManager->SetShaderManager(m_pPreviousShader);
+		m_pPreviousShader->use();
+		m_pPreviousShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  CollectStatistics()
+ *
+ *  This method is used for reading the finished queries
+ *  without waiting on the GPU, and for printing the cost with
+ *  and without the pre-pass whenever it is toggled.
+ ***********************************************************/
+void DepthPrepassRenderer::CollectStatistics(bool bPrepass)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (!m_bQueryPending[i])
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 fragments = 0;
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(m_fragmentQueries[i], GL_QUERY_RESULT, &fragments);
+			glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &nanoseconds);
+
+			PREPASS_STATS& stats = m_stats[m_bQueryPrepass[i] ? 1 : 0];
+			stats.frames++;
+			stats.fragmentsShaded += (double)fragments;
+			stats.lastGpuMilliseconds = nanoseconds / 1000000.0;
+			stats.gpuMilliseconds += stats.lastGpuMilliseconds;
+			m_bQueryPending[i] = false;
+		}
+	}
+
+	if (bPrepass != m_bLastPrepass)
+	{
+		const char* names[2] = { "without pre-pass", "with pre-pass" };
+		std::cout << "INFO: Opaque shading pass per frame:";
+		for (int i = 0; i < 2; i++)
+		{
+			if (m_stats[i].frames > 0)
+			{
+				std::cout << " " << names[i]
+					<< " " << (long long)(m_stats[i].fragmentsShaded / m_stats[i].frames) << " fragments"
+					<< " " << m_stats[i].gpuMilliseconds / m_stats[i].frames << " ms"
+					<< " (" << m_stats[i].frames << " frames)";
+			}
+		}
+		std::cout << std::endl;
+		m_bLastPrepass = bPrepass;
+	}
+}
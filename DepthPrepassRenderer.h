@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthprepassrenderer.h
+// ============
+// lay down the opaque depth before shading to exploit early-Z
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+
+#include <vector>
+
+/***********************************************************
+ *  DepthPrepassRenderer
+ *
+ *  This class renders the opaque items depth-only with a
+ *  trivial shader, so that the following shading pass runs
+ *  with GL_LEQUAL depth testing and only shades the visible
+ *  fragments.  After the pre-pass the opaque items are shaded
+ *  with its own Phong program rather than the main one, as
+ *  both of its vertex shaders compute an invariant position
+ *  with the same expression and so produce the same depth.
+ *  The shading pass is measured with a fragment shader
+ *  invocation query whether the pre-pass is on or off, so
+ *  both can be compared on the same scene.
+ ***********************************************************/
+class DepthPrepassRenderer
+{
+public:
+	// constructor
+	DepthPrepassRenderer();
+	// destructor
+	~DepthPrepassRenderer();
+
+	// running cost of the opaque pass with or without the pre-pass
+	struct PREPASS_STATS
+	{
+		int frames;
+		double fragmentsShaded;
+		double gpuMilliseconds;
+		// cost of the most recently finished frame
+		double lastGpuMilliseconds;
+	};
+
+	// load the depth-only and shading programs through the
+	// cache and set the scene lights into the shading program
+	bool Initialize(SceneManager* pSceneManager);
+
+	// draw the opaque items into the depth buffer only and set
+	// up the depth state and program for the shading pass
+	void RenderDepth(
+		SceneManager* pSceneManager,
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& opaqueItems);
+
+	// measure the opaque pass - BeginMeasurement() goes before
+	// the optional pre-pass so its cost is part of the timing,
+	// BeginShadingPass() before the shaded draws so only their
+	// fragments are counted, and EndMeasurement() after them
+	void BeginMeasurement(bool bPrepass);
+	void BeginShadingPass();
+	void EndMeasurement(SceneManager* pSceneManager);
+
+	// measured cost with the pre-pass on (true) or off (false)
+	const PREPASS_STATS& GetStats(bool bPrepass) const { return m_stats[bPrepass ? 1 : 0]; }
+
+private:
+	// shader managers wrapping the depth-only program and the
+	// program that shades after it
+	ShaderManager* m_pDepthShader;
+	ShaderManager* m_pShadingShader;
+	// references to the programs in the resource cache
+	ResourceHandle m_programs[2];
+	// the scene program to restore after the shading pass, NULL
+	// when the pre-pass did not replace it
+	ShaderManager* m_pPreviousShader;
+	// fragment count and timer queries, alternated so the
+	// results are read a frame late without stalling
+	GLuint m_fragmentQueries[2];
+	GLuint m_timerQueries[2];
+	bool m_bQueryPrepass[2];
+	bool m_bQueryPending[2];
+	int m_queryIndex;
+	bool m_bMeasuring;
+	bool m_bCountingFragments;
+	bool m_bDepthReadOnly;
+	bool m_bLastPrepass;
+	PREPASS_STATS m_stats[2];
+
+	// collect finished queries and report on a mode switch
+	void CollectStatistics(bool bPrepass);
+};
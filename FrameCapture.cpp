@@ -0,0 +1,2556 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// record the GL calls of one frame to a file and replay them in a
+// tight loop to measure the driver cost of each call type
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+// the name alone is still the GL library's glDrawArrays
+PFNCAPTUREDRAWARRAYSPROC g_CaptureDrawArrays = glDrawArrays;
+
+// declaration of global variables
+namespace
+{
+	// file identification and version of the capture format
+	const char g_CaptureMagic[4] = { 'G', 'L', 'F', 'C' };
+	const uint32_t CAPTURE_VERSION = 1;
+	// texture units included in the fixed-function snapshot
+	const int SNAPSHOT_TEXTURE_UNITS = 16;
+
+	// fixed-function state set through GL 1.1 entry points
+	struct FIXED_STATE
+	{
+		uint8_t depthTest;
+		uint8_t blend;
+		uint8_t cullFace;
+		uint8_t depthMask;
+		uint8_t colorMask[4];
+		int32_t depthFunc;
+		int32_t blendSrc;
+		int32_t blendDst;
+		int32_t viewport[4];
+		uint32_t textures[SNAPSHOT_TEXTURE_UNITS];
+	};
+
+	// how a recorded uniform value is set again
+	enum UNIFORM_KIND
+	{
+		UNIFORM_FLOAT,
+		UNIFORM_INT,
+		UNIFORM_UINT,
+		UNIFORM_MATRIX
+	};
+
+	// uniform types that do not hold a single int
+	struct UNIFORM_LAYOUT
+	{
+		GLenum type;
+		int kind;
+		int components;
+	};
+
+	const UNIFORM_LAYOUT g_UniformLayouts[] =
+	{
+		{ GL_FLOAT, UNIFORM_FLOAT, 1 },
+		{ GL_FLOAT_VEC2, UNIFORM_FLOAT, 2 },
+		{ GL_FLOAT_VEC3, UNIFORM_FLOAT, 3 },
+		{ GL_FLOAT_VEC4, UNIFORM_FLOAT, 4 },
+		{ GL_INT_VEC2, UNIFORM_INT, 2 },
+		{ GL_INT_VEC3, UNIFORM_INT, 3 },
+		{ GL_INT_VEC4, UNIFORM_INT, 4 },
+		{ GL_BOOL_VEC2, UNIFORM_INT, 2 },
+		{ GL_BOOL_VEC3, UNIFORM_INT, 3 },
+		{ GL_BOOL_VEC4, UNIFORM_INT, 4 },
+		{ GL_UNSIGNED_INT, UNIFORM_UINT, 1 },
+		{ GL_UNSIGNED_INT_VEC2, UNIFORM_UINT, 2 },
+		{ GL_UNSIGNED_INT_VEC3, UNIFORM_UINT, 3 },
+		{ GL_UNSIGNED_INT_VEC4, UNIFORM_UINT, 4 },
+		{ GL_FLOAT_MAT2, UNIFORM_MATRIX, 4 },
+		{ GL_FLOAT_MAT3, UNIFORM_MATRIX, 9 },
+		{ GL_FLOAT_MAT4, UNIFORM_MATRIX, 16 }
+	};
+
+	// texture state recorded along with the texture contents
+	const int SAMPLER_STATE_COUNT = 9;
+	const GLenum g_SamplerStates[SAMPLER_STATE_COUNT] =
+	{
+		GL_TEXTURE_MIN_FILTER,
+		GL_TEXTURE_MAG_FILTER,
+		GL_TEXTURE_WRAP_S,
+		GL_TEXTURE_WRAP_T,
+		GL_TEXTURE_WRAP_R,
+		GL_TEXTURE_COMPARE_MODE,
+		GL_TEXTURE_COMPARE_FUNC,
+		GL_TEXTURE_BASE_LEVEL,
+		GL_TEXTURE_MAX_LEVEL
+	};
+
+	// framebuffer attachment points and vertex array slots
+	// recorded with their objects
+	const int MAX_DRAW_BUFFERS = 8;
+	const int FRAMEBUFFER_ATTACHMENTS = MAX_DRAW_BUFFERS + 2;
+	const GLenum g_Attachments[FRAMEBUFFER_ATTACHMENTS] =
+	{
+		GL_COLOR_ATTACHMENT0,
+		GL_COLOR_ATTACHMENT1,
+		GL_COLOR_ATTACHMENT2,
+		GL_COLOR_ATTACHMENT3,
+		GL_COLOR_ATTACHMENT4,
+		GL_COLOR_ATTACHMENT5,
+		GL_COLOR_ATTACHMENT6,
+		GL_COLOR_ATTACHMENT7,
+		GL_DEPTH_ATTACHMENT,
+		GL_STENCIL_ATTACHMENT
+	};
+	const int VERTEX_ATTRIBUTES = 16;
+	// indexed buffer and image bindings recorded as the frame
+	// starts
+	const int RECORDED_BINDINGS = 8;
+
+	// the GLEW entry points replaced by the recording hooks
+	struct REAL_ENTRY_POINTS
+	{
+		PFNGLUSEPROGRAMPROC UseProgram;
+		PFNGLUNIFORM1IPROC Uniform1i;
+		PFNGLUNIFORM1UIPROC Uniform1ui;
+		PFNGLUNIFORM1FPROC Uniform1f;
+		PFNGLUNIFORM2FPROC Uniform2f;
+		PFNGLUNIFORM2FVPROC Uniform2fv;
+		PFNGLUNIFORM3FPROC Uniform3f;
+		PFNGLUNIFORM3FVPROC Uniform3fv;
+		PFNGLUNIFORM4FPROC Uniform4f;
+		PFNGLUNIFORM4FVPROC Uniform4fv;
+		PFNGLUNIFORMMATRIX3FVPROC UniformMatrix3fv;
+		PFNGLUNIFORMMATRIX4FVPROC UniformMatrix4fv;
+		PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+		PFNGLBINDBUFFERPROC BindBuffer;
+		PFNGLBINDBUFFERBASEPROC BindBufferBase;
+		PFNGLBUFFERDATAPROC BufferData;
+		PFNGLBUFFERSUBDATAPROC BufferSubData;
+		PFNGLACTIVETEXTUREPROC ActiveTexture;
+		PFNGLBINDTEXTUREUNITPROC BindTextureUnit;
+		PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+		PFNGLDRAWBUFFERSPROC DrawBuffers;
+		PFNGLBLENDFUNCIPROC BlendFunci;
+		PFNGLCLEARBUFFERFVPROC ClearBufferfv;
+		PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer;
+		PFNGLDRAWELEMENTSBASEVERTEXPROC DrawElementsBaseVertex;
+		PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC DrawElementsInstancedBaseVertex;
+		PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect;
+		PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC MultiDrawElementsIndirectCount;
+		PFNGLDISPATCHCOMPUTEPROC DispatchCompute;
+		PFNGLMEMORYBARRIERPROC MemoryBarrier;
+		PFNCAPTUREDRAWARRAYSPROC DrawArrays;
+		PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced;
+		PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC DrawArraysInstancedBaseInstance;
+		PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC DrawElementsInstancedBaseVertexBaseInstance;
+		PFNGLBINDBUFFERRANGEPROC BindBufferRange;
+		PFNGLBINDIMAGETEXTUREPROC BindImageTexture;
+	};
+
+	REAL_ENTRY_POINTS g_Real;
+	bool g_bCapturing = false;
+	std::string g_CaptureFilename;
+	std::vector<unsigned char> g_Stream;
+	uint32_t g_RecordCount = 0;
+	size_t g_RecordStart = 0;
+	FIXED_STATE g_LastState;
+	bool g_bHaveState = false;
+	// vertices the GL was handed over the capture, checked
+	// against the vertices of the recorded draws
+	GLuint g_VertexQuery = 0;
+	uint64_t g_RecordedVertices = 0;
+	// objects recorded with their contents during the capture,
+	// keyed by object type and name
+	std::set<uint64_t> g_DeclaredObjects;
+	// the first reason the capture cannot be replayed
+	std::string g_CaptureError;
+
+	/***********************************************************
+	 *  Stream writing helpers
+	 *
+	 *  Every record is a call type byte, the payload size and
+	 *  the payload, with values stored in native byte order.
+	 ***********************************************************/
+	void PutBytes(const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		g_Stream.insert(g_Stream.end(), bytes, bytes + size);
+	}
+
+	template<typename T>
+	void Put(const T& value)
+	{
+		PutBytes(&value, sizeof(T));
+	}
+
+	void BeginRecord(int callType)
+	{
+		g_Stream.push_back((unsigned char)callType);
+		g_RecordStart = g_Stream.size();
+		Put<uint32_t>(0);
+	}
+
+	void EndRecord()
+	{
+		uint32_t size = (uint32_t)(g_Stream.size() - g_RecordStart - sizeof(uint32_t));
+		memcpy(&g_Stream[g_RecordStart], &size, sizeof(size));
+		g_RecordCount++;
+	}
+
+	/***********************************************************
+	 *  FailCapture()
+	 *
+	 *  This function is used for keeping the first reason the
+	 *  capture cannot be replayed, which drops it at the end.
+	 ***********************************************************/
+	void FailCapture(const std::string& reason)
+	{
+		if (g_CaptureError.empty())
+		{
+			g_CaptureError = reason;
+		}
+	}
+
+	/***********************************************************
+	 *  GetPixelBytes()
+	 *
+	 *  This function is used for getting the size of one pixel
+	 *  read back with the passed in format and type, 0 for the
+	 *  ones not read back.
+	 ***********************************************************/
+	int GetPixelBytes(GLenum format, GLenum type)
+	{
+		// packed types hold the whole pixel
+		switch (type)
+		{
+		case GL_UNSIGNED_INT_24_8:
+		case GL_UNSIGNED_INT_10F_11F_11F_REV:
+		case GL_UNSIGNED_INT_5_9_9_9_REV:
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+			return(4);
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+			return(8);
+		}
+
+		int components = 0;
+		switch (format)
+		{
+		case GL_RED:
+		case GL_RED_INTEGER:
+		case GL_DEPTH_COMPONENT:
+		case GL_STENCIL_INDEX:
+			components = 1;
+			break;
+		case GL_RG:
+		case GL_RG_INTEGER:
+			components = 2;
+			break;
+		case GL_RGB:
+		case GL_BGR:
+		case GL_RGB_INTEGER:
+			components = 3;
+			break;
+		case GL_RGBA:
+		case GL_BGRA:
+		case GL_RGBA_INTEGER:
+			components = 4;
+			break;
+		}
+
+		switch (type)
+		{
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			return(components);
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			return(components * 2);
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT:
+			return(components * 4);
+		}
+
+		return(0);
+	}
+
+	/***********************************************************
+	 *  GetUniformLayout()
+	 *
+	 *  This function is used for getting how the value of an
+	 *  active uniform of the passed in type is read and set.
+	 ***********************************************************/
+	void GetUniformLayout(GLenum type, int& kind, int& components)
+	{
+		for (size_t i = 0; i < sizeof(g_UniformLayouts) / sizeof(g_UniformLayouts[0]); i++)
+		{
+			if (g_UniformLayouts[i].type == type)
+			{
+				kind = g_UniformLayouts[i].kind;
+				components = g_UniformLayouts[i].components;
+				return;
+			}
+		}
+
+		// samplers and images hold the unit they read from
+		kind = UNIFORM_INT;
+		components = 1;
+	}
+
+	void DeclareObject(int objectType, GLuint name);
+
+	/***********************************************************
+	 *  DeclareBuffer()
+	 *
+	 *  This function is used for recording a buffer with its
+	 *  storage and contents.
+	 ***********************************************************/
+	void DeclareBuffer(GLuint buffer)
+	{
+		GLint64 size = 0;
+		GLint usage = GL_STATIC_DRAW;
+		GLint immutable = GL_FALSE;
+		GLint flags = 0;
+		GLint mapped = GL_FALSE;
+		glGetNamedBufferParameteri64v(buffer, GL_BUFFER_SIZE, &size);
+		glGetNamedBufferParameteriv(buffer, GL_BUFFER_USAGE, &usage);
+		glGetNamedBufferParameteriv(buffer, GL_BUFFER_IMMUTABLE_STORAGE, &immutable);
+		glGetNamedBufferParameteriv(buffer, GL_BUFFER_STORAGE_FLAGS, &flags);
+		glGetNamedBufferParameteriv(buffer, GL_BUFFER_MAPPED, &mapped);
+
+		// a buffer mapped without persistence cannot be read, and
+		// is recorded with its storage only
+		std::vector<unsigned char> contents((size_t)size, 0);
+		if ((size > 0) && (!mapped || (0 != (flags & GL_MAP_PERSISTENT_BIT))))
+		{
+			glGetNamedBufferSubData(buffer, 0, (GLsizeiptr)size, contents.data());
+		}
+
+		BeginRecord(FrameCapture::CALL_CREATE_BUFFER);
+		Put<uint32_t>(buffer);
+		Put<int64_t>(size);
+		Put<uint32_t>(usage);
+		Put<uint8_t>(immutable);
+		Put<uint32_t>(flags);
+		PutBytes(contents.data(), contents.size());
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareTexture()
+	 *
+	 *  This function is used for recording a 2D or 2D array
+	 *  texture with its sampling state and every mip level.
+	 ***********************************************************/
+	void DeclareTexture(GLuint texture)
+	{
+		GLint target = GL_NONE;
+		glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+		if ((GL_TEXTURE_2D != target) && (GL_TEXTURE_2D_ARRAY != target))
+		{
+			FailCapture("texture " + std::to_string(texture) + " is not a 2D or 2D array texture");
+			return;
+		}
+
+		GLint internalFormat = GL_RGBA8;
+		GLint width = 0;
+		GLint height = 0;
+		GLint depth = 0;
+		GLint compressed = GL_FALSE;
+		glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+		glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+		glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_DEPTH, &depth);
+		glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_COMPRESSED, &compressed);
+
+		// mutable textures are counted down to their last level
+		GLint immutable = GL_FALSE;
+		GLint levels = 0;
+		glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+		if (immutable)
+		{
+			glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+		}
+		else
+		{
+			GLint levelWidth = width;
+			while ((levelWidth > 0) && (levels < 32))
+			{
+				levels++;
+				glGetTextureLevelParameteriv(texture, levels, GL_TEXTURE_WIDTH, &levelWidth);
+			}
+		}
+
+		GLint format = GL_RGBA;
+		GLint type = GL_UNSIGNED_BYTE;
+		int pixelBytes = 0;
+		if (!compressed && (levels > 0))
+		{
+			glGetInternalformativ(target, internalFormat, GL_TEXTURE_IMAGE_FORMAT, 1, &format);
+			glGetInternalformativ(target, internalFormat, GL_TEXTURE_IMAGE_TYPE, 1, &type);
+			pixelBytes = GetPixelBytes(format, type);
+			if (0 == pixelBytes)
+			{
+				FailCapture("texture " + std::to_string(texture) + " has a format that cannot be read back");
+				return;
+			}
+		}
+
+		GLint samplerState[SAMPLER_STATE_COUNT];
+		for (int i = 0; i < SAMPLER_STATE_COUNT; i++)
+		{
+			glGetTextureParameteriv(texture, g_SamplerStates[i], &samplerState[i]);
+		}
+		GLfloat borderColor[4];
+		glGetTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+		BeginRecord(FrameCapture::CALL_CREATE_TEXTURE);
+		Put<uint32_t>(texture);
+		Put<uint32_t>(target);
+		Put<int32_t>(levels);
+		Put<uint32_t>(internalFormat);
+		Put<int32_t>(width);
+		Put<int32_t>(height);
+		Put<int32_t>(depth);
+		Put<uint8_t>(compressed);
+		Put<uint32_t>(format);
+		Put<uint32_t>(type);
+		PutBytes(samplerState, sizeof(samplerState));
+		PutBytes(borderColor, sizeof(borderColor));
+
+		// read the levels tightly packed and not into a buffer
+		GLint packAlignment = 4;
+		GLint packBuffer = 0;
+		glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+		glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		g_Real.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		std::vector<unsigned char> pixels;
+		for (int level = 0; level < levels; level++)
+		{
+			GLint levelBytes = 0;
+			if (compressed)
+			{
+				glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelBytes);
+				pixels.resize((size_t)levelBytes);
+				glGetCompressedTextureImage(texture, level, levelBytes, pixels.data());
+			}
+			else
+			{
+				GLint levelWidth = glm::max(1, width >> level);
+				GLint levelHeight = glm::max(1, height >> level);
+				levelBytes = levelWidth * levelHeight * depth * pixelBytes;
+				pixels.resize((size_t)levelBytes);
+				glGetTextureImage(texture, level, format, type, levelBytes, pixels.data());
+			}
+			Put<uint32_t>(levelBytes);
+			PutBytes(pixels.data(), pixels.size());
+		}
+
+		glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+		g_Real.BindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareRenderbuffer()
+	 *
+	 *  This function is used for recording the storage of a
+	 *  renderbuffer.  Its contents cannot be read back without
+	 *  binding it to a framebuffer, so it replays cleared.
+	 ***********************************************************/
+	void DeclareRenderbuffer(GLuint renderbuffer)
+	{
+		GLint internalFormat = GL_DEPTH_COMPONENT24;
+		GLint width = 0;
+		GLint height = 0;
+		GLint samples = 0;
+		glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_INTERNAL_FORMAT, &internalFormat);
+		glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_WIDTH, &width);
+		glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_HEIGHT, &height);
+		glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_SAMPLES, &samples);
+
+		BeginRecord(FrameCapture::CALL_CREATE_RENDERBUFFER);
+		Put<uint32_t>(renderbuffer);
+		Put<uint32_t>(internalFormat);
+		Put<int32_t>(width);
+		Put<int32_t>(height);
+		Put<int32_t>(samples);
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareFramebuffer()
+	 *
+	 *  This function is used for recording the attachments and
+	 *  draw buffers of a framebuffer, after the textures and
+	 *  renderbuffers attached to it.
+	 ***********************************************************/
+	void DeclareFramebuffer(GLuint framebuffer)
+	{
+		GLint objectTypes[FRAMEBUFFER_ATTACHMENTS];
+		GLint objects[FRAMEBUFFER_ATTACHMENTS];
+		GLint levels[FRAMEBUFFER_ATTACHMENTS];
+		GLint layers[FRAMEBUFFER_ATTACHMENTS];
+		GLint layered[FRAMEBUFFER_ATTACHMENTS];
+		for (int i = 0; i < FRAMEBUFFER_ATTACHMENTS; i++)
+		{
+			objectTypes[i] = GL_NONE;
+			objects[i] = 0;
+			levels[i] = 0;
+			layers[i] = -1;
+			layered[i] = GL_FALSE;
+			glGetNamedFramebufferAttachmentParameteriv(framebuffer, g_Attachments[i], GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &objectTypes[i]);
+			if (GL_NONE == objectTypes[i])
+			{
+				continue;
+			}
+
+			glGetNamedFramebufferAttachmentParameteriv(framebuffer, g_Attachments[i], GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &objects[i]);
+			if (GL_RENDERBUFFER == objectTypes[i])
+			{
+				DeclareObject(FrameCapture::OBJECT_RENDERBUFFER, objects[i]);
+				continue;
+			}
+
+			glGetNamedFramebufferAttachmentParameteriv(framebuffer, g_Attachments[i], GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL, &levels[i]);
+			glGetNamedFramebufferAttachmentParameteriv(framebuffer, g_Attachments[i], GL_FRAMEBUFFER_ATTACHMENT_LAYERED, &layered[i]);
+			// one layer of an array is attached by its layer
+			GLint target = GL_NONE;
+			glGetTextureParameteriv(objects[i], GL_TEXTURE_TARGET, &target);
+			if ((GL_TEXTURE_2D_ARRAY == target) && !layered[i])
+			{
+				glGetNamedFramebufferAttachmentParameteriv(framebuffer, g_Attachments[i], GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LAYER, &layers[i]);
+			}
+			DeclareObject(FrameCapture::OBJECT_TEXTURE, objects[i]);
+		}
+
+		// the draw and read buffers are only read back while bound
+		GLint previousDraw = 0;
+		GLint previousRead = 0;
+		GLint drawBuffers[MAX_DRAW_BUFFERS];
+		GLint readBuffer = GL_NONE;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+		g_Real.BindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+		g_Real.BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		for (int i = 0; i < MAX_DRAW_BUFFERS; i++)
+		{
+			glGetIntegerv(GL_DRAW_BUFFER0 + i, &drawBuffers[i]);
+		}
+		glGetIntegerv(GL_READ_BUFFER, &readBuffer);
+		g_Real.BindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+		g_Real.BindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+
+		BeginRecord(FrameCapture::CALL_CREATE_FRAMEBUFFER);
+		Put<uint32_t>(framebuffer);
+		for (int i = 0; i < FRAMEBUFFER_ATTACHMENTS; i++)
+		{
+			Put<uint32_t>(objectTypes[i]);
+			Put<uint32_t>(objects[i]);
+			Put<int32_t>(levels[i]);
+			Put<int32_t>(layers[i]);
+		}
+		PutBytes(drawBuffers, sizeof(drawBuffers));
+		Put<uint32_t>(readBuffer);
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareVertexArray()
+	 *
+	 *  This function is used for recording the attribute
+	 *  formats and buffer bindings of a vertex array, after the
+	 *  buffers it reads from.
+	 ***********************************************************/
+	void DeclareVertexArray(GLuint vertexArray)
+	{
+		struct ATTRIBUTE
+		{
+			GLint enabled;
+			GLint size;
+			GLint type;
+			GLint normalized;
+			GLint integer;
+			GLint relativeOffset;
+			GLint binding;
+		};
+		struct BINDING
+		{
+			GLint buffer;
+			GLint64 offset;
+			GLint stride;
+			GLint divisor;
+		};
+		ATTRIBUTE attributes[VERTEX_ATTRIBUTES];
+		BINDING bindings[VERTEX_ATTRIBUTES];
+		GLint elementBuffer = 0;
+
+		// the attribute state is only read back while bound
+		GLint previousVertexArray = 0;
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+		g_Real.BindVertexArray(vertexArray);
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+		for (int i = 0; i < VERTEX_ATTRIBUTES; i++)
+		{
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &attributes[i].enabled);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attributes[i].size);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attributes[i].type);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attributes[i].normalized);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &attributes[i].integer);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &attributes[i].relativeOffset);
+			glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_BINDING, &attributes[i].binding);
+			glGetIntegeri_v(GL_VERTEX_BINDING_BUFFER, i, &bindings[i].buffer);
+			glGetInteger64i_v(GL_VERTEX_BINDING_OFFSET, i, &bindings[i].offset);
+			glGetIntegeri_v(GL_VERTEX_BINDING_STRIDE, i, &bindings[i].stride);
+			glGetIntegeri_v(GL_VERTEX_BINDING_DIVISOR, i, &bindings[i].divisor);
+		}
+		g_Real.BindVertexArray(previousVertexArray);
+
+		DeclareObject(FrameCapture::OBJECT_BUFFER, elementBuffer);
+		for (int i = 0; i < VERTEX_ATTRIBUTES; i++)
+		{
+			DeclareObject(FrameCapture::OBJECT_BUFFER, bindings[i].buffer);
+		}
+
+		BeginRecord(FrameCapture::CALL_CREATE_VERTEX_ARRAY);
+		Put<uint32_t>(vertexArray);
+		Put<uint32_t>(elementBuffer);
+		for (int i = 0; i < VERTEX_ATTRIBUTES; i++)
+		{
+			Put<uint8_t>(attributes[i].enabled);
+			Put<int32_t>(attributes[i].size);
+			Put<uint32_t>(attributes[i].type);
+			Put<uint8_t>(attributes[i].normalized);
+			Put<uint8_t>(attributes[i].integer);
+			Put<uint32_t>(attributes[i].relativeOffset);
+			Put<uint32_t>(attributes[i].binding);
+		}
+		for (int i = 0; i < VERTEX_ATTRIBUTES; i++)
+		{
+			Put<uint32_t>(bindings[i].buffer);
+			Put<int64_t>(bindings[i].offset);
+			Put<int32_t>(bindings[i].stride);
+			Put<uint32_t>(bindings[i].divisor);
+		}
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareProgram()
+	 *
+	 *  This function is used for recording a program as the
+	 *  binary the driver linked, with the values of its default
+	 *  block uniforms, which were set before the frame.
+	 ***********************************************************/
+	void DeclareProgram(GLuint program)
+	{
+		GLint binaryLength = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		if (binaryLength <= 0)
+		{
+			FailCapture("the driver did not return a binary of program " + std::to_string(program));
+			return;
+		}
+		std::vector<unsigned char> binary((size_t)binaryLength);
+		GLenum binaryFormat = 0;
+		glGetProgramBinary(program, binaryLength, NULL, &binaryFormat, binary.data());
+
+		// every element of a uniform array has its own location
+		std::vector<unsigned char> uniformValues;
+		uint32_t uniformCount = 0;
+		GLint activeUniforms = 0;
+		GLint maxNameLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+		std::vector<GLchar> nameBuffer((size_t)maxNameLength + 1, 0);
+		for (GLint uniform = 0; uniform < activeUniforms; uniform++)
+		{
+			GLuint index = (GLuint)uniform;
+			GLint blockIndex = -1;
+			glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+			if (-1 != blockIndex)
+			{
+				continue;
+			}
+
+			GLint arraySize = 0;
+			GLenum type = GL_NONE;
+			glGetActiveUniform(program, index, (GLsizei)nameBuffer.size(), NULL, &arraySize, &type, nameBuffer.data());
+			std::string name = nameBuffer.data();
+			size_t bracket = name.find('[');
+			if (std::string::npos != bracket)
+			{
+				name.erase(bracket);
+			}
+
+			int kind = UNIFORM_INT;
+			int components = 1;
+			GetUniformLayout(type, kind, components);
+			for (GLint element = 0; element < arraySize; element++)
+			{
+				std::string elementName = (arraySize > 1) ? name + "[" + std::to_string(element) + "]" : name;
+				GLint location = glGetUniformLocation(program, elementName.c_str());
+				if (-1 == location)
+				{
+					continue;
+				}
+
+				uint32_t values[16];
+				if ((UNIFORM_FLOAT == kind) || (UNIFORM_MATRIX == kind))
+					glGetUniformfv(program, location, (GLfloat*)values);
+				else if (UNIFORM_UINT == kind)
+					glGetUniformuiv(program, location, values);
+				else
+					glGetUniformiv(program, location, (GLint*)values);
+
+				int32_t header[3] = { location, kind, components };
+				const unsigned char* headerBytes = (const unsigned char*)header;
+				const unsigned char* valueBytes = (const unsigned char*)values;
+				uniformValues.insert(uniformValues.end(), headerBytes, headerBytes + sizeof(header));
+				uniformValues.insert(uniformValues.end(), valueBytes, valueBytes + sizeof(uint32_t) * components);
+				uniformCount++;
+			}
+		}
+
+		BeginRecord(FrameCapture::CALL_CREATE_PROGRAM);
+		Put<uint32_t>(program);
+		Put<uint32_t>(binaryFormat);
+		Put<uint32_t>((uint32_t)binary.size());
+		PutBytes(binary.data(), binary.size());
+		Put<uint32_t>(uniformCount);
+		PutBytes(uniformValues.data(), uniformValues.size());
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  DeclareObject()
+	 *
+	 *  This function is used for recording an object the first
+	 *  time a call refers to it during the capture, before the
+	 *  call itself is recorded.
+	 ***********************************************************/
+	void DeclareObject(int objectType, GLuint name)
+	{
+		if (0 == name)
+		{
+			return;
+		}
+		uint64_t key = ((uint64_t)objectType << 32) | name;
+		if (!g_DeclaredObjects.insert(key).second)
+		{
+			return;
+		}
+
+		switch (objectType)
+		{
+		case FrameCapture::OBJECT_BUFFER:
+			DeclareBuffer(name);
+			break;
+		case FrameCapture::OBJECT_TEXTURE:
+			DeclareTexture(name);
+			break;
+		case FrameCapture::OBJECT_RENDERBUFFER:
+			DeclareRenderbuffer(name);
+			break;
+		case FrameCapture::OBJECT_FRAMEBUFFER:
+			DeclareFramebuffer(name);
+			break;
+		case FrameCapture::OBJECT_VERTEX_ARRAY:
+			DeclareVertexArray(name);
+			break;
+		case FrameCapture::OBJECT_PROGRAM:
+			DeclareProgram(name);
+			break;
+		}
+	}
+
+	/***********************************************************
+	 *  RecordFixedState()
+	 *
+	 *  This function is used for recording a snapshot of the
+	 *  GL 1.1 state before a draw, when it changed since the
+	 *  last snapshot.
+	 ***********************************************************/
+	void RecordFixedState()
+	{
+		FIXED_STATE state;
+		GLint value = 0;
+		GLboolean flags[4];
+		memset(&state, 0, sizeof(state));
+
+		state.depthTest = glIsEnabled(GL_DEPTH_TEST);
+		state.blend = glIsEnabled(GL_BLEND);
+		state.cullFace = glIsEnabled(GL_CULL_FACE);
+		glGetBooleanv(GL_DEPTH_WRITEMASK, flags);
+		state.depthMask = flags[0];
+		glGetBooleanv(GL_COLOR_WRITEMASK, flags);
+		for (int i = 0; i < 4; i++)
+		{
+			state.colorMask[i] = flags[i];
+		}
+		glGetIntegerv(GL_DEPTH_FUNC, &value);
+		state.depthFunc = value;
+		glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+		state.blendSrc = value;
+		glGetIntegerv(GL_BLEND_DST_RGB, &value);
+		state.blendDst = value;
+		glGetIntegerv(GL_VIEWPORT, state.viewport);
+
+		// texture binds go through glBindTexture, so read them
+		// back per unit with the unhooked glActiveTexture
+		GLint activeTexture = GL_TEXTURE0;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+		for (int unit = 0; unit < SNAPSHOT_TEXTURE_UNITS; unit++)
+		{
+			g_Real.ActiveTexture(GL_TEXTURE0 + unit);
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+			state.textures[unit] = (uint32_t)value;
+		}
+		g_Real.ActiveTexture(activeTexture);
+
+		if (g_bHaveState && (memcmp(&state, &g_LastState, sizeof(state)) == 0))
+		{
+			return;
+		}
+
+		for (int unit = 0; unit < SNAPSHOT_TEXTURE_UNITS; unit++)
+		{
+			DeclareObject(FrameCapture::OBJECT_TEXTURE, state.textures[unit]);
+		}
+		BeginRecord(FrameCapture::CALL_FIXED_STATE);
+		Put(state);
+		EndRecord();
+		g_LastState = state;
+		g_bHaveState = true;
+	}
+
+	/***********************************************************
+	 *  AddIndirectVertices()
+	 *
+	 *  This function is used for adding the vertices of the
+	 *  commands of an indirect draw to the recorded count.  The
+	 *  commands are read back from the bound indirect buffer,
+	 *  which stalls, but only while capturing.
+	 ***********************************************************/
+	void AddIndirectVertices(const void* indirect, GLsizei drawCount, GLsizei stride)
+	{
+		const GLsizei commandSize = 5 * sizeof(GLuint);
+		GLint buffer = 0;
+		glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &buffer);
+		if ((0 == buffer) || (drawCount <= 0))
+		{
+			return;
+		}
+		if (0 == stride)
+		{
+			stride = commandSize;
+		}
+
+		// count and instance count lead every command
+		std::vector<unsigned char> commands((size_t)(drawCount - 1) * stride + commandSize);
+		glGetNamedBufferSubData(buffer, (GLintptr)indirect, (GLsizeiptr)commands.size(), commands.data());
+		for (GLsizei i = 0; i < drawCount; i++)
+		{
+			GLuint command[2];
+			memcpy(command, &commands[(size_t)i * stride], sizeof(command));
+			g_RecordedVertices += (uint64_t)command[0] * command[1];
+		}
+	}
+
+	/***********************************************************
+	 *  Recording hooks
+	 *
+	 *  Each hook forwards to the real entry point and records
+	 *  the call with its data.
+	 ***********************************************************/
+	void GLAPIENTRY HookUseProgram(GLuint program)
+	{
+		DeclareObject(FrameCapture::OBJECT_PROGRAM, program);
+		g_Real.UseProgram(program);
+		BeginRecord(FrameCapture::CALL_USE_PROGRAM);
+		Put<uint32_t>(program);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform1i(GLint location, GLint v0)
+	{
+		g_Real.Uniform1i(location, v0);
+		BeginRecord(FrameCapture::CALL_UNIFORM_1I);
+		Put<int32_t>(location);
+		Put<int32_t>(v0);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform1ui(GLint location, GLuint v0)
+	{
+		g_Real.Uniform1ui(location, v0);
+		BeginRecord(FrameCapture::CALL_UNIFORM_1UI);
+		Put<int32_t>(location);
+		Put<uint32_t>(v0);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform1f(GLint location, GLfloat v0)
+	{
+		g_Real.Uniform1f(location, v0);
+		BeginRecord(FrameCapture::CALL_UNIFORM_1F);
+		Put<int32_t>(location);
+		Put<float>(v0);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform2f(GLint location, GLfloat v0, GLfloat v1)
+	{
+		g_Real.Uniform2f(location, v0, v1);
+		BeginRecord(FrameCapture::CALL_UNIFORM_2F);
+		Put<int32_t>(location);
+		Put<float>(v0);
+		Put<float>(v1);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+	{
+		g_Real.Uniform3f(location, v0, v1, v2);
+		BeginRecord(FrameCapture::CALL_UNIFORM_3F);
+		Put<int32_t>(location);
+		Put<float>(v0);
+		Put<float>(v1);
+		Put<float>(v2);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+	{
+		g_Real.Uniform4f(location, v0, v1, v2, v3);
+		BeginRecord(FrameCapture::CALL_UNIFORM_4F);
+		Put<int32_t>(location);
+		Put<float>(v0);
+		Put<float>(v1);
+		Put<float>(v2);
+		Put<float>(v3);
+		EndRecord();
+	}
+
+	// shared by the vector and matrix uniform array hooks
+	void RecordUniformArray(int callType, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value, int components)
+	{
+		BeginRecord(callType);
+		Put<int32_t>(location);
+		Put<int32_t>(count);
+		Put<uint8_t>(transpose);
+		PutBytes(value, sizeof(GLfloat) * components * count);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookUniform2fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		g_Real.Uniform2fv(location, count, value);
+		RecordUniformArray(FrameCapture::CALL_UNIFORM_2FV, location, count, GL_FALSE, value, 2);
+	}
+
+	void GLAPIENTRY HookUniform3fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		g_Real.Uniform3fv(location, count, value);
+		RecordUniformArray(FrameCapture::CALL_UNIFORM_3FV, location, count, GL_FALSE, value, 3);
+	}
+
+	void GLAPIENTRY HookUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+	{
+		g_Real.Uniform4fv(location, count, value);
+		RecordUniformArray(FrameCapture::CALL_UNIFORM_4FV, location, count, GL_FALSE, value, 4);
+	}
+
+	void GLAPIENTRY HookUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		g_Real.UniformMatrix3fv(location, count, transpose, value);
+		RecordUniformArray(FrameCapture::CALL_UNIFORM_MATRIX_3FV, location, count, transpose, value, 9);
+	}
+
+	void GLAPIENTRY HookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		g_Real.UniformMatrix4fv(location, count, transpose, value);
+		RecordUniformArray(FrameCapture::CALL_UNIFORM_MATRIX_4FV, location, count, transpose, value, 16);
+	}
+
+	void GLAPIENTRY HookBindVertexArray(GLuint array)
+	{
+		DeclareObject(FrameCapture::OBJECT_VERTEX_ARRAY, array);
+		g_Real.BindVertexArray(array);
+		BeginRecord(FrameCapture::CALL_BIND_VERTEX_ARRAY);
+		Put<uint32_t>(array);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindBuffer(GLenum target, GLuint buffer)
+	{
+		DeclareObject(FrameCapture::OBJECT_BUFFER, buffer);
+		g_Real.BindBuffer(target, buffer);
+		BeginRecord(FrameCapture::CALL_BIND_BUFFER);
+		Put<uint32_t>(target);
+		Put<uint32_t>(buffer);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		DeclareObject(FrameCapture::OBJECT_BUFFER, buffer);
+		g_Real.BindBufferBase(target, index, buffer);
+		BeginRecord(FrameCapture::CALL_BIND_BUFFER_BASE);
+		Put<uint32_t>(target);
+		Put<uint32_t>(index);
+		Put<uint32_t>(buffer);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		DeclareObject(FrameCapture::OBJECT_BUFFER, buffer);
+		g_Real.BindBufferRange(target, index, buffer, offset, size);
+		BeginRecord(FrameCapture::CALL_BIND_BUFFER_RANGE);
+		Put<uint32_t>(target);
+		Put<uint32_t>(index);
+		Put<uint32_t>(buffer);
+		Put<int64_t>(offset);
+		Put<int64_t>(size);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		g_Real.BufferData(target, size, data, usage);
+		BeginRecord(FrameCapture::CALL_BUFFER_DATA);
+		Put<uint32_t>(target);
+		Put<int64_t>(size);
+		Put<uint32_t>(usage);
+		Put<uint8_t>(NULL != data);
+		if (NULL != data)
+		{
+			PutBytes(data, (size_t)size);
+		}
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		g_Real.BufferSubData(target, offset, size, data);
+		BeginRecord(FrameCapture::CALL_BUFFER_SUB_DATA);
+		Put<uint32_t>(target);
+		Put<int64_t>(offset);
+		Put<int64_t>(size);
+		PutBytes(data, (size_t)size);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookActiveTexture(GLenum texture)
+	{
+		g_Real.ActiveTexture(texture);
+		BeginRecord(FrameCapture::CALL_ACTIVE_TEXTURE);
+		Put<uint32_t>(texture);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindTextureUnit(GLuint unit, GLuint texture)
+	{
+		DeclareObject(FrameCapture::OBJECT_TEXTURE, texture);
+		g_Real.BindTextureUnit(unit, texture);
+		BeginRecord(FrameCapture::CALL_BIND_TEXTURE_UNIT);
+		Put<uint32_t>(unit);
+		Put<uint32_t>(texture);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
+	{
+		DeclareObject(FrameCapture::OBJECT_TEXTURE, texture);
+		g_Real.BindImageTexture(unit, texture, level, layered, layer, access, format);
+		BeginRecord(FrameCapture::CALL_BIND_IMAGE_TEXTURE);
+		Put<uint32_t>(unit);
+		Put<uint32_t>(texture);
+		Put<int32_t>(level);
+		Put<uint8_t>(layered);
+		Put<int32_t>(layer);
+		Put<uint32_t>(access);
+		Put<uint32_t>(format);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		DeclareObject(FrameCapture::OBJECT_FRAMEBUFFER, framebuffer);
+		g_Real.BindFramebuffer(target, framebuffer);
+		BeginRecord(FrameCapture::CALL_BIND_FRAMEBUFFER);
+		Put<uint32_t>(target);
+		Put<uint32_t>(framebuffer);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawBuffers(GLsizei n, const GLenum* bufs)
+	{
+		g_Real.DrawBuffers(n, bufs);
+		BeginRecord(FrameCapture::CALL_DRAW_BUFFERS);
+		Put<int32_t>(n);
+		PutBytes(bufs, sizeof(GLenum) * n);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBlendFunci(GLuint buf, GLenum src, GLenum dst)
+	{
+		g_Real.BlendFunci(buf, src, dst);
+		BeginRecord(FrameCapture::CALL_BLEND_FUNCI);
+		Put<uint32_t>(buf);
+		Put<uint32_t>(src);
+		Put<uint32_t>(dst);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value)
+	{
+		g_Real.ClearBufferfv(buffer, drawbuffer, value);
+		BeginRecord(FrameCapture::CALL_CLEAR_BUFFER_FV);
+		Put<uint32_t>(buffer);
+		Put<int32_t>(drawbuffer);
+		PutBytes(value, sizeof(GLfloat) * ((buffer == GL_COLOR) ? 4 : 1));
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookBlitFramebuffer(
+		GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+		GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+		GLbitfield mask, GLenum filter)
+	{
+		g_Real.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+		BeginRecord(FrameCapture::CALL_BLIT_FRAMEBUFFER);
+		const int32_t rects[8] = { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1 };
+		PutBytes(rects, sizeof(rects));
+		Put<uint32_t>(mask);
+		Put<uint32_t>(filter);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+	{
+		RecordFixedState();
+		g_Real.DrawElementsBaseVertex(mode, count, type, indices, basevertex);
+		g_RecordedVertices += (uint64_t)count;
+		BeginRecord(FrameCapture::CALL_DRAW_ELEMENTS_BASE_VERTEX);
+		Put<uint32_t>(mode);
+		Put<int32_t>(count);
+		Put<uint32_t>(type);
+		Put<uint64_t>((uint64_t)(uintptr_t)indices);
+		Put<int32_t>(basevertex);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+	{
+		RecordFixedState();
+		g_Real.DrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+		g_RecordedVertices += (uint64_t)count * instancecount;
+		BeginRecord(FrameCapture::CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX);
+		Put<uint32_t>(mode);
+		Put<int32_t>(count);
+		Put<uint32_t>(type);
+		Put<uint64_t>((uint64_t)(uintptr_t)indices);
+		Put<int32_t>(instancecount);
+		Put<int32_t>(basevertex);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+	{
+		RecordFixedState();
+		g_Real.MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+		AddIndirectVertices(indirect, drawcount, stride);
+		BeginRecord(FrameCapture::CALL_MULTI_DRAW_ELEMENTS_INDIRECT);
+		Put<uint32_t>(mode);
+		Put<uint32_t>(type);
+		Put<uint64_t>((uint64_t)(uintptr_t)indirect);
+		Put<int32_t>(drawcount);
+		Put<int32_t>(stride);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookMultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+	{
+		RecordFixedState();
+		g_Real.MultiDrawElementsIndirectCount(mode, type, indirect, drawcount, maxdrawcount, stride);
+		// the number of commands drawn is in the parameter buffer
+		GLint parameterBuffer = 0;
+		GLuint commandCount = 0;
+		glGetIntegerv(GL_PARAMETER_BUFFER_BINDING, &parameterBuffer);
+		if (0 != parameterBuffer)
+		{
+			glGetNamedBufferSubData(parameterBuffer, drawcount, sizeof(commandCount), &commandCount);
+		}
+		AddIndirectVertices(indirect, (GLsizei)glm::min(commandCount, (GLuint)maxdrawcount), stride);
+		BeginRecord(FrameCapture::CALL_MULTI_DRAW_ELEMENTS_INDIRECT_COUNT);
+		Put<uint32_t>(mode);
+		Put<uint32_t>(type);
+		Put<uint64_t>((uint64_t)(uintptr_t)indirect);
+		Put<int64_t>(drawcount);
+		Put<int32_t>(maxdrawcount);
+		Put<int32_t>(stride);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		RecordFixedState();
+		g_Real.DrawArrays(mode, first, count);
+		g_RecordedVertices += (uint64_t)count;
+		BeginRecord(FrameCapture::CALL_DRAW_ARRAYS);
+		Put<uint32_t>(mode);
+		Put<int32_t>(first);
+		Put<int32_t>(count);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+	{
+		RecordFixedState();
+		g_Real.DrawArraysInstanced(mode, first, count, instancecount);
+		g_RecordedVertices += (uint64_t)count * instancecount;
+		BeginRecord(FrameCapture::CALL_DRAW_ARRAYS_INSTANCED);
+		Put<uint32_t>(mode);
+		Put<int32_t>(first);
+		Put<int32_t>(count);
+		Put<int32_t>(instancecount);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+	{
+		RecordFixedState();
+		g_Real.DrawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
+		g_RecordedVertices += (uint64_t)count * instancecount;
+		BeginRecord(FrameCapture::CALL_DRAW_ARRAYS_INSTANCED_BASE_INSTANCE);
+		Put<uint32_t>(mode);
+		Put<int32_t>(first);
+		Put<int32_t>(count);
+		Put<int32_t>(instancecount);
+		Put<uint32_t>(baseinstance);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance)
+	{
+		RecordFixedState();
+		g_Real.DrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instancecount, basevertex, baseinstance);
+		g_RecordedVertices += (uint64_t)count * instancecount;
+		BeginRecord(FrameCapture::CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE);
+		Put<uint32_t>(mode);
+		Put<int32_t>(count);
+		Put<uint32_t>(type);
+		Put<uint64_t>((uint64_t)(uintptr_t)indices);
+		Put<int32_t>(instancecount);
+		Put<int32_t>(basevertex);
+		Put<uint32_t>(baseinstance);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookDispatchCompute(GLuint x, GLuint y, GLuint z)
+	{
+		g_Real.DispatchCompute(x, y, z);
+		BeginRecord(FrameCapture::CALL_DISPATCH_COMPUTE);
+		Put<uint32_t>(x);
+		Put<uint32_t>(y);
+		Put<uint32_t>(z);
+		EndRecord();
+	}
+
+	void GLAPIENTRY HookMemoryBarrier(GLbitfield barriers)
+	{
+		g_Real.MemoryBarrier(barriers);
+		BeginRecord(FrameCapture::CALL_MEMORY_BARRIER);
+		Put<uint32_t>(barriers);
+		EndRecord();
+	}
+
+	/***********************************************************
+	 *  SwapEntryPoint()
+	 *
+	 *  This function is used for installing one recording hook
+	 *  into a GLEW entry point, or putting the real one back.
+	 *  An entry point the context does not have is left NULL,
+	 *  so the checks for it still find it missing.
+	 ***********************************************************/
+	template<typename T>
+	void SwapEntryPoint(T& entryPoint, T& real, T hook, bool bInstall)
+	{
+		if (bInstall)
+		{
+			real = entryPoint;
+			if (NULL != real)
+			{
+				entryPoint = hook;
+			}
+		}
+		else
+		{
+			entryPoint = real;
+		}
+	}
+
+	/***********************************************************
+	 *  SwapEntryPoints()
+	 *
+	 *  This function is used for installing the recording hooks
+	 *  into the GLEW entry points, or putting the real entry
+	 *  points back.
+	 ***********************************************************/
+	void SwapEntryPoints(bool bInstall)
+	{
+		SwapEntryPoint(__glewUseProgram, g_Real.UseProgram, HookUseProgram, bInstall);
+		SwapEntryPoint(__glewUniform1i, g_Real.Uniform1i, HookUniform1i, bInstall);
+		SwapEntryPoint(__glewUniform1ui, g_Real.Uniform1ui, HookUniform1ui, bInstall);
+		SwapEntryPoint(__glewUniform1f, g_Real.Uniform1f, HookUniform1f, bInstall);
+		SwapEntryPoint(__glewUniform2f, g_Real.Uniform2f, HookUniform2f, bInstall);
+		SwapEntryPoint(__glewUniform2fv, g_Real.Uniform2fv, HookUniform2fv, bInstall);
+		SwapEntryPoint(__glewUniform3f, g_Real.Uniform3f, HookUniform3f, bInstall);
+		SwapEntryPoint(__glewUniform3fv, g_Real.Uniform3fv, HookUniform3fv, bInstall);
+		SwapEntryPoint(__glewUniform4f, g_Real.Uniform4f, HookUniform4f, bInstall);
+		SwapEntryPoint(__glewUniform4fv, g_Real.Uniform4fv, HookUniform4fv, bInstall);
+		SwapEntryPoint(__glewUniformMatrix3fv, g_Real.UniformMatrix3fv, HookUniformMatrix3fv, bInstall);
+		SwapEntryPoint(__glewUniformMatrix4fv, g_Real.UniformMatrix4fv, HookUniformMatrix4fv, bInstall);
+		SwapEntryPoint(__glewBindVertexArray, g_Real.BindVertexArray, HookBindVertexArray, bInstall);
+		SwapEntryPoint(__glewBindBuffer, g_Real.BindBuffer, HookBindBuffer, bInstall);
+		SwapEntryPoint(__glewBindBufferBase, g_Real.BindBufferBase, HookBindBufferBase, bInstall);
+		SwapEntryPoint(__glewBufferData, g_Real.BufferData, HookBufferData, bInstall);
+		SwapEntryPoint(__glewBufferSubData, g_Real.BufferSubData, HookBufferSubData, bInstall);
+		SwapEntryPoint(__glewActiveTexture, g_Real.ActiveTexture, HookActiveTexture, bInstall);
+		SwapEntryPoint(__glewBindTextureUnit, g_Real.BindTextureUnit, HookBindTextureUnit, bInstall);
+		SwapEntryPoint(__glewBindFramebuffer, g_Real.BindFramebuffer, HookBindFramebuffer, bInstall);
+		SwapEntryPoint(__glewDrawBuffers, g_Real.DrawBuffers, HookDrawBuffers, bInstall);
+		SwapEntryPoint(__glewBlendFunci, g_Real.BlendFunci, HookBlendFunci, bInstall);
+		SwapEntryPoint(__glewClearBufferfv, g_Real.ClearBufferfv, HookClearBufferfv, bInstall);
+		SwapEntryPoint(__glewBlitFramebuffer, g_Real.BlitFramebuffer, HookBlitFramebuffer, bInstall);
+		SwapEntryPoint(__glewDrawElementsBaseVertex, g_Real.DrawElementsBaseVertex, HookDrawElementsBaseVertex, bInstall);
+		SwapEntryPoint(__glewDrawElementsInstancedBaseVertex, g_Real.DrawElementsInstancedBaseVertex, HookDrawElementsInstancedBaseVertex, bInstall);
+		SwapEntryPoint(__glewMultiDrawElementsIndirect, g_Real.MultiDrawElementsIndirect, HookMultiDrawElementsIndirect, bInstall);
+		SwapEntryPoint(__glewMultiDrawElementsIndirectCount, g_Real.MultiDrawElementsIndirectCount, HookMultiDrawElementsIndirectCount, bInstall);
+		SwapEntryPoint(__glewDispatchCompute, g_Real.DispatchCompute, HookDispatchCompute, bInstall);
+		SwapEntryPoint(__glewMemoryBarrier, g_Real.MemoryBarrier, HookMemoryBarrier, bInstall);
+		SwapEntryPoint(g_CaptureDrawArrays, g_Real.DrawArrays, HookDrawArrays, bInstall);
+		SwapEntryPoint(__glewDrawArraysInstanced, g_Real.DrawArraysInstanced, HookDrawArraysInstanced, bInstall);
+		SwapEntryPoint(__glewDrawArraysInstancedBaseInstance, g_Real.DrawArraysInstancedBaseInstance, HookDrawArraysInstancedBaseInstance, bInstall);
+		SwapEntryPoint(__glewDrawElementsInstancedBaseVertexBaseInstance, g_Real.DrawElementsInstancedBaseVertexBaseInstance, HookDrawElementsInstancedBaseVertexBaseInstance, bInstall);
+		SwapEntryPoint(__glewBindBufferRange, g_Real.BindBufferRange, HookBindBufferRange, bInstall);
+		SwapEntryPoint(__glewBindImageTexture, g_Real.BindImageTexture, HookBindImageTexture, bInstall);
+	}
+
+	/***********************************************************
+	 *  RecordBindings()
+	 *
+	 *  This function is used for recording what is bound as the
+	 *  frame starts, which the frame relies on without binding
+	 *  it again, by passing it through the hooks.
+	 ***********************************************************/
+	void RecordBindings()
+	{
+		GLint value = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+		HookUseProgram(value);
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+		HookBindVertexArray(value);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &value);
+		HookBindFramebuffer(GL_DRAW_FRAMEBUFFER, value);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &value);
+		HookBindFramebuffer(GL_READ_FRAMEBUFFER, value);
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &value);
+		HookActiveTexture(value);
+
+		const GLenum targets[][2] =
+		{
+			{ GL_ARRAY_BUFFER, GL_ARRAY_BUFFER_BINDING },
+			{ GL_DRAW_INDIRECT_BUFFER, GL_DRAW_INDIRECT_BUFFER_BINDING },
+			{ GL_PARAMETER_BUFFER, GL_PARAMETER_BUFFER_BINDING },
+			{ GL_DISPATCH_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER_BINDING },
+			{ GL_UNIFORM_BUFFER, GL_UNIFORM_BUFFER_BINDING },
+			{ GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING }
+		};
+		for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++)
+		{
+			value = 0;
+			glGetIntegerv(targets[i][1], &value);
+			if (0 != value)
+			{
+				HookBindBuffer(targets[i][0], value);
+			}
+		}
+
+		const GLenum indexedTargets[][4] =
+		{
+			{ GL_UNIFORM_BUFFER, GL_UNIFORM_BUFFER_BINDING, GL_UNIFORM_BUFFER_START, GL_UNIFORM_BUFFER_SIZE },
+			{ GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING, GL_SHADER_STORAGE_BUFFER_START, GL_SHADER_STORAGE_BUFFER_SIZE }
+		};
+		for (size_t i = 0; i < sizeof(indexedTargets) / sizeof(indexedTargets[0]); i++)
+		{
+			for (GLuint index = 0; index < (GLuint)RECORDED_BINDINGS; index++)
+			{
+				GLint64 start = 0;
+				GLint64 size = 0;
+				glGetIntegeri_v(indexedTargets[i][1], index, &value);
+				glGetInteger64i_v(indexedTargets[i][2], index, &start);
+				glGetInteger64i_v(indexedTargets[i][3], index, &size);
+				if (0 == value)
+				{
+					continue;
+				}
+				// a whole buffer bind reads back as size 0
+				if (0 == size)
+					HookBindBufferBase(indexedTargets[i][0], index, value);
+				else
+					HookBindBufferRange(indexedTargets[i][0], index, value, (GLintptr)start, (GLsizeiptr)size);
+			}
+		}
+
+		for (GLuint unit = 0; unit < (GLuint)RECORDED_BINDINGS; unit++)
+		{
+			GLint level = 0;
+			GLint layered = GL_FALSE;
+			GLint layer = 0;
+			GLint access = GL_READ_ONLY;
+			GLint format = GL_R32F;
+			glGetIntegeri_v(GL_IMAGE_BINDING_NAME, unit, &value);
+			if (0 == value)
+			{
+				continue;
+			}
+			glGetIntegeri_v(GL_IMAGE_BINDING_LEVEL, unit, &level);
+			glGetIntegeri_v(GL_IMAGE_BINDING_LAYERED, unit, &layered);
+			glGetIntegeri_v(GL_IMAGE_BINDING_LAYER, unit, &layer);
+			glGetIntegeri_v(GL_IMAGE_BINDING_ACCESS, unit, &access);
+			glGetIntegeri_v(GL_IMAGE_BINDING_FORMAT, unit, &format);
+			HookBindImageTexture(unit, value, level, (GLboolean)layered, layer, access, format);
+		}
+	}
+
+	/***********************************************************
+	 *  PAYLOAD_READER
+	 *
+	 *  Reads the values of one record back in the order they
+	 *  were written, flagging reads past the end of the record.
+	 ***********************************************************/
+	struct PAYLOAD_READER
+	{
+		const unsigned char* data;
+		uint32_t size;
+		uint32_t offset;
+		bool bValid;
+
+		PAYLOAD_READER(const unsigned char* payload, uint32_t payloadSize)
+		{
+			data = payload;
+			size = payloadSize;
+			offset = 0;
+			bValid = true;
+		}
+
+		const void* GetBytes(size_t count)
+		{
+			if (offset + count > size)
+			{
+				bValid = false;
+				return(NULL);
+			}
+			const void* bytes = data + offset;
+			offset += (uint32_t)count;
+			return(bytes);
+		}
+
+		template<typename T>
+		T Get()
+		{
+			T value = T();
+			const void* bytes = GetBytes(sizeof(T));
+			if (NULL != bytes)
+			{
+				memcpy(&value, bytes, sizeof(T));
+			}
+			return(value);
+		}
+	};
+
+	typedef std::unordered_map<uint32_t, GLuint> NAME_MAP;
+
+	/***********************************************************
+	 *  MapObjectName()
+	 *
+	 *  This function is used for turning a recorded object name
+	 *  into the name of the object made for it at replay.  A
+	 *  name nothing was made for marks the record bad.
+	 ***********************************************************/
+	GLuint MapObjectName(uint32_t name, const NAME_MAP& names, bool& bValid)
+	{
+		if (0 == name)
+		{
+			return(0);
+		}
+
+		NAME_MAP::const_iterator it = names.find(name);
+		if (it == names.end())
+		{
+			bValid = false;
+			return(0);
+		}
+
+		return(it->second);
+	}
+
+	// read a recorded object name and map it
+	GLuint GetObjectName(PAYLOAD_READER& reader, const NAME_MAP& names)
+	{
+		return(MapObjectName(reader.Get<uint32_t>(), names, reader.bValid));
+	}
+
+	// whether a record makes an object rather than being a call
+	// of the frame
+	bool IsCreateCall(int callType)
+	{
+		return((callType >= FrameCapture::CALL_CREATE_BUFFER) && (callType <= FrameCapture::CALL_CREATE_PROGRAM));
+	}
+}
+
+/***********************************************************
+ *  BeginCapture()
+ *
+ *  This method is used for installing the recording hooks.
+ *  Every hooked GL call from here until EndCapture() is
+ *  recorded into memory.
+ ***********************************************************/
+bool FrameCapture::BeginCapture(const char* filename)
+{
+	if (g_bCapturing || (NULL == filename))
+	{
+		return(false);
+	}
+
+	g_CaptureFilename = filename;
+	g_Stream.clear();
+	g_RecordCount = 0;
+	g_bHaveState = false;
+	g_RecordedVertices = 0;
+	g_DeclaredObjects.clear();
+	g_CaptureError.clear();
+
+	// count what the GL is handed, to catch draws that went
+	// around the hooks
+	if (GLEW_ARB_pipeline_statistics_query)
+	{
+		if (0 == g_VertexQuery)
+		{
+			glGenQueries(1, &g_VertexQuery);
+		}
+		glBeginQuery(GL_VERTICES_SUBMITTED_ARB, g_VertexQuery);
+	}
+	else
+	{
+		std::cout << "WARNING: Pipeline statistics are not supported, the frame capture cannot check that every draw was recorded" << std::endl;
+	}
+
+	SwapEntryPoints(true);
+	g_bCapturing = true;
+	RecordBindings();
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndCapture()
+ *
+ *  This method is used for removing the recording hooks and
+ *  writing the recorded stream to the capture file.
+ ***********************************************************/
+bool FrameCapture::EndCapture()
+{
+	if (!g_bCapturing)
+	{
+		return(false);
+	}
+
+	SwapEntryPoints(false);
+	g_bCapturing = false;
+
+	// some drivers leave indirect draws out of the count, so only
+	// more vertices than were recorded is taken as a draw made
+	// through an entry point that is not hooked
+	if (0 != g_VertexQuery)
+	{
+		glEndQuery(GL_VERTICES_SUBMITTED_ARB);
+		GLuint64 submittedVertices = 0;
+		glGetQueryObjectui64v(g_VertexQuery, GL_QUERY_RESULT, &submittedVertices);
+		if (submittedVertices > g_RecordedVertices)
+		{
+			FailCapture(std::to_string(submittedVertices) + " vertices were drawn but the recorded draws only hold "
+				+ std::to_string(g_RecordedVertices) + " - a draw went through a GL entry point that cannot be hooked");
+		}
+	}
+
+	if (!g_CaptureError.empty())
+	{
+		std::cout << "ERROR: Frame capture dropped, " << g_CaptureError << std::endl;
+		g_Stream.clear();
+		g_Stream.shrink_to_fit();
+		return(false);
+	}
+
+	std::ofstream file(g_CaptureFilename.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write frame capture:" << g_CaptureFilename << std::endl;
+		return(false);
+	}
+
+	file.write(g_CaptureMagic, sizeof(g_CaptureMagic));
+	file.write((const char*)&CAPTURE_VERSION, sizeof(CAPTURE_VERSION));
+	file.write((const char*)&g_RecordCount, sizeof(g_RecordCount));
+	file.write((const char*)g_Stream.data(), g_Stream.size());
+
+	std::cout << "INFO: Captured " << g_RecordCount << " GL calls ("
+		<< g_Stream.size() << " bytes) to " << g_CaptureFilename << std::endl;
+
+	g_Stream.clear();
+	g_Stream.shrink_to_fit();
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsCapturing()
+ *
+ *  This method is used for checking whether a frame is being
+ *  recorded.
+ ***********************************************************/
+bool FrameCapture::IsCapturing()
+{
+	return(g_bCapturing);
+}
+
+/***********************************************************
+ *  GetCallName()
+ *
+ *  This method is used for getting a readable name for a
+ *  recorded call type.
+ ***********************************************************/
+const char* FrameCapture::GetCallName(int callType)
+{
+	static const char* names[CALL_TYPE_COUNT] =
+	{
+		"glUseProgram",
+		"glUniform1i",
+		"glUniform1ui",
+		"glUniform1f",
+		"glUniform2f",
+		"glUniform2fv",
+		"glUniform3f",
+		"glUniform3fv",
+		"glUniform4f",
+		"glUniform4fv",
+		"glUniformMatrix3fv",
+		"glUniformMatrix4fv",
+		"glBindVertexArray",
+		"glBindBuffer",
+		"glBindBufferBase",
+		"glBindBufferRange",
+		"glBufferData",
+		"glBufferSubData",
+		"glActiveTexture",
+		"glBindTextureUnit",
+		"glBindImageTexture",
+		"glBindFramebuffer",
+		"glDrawBuffers",
+		"glBlendFunci",
+		"glClearBufferfv",
+		"glBlitFramebuffer",
+		"fixed-function state",
+		"glDrawArrays",
+		"glDrawArraysInstanced",
+		"glDrawArraysInstancedBaseInstance",
+		"glDrawElementsBaseVertex",
+		"glDrawElementsInstancedBaseVertex",
+		"glDrawElementsInstancedBaseVertexBaseInstance",
+		"glMultiDrawElementsIndirect",
+		"glMultiDrawElementsIndirectCount",
+		"glDispatchCompute",
+		"glMemoryBarrier",
+		"buffer contents",
+		"texture contents",
+		"renderbuffer storage",
+		"framebuffer attachments",
+		"vertex array layout",
+		"program binary"
+	};
+
+	if ((callType < 0) || (callType >= CALL_TYPE_COUNT))
+	{
+		return("unknown");
+	}
+
+	return(names[callType]);
+}
+
+/***********************************************************
+ *  FrameReplayer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameReplayer::FrameReplayer()
+{
+	m_recordCount = 0;
+	for (int i = 0; i < FrameCapture::CALL_TYPE_COUNT; i++)
+	{
+		m_stats[i].calls = 0;
+		m_stats[i].totalMilliseconds = 0.0;
+	}
+}
+
+/***********************************************************
+ *  LoadCapture()
+ *
+ *  This method is used for reading the recorded call stream
+ *  from a capture file.
+ ***********************************************************/
+bool FrameReplayer::LoadCapture(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open frame capture:" << filename << std::endl;
+		return(false);
+	}
+
+	std::streamsize fileSize = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	char magic[4];
+	uint32_t version = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&m_recordCount, sizeof(m_recordCount));
+	if (!file || (memcmp(magic, g_CaptureMagic, sizeof(magic)) != 0) || (version != CAPTURE_VERSION))
+	{
+		std::cout << "Not a supported frame capture:" << filename << std::endl;
+		return(false);
+	}
+
+	m_stream.resize((size_t)fileSize - 12);
+	file.read((char*)m_stream.data(), m_stream.size());
+	if (!file)
+	{
+		std::cout << "Frame capture is truncated:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  NextRecord()
+ *
+ *  This method is used for reading the call type and payload
+ *  of the record at the passed in offset and stepping past
+ *  it, returning false when the record does not fit in the
+ *  stream.
+ ***********************************************************/
+bool FrameReplayer::NextRecord(
+	size_t& offset,
+	int& callType,
+	const unsigned char*& payload,
+	uint32_t& size) const
+{
+	if (offset + 5 > m_stream.size())
+	{
+		return(false);
+	}
+
+	callType = m_stream[offset];
+	memcpy(&size, &m_stream[offset + 1], sizeof(size));
+	if (size > m_stream.size() - offset - 5)
+	{
+		return(false);
+	}
+	payload = &m_stream[offset + 5];
+	offset += 5 + size;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateObjects()
+ *
+ *  This method is used for making the objects recorded in
+ *  the capture before the frame is replayed.
+ ***********************************************************/
+bool FrameReplayer::CreateObjects()
+{
+	size_t offset = 0;
+	for (uint32_t record = 0; record < m_recordCount; record++)
+	{
+		int callType = 0;
+		const unsigned char* payload = NULL;
+		uint32_t size = 0;
+		if (!NextRecord(offset, callType, payload, size))
+		{
+			std::cout << "Frame capture ended early at record " << record << std::endl;
+			return(false);
+		}
+
+		if (IsCreateCall(callType) && !CreateObject(callType, payload, size))
+		{
+			std::cout << "Bad object in frame capture at record " << record << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateObject()
+ *
+ *  This method is used for making one recorded object with
+ *  its recorded contents and keeping its new name.
+ ***********************************************************/
+bool FrameReplayer::CreateObject(
+	int callType,
+	const unsigned char* payload,
+	uint32_t size)
+{
+	PAYLOAD_READER reader(payload, size);
+
+	switch (callType)
+	{
+	case FrameCapture::CALL_CREATE_BUFFER:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		int64_t bufferSize = reader.Get<int64_t>();
+		GLenum usage = reader.Get<uint32_t>();
+		bool bImmutable = reader.Get<uint8_t>() != 0;
+		GLbitfield flags = reader.Get<uint32_t>();
+		const void* contents = (bufferSize >= 0) ? reader.GetBytes((size_t)bufferSize) : NULL;
+		if (NULL == contents)
+		{
+			return(false);
+		}
+
+		GLuint buffer = 0;
+		glCreateBuffers(1, &buffer);
+		if (bImmutable && (bufferSize > 0))
+			glNamedBufferStorage(buffer, (GLsizeiptr)bufferSize, contents, flags);
+		else if (bufferSize > 0)
+			glNamedBufferData(buffer, (GLsizeiptr)bufferSize, contents, usage);
+		m_names[FrameCapture::OBJECT_BUFFER][name] = buffer;
+		break;
+	}
+	case FrameCapture::CALL_CREATE_TEXTURE:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		GLenum target = reader.Get<uint32_t>();
+		GLsizei levels = reader.Get<int32_t>();
+		GLenum internalFormat = reader.Get<uint32_t>();
+		GLsizei width = reader.Get<int32_t>();
+		GLsizei height = reader.Get<int32_t>();
+		GLsizei depth = reader.Get<int32_t>();
+		bool bCompressed = reader.Get<uint8_t>() != 0;
+		GLenum format = reader.Get<uint32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		GLint samplerState[SAMPLER_STATE_COUNT];
+		for (int i = 0; i < SAMPLER_STATE_COUNT; i++)
+		{
+			samplerState[i] = reader.Get<int32_t>();
+		}
+		GLfloat borderColor[4];
+		for (int i = 0; i < 4; i++)
+		{
+			borderColor[i] = reader.Get<float>();
+		}
+		bool bArray = (GL_TEXTURE_2D_ARRAY == target);
+		if (!reader.bValid || (!bArray && (GL_TEXTURE_2D != target)) || (levels < 0)
+			|| ((levels > 0) && ((width <= 0) || (height <= 0) || (depth <= 0))))
+		{
+			return(false);
+		}
+
+		GLuint texture = 0;
+		glCreateTextures(target, 1, &texture);
+		m_names[FrameCapture::OBJECT_TEXTURE][name] = texture;
+		if (levels > 0)
+		{
+			if (bArray)
+				glTextureStorage3D(texture, levels, internalFormat, width, height, depth);
+			else
+				glTextureStorage2D(texture, levels, internalFormat, width, height);
+		}
+
+		GLint unpackAlignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		int pixelBytes = GetPixelBytes(format, type);
+		for (GLsizei level = 0; (level < levels) && reader.bValid; level++)
+		{
+			GLsizei levelWidth = glm::max(1, width >> level);
+			GLsizei levelHeight = glm::max(1, height >> level);
+			uint32_t levelBytes = reader.Get<uint32_t>();
+			const void* pixels = reader.GetBytes(levelBytes);
+			// an uncompressed level is read for its whole size
+			if ((NULL == pixels) || (!bCompressed && ((size_t)levelBytes != (size_t)levelWidth * levelHeight * depth * pixelBytes)))
+			{
+				reader.bValid = false;
+				break;
+			}
+
+			if (bCompressed && bArray)
+				glCompressedTextureSubImage3D(texture, level, 0, 0, 0, levelWidth, levelHeight, depth, internalFormat, levelBytes, pixels);
+			else if (bCompressed)
+				glCompressedTextureSubImage2D(texture, level, 0, 0, levelWidth, levelHeight, internalFormat, levelBytes, pixels);
+			else if (bArray)
+				glTextureSubImage3D(texture, level, 0, 0, 0, levelWidth, levelHeight, depth, format, type, pixels);
+			else
+				glTextureSubImage2D(texture, level, 0, 0, levelWidth, levelHeight, format, type, pixels);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+		for (int i = 0; i < SAMPLER_STATE_COUNT; i++)
+		{
+			glTextureParameteri(texture, g_SamplerStates[i], samplerState[i]);
+		}
+		glTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, borderColor);
+		break;
+	}
+	case FrameCapture::CALL_CREATE_RENDERBUFFER:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		GLenum internalFormat = reader.Get<uint32_t>();
+		GLsizei width = reader.Get<int32_t>();
+		GLsizei height = reader.Get<int32_t>();
+		GLsizei samples = reader.Get<int32_t>();
+		if (!reader.bValid)
+		{
+			return(false);
+		}
+
+		GLuint renderbuffer = 0;
+		glCreateRenderbuffers(1, &renderbuffer);
+		glNamedRenderbufferStorageMultisample(renderbuffer, samples, internalFormat, width, height);
+		m_names[FrameCapture::OBJECT_RENDERBUFFER][name] = renderbuffer;
+		break;
+	}
+	case FrameCapture::CALL_CREATE_FRAMEBUFFER:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		GLuint framebuffer = 0;
+		glCreateFramebuffers(1, &framebuffer);
+		m_names[FrameCapture::OBJECT_FRAMEBUFFER][name] = framebuffer;
+
+		for (int i = 0; i < FRAMEBUFFER_ATTACHMENTS; i++)
+		{
+			GLenum objectType = reader.Get<uint32_t>();
+			uint32_t object = reader.Get<uint32_t>();
+			GLint level = reader.Get<int32_t>();
+			GLint layer = reader.Get<int32_t>();
+			if (GL_RENDERBUFFER == objectType)
+			{
+				GLuint renderbuffer = MapObjectName(object, m_names[FrameCapture::OBJECT_RENDERBUFFER], reader.bValid);
+				glNamedFramebufferRenderbuffer(framebuffer, g_Attachments[i], GL_RENDERBUFFER, renderbuffer);
+			}
+			else if (GL_TEXTURE == objectType)
+			{
+				GLuint texture = MapObjectName(object, m_names[FrameCapture::OBJECT_TEXTURE], reader.bValid);
+				if (layer >= 0)
+					glNamedFramebufferTextureLayer(framebuffer, g_Attachments[i], texture, level, layer);
+				else
+					glNamedFramebufferTexture(framebuffer, g_Attachments[i], texture, level);
+			}
+		}
+
+		GLenum drawBuffers[MAX_DRAW_BUFFERS];
+		for (int i = 0; i < MAX_DRAW_BUFFERS; i++)
+		{
+			drawBuffers[i] = reader.Get<uint32_t>();
+		}
+		GLenum readBuffer = reader.Get<uint32_t>();
+		if (reader.bValid)
+		{
+			glNamedFramebufferDrawBuffers(framebuffer, MAX_DRAW_BUFFERS, drawBuffers);
+			glNamedFramebufferReadBuffer(framebuffer, readBuffer);
+		}
+		break;
+	}
+	case FrameCapture::CALL_CREATE_VERTEX_ARRAY:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		GLuint vertexArray = 0;
+		glCreateVertexArrays(1, &vertexArray);
+		m_names[FrameCapture::OBJECT_VERTEX_ARRAY][name] = vertexArray;
+		glVertexArrayElementBuffer(vertexArray, GetObjectName(reader, m_names[FrameCapture::OBJECT_BUFFER]));
+
+		for (GLuint i = 0; i < (GLuint)VERTEX_ATTRIBUTES; i++)
+		{
+			bool bEnabled = reader.Get<uint8_t>() != 0;
+			GLint attributeSize = reader.Get<int32_t>();
+			GLenum type = reader.Get<uint32_t>();
+			GLboolean normalized = reader.Get<uint8_t>();
+			bool bInteger = reader.Get<uint8_t>() != 0;
+			GLuint relativeOffset = reader.Get<uint32_t>();
+			GLuint binding = reader.Get<uint32_t>();
+			if (!bEnabled || !reader.bValid)
+			{
+				continue;
+			}
+
+			if (bInteger)
+				glVertexArrayAttribIFormat(vertexArray, i, attributeSize, type, relativeOffset);
+			else
+				glVertexArrayAttribFormat(vertexArray, i, attributeSize, type, normalized, relativeOffset);
+			glVertexArrayAttribBinding(vertexArray, i, binding);
+			glEnableVertexArrayAttrib(vertexArray, i);
+		}
+
+		for (GLuint i = 0; i < (GLuint)VERTEX_ATTRIBUTES; i++)
+		{
+			GLuint buffer = GetObjectName(reader, m_names[FrameCapture::OBJECT_BUFFER]);
+			int64_t offset = reader.Get<int64_t>();
+			GLsizei stride = reader.Get<int32_t>();
+			GLuint divisor = reader.Get<uint32_t>();
+			if (!reader.bValid)
+			{
+				break;
+			}
+
+			glVertexArrayVertexBuffer(vertexArray, i, buffer, (GLintptr)offset, stride);
+			glVertexArrayBindingDivisor(vertexArray, i, divisor);
+		}
+		break;
+	}
+	case FrameCapture::CALL_CREATE_PROGRAM:
+	{
+		uint32_t name = reader.Get<uint32_t>();
+		GLenum binaryFormat = reader.Get<uint32_t>();
+		uint32_t binaryLength = reader.Get<uint32_t>();
+		const void* binary = reader.GetBytes(binaryLength);
+		if (NULL == binary)
+		{
+			return(false);
+		}
+
+		GLuint program = glCreateProgram();
+		m_names[FrameCapture::OBJECT_PROGRAM][name] = program;
+		glProgramBinary(program, binaryFormat, binary, (GLsizei)binaryLength);
+		GLint linked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked)
+		{
+			std::cout << "ERROR: Program " << name << " of the frame capture could not be loaded, it was captured with another driver" << std::endl;
+			return(false);
+		}
+
+		// the uniforms were set before the frame, so they are not
+		// among its calls
+		uint32_t uniformCount = reader.Get<uint32_t>();
+		for (uint32_t uniform = 0; (uniform < uniformCount) && reader.bValid; uniform++)
+		{
+			GLint location = reader.Get<int32_t>();
+			int kind = reader.Get<int32_t>();
+			int components = reader.Get<int32_t>();
+			const void* values = ((components >= 1) && (components <= 16)) ? reader.GetBytes(sizeof(uint32_t) * components) : NULL;
+			if (NULL == values)
+			{
+				return(false);
+			}
+
+			const GLfloat* floats = (const GLfloat*)values;
+			const GLint* ints = (const GLint*)values;
+			const GLuint* uints = (const GLuint*)values;
+			if ((UNIFORM_MATRIX == kind) && (components == 4))
+				glProgramUniformMatrix2fv(program, location, 1, GL_FALSE, floats);
+			else if ((UNIFORM_MATRIX == kind) && (components == 9))
+				glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, floats);
+			else if (UNIFORM_MATRIX == kind)
+				glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, floats);
+			else if ((UNIFORM_FLOAT == kind) && (components == 1))
+				glProgramUniform1fv(program, location, 1, floats);
+			else if ((UNIFORM_FLOAT == kind) && (components == 2))
+				glProgramUniform2fv(program, location, 1, floats);
+			else if ((UNIFORM_FLOAT == kind) && (components == 3))
+				glProgramUniform3fv(program, location, 1, floats);
+			else if (UNIFORM_FLOAT == kind)
+				glProgramUniform4fv(program, location, 1, floats);
+			else if ((UNIFORM_UINT == kind) && (components == 1))
+				glProgramUniform1uiv(program, location, 1, uints);
+			else if ((UNIFORM_UINT == kind) && (components == 2))
+				glProgramUniform2uiv(program, location, 1, uints);
+			else if ((UNIFORM_UINT == kind) && (components == 3))
+				glProgramUniform3uiv(program, location, 1, uints);
+			else if (UNIFORM_UINT == kind)
+				glProgramUniform4uiv(program, location, 1, uints);
+			else if (components == 1)
+				glProgramUniform1iv(program, location, 1, ints);
+			else if (components == 2)
+				glProgramUniform2iv(program, location, 1, ints);
+			else if (components == 3)
+				glProgramUniform3iv(program, location, 1, ints);
+			else
+				glProgramUniform4iv(program, location, 1, ints);
+		}
+		break;
+	}
+	default:
+		return(false);
+	}
+
+	return(reader.bValid);
+}
+
+/***********************************************************
+ *  DeleteObjects()
+ *
+ *  This method is used for deleting the objects made for the
+ *  replay.
+ ***********************************************************/
+void FrameReplayer::DeleteObjects()
+{
+	for (int objectType = 0; objectType < FrameCapture::OBJECT_TYPE_COUNT; objectType++)
+	{
+		NAME_MAP& names = m_names[objectType];
+		for (NAME_MAP::const_iterator it = names.begin(); it != names.end(); ++it)
+		{
+			GLuint name = it->second;
+			switch (objectType)
+			{
+			case FrameCapture::OBJECT_BUFFER:
+				glDeleteBuffers(1, &name);
+				break;
+			case FrameCapture::OBJECT_TEXTURE:
+				glDeleteTextures(1, &name);
+				break;
+			case FrameCapture::OBJECT_RENDERBUFFER:
+				glDeleteRenderbuffers(1, &name);
+				break;
+			case FrameCapture::OBJECT_FRAMEBUFFER:
+				glDeleteFramebuffers(1, &name);
+				break;
+			case FrameCapture::OBJECT_VERTEX_ARRAY:
+				glDeleteVertexArrays(1, &name);
+				break;
+			case FrameCapture::OBJECT_PROGRAM:
+				glDeleteProgram(name);
+				break;
+			}
+		}
+		names.clear();
+	}
+}
+
+/***********************************************************
+ *  ReplayRecord()
+ *
+ *  This method is used for re-issuing one recorded call.
+ ***********************************************************/
+bool FrameReplayer::ReplayRecord(
+	int callType,
+	const unsigned char* payload,
+	uint32_t size)
+{
+	PAYLOAD_READER reader(payload, size);
+
+	switch (callType)
+	{
+	case FrameCapture::CALL_USE_PROGRAM:
+		glUseProgram(GetObjectName(reader, m_names[FrameCapture::OBJECT_PROGRAM]));
+		break;
+	case FrameCapture::CALL_UNIFORM_1I:
+	{
+		GLint location = reader.Get<int32_t>();
+		glUniform1i(location, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_UNIFORM_1UI:
+	{
+		GLint location = reader.Get<int32_t>();
+		glUniform1ui(location, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_UNIFORM_1F:
+	{
+		GLint location = reader.Get<int32_t>();
+		glUniform1f(location, reader.Get<float>());
+		break;
+	}
+	case FrameCapture::CALL_UNIFORM_2F:
+	case FrameCapture::CALL_UNIFORM_3F:
+	case FrameCapture::CALL_UNIFORM_4F:
+	{
+		GLint location = reader.Get<int32_t>();
+		float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		int components = 2 + (callType - FrameCapture::CALL_UNIFORM_2F) / 2;
+		for (int i = 0; i < components; i++)
+		{
+			v[i] = reader.Get<float>();
+		}
+		if (callType == FrameCapture::CALL_UNIFORM_2F)
+			glUniform2f(location, v[0], v[1]);
+		else if (callType == FrameCapture::CALL_UNIFORM_3F)
+			glUniform3f(location, v[0], v[1], v[2]);
+		else
+			glUniform4f(location, v[0], v[1], v[2], v[3]);
+		break;
+	}
+	case FrameCapture::CALL_UNIFORM_2FV:
+	case FrameCapture::CALL_UNIFORM_3FV:
+	case FrameCapture::CALL_UNIFORM_4FV:
+	case FrameCapture::CALL_UNIFORM_MATRIX_3FV:
+	case FrameCapture::CALL_UNIFORM_MATRIX_4FV:
+	{
+		GLint location = reader.Get<int32_t>();
+		GLsizei count = reader.Get<int32_t>();
+		GLboolean transpose = reader.Get<uint8_t>();
+		int components = 16;
+		if (callType == FrameCapture::CALL_UNIFORM_2FV)
+			components = 2;
+		else if (callType == FrameCapture::CALL_UNIFORM_3FV)
+			components = 3;
+		else if (callType == FrameCapture::CALL_UNIFORM_4FV)
+			components = 4;
+		else if (callType == FrameCapture::CALL_UNIFORM_MATRIX_3FV)
+			components = 9;
+		// the values have to be in the record for every element
+		const GLfloat* value = (count >= 0) ? (const GLfloat*)reader.GetBytes(sizeof(GLfloat) * components * (size_t)count) : NULL;
+		if (NULL == value)
+		{
+			return(false);
+		}
+		if (callType == FrameCapture::CALL_UNIFORM_2FV)
+			glUniform2fv(location, count, value);
+		else if (callType == FrameCapture::CALL_UNIFORM_3FV)
+			glUniform3fv(location, count, value);
+		else if (callType == FrameCapture::CALL_UNIFORM_4FV)
+			glUniform4fv(location, count, value);
+		else if (callType == FrameCapture::CALL_UNIFORM_MATRIX_3FV)
+			glUniformMatrix3fv(location, count, transpose, value);
+		else
+			glUniformMatrix4fv(location, count, transpose, value);
+		break;
+	}
+	case FrameCapture::CALL_BIND_VERTEX_ARRAY:
+		glBindVertexArray(GetObjectName(reader, m_names[FrameCapture::OBJECT_VERTEX_ARRAY]));
+		break;
+	case FrameCapture::CALL_BIND_BUFFER:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		glBindBuffer(target, GetObjectName(reader, m_names[FrameCapture::OBJECT_BUFFER]));
+		break;
+	}
+	case FrameCapture::CALL_BIND_BUFFER_BASE:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		GLuint index = reader.Get<uint32_t>();
+		glBindBufferBase(target, index, GetObjectName(reader, m_names[FrameCapture::OBJECT_BUFFER]));
+		break;
+	}
+	case FrameCapture::CALL_BIND_BUFFER_RANGE:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		GLuint index = reader.Get<uint32_t>();
+		GLuint buffer = GetObjectName(reader, m_names[FrameCapture::OBJECT_BUFFER]);
+		int64_t offset = reader.Get<int64_t>();
+		glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)reader.Get<int64_t>());
+		break;
+	}
+	case FrameCapture::CALL_BUFFER_DATA:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		int64_t dataSize = reader.Get<int64_t>();
+		GLenum usage = reader.Get<uint32_t>();
+		bool bHasData = reader.Get<uint8_t>() != 0;
+		const void* data = bHasData ? reader.GetBytes((size_t)dataSize) : NULL;
+		glBufferData(target, (GLsizeiptr)dataSize, data, usage);
+		break;
+	}
+	case FrameCapture::CALL_BUFFER_SUB_DATA:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		int64_t offset = reader.Get<int64_t>();
+		int64_t dataSize = reader.Get<int64_t>();
+		const void* data = reader.GetBytes((size_t)dataSize);
+		if (NULL != data)
+		{
+			glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)dataSize, data);
+		}
+		break;
+	}
+	case FrameCapture::CALL_ACTIVE_TEXTURE:
+		glActiveTexture(reader.Get<uint32_t>());
+		break;
+	case FrameCapture::CALL_BIND_TEXTURE_UNIT:
+	{
+		GLuint unit = reader.Get<uint32_t>();
+		glBindTextureUnit(unit, GetObjectName(reader, m_names[FrameCapture::OBJECT_TEXTURE]));
+		break;
+	}
+	case FrameCapture::CALL_BIND_IMAGE_TEXTURE:
+	{
+		GLuint unit = reader.Get<uint32_t>();
+		GLuint texture = GetObjectName(reader, m_names[FrameCapture::OBJECT_TEXTURE]);
+		GLint level = reader.Get<int32_t>();
+		GLboolean layered = reader.Get<uint8_t>();
+		GLint layer = reader.Get<int32_t>();
+		GLenum access = reader.Get<uint32_t>();
+		glBindImageTexture(unit, texture, level, layered, layer, access, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_BIND_FRAMEBUFFER:
+	{
+		GLenum target = reader.Get<uint32_t>();
+		glBindFramebuffer(target, GetObjectName(reader, m_names[FrameCapture::OBJECT_FRAMEBUFFER]));
+		break;
+	}
+	case FrameCapture::CALL_DRAW_BUFFERS:
+	{
+		GLsizei count = reader.Get<int32_t>();
+		const GLenum* buffers = (const GLenum*)reader.GetBytes(sizeof(GLenum) * count);
+		if (NULL != buffers)
+		{
+			glDrawBuffers(count, buffers);
+		}
+		break;
+	}
+	case FrameCapture::CALL_BLEND_FUNCI:
+	{
+		GLuint buffer = reader.Get<uint32_t>();
+		GLenum src = reader.Get<uint32_t>();
+		glBlendFunci(buffer, src, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_CLEAR_BUFFER_FV:
+	{
+		GLenum buffer = reader.Get<uint32_t>();
+		GLint drawBuffer = reader.Get<int32_t>();
+		const GLfloat* value = (const GLfloat*)reader.GetBytes(sizeof(GLfloat) * ((buffer == GL_COLOR) ? 4 : 1));
+		if (NULL != value)
+		{
+			glClearBufferfv(buffer, drawBuffer, value);
+		}
+		break;
+	}
+	case FrameCapture::CALL_BLIT_FRAMEBUFFER:
+	{
+		int32_t r[8];
+		for (int i = 0; i < 8; i++)
+		{
+			r[i] = reader.Get<int32_t>();
+		}
+		GLbitfield mask = reader.Get<uint32_t>();
+		glBlitFramebuffer(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], mask, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_DRAW_ELEMENTS_BASE_VERTEX:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLsizei count = reader.Get<int32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		uint64_t indices = reader.Get<uint64_t>();
+		glDrawElementsBaseVertex(mode, count, type, (const void*)(uintptr_t)indices, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLsizei count = reader.Get<int32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		uint64_t indices = reader.Get<uint64_t>();
+		GLsizei instances = reader.Get<int32_t>();
+		glDrawElementsInstancedBaseVertex(mode, count, type, (const void*)(uintptr_t)indices, instances, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_MULTI_DRAW_ELEMENTS_INDIRECT:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		uint64_t indirect = reader.Get<uint64_t>();
+		GLsizei drawCount = reader.Get<int32_t>();
+		glMultiDrawElementsIndirect(mode, type, (const void*)(uintptr_t)indirect, drawCount, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_MULTI_DRAW_ELEMENTS_INDIRECT_COUNT:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		uint64_t indirect = reader.Get<uint64_t>();
+		int64_t drawCount = reader.Get<int64_t>();
+		GLsizei maxDrawCount = reader.Get<int32_t>();
+		glMultiDrawElementsIndirectCount(mode, type, (const void*)(uintptr_t)indirect, (GLintptr)drawCount, maxDrawCount, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_DISPATCH_COMPUTE:
+	{
+		GLuint x = reader.Get<uint32_t>();
+		GLuint y = reader.Get<uint32_t>();
+		glDispatchCompute(x, y, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_MEMORY_BARRIER:
+		glMemoryBarrier(reader.Get<uint32_t>());
+		break;
+	case FrameCapture::CALL_FIXED_STATE:
+	{
+		FIXED_STATE state = reader.Get<FIXED_STATE>();
+		state.depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+		state.blend ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		state.cullFace ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+		glDepthMask(state.depthMask);
+		glColorMask(state.colorMask[0], state.colorMask[1], state.colorMask[2], state.colorMask[3]);
+		glDepthFunc(state.depthFunc);
+		glBlendFunc(state.blendSrc, state.blendDst);
+		glViewport(state.viewport[0], state.viewport[1], state.viewport[2], state.viewport[3]);
+		GLint activeTexture = GL_TEXTURE0;
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+		for (int unit = 0; unit < SNAPSHOT_TEXTURE_UNITS; unit++)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_2D, MapObjectName(state.textures[unit], m_names[FrameCapture::OBJECT_TEXTURE], reader.bValid));
+		}
+		glActiveTexture(activeTexture);
+		break;
+	}
+	case FrameCapture::CALL_DRAW_ARRAYS:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLint first = reader.Get<int32_t>();
+		glDrawArrays(mode, first, reader.Get<int32_t>());
+		break;
+	}
+	case FrameCapture::CALL_DRAW_ARRAYS_INSTANCED:
+	case FrameCapture::CALL_DRAW_ARRAYS_INSTANCED_BASE_INSTANCE:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLint first = reader.Get<int32_t>();
+		GLsizei count = reader.Get<int32_t>();
+		GLsizei instances = reader.Get<int32_t>();
+		if (callType == FrameCapture::CALL_DRAW_ARRAYS_INSTANCED)
+			glDrawArraysInstanced(mode, first, count, instances);
+		else
+			glDrawArraysInstancedBaseInstance(mode, first, count, instances, reader.Get<uint32_t>());
+		break;
+	}
+	case FrameCapture::CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE:
+	{
+		GLenum mode = reader.Get<uint32_t>();
+		GLsizei count = reader.Get<int32_t>();
+		GLenum type = reader.Get<uint32_t>();
+		uint64_t indices = reader.Get<uint64_t>();
+		GLsizei instances = reader.Get<int32_t>();
+		GLint baseVertex = reader.Get<int32_t>();
+		glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, (const void*)(uintptr_t)indices, instances, baseVertex, reader.Get<uint32_t>());
+		break;
+	}
+	default:
+		return(false);
+	}
+
+	return(reader.bValid);
+}
+
+/***********************************************************
+ *  Replay()
+ *
+ *  This method is used for re-issuing the recorded frame in
+ *  a tight loop.  Every call is timed on the CPU, which is
+ *  the driver cost of submitting it, and the frame is
+ *  finished after each iteration so the GPU keeps up.
+ ***********************************************************/
+void FrameReplayer::Replay(int iterations)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	if (m_stream.size() == 0)
+	{
+		return;
+	}
+
+	if (!CreateObjects())
+	{
+		DeleteObjects();
+		return;
+	}
+
+	// the cost of reading the clock twice is taken off every call
+	const int calibrationRuns = 10000;
+	Clock::time_point calibrationStart = Clock::now();
+	for (int i = 0; i < calibrationRuns; i++)
+	{
+		Clock::now();
+	}
+	double clockOverhead = std::chrono::duration<double, std::milli>(Clock::now() - calibrationStart).count() / calibrationRuns;
+
+	Clock::time_point replayStart = Clock::now();
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// the records were checked to fit while making the objects
+		size_t offset = 0;
+		for (uint32_t record = 0; record < m_recordCount; record++)
+		{
+			int callType = 0;
+			const unsigned char* payload = NULL;
+			uint32_t size = 0;
+			NextRecord(offset, callType, payload, size);
+			if (IsCreateCall(callType))
+			{
+				continue;
+			}
+
+			Clock::time_point callStart = Clock::now();
+			bool bValid = ReplayRecord(callType, payload, size);
+			double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - callStart).count();
+			if (!bValid)
+			{
+				std::cout << "Bad record in frame capture at record " << record << std::endl;
+				DeleteObjects();
+				return;
+			}
+
+			m_stats[callType].calls++;
+			m_stats[callType].totalMilliseconds += glm::max(0.0, elapsed - clockOverhead);
+		}
+
+		glFinish();
+	}
+	double replayMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - replayStart).count();
+	DeleteObjects();
+
+	std::cout << "INFO: Replayed " << iterations << " frames of " << m_recordCount << " calls, "
+		<< replayMilliseconds / iterations << " ms per frame" << std::endl;
+	std::cout << std::left << std::setw(36) << "call" << std::right
+		<< std::setw(12) << "per frame" << std::setw(14) << "ms per frame" << std::setw(14) << "us per call" << std::endl;
+	for (int i = 0; i < FrameCapture::CALL_TYPE_COUNT; i++)
+	{
+		if (m_stats[i].calls == 0)
+		{
+			continue;
+		}
+
+		std::cout << std::left << std::setw(36) << FrameCapture::GetCallName(i) << std::right
+			<< std::setw(12) << m_stats[i].calls / iterations
+			<< std::setw(14) << std::fixed << std::setprecision(4) << m_stats[i].totalMilliseconds / iterations
+			<< std::setw(14) << m_stats[i].totalMilliseconds * 1000.0 / m_stats[i].calls
+			<< std::defaultfloat << std::endl;
+	}
+}
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// record the GL calls of one frame to a file and replay them in a
+// tight loop to measure the driver cost of each call type
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// glDrawArrays is a GL 1.1 entry point, which GLEW leaves to the
+// GL library instead of loading it, so the files that draw with it
+// include this header and call it through a pointer that the
+// capture swaps like the GLEW entry points
+typedef void (GLAPIENTRY * PFNCAPTUREDRAWARRAYSPROC)(GLenum mode, GLint first, GLsizei count);
+extern PFNCAPTUREDRAWARRAYSPROC g_CaptureDrawArrays;
+#define glDrawArrays(mode, first, count) g_CaptureDrawArrays(mode, first, count)
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class records the GL calls issued during one frame
+ *  by swapping the GLEW entry points for recording hooks.
+ *  Uniform values, buffer uploads, binds and draws are kept
+ *  with their data in a compact binary stream.  The first time
+ *  a call refers to a program, buffer, texture, renderbuffer,
+ *  framebuffer or vertex array, the object is recorded along
+ *  with its contents, so the frame can be replayed into new
+ *  objects whatever names they get.
+ *
+ *  The GL 1.1 entry points are linked directly rather than
+ *  through GLEW, so they cannot be hooked.  Instead the
+ *  fixed-function state they set is captured as a snapshot
+ *  before every draw.  Of their draws, glDrawArrays is routed
+ *  through the pointer above and recorded; one made through
+ *  glDrawElements would be lost, so the renderer does not use
+ *  it, and the capture counts the vertices the GL was handed
+ *  over the frame and fails when the recorded draws do not
+ *  account for them.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// identifiers for the recorded calls
+	enum CALL_TYPE
+	{
+		// program and uniforms
+		CALL_USE_PROGRAM,
+		CALL_UNIFORM_1I,
+		CALL_UNIFORM_1UI,
+		CALL_UNIFORM_1F,
+		CALL_UNIFORM_2F,
+		CALL_UNIFORM_2FV,
+		CALL_UNIFORM_3F,
+		CALL_UNIFORM_3FV,
+		CALL_UNIFORM_4F,
+		CALL_UNIFORM_4FV,
+		CALL_UNIFORM_MATRIX_3FV,
+		CALL_UNIFORM_MATRIX_4FV,
+		// vertex arrays and buffers
+		CALL_BIND_VERTEX_ARRAY,
+		CALL_BIND_BUFFER,
+		CALL_BIND_BUFFER_BASE,
+		CALL_BIND_BUFFER_RANGE,
+		CALL_BUFFER_DATA,
+		CALL_BUFFER_SUB_DATA,
+		// textures
+		CALL_ACTIVE_TEXTURE,
+		CALL_BIND_TEXTURE_UNIT,
+		CALL_BIND_IMAGE_TEXTURE,
+		// framebuffers
+		CALL_BIND_FRAMEBUFFER,
+		CALL_DRAW_BUFFERS,
+		CALL_BLEND_FUNCI,
+		CALL_CLEAR_BUFFER_FV,
+		CALL_BLIT_FRAMEBUFFER,
+		// snapshot of the GL 1.1 state before every draw
+		CALL_FIXED_STATE,
+		// draws and compute
+		CALL_DRAW_ARRAYS,
+		CALL_DRAW_ARRAYS_INSTANCED,
+		CALL_DRAW_ARRAYS_INSTANCED_BASE_INSTANCE,
+		CALL_DRAW_ELEMENTS_BASE_VERTEX,
+		CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX,
+		CALL_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX_BASE_INSTANCE,
+		CALL_MULTI_DRAW_ELEMENTS_INDIRECT,
+		CALL_MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+		CALL_DISPATCH_COMPUTE,
+		CALL_MEMORY_BARRIER,
+		// the objects the frame uses, made once before it replays
+		CALL_CREATE_BUFFER,
+		CALL_CREATE_TEXTURE,
+		CALL_CREATE_RENDERBUFFER,
+		CALL_CREATE_FRAMEBUFFER,
+		CALL_CREATE_VERTEX_ARRAY,
+		CALL_CREATE_PROGRAM,
+		CALL_TYPE_COUNT
+	};
+
+	// the kinds of GL object recorded by their contents, each
+	// with its own names
+	enum OBJECT_TYPE
+	{
+		OBJECT_BUFFER,
+		OBJECT_TEXTURE,
+		OBJECT_RENDERBUFFER,
+		OBJECT_FRAMEBUFFER,
+		OBJECT_VERTEX_ARRAY,
+		OBJECT_PROGRAM,
+		OBJECT_TYPE_COUNT
+	};
+
+	// start recording the GL calls into memory
+	static bool BeginCapture(const char* filename);
+	// stop recording and write the stream to the capture file
+	static bool EndCapture();
+	static bool IsCapturing();
+
+	// readable name of a recorded call type
+	static const char* GetCallName(int callType);
+};
+
+/***********************************************************
+ *  FrameReplayer
+ *
+ *  This class loads a capture file, makes the objects it
+ *  recorded and re-issues its calls with the recorded object
+ *  names swapped for the new ones, timing the CPU submission
+ *  cost of every call type.  Uniform locations are kept as
+ *  recorded, as the programs are loaded from the binaries the
+ *  same driver linked.
+ ***********************************************************/
+class FrameReplayer
+{
+public:
+	// constructor
+	FrameReplayer();
+
+	// timing of one call type over all replayed frames
+	struct CALL_STATS
+	{
+		uint64_t calls;
+		double totalMilliseconds;
+	};
+
+	// read the recorded stream from a capture file
+	bool LoadCapture(const char* filename);
+
+	// replay the frame the passed in number of times and
+	// print the per call type timing
+	void Replay(int iterations);
+
+	const CALL_STATS& GetStats(int callType) const { return m_stats[callType]; }
+
+private:
+	// recorded call stream and the number of calls in it
+	std::vector<unsigned char> m_stream;
+	uint32_t m_recordCount;
+	CALL_STATS m_stats[FrameCapture::CALL_TYPE_COUNT];
+	// the objects made for the recorded names
+	std::unordered_map<uint32_t, GLuint> m_names[FrameCapture::OBJECT_TYPE_COUNT];
+
+	// step to the record at the passed in offset, returning
+	// false past the end of the stream
+	bool NextRecord(size_t& offset, int& callType, const unsigned char*& payload, uint32_t& size) const;
+	// make the recorded objects, returning false on a bad record
+	bool CreateObjects();
+	bool CreateObject(int callType, const unsigned char* payload, uint32_t size);
+	void DeleteObjects();
+	// issue one recorded call, returning false on a bad record
+	bool ReplayRecord(int callType, const unsigned char* payload, uint32_t size);
+};
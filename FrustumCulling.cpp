@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculling.cpp
+// ============
+// bounding box and view frustum tests for culling scene objects
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCulling.h"
+
+#include <cmath>
+
+/***********************************************************
+ *  ExtractFrustum()
+ *
+ *  This function is used for extracting the six frustum planes
+ *  from the rows of a combined projection * view matrix.
+ ***********************************************************/
+FRUSTUM ExtractFrustum(const glm::mat4& viewProjection)
+{
+	FRUSTUM frustum;
+	glm::vec4 row[4];
+
+	// glm matrices are column major, so gather the rows first
+	for (int i = 0; i < 4; i++)
+	{
+		row[i] = glm::vec4(
+			viewProjection[0][i],
+			viewProjection[1][i],
+			viewProjection[2][i],
+			viewProjection[3][i]);
+	}
+
+	frustum.planes[0] = row[3] + row[0];	// left
+	frustum.planes[1] = row[3] - row[0];	// right
+	frustum.planes[2] = row[3] + row[1];	// bottom
+	frustum.planes[3] = row[3] - row[1];	// top
+	frustum.planes[4] = row[3] + row[2];	// near
+	frustum.planes[5] = row[3] - row[2];	// far
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(frustum.planes[i]));
+		if (length > 0.0f)
+		{
+			frustum.planes[i] = frustum.planes[i] / length;
+		}
+	}
+
+	return(frustum);
+}
+
+/***********************************************************
+ *  TransformBoundingBox()
+ *
+ *  This function is used for transforming an object space
+ *  bounding box by a model matrix, returning the world space
+ *  box that encloses the transformed corners.
+ ***********************************************************/
+BOUNDING_BOX TransformBoundingBox(const BOUNDING_BOX& box, const glm::mat4& model)
+{
+	BOUNDING_BOX result;
+	glm::vec3 center = (box.min + box.max) * 0.5f;
+	glm::vec3 extent = (box.max - box.min) * 0.5f;
+	glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+	glm::vec3 worldExtent;
+
+	// the world extent along each axis is the sum of the
+	// absolute projections of the rotated and scaled box axes
+	for (int i = 0; i < 3; i++)
+	{
+		worldExtent[i] =
+			std::fabs(model[0][i]) * extent.x +
+			std::fabs(model[1][i]) * extent.y +
+			std::fabs(model[2][i]) * extent.z;
+	}
+
+	result.min = worldCenter - worldExtent;
+	result.max = worldCenter + worldExtent;
+
+	return(result);
+}
+
+/***********************************************************
+ *  IsBoxInFrustum()
+ *
+ *  This function is used for testing a world space bounding
+ *  box against the frustum planes.  The box is rejected only
+ *  when it lies entirely behind one of the planes.
+ ***********************************************************/
+bool IsBoxInFrustum(const FRUSTUM& frustum, const BOUNDING_BOX& box)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& plane = frustum.planes[i];
+
+		// the box corner furthest along the plane normal
+		glm::vec3 positive(
+			(plane.x >= 0.0f) ? box.max.x : box.min.x,
+			(plane.y >= 0.0f) ? box.max.y : box.min.y,
+			(plane.z >= 0.0f) ? box.max.z : box.min.z);
+
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculling.h
+// ============
+// bounding box and view frustum tests for culling scene objects
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  BOUNDING_BOX
+ *
+ *  Axis aligned bounding box in world or object space.
+ ***********************************************************/
+struct BOUNDING_BOX
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+/***********************************************************
+ *  FRUSTUM
+ *
+ *  The six clipping planes of a view frustum, stored as
+ *  (normal, distance) with the normals pointing inwards.
+ ***********************************************************/
+struct FRUSTUM
+{
+	glm::vec4 planes[6];
+};
+
+// extract the frustum planes from a combined projection * view matrix
+FRUSTUM ExtractFrustum(const glm::mat4& viewProjection);
+
+// transform an object space box into a world space box
+BOUNDING_BOX TransformBoundingBox(const BOUNDING_BOX& box, const glm::mat4& model);
+
+// test whether a world space box is at least partly inside the frustum
+bool IsBoxInFrustum(const FRUSTUM& frustum, const BOUNDING_BOX& box);
@@ -0,0 +1,786 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.cpp
+// ============
+// OpenGL implementation of the render hardware interface
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLRenderDevice.h"
+#include "GpuMemoryTracker.h"
+#include "ShaderLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// bytes per texel of each texture format
+	int TextureFormatBytes(TEXTURE_FORMAT format)
+	{
+		return((TEXTURE_FORMAT_R8 == format) ? 1 : 4);
+	}
+}
+
+/***********************************************************
+ *  GLRenderCommandBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderCommandBuffer::GLRenderCommandBuffer(size_t uniformAlignment)
+{
+	m_uniformAlignment = std::max(uniformAlignment, (size_t)16);
+}
+
+/***********************************************************
+ *  AddCommand()
+ *
+ *  This method is used for appending a command to the list
+ *  with its counts cleared.
+ ***********************************************************/
+GLRenderCommandBuffer::GL_COMMAND& GLRenderCommandBuffer::AddCommand(GL_COMMAND_TYPE type, unsigned int handle)
+{
+	GL_COMMAND command;
+	command.type = type;
+	command.handle = handle;
+	command.counts[0] = 0;
+	command.counts[1] = 0;
+	command.counts[2] = 0;
+	command.counts[3] = 0;
+	command.vertexOffset = 0;
+	command.offset = 0;
+	m_commands.push_back(command);
+	return(m_commands.back());
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for clearing the recorded commands,
+ *  keeping the storage.  GL runs a command buffer when it is
+ *  submitted, so there is nothing to wait for.
+ ***********************************************************/
+void GLRenderCommandBuffer::Begin()
+{
+	m_commands.clear();
+	m_uniformData.clear();
+	m_clearColors.clear();
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used for finishing the recording.
+ ***********************************************************/
+void GLRenderCommandBuffer::End()
+{
+}
+
+/***********************************************************
+ *  BeginRenderPass()
+ *
+ *  This method is used for recording the start of a pass.
+ ***********************************************************/
+void GLRenderCommandBuffer::BeginRenderPass(RENDER_TARGET_HANDLE target, const glm::vec4& clearColor)
+{
+	GL_COMMAND& command = AddCommand(GL_COMMAND_BEGIN_PASS, target);
+	command.counts[0] = (unsigned int)m_clearColors.size();
+	m_clearColors.push_back(clearColor);
+}
+
+/***********************************************************
+ *  EndRenderPass()
+ *
+ *  This method is used for recording the end of a pass.
+ ***********************************************************/
+void GLRenderCommandBuffer::EndRenderPass()
+{
+	AddCommand(GL_COMMAND_END_PASS, 0);
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for recording a pipeline change.  The
+ *  vertex layout belongs to the pipeline in GL, so the vertex
+ *  and index buffers are bound again after it.
+ ***********************************************************/
+void GLRenderCommandBuffer::BindPipeline(PIPELINE_HANDLE pipeline)
+{
+	AddCommand(GL_COMMAND_BIND_PIPELINE, pipeline);
+}
+
+/***********************************************************
+ *  BindVertexBuffer()
+ *
+ *  This method is used for recording a vertex buffer binding.
+ ***********************************************************/
+void GLRenderCommandBuffer::BindVertexBuffer(unsigned int binding, BUFFER_HANDLE buffer, size_t offset)
+{
+	GL_COMMAND& command = AddCommand(GL_COMMAND_BIND_VERTEX_BUFFER, buffer);
+	command.counts[0] = binding;
+	command.offset = offset;
+}
+
+/***********************************************************
+ *  BindIndexBuffer()
+ *
+ *  This method is used for recording the index buffer.
+ ***********************************************************/
+void GLRenderCommandBuffer::BindIndexBuffer(BUFFER_HANDLE buffer, size_t offset)
+{
+	GL_COMMAND& command = AddCommand(GL_COMMAND_BIND_INDEX_BUFFER, buffer);
+	command.offset = offset;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for recording the texture.
+ ***********************************************************/
+void GLRenderCommandBuffer::BindTexture(TEXTURE_HANDLE texture)
+{
+	AddCommand(GL_COMMAND_BIND_TEXTURE, texture);
+}
+
+/***********************************************************
+ *  SetUniforms()
+ *
+ *  This method is used for copying the uniforms into the
+ *  packed block at the next aligned offset.
+ ***********************************************************/
+void GLRenderCommandBuffer::SetUniforms(const void* data, size_t size)
+{
+	if (size > RHI_MAX_UNIFORM_BYTES)
+	{
+		std::cout << "Uniform data of " << size << " bytes is over the limit of "
+			<< RHI_MAX_UNIFORM_BYTES << std::endl;
+		size = RHI_MAX_UNIFORM_BYTES;
+	}
+
+	size_t offset = (m_uniformData.size() + m_uniformAlignment - 1) / m_uniformAlignment * m_uniformAlignment;
+	m_uniformData.resize(offset + size);
+	memcpy(&m_uniformData[offset], data, size);
+
+	GL_COMMAND& command = AddCommand(GL_COMMAND_SET_UNIFORMS, 0);
+	command.counts[0] = (unsigned int)size;
+	command.offset = offset;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for recording a non-indexed draw.
+ ***********************************************************/
+void GLRenderCommandBuffer::Draw(
+	unsigned int vertexCount,
+	unsigned int instanceCount,
+	unsigned int firstVertex,
+	unsigned int firstInstance)
+{
+	GL_COMMAND& command = AddCommand(GL_COMMAND_DRAW, 0);
+	command.counts[0] = vertexCount;
+	command.counts[1] = instanceCount;
+	command.counts[2] = firstVertex;
+	command.counts[3] = firstInstance;
+}
+
+/***********************************************************
+ *  DrawIndexed()
+ *
+ *  This method is used for recording an indexed draw.
+ ***********************************************************/
+void GLRenderCommandBuffer::DrawIndexed(
+	unsigned int indexCount,
+	unsigned int instanceCount,
+	unsigned int firstIndex,
+	int vertexOffset,
+	unsigned int firstInstance)
+{
+	GL_COMMAND& command = AddCommand(GL_COMMAND_DRAW_INDEXED, 0);
+	command.counts[0] = indexCount;
+	command.counts[1] = instanceCount;
+	command.counts[2] = firstIndex;
+	command.counts[3] = firstInstance;
+	command.vertexOffset = vertexOffset;
+}
+
+/***********************************************************
+ *  GLRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderDevice::GLRenderDevice()
+{
+	m_uniformBuffer = 0;
+	m_uniformCapacity = 0;
+	m_uniformAlignment = 256;
+}
+
+/***********************************************************
+ *  ~GLRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLRenderDevice::~GLRenderDevice()
+{
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+	{
+		DestroyBuffer((BUFFER_HANDLE)(i + 1));
+	}
+	for (size_t i = 0; i < m_textures.size(); ++i)
+	{
+		DestroyTexture((TEXTURE_HANDLE)(i + 1));
+	}
+	for (size_t i = 0; i < m_pipelines.size(); ++i)
+	{
+		DestroyPipeline((PIPELINE_HANDLE)(i + 1));
+	}
+	for (size_t i = 0; i < m_renderTargets.size(); ++i)
+	{
+		DestroyRenderTarget((RENDER_TARGET_HANDLE)(i + 1));
+	}
+	if (0 != m_uniformBuffer)
+	{
+		glDeleteBuffers(1, &m_uniformBuffer);
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)m_uniformCapacity);
+		m_uniformBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for checking the context and creating
+ *  the uniform buffer.  The GL context must be current.
+ ***********************************************************/
+bool GLRenderDevice::Initialize()
+{
+	// separate attribute formats and base instance draws
+	if (!GLEW_VERSION_4_3)
+	{
+		std::cout << "The GL render device needs OpenGL 4.3" << std::endl;
+		return(false);
+	}
+
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	m_deviceName = (NULL != renderer) ? (const char*)renderer : "OpenGL";
+
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment > 0)
+	{
+		m_uniformAlignment = (size_t)alignment;
+	}
+
+	glGenBuffers(1, &m_uniformBuffer);
+	return(0 != m_uniformBuffer);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a vertex or index buffer.
+ *  The copy target is used so the element array binding of
+ *  the current vertex array is left alone.  OpenGL buffers
+ *  are not typed, so the usage is only needed by Vulkan.
+ ***********************************************************/
+BUFFER_HANDLE GLRenderDevice::CreateBuffer(BUFFER_USAGE, size_t size, const void* data)
+{
+	BUFFER_ENTRY entry;
+	entry.buffer = 0;
+	entry.size = size;
+
+	glGenBuffers(1, &entry.buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, entry.buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, data, (NULL != data) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)size);
+
+	m_buffers.push_back(entry);
+	return((BUFFER_HANDLE)m_buffers.size());
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for replacing part of a buffer.
+ ***********************************************************/
+void GLRenderDevice::UpdateBuffer(BUFFER_HANDLE buffer, size_t offset, size_t size, const void* data)
+{
+	if ((0 == buffer) || (buffer > m_buffers.size()) || (offset + size > m_buffers[buffer - 1].size))
+	{
+		std::cout << "Buffer update out of range" << std::endl;
+		return;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffers[buffer - 1].buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for deleting a buffer.
+ ***********************************************************/
+void GLRenderDevice::DestroyBuffer(BUFFER_HANDLE buffer)
+{
+	if ((0 == buffer) || (buffer > m_buffers.size()) || (0 == m_buffers[buffer - 1].buffer))
+	{
+		return;
+	}
+
+	BUFFER_ENTRY& entry = m_buffers[buffer - 1];
+	glDeleteBuffers(1, &entry.buffer);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)entry.size);
+	entry.buffer = 0;
+	entry.size = 0;
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a single level texture
+ *  with linear filtering and clamped edges.  The texture unit
+ *  of the interface is used so the scene textures stay bound.
+ ***********************************************************/
+TEXTURE_HANDLE GLRenderDevice::CreateTexture(int width, int height, TEXTURE_FORMAT format, const void* pixels)
+{
+	TEXTURE_ENTRY entry;
+	entry.texture = 0;
+	entry.bytes = width * height * TextureFormatBytes(format);
+
+	glActiveTexture(GL_TEXTURE0 + RHI_TEXTURE_BINDING);
+	glGenTextures(1, &entry.texture);
+	glBindTexture(GL_TEXTURE_2D, entry.texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, (TEXTURE_FORMAT_R8 == format) ? GL_R8 : GL_RGBA8, width, height);
+	if (NULL != pixels)
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+			(TEXTURE_FORMAT_R8 == format) ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glActiveTexture(GL_TEXTURE0);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)entry.bytes);
+
+	m_textures.push_back(entry);
+	return((TEXTURE_HANDLE)m_textures.size());
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for deleting a texture.
+ ***********************************************************/
+void GLRenderDevice::DestroyTexture(TEXTURE_HANDLE texture)
+{
+	if ((0 == texture) || (texture > m_textures.size()) || (0 == m_textures[texture - 1].texture))
+	{
+		return;
+	}
+
+	TEXTURE_ENTRY& entry = m_textures[texture - 1];
+	glDeleteTextures(1, &entry.texture);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)entry.bytes);
+	entry.texture = 0;
+	entry.bytes = 0;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for linking the GLSL program and
+ *  building the vertex array that holds the vertex layout.
+ ***********************************************************/
+PIPELINE_HANDLE GLRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	GLuint program = LoadShaderProgram(desc.vertexShaderFile.c_str(), NULL, desc.fragmentShaderFile.c_str());
+	if (0 == program)
+	{
+		return(0);
+	}
+
+	PIPELINE_ENTRY entry;
+	entry.program = program;
+	entry.vertexArray = 0;
+	entry.topology = (PRIMITIVE_TRIANGLE_STRIP == desc.topology) ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+	entry.bDepthTest = desc.bDepthTest;
+	entry.bDepthWrite = desc.bDepthWrite;
+	entry.bBlend = desc.bBlend;
+
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glGenVertexArrays(1, &entry.vertexArray);
+	glBindVertexArray(entry.vertexArray);
+
+	for (size_t i = 0; i < desc.attributes.size(); ++i)
+	{
+		const VERTEX_ATTRIBUTE& attribute = desc.attributes[i];
+		glEnableVertexAttribArray(attribute.location);
+		switch (attribute.format)
+		{
+		case VERTEX_FORMAT_FLOAT2:
+			glVertexAttribFormat(attribute.location, 2, GL_FLOAT, GL_FALSE, attribute.offset);
+			break;
+		case VERTEX_FORMAT_FLOAT3:
+			glVertexAttribFormat(attribute.location, 3, GL_FLOAT, GL_FALSE, attribute.offset);
+			break;
+		case VERTEX_FORMAT_FLOAT4:
+			glVertexAttribFormat(attribute.location, 4, GL_FLOAT, GL_FALSE, attribute.offset);
+			break;
+		case VERTEX_FORMAT_UNORM8X4:
+			glVertexAttribFormat(attribute.location, 4, GL_UNSIGNED_BYTE, GL_TRUE, attribute.offset);
+			break;
+		}
+		glVertexAttribBinding(attribute.location, attribute.binding);
+	}
+	for (size_t i = 0; i < desc.bindings.size(); ++i)
+	{
+		const VERTEX_BINDING& binding = desc.bindings[i];
+		glVertexBindingDivisor(binding.binding, binding.bPerInstance ? 1 : 0);
+		if (binding.binding >= entry.strides.size())
+		{
+			entry.strides.resize(binding.binding + 1, 0);
+		}
+		entry.strides[binding.binding] = (GLsizei)binding.stride;
+	}
+	glBindVertexArray(previousVertexArray);
+
+	m_pipelines.push_back(entry);
+	return((PIPELINE_HANDLE)m_pipelines.size());
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for deleting a pipeline.
+ ***********************************************************/
+void GLRenderDevice::DestroyPipeline(PIPELINE_HANDLE pipeline)
+{
+	if ((0 == pipeline) || (pipeline > m_pipelines.size()) || (0 == m_pipelines[pipeline - 1].program))
+	{
+		return;
+	}
+
+	PIPELINE_ENTRY& entry = m_pipelines[pipeline - 1];
+	glDeleteProgram(entry.program);
+	glDeleteVertexArrays(1, &entry.vertexArray);
+	entry.program = 0;
+	entry.vertexArray = 0;
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating a framebuffer with an
+ *  RGBA8 color texture and a depth renderbuffer.
+ ***********************************************************/
+RENDER_TARGET_HANDLE GLRenderDevice::CreateRenderTarget(int width, int height)
+{
+	RENDER_TARGET_ENTRY entry;
+	entry.framebuffer = 0;
+	entry.colorTexture = 0;
+	entry.depthBuffer = 0;
+	entry.width = width;
+	entry.height = height;
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	glActiveTexture(GL_TEXTURE0 + RHI_TEXTURE_BINDING);
+	glGenTextures(1, &entry.colorTexture);
+	glBindTexture(GL_TEXTURE_2D, entry.colorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glActiveTexture(GL_TEXTURE0);
+
+	glGenRenderbuffers(1, &entry.depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, entry.depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+
+	glGenFramebuffers(1, &entry.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, entry.framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, entry.colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, entry.depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	// RGBA8 color and 32 bit float depth
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)width * height * 8);
+
+	m_renderTargets.push_back(entry);
+	RENDER_TARGET_HANDLE target = (RENDER_TARGET_HANDLE)m_renderTargets.size();
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "Render target framebuffer is incomplete: 0x" << std::hex << status << std::dec << std::endl;
+		DestroyRenderTarget(target);
+		return(0);
+	}
+	return(target);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for deleting a render target.
+ ***********************************************************/
+void GLRenderDevice::DestroyRenderTarget(RENDER_TARGET_HANDLE target)
+{
+	if ((0 == target) || (target > m_renderTargets.size()) || (0 == m_renderTargets[target - 1].framebuffer))
+	{
+		return;
+	}
+
+	RENDER_TARGET_ENTRY& entry = m_renderTargets[target - 1];
+	glDeleteFramebuffers(1, &entry.framebuffer);
+	glDeleteRenderbuffers(1, &entry.depthBuffer);
+	glDeleteTextures(1, &entry.colorTexture);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)entry.width * entry.height * 8);
+	entry.framebuffer = 0;
+	entry.colorTexture = 0;
+	entry.depthBuffer = 0;
+}
+
+/***********************************************************
+ *  ReadRenderTarget()
+ *
+ *  This method is used for reading the color of a target
+ *  back.  GL returns the bottom row first, so the rows are
+ *  flipped to match the interface.
+ ***********************************************************/
+bool GLRenderDevice::ReadRenderTarget(RENDER_TARGET_HANDLE target, std::vector<unsigned char>& pixels)
+{
+	GLuint framebuffer = 0;
+	int width = 0;
+	int height = 0;
+	if (0 == target)
+	{
+		GLint viewport[4] = { 0, 0, 0, 0 };
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		width = viewport[2];
+		height = viewport[3];
+	}
+	else if ((target <= m_renderTargets.size()) && (0 != m_renderTargets[target - 1].framebuffer))
+	{
+		framebuffer = m_renderTargets[target - 1].framebuffer;
+		width = m_renderTargets[target - 1].width;
+		height = m_renderTargets[target - 1].height;
+	}
+	else
+	{
+		return(false);
+	}
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+
+	std::vector<unsigned char> flipped((size_t)width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, flipped.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+
+	size_t rowBytes = (size_t)width * 4;
+	pixels.resize(flipped.size());
+	for (int row = 0; row < height; ++row)
+	{
+		memcpy(&pixels[row * rowBytes], &flipped[(height - 1 - row) * rowBytes], rowBytes);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  CreateCommandBuffer()
+ *
+ *  This method is used for creating a command buffer that
+ *  packs its uniforms at the alignment of this device.
+ ***********************************************************/
+RenderCommandBuffer* GLRenderDevice::CreateCommandBuffer()
+{
+	return(new GLRenderCommandBuffer(m_uniformAlignment));
+}
+
+/***********************************************************
+ *  DestroyCommandBuffer()
+ *
+ *  This method is used for deleting a command buffer.
+ ***********************************************************/
+void GLRenderDevice::DestroyCommandBuffer(RenderCommandBuffer* pCommandBuffer)
+{
+	delete pCommandBuffer;
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for running a recorded command buffer
+ *  on the GL thread.
+ ***********************************************************/
+void GLRenderDevice::Submit(RenderCommandBuffer* pCommandBuffer)
+{
+	if (NULL != pCommandBuffer)
+	{
+		Execute(*static_cast<GLRenderCommandBuffer*>(pCommandBuffer));
+	}
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used for waiting for the GL commands to
+ *  finish.
+ ***********************************************************/
+void GLRenderDevice::WaitIdle()
+{
+	glFinish();
+}
+
+/***********************************************************
+ *  ApplyPipeline()
+ *
+ *  This method is used for setting the program, the vertex
+ *  array and the fixed function state of a pipeline.
+ ***********************************************************/
+void GLRenderDevice::ApplyPipeline(const PIPELINE_ENTRY& pipeline)
+{
+	glUseProgram(pipeline.program);
+	glBindVertexArray(pipeline.vertexArray);
+
+	if (pipeline.bDepthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	else
+	{
+		glDisable(GL_DEPTH_TEST);
+	}
+	glDepthMask(pipeline.bDepthWrite ? GL_TRUE : GL_FALSE);
+
+	if (pipeline.bBlend)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else
+	{
+		glDisable(GL_BLEND);
+	}
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for uploading the packed uniforms and
+ *  replaying the recorded commands as GL calls.  The buffer
+ *  is orphaned before the upload so the driver does not wait
+ *  for the draws of the previous submit.
+ ***********************************************************/
+void GLRenderDevice::Execute(const GLRenderCommandBuffer& commandBuffer)
+{
+	const std::vector<unsigned char>& uniformData = commandBuffer.GetUniformData();
+	if (!uniformData.empty())
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_uniformBuffer);
+		if (uniformData.size() > m_uniformCapacity)
+		{
+			size_t capacity = std::max(uniformData.size(), m_uniformCapacity * 2);
+			TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)capacity - (long long)m_uniformCapacity);
+			m_uniformCapacity = capacity;
+		}
+		glBufferData(GL_UNIFORM_BUFFER, m_uniformCapacity, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, uniformData.size(), uniformData.data());
+	}
+
+	GLint previousFramebuffer = 0;
+	GLint previousViewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+	const PIPELINE_ENTRY* pPipeline = NULL;
+	size_t indexOffset = 0;
+
+	const std::vector<GLRenderCommandBuffer::GL_COMMAND>& commands = commandBuffer.GetCommands();
+	for (size_t i = 0; i < commands.size(); ++i)
+	{
+		const GLRenderCommandBuffer::GL_COMMAND& command = commands[i];
+		switch (command.type)
+		{
+		case GLRenderCommandBuffer::GL_COMMAND_BEGIN_PASS:
+		{
+			if (0 == command.handle)
+			{
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			}
+			else
+			{
+				const RENDER_TARGET_ENTRY& target = m_renderTargets[command.handle - 1];
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
+				glViewport(0, 0, target.width, target.height);
+			}
+			const glm::vec4& clearColor = commandBuffer.GetClearColor(command.counts[0]);
+			// the clear honours the depth mask left by the last pipeline
+			glDepthMask(GL_TRUE);
+			glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			break;
+		}
+		case GLRenderCommandBuffer::GL_COMMAND_END_PASS:
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+			glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_BIND_PIPELINE:
+			pPipeline = &m_pipelines[command.handle - 1];
+			ApplyPipeline(*pPipeline);
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_BIND_VERTEX_BUFFER:
+			if ((NULL != pPipeline) && (command.counts[0] < pPipeline->strides.size()))
+			{
+				glBindVertexBuffer(command.counts[0], m_buffers[command.handle - 1].buffer,
+					(GLintptr)command.offset, pPipeline->strides[command.counts[0]]);
+			}
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_BIND_INDEX_BUFFER:
+			// the element array binding is vertex array state
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffers[command.handle - 1].buffer);
+			indexOffset = command.offset;
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_BIND_TEXTURE:
+			glActiveTexture(GL_TEXTURE0 + RHI_TEXTURE_BINDING);
+			glBindTexture(GL_TEXTURE_2D, m_textures[command.handle - 1].texture);
+			glActiveTexture(GL_TEXTURE0);
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_SET_UNIFORMS:
+			glBindBufferRange(GL_UNIFORM_BUFFER, RHI_UNIFORM_BINDING, m_uniformBuffer,
+				(GLintptr)command.offset, (GLsizeiptr)command.counts[0]);
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_DRAW:
+			if (NULL != pPipeline)
+			{
+				glDrawArraysInstancedBaseInstance(pPipeline->topology,
+					(GLint)command.counts[2], (GLsizei)command.counts[0],
+					(GLsizei)command.counts[1], command.counts[3]);
+			}
+			break;
+		case GLRenderCommandBuffer::GL_COMMAND_DRAW_INDEXED:
+			if (NULL != pPipeline)
+			{
+				glDrawElementsInstancedBaseVertexBaseInstance(pPipeline->topology,
+					(GLsizei)command.counts[0], GL_UNSIGNED_INT,
+					(const void*)(indexOffset + command.counts[2] * sizeof(GLuint)),
+					(GLsizei)command.counts[1], command.vertexOffset, command.counts[3]);
+			}
+			break;
+		}
+	}
+
+	glBindVertexArray(0);
+}
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.h
+// ============
+// OpenGL implementation of the render hardware interface
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  GLRenderCommandBuffer
+ *
+ *  This class records the commands as plain data, the same
+ *  way as CommandList, so it can be recorded on any thread.
+ *  The uniforms of the whole buffer are packed into one block
+ *  at their GL offset alignment and uploaded with a single
+ *  call when the device executes the commands.
+ ***********************************************************/
+class GLRenderCommandBuffer : public RenderCommandBuffer
+{
+public:
+	// kinds of recorded command
+	enum GL_COMMAND_TYPE
+	{
+		GL_COMMAND_BEGIN_PASS,
+		GL_COMMAND_END_PASS,
+		GL_COMMAND_BIND_PIPELINE,
+		GL_COMMAND_BIND_VERTEX_BUFFER,
+		GL_COMMAND_BIND_INDEX_BUFFER,
+		GL_COMMAND_BIND_TEXTURE,
+		GL_COMMAND_SET_UNIFORMS,
+		GL_COMMAND_DRAW,
+		GL_COMMAND_DRAW_INDEXED
+	};
+
+	// one recorded command - the meaning of the counts follows
+	// the arguments of the recording method
+	struct GL_COMMAND
+	{
+		GL_COMMAND_TYPE type;
+		unsigned int handle;
+		unsigned int counts[4];
+		int vertexOffset;
+		size_t offset;
+	};
+
+	// constructor
+	GLRenderCommandBuffer(size_t uniformAlignment);
+
+	void Begin();
+	void End();
+	void BeginRenderPass(RENDER_TARGET_HANDLE target, const glm::vec4& clearColor);
+	void EndRenderPass();
+	void BindPipeline(PIPELINE_HANDLE pipeline);
+	void BindVertexBuffer(unsigned int binding, BUFFER_HANDLE buffer, size_t offset);
+	void BindIndexBuffer(BUFFER_HANDLE buffer, size_t offset);
+	void BindTexture(TEXTURE_HANDLE texture);
+	void SetUniforms(const void* data, size_t size);
+	void Draw(
+		unsigned int vertexCount,
+		unsigned int instanceCount,
+		unsigned int firstVertex,
+		unsigned int firstInstance);
+	void DrawIndexed(
+		unsigned int indexCount,
+		unsigned int instanceCount,
+		unsigned int firstIndex,
+		int vertexOffset,
+		unsigned int firstInstance);
+
+	// read the recorded commands back
+	const std::vector<GL_COMMAND>& GetCommands() const { return m_commands; }
+	const std::vector<unsigned char>& GetUniformData() const { return m_uniformData; }
+	const glm::vec4& GetClearColor(unsigned int index) const { return m_clearColors[index]; }
+
+private:
+	std::vector<GL_COMMAND> m_commands;
+	std::vector<unsigned char> m_uniformData;
+	std::vector<glm::vec4> m_clearColors;
+	size_t m_uniformAlignment;
+
+	GL_COMMAND& AddCommand(GL_COMMAND_TYPE type, unsigned int handle);
+};
+
+/***********************************************************
+ *  GLRenderDevice
+ *
+ *  This class implements the device with the GL calls the
+ *  scene renderers use.  The vertex layout of a pipeline is
+ *  set up once with separate attribute formats, so binding a
+ *  vertex buffer is a single call like in Vulkan.  Render
+ *  target 0 is the default framebuffer of the window.
+ ***********************************************************/
+class GLRenderDevice : public RenderDevice
+{
+public:
+	// constructor
+	GLRenderDevice();
+	// destructor
+	~GLRenderDevice();
+
+	bool Initialize();
+	RENDER_BACKEND GetBackend() const { return RENDER_BACKEND_OPENGL; }
+	const char* GetDeviceName() const { return m_deviceName.c_str(); }
+
+	BUFFER_HANDLE CreateBuffer(BUFFER_USAGE usage, size_t size, const void* data);
+	void UpdateBuffer(BUFFER_HANDLE buffer, size_t offset, size_t size, const void* data);
+	void DestroyBuffer(BUFFER_HANDLE buffer);
+
+	TEXTURE_HANDLE CreateTexture(int width, int height, TEXTURE_FORMAT format, const void* pixels);
+	void DestroyTexture(TEXTURE_HANDLE texture);
+
+	PIPELINE_HANDLE CreatePipeline(const PIPELINE_DESC& desc);
+	void DestroyPipeline(PIPELINE_HANDLE pipeline);
+
+	RENDER_TARGET_HANDLE CreateRenderTarget(int width, int height);
+	void DestroyRenderTarget(RENDER_TARGET_HANDLE target);
+	bool ReadRenderTarget(RENDER_TARGET_HANDLE target, std::vector<unsigned char>& pixels);
+
+	RenderCommandBuffer* CreateCommandBuffer();
+	void DestroyCommandBuffer(RenderCommandBuffer* pCommandBuffer);
+	void Submit(RenderCommandBuffer* pCommandBuffer);
+	void WaitIdle();
+
+private:
+	struct BUFFER_ENTRY
+	{
+		GLuint buffer;
+		size_t size;
+	};
+
+	struct TEXTURE_ENTRY
+	{
+		GLuint texture;
+		int bytes;
+	};
+
+	struct PIPELINE_ENTRY
+	{
+		GLuint program;
+		GLuint vertexArray;
+		GLenum topology;
+		// stride of each vertex buffer binding
+		std::vector<GLsizei> strides;
+		bool bDepthTest;
+		bool bDepthWrite;
+		bool bBlend;
+	};
+
+	struct RENDER_TARGET_ENTRY
+	{
+		GLuint framebuffer;
+		GLuint colorTexture;
+		GLuint depthBuffer;
+		int width;
+		int height;
+	};
+
+	std::string m_deviceName;
+	// destroyed resources leave a zeroed entry so handles stay unique
+	std::vector<BUFFER_ENTRY> m_buffers;
+	std::vector<TEXTURE_ENTRY> m_textures;
+	std::vector<PIPELINE_ENTRY> m_pipelines;
+	std::vector<RENDER_TARGET_ENTRY> m_renderTargets;
+	// uniform block storage for the executed command buffers
+	GLuint m_uniformBuffer;
+	size_t m_uniformCapacity;
+	size_t m_uniformAlignment;
+
+	void Execute(const GLRenderCommandBuffer& commandBuffer);
+	void ApplyPipeline(const PIPELINE_ENTRY& pipeline);
+};
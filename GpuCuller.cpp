@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// cull objects and compact their draws on the GPU, so one indirect
+// multi-draw submits whatever survives
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCuller.h"
+#include "FrustumCulling.h"
+#include "GpuMemoryTracker.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CullComputeShader = "./Source/shaders/gpuCullComputeShader.glsl";
+	const char* g_PyramidComputeShader = "./Source/shaders/hiZBuildComputeShader.glsl";
+
+	// work group sizes of the compute shaders
+	const int CULL_GROUP_SIZE = 64;
+	const int PYRAMID_GROUP_SIZE = 8;
+
+	// shader storage bindings of the culling pass
+	const GLuint MESH_BINDING = 1;
+	const GLuint COMMAND_BINDING = 2;
+	const GLuint COUNT_BINDING = 3;
+
+	// layout of one glMultiDrawElementsIndirect command
+	struct DRAW_ELEMENTS_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+}
+
+/***********************************************************
+ *  GpuCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCuller::GpuCuller()
+{
+	m_objectBuffer = 0;
+	m_meshBuffer = 0;
+	m_commandBuffer = 0;
+	m_countBuffer = 0;
+	m_objectCount = 0;
+	m_objectCapacity = 0;
+	m_meshCount = 0;
+	m_depthPyramid = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_pyramidLevels = 0;
+	m_bPyramidValid = false;
+	m_pyramidViewProjection = glm::mat4(1.0f);
+	m_bufferBytes = 0;
+	m_textureBytes = 0;
+}
+
+/***********************************************************
+ *  ~GpuCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCuller::~GpuCuller()
+{
+	// the programs stay in the resource cache
+	m_cullProgram.Release();
+	m_pyramidProgram.Release();
+
+	GLuint buffers[4] = { m_objectBuffer, m_meshBuffer, m_commandBuffer, m_countBuffer };
+	glDeleteBuffers(4, buffers);
+	m_objectBuffer = m_meshBuffer = m_commandBuffer = m_countBuffer = 0;
+	TrackGpuMemory(GPU_MEMORY_BUFFER, -m_bufferBytes);
+	m_bufferBytes = 0;
+
+	if (0 != m_depthPyramid)
+	{
+		glDeleteTextures(1, &m_depthPyramid);
+		m_depthPyramid = 0;
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -m_textureBytes);
+	m_textureBytes = 0;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the culling and depth
+ *  pyramid programs and creating the buffers.
+ ***********************************************************/
+bool GpuCuller::Initialize(ResourceCache* pResourceCache)
+{
+	m_cullProgram = pResourceCache->AcquireComputeProgram(g_CullComputeShader);
+	m_pyramidProgram = pResourceCache->AcquireComputeProgram(g_PyramidComputeShader);
+	if ((!m_cullProgram.IsValid()) || (!m_pyramidProgram.IsValid()))
+	{
+		std::cout << "Failed to load the GPU culling programs" << std::endl;
+		return(false);
+	}
+
+	glGenBuffers(1, &m_objectBuffer);
+	glGenBuffers(1, &m_meshBuffer);
+	glGenBuffers(1, &m_commandBuffer);
+	glGenBuffers(1, &m_countBuffer);
+
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	m_bufferBytes += sizeof(GLuint);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, sizeof(GLuint));
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetMeshes()
+ *
+ *  This method is used for uploading the index ranges of the
+ *  meshes the objects are drawn with.
+ ***********************************************************/
+void GpuCuller::SetMeshes(const std::vector<CULL_MESH>& meshes)
+{
+	long long oldBytes = (long long)m_meshCount * sizeof(CULL_MESH);
+	long long newBytes = (long long)meshes.size() * sizeof(CULL_MESH);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_meshBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, newBytes, meshes.empty() ? NULL : &meshes[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_meshCount = (int)meshes.size();
+	m_bufferBytes += newBytes - oldBytes;
+	TrackGpuMemory(GPU_MEMORY_BUFFER, newBytes - oldBytes);
+}
+
+/***********************************************************
+ *  SetObjects()
+ *
+ *  This method is used for uploading all the objects,
+ *  replacing the ones that were there.
+ ***********************************************************/
+void GpuCuller::SetObjects(const std::vector<CULL_OBJECT>& objects)
+{
+	ReserveObjects((int)objects.size());
+	m_objectCount = (int)objects.size();
+	if (m_objectCount > 0)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_objectCount * sizeof(CULL_OBJECT), &objects[0]);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+}
+
+/***********************************************************
+ *  UpdateObjects()
+ *
+ *  This method is used for rewriting the passed in range of
+ *  objects, after they moved.
+ ***********************************************************/
+void GpuCuller::UpdateObjects(int first, const CULL_OBJECT* pObjects, int count)
+{
+	if ((first < 0) || (count <= 0) || (first + count > m_objectCount))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(CULL_OBJECT), count * sizeof(CULL_OBJECT), pObjects);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BuildDepthPyramid()
+ *
+ *  This method is used for building the farthest depth
+ *  pyramid from the passed in depth texture.  Level 0 is a
+ *  copy of the depth and every level above it keeps the
+ *  farthest depth of the texels it covers, so a box nearer
+ *  than the farthest depth over its screen rectangle may be
+ *  visible and one behind it is hidden.  The view projection
+ *  the depth was rendered with is kept, so the boxes are
+ *  projected with it in the occlusion test.
+ ***********************************************************/
+void GpuCuller::BuildDepthPyramid(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection)
+{
+	if ((0 == depthTexture) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	if ((width != m_pyramidWidth) || (height != m_pyramidHeight))
+	{
+		CreateDepthPyramid(width, height);
+	}
+
+	GLuint programID = m_pyramidProgram.GetID();
+	glUseProgram(programID);
+	glUniform1i(glGetUniformLocation(programID, "sourceDepth"), 0);
+
+	GLint activeTexture = 0;
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < m_pyramidLevels; level++)
+	{
+		if (level == 0)
+		{
+			glBindTexture(GL_TEXTURE_2D, depthTexture);
+			glUniform1i(glGetUniformLocation(programID, "bCopy"), 1);
+		}
+		else
+		{
+			// the level below is read while this one is written
+			glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+			glUniform1i(glGetUniformLocation(programID, "bCopy"), 0);
+			glUniform1i(glGetUniformLocation(programID, "sourceLevel"), level - 1);
+			levelWidth = std::max(1, levelWidth / 2);
+			levelHeight = std::max(1, levelHeight / 2);
+		}
+
+		glBindImageTexture(0, m_depthPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute(
+			(levelWidth + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+			(levelHeight + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+			1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+	glActiveTexture(activeTexture);
+
+	m_pyramidViewProjection = viewProjection;
+	m_bPyramidValid = true;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the culling pass.  The
+ *  draw count is reset and one invocation per object appends
+ *  the draw command of a visible object.  The order of the
+ *  commands changes from frame to frame, which only matters
+ *  to blended draws, so the pass is meant for opaque ones.
+ ***********************************************************/
+void GpuCuller::Cull(const glm::mat4& viewProjection, bool bOcclusion)
+{
+	if (0 == m_objectCount)
+	{
+		return;
+	}
+
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	FRUSTUM frustum = ExtractFrustum(viewProjection);
+	bool bUsePyramid = bOcclusion && m_bPyramidValid;
+
+	GLuint programID = m_cullProgram.GetID();
+	glUseProgram(programID);
+	glUniform1ui(glGetUniformLocation(programID, "objectCount"), (GLuint)m_objectCount);
+	glUniform4fv(glGetUniformLocation(programID, "frustumPlanes"), 6, glm::value_ptr(frustum.planes[0]));
+	glUniform1i(glGetUniformLocation(programID, "bOcclusion"), bUsePyramid ? 1 : 0);
+
+	GLint activeTexture = 0;
+	GLint boundTexture = 0;
+	if (bUsePyramid)
+	{
+		glUniformMatrix4fv(glGetUniformLocation(programID, "pyramidViewProjection"), 1, GL_FALSE, glm::value_ptr(m_pyramidViewProjection));
+		glUniform2f(glGetUniformLocation(programID, "pyramidSize"), (float)m_pyramidWidth, (float)m_pyramidHeight);
+		glUniform1i(glGetUniformLocation(programID, "pyramidLevels"), m_pyramidLevels);
+		glUniform1i(glGetUniformLocation(programID, "depthPyramid"), 0);
+
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+		glActiveTexture(GL_TEXTURE0);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+		glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_BINDING, m_meshBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNT_BINDING, m_countBuffer);
+
+	glDispatchCompute((m_objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+	// the commands and the count are read by the draw next
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	if (bUsePyramid)
+	{
+		glBindTexture(GL_TEXTURE_2D, boundTexture);
+		glActiveTexture(activeTexture);
+	}
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the commands appended by
+ *  the last Cull().  The count is read by the GPU, so up to
+ *  one command per object is drawn without a read back.
+ ***********************************************************/
+void GpuCuller::Draw(GLenum mode)
+{
+	if (0 == m_objectCount)
+	{
+		return;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBindBuffer(GL_PARAMETER_BUFFER, m_countBuffer);
+
+	glMultiDrawElementsIndirectCount(mode, GL_UNSIGNED_INT, 0, 0, m_objectCount, 0);
+
+	glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  ReadDrawCount()
+ *
+ *  This method is used for reading back the number of draws
+ *  the last Cull() appended.
+ ***********************************************************/
+int GpuCuller::ReadDrawCount()
+{
+	GLuint count = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &count);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return((int)count);
+}
+
+/***********************************************************
+ *  ReserveObjects()
+ *
+ *  This method is used for growing the object and command
+ *  buffers to hold the passed in number of objects.
+ ***********************************************************/
+void GpuCuller::ReserveObjects(int count)
+{
+	if (count <= m_objectCapacity)
+	{
+		return;
+	}
+
+	long long oldBytes = (long long)m_objectCapacity * (sizeof(CULL_OBJECT) + sizeof(DRAW_ELEMENTS_COMMAND));
+	long long newBytes = (long long)count * (sizeof(CULL_OBJECT) + sizeof(DRAW_ELEMENTS_COMMAND));
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(CULL_OBJECT), NULL, GL_DYNAMIC_DRAW);
+	// the commands are only ever written by the culling pass
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(DRAW_ELEMENTS_COMMAND), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_objectCapacity = count;
+	m_bufferBytes += newBytes - oldBytes;
+	TrackGpuMemory(GPU_MEMORY_BUFFER, newBytes - oldBytes);
+}
+
+/***********************************************************
+ *  CreateDepthPyramid()
+ *
+ *  This method is used for creating the depth pyramid with a
+ *  full chain of levels for the passed in size.
+ ***********************************************************/
+void GpuCuller::CreateDepthPyramid(int width, int height)
+{
+	if (0 != m_depthPyramid)
+	{
+		glDeleteTextures(1, &m_depthPyramid);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -m_textureBytes);
+		m_textureBytes = 0;
+	}
+
+	m_pyramidWidth = width;
+	m_pyramidHeight = height;
+	m_pyramidLevels = (int)std::floor(std::log2((double)std::max(width, height))) + 1;
+
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+
+	glGenTextures(1, &m_depthPyramid);
+	glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+	glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, width, height);
+	// each sample reads a single texel of the chosen level
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < m_pyramidLevels; level++)
+	{
+		m_textureBytes += (long long)levelWidth * levelHeight * sizeof(float);
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, m_textureBytes);
+	m_bPyramidValid = false;
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// cull objects and compact their draws on the GPU, so one indirect
+// multi-draw submits whatever survives
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ResourceCache.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  CULL_OBJECT
+ *
+ *  One object of the GPU culling pass, laid out as the
+ *  std430 struct of the shaders.
+ ***********************************************************/
+struct CULL_OBJECT
+{
+	glm::mat4 model;
+	// object space bounding box, w unused
+	glm::vec4 boundsMin;
+	glm::vec4 boundsMax;
+	// index into the meshes, then padding
+	unsigned int mesh;
+	unsigned int padding[3];
+};
+
+/***********************************************************
+ *  CULL_MESH
+ *
+ *  The range of a mesh in the shared vertex and index
+ *  buffers, copied into each draw command.
+ ***********************************************************/
+struct CULL_MESH
+{
+	unsigned int indexCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int padding;
+};
+
+/***********************************************************
+ *  GpuCuller
+ *
+ *  This class keeps the bounds and transforms of all the
+ *  objects in shader storage buffers.  Every frame a compute
+ *  pass tests each object against the view frustum, and
+ *  optionally against a depth pyramid built from the depth
+ *  of the last frame, and atomically appends a draw command
+ *  for each one that survives.  The commands are drawn with
+ *  a single glMultiDrawElementsIndirectCount reading the
+ *  count from the GPU, so the CPU never touches the objects
+ *  and its cost per frame does not grow with their number.
+ ***********************************************************/
+class GpuCuller
+{
+public:
+	// constructor
+	GpuCuller();
+	// destructor
+	~GpuCuller();
+
+	// shader storage binding of the objects, read by the
+	// vertex shader of the draws through gl_BaseInstance
+	static const GLuint OBJECT_BINDING = 0;
+
+	// load the compute programs through the cache and create
+	// the command and count buffers
+	bool Initialize(ResourceCache* pResourceCache);
+
+	// set the index ranges of the meshes the objects refer to
+	void SetMeshes(const std::vector<CULL_MESH>& meshes);
+	// replace all the objects
+	void SetObjects(const std::vector<CULL_OBJECT>& objects);
+	// rewrite a range of objects that moved
+	void UpdateObjects(int first, const CULL_OBJECT* pObjects, int count);
+
+	// build the depth pyramid from a depth texture rendered
+	// with the passed in view projection, for the occlusion
+	// test of the following frames
+	void BuildDepthPyramid(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection);
+
+	// append the draws of the visible objects, testing them
+	// against the depth pyramid too when asked and one exists
+	void Cull(const glm::mat4& viewProjection, bool bOcclusion);
+	// draw the appended commands with the vertex array, index
+	// buffer and program that are bound
+	void Draw(GLenum mode);
+
+	// number of draws appended by the last Cull(), which waits
+	// for the GPU so it is for tools and statistics
+	int ReadDrawCount();
+	int GetObjectCount() const { return m_objectCount; }
+
+private:
+	// references to the programs in the resource cache
+	ResourceHandle m_cullProgram;
+	ResourceHandle m_pyramidProgram;
+	GLuint m_objectBuffer;
+	GLuint m_meshBuffer;
+	GLuint m_commandBuffer;
+	GLuint m_countBuffer;
+	int m_objectCount;
+	int m_objectCapacity;
+	int m_meshCount;
+	// farthest depth pyramid and the view it was rendered from
+	GLuint m_depthPyramid;
+	int m_pyramidWidth;
+	int m_pyramidHeight;
+	int m_pyramidLevels;
+	bool m_bPyramidValid;
+	glm::mat4 m_pyramidViewProjection;
+	long long m_bufferBytes;
+	long long m_textureBytes;
+
+	void ReserveObjects(int count);
+	void CreateDepthPyramid(int width, int height);
+};
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemorytracker.cpp
+// ============
+// running totals of the texture and buffer memory allocated on the GPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuMemoryTracker.h"
+
+#include <atomic>
+
+// declaration of global variables
+namespace
+{
+	// the totals are read by the HUD while loading code may
+	// still be allocating, so they are kept atomic
+	std::atomic<long long> g_gpuMemoryBytes[GPU_MEMORY_KIND_COUNT];
+}
+
+/***********************************************************
+ *  TrackGpuMemory()
+ *
+ *  This function is used for adding the size of a texture or
+ *  buffer allocation to its running total.
+ ***********************************************************/
+void TrackGpuMemory(GPU_MEMORY_KIND kind, long long bytes)
+{
+	if ((kind >= 0) && (kind < GPU_MEMORY_KIND_COUNT))
+	{
+		g_gpuMemoryBytes[kind].fetch_add(bytes, std::memory_order_relaxed);
+	}
+}
+
+/***********************************************************
+ *  GetGpuMemory()
+ *
+ *  This function is used for getting the running total of
+ *  the passed in kind of allocation.
+ ***********************************************************/
+long long GetGpuMemory(GPU_MEMORY_KIND kind)
+{
+	if ((kind >= 0) && (kind < GPU_MEMORY_KIND_COUNT))
+	{
+		return(g_gpuMemoryBytes[kind].load(std::memory_order_relaxed));
+	}
+
+	return(0);
+}
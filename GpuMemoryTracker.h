@@ -0,0 +1,23 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemorytracker.h
+// ============
+// running totals of the texture and buffer memory allocated on the GPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// kinds of GPU allocation that are tracked
+enum GPU_MEMORY_KIND
+{
+	GPU_MEMORY_TEXTURE,
+	GPU_MEMORY_BUFFER,
+	GPU_MEMORY_KIND_COUNT
+};
+
+// add the size of an allocation, or subtract it with a
+// negative size when the allocation is freed
+void TrackGpuMemory(GPU_MEMORY_KIND kind, long long bytes);
+
+// current total of the passed in kind of allocation in bytes
+long long GetGpuMemory(GPU_MEMORY_KIND kind);
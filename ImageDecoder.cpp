@@ -0,0 +1,502 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagedecoder.cpp
+// ============
+// decode JPEG, PNG and WebP files with the fastest library compiled in for
+// each format - stb_image always, libjpeg-turbo when IMAGE_DECODER_LIBJPEG
+// is defined, libpng when IMAGE_DECODER_LIBPNG is defined and libwebp when
+// IMAGE_DECODER_LIBWEBP is defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageDecoder.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#ifdef IMAGE_DECODER_LIBJPEG
+#include <csetjmp>
+#include <cstdio>           // jpeglib.h needs FILE
+#include <jpeglib.h>
+#endif
+#ifdef IMAGE_DECODER_LIBPNG
+#include <png.h>
+#endif
+#ifdef IMAGE_DECODER_LIBWEBP
+#include <webp/decode.h>
+#endif
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__)
+#include <malloc.h>         // malloc_trim
+#endif
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  StbImageDecoder
+	 *
+	 *  This class decodes with stb_image, which reads every
+	 *  format but WebP and is always compiled in.
+	 ***********************************************************/
+	class StbImageDecoder : public ImageDecoder
+	{
+	public:
+		const char* GetName() const { return "stb_image"; }
+		bool SupportsFormat(IMAGE_FORMAT format) const { return format != IMAGE_FORMAT_WEBP; }
+
+		bool Decode(const unsigned char* data, size_t size, DECODED_IMAGE& image) const
+		{
+			if (size > INT_MAX)
+			{
+				return(false);
+			}
+			unsigned char* pixels = stbi_load_from_memory(data, (int)size, &image.width, &image.height, &image.channels, 0);
+			if (NULL == pixels)
+			{
+				return(false);
+			}
+			image.pixels.assign(pixels, pixels + (size_t)image.width * image.height * image.channels);
+			stbi_image_free(pixels);
+			return(true);
+		}
+	};
+
+#ifdef IMAGE_DECODER_LIBJPEG
+	// libjpeg reports errors by calling back, which jumps out of
+	// the decode
+	struct JPEG_ERROR
+	{
+		struct jpeg_error_mgr manager;
+		jmp_buf jump;
+	};
+
+	/***********************************************************
+	 *  JpegErrorExit()
+	 *
+	 *  This function is used for leaving a decode that libjpeg
+	 *  cannot go on with.
+	 ***********************************************************/
+	void JpegErrorExit(j_common_ptr pInfo)
+	{
+		longjmp(((JPEG_ERROR*)pInfo->err)->jump, 1);
+	}
+
+	/***********************************************************
+	 *  JpegOutputMessage()
+	 *
+	 *  This function is used for keeping the warnings of libjpeg
+	 *  off the console, a failed decode is reported by the
+	 *  caller.
+	 ***********************************************************/
+	void JpegOutputMessage(j_common_ptr pInfo)
+	{
+	}
+
+	/***********************************************************
+	 *  LibJpegDecoder
+	 *
+	 *  This class decodes JPEG with libjpeg-turbo, whose SIMD
+	 *  inverse DCT and color conversion are several times the
+	 *  speed of stb_image on large photos.
+	 ***********************************************************/
+	class LibJpegDecoder : public ImageDecoder
+	{
+	public:
+		const char* GetName() const { return "libjpeg-turbo"; }
+		bool SupportsFormat(IMAGE_FORMAT format) const { return format == IMAGE_FORMAT_JPEG; }
+
+		bool Decode(const unsigned char* data, size_t size, DECODED_IMAGE& image) const
+		{
+			// nothing with a destructor may live in this scope, as
+			// an error jumps back to the setjmp()
+			struct jpeg_decompress_struct info;
+			JPEG_ERROR error;
+			info.err = jpeg_std_error(&error.manager);
+			error.manager.error_exit = JpegErrorExit;
+			error.manager.output_message = JpegOutputMessage;
+			if (setjmp(error.jump))
+			{
+				jpeg_destroy_decompress(&info);
+				return(false);
+			}
+
+			jpeg_create_decompress(&info);
+			jpeg_mem_src(&info, (unsigned char*)data, (unsigned long)size);
+			jpeg_read_header(&info, TRUE);
+			// grey and YCbCr files both come out as RGB
+			info.out_color_space = JCS_RGB;
+			jpeg_start_decompress(&info);
+
+			image.width = (int)info.output_width;
+			image.height = (int)info.output_height;
+			image.channels = 3;
+			size_t rowBytes = (size_t)image.width * 3;
+			image.pixels.resize(rowBytes * image.height);
+			while (info.output_scanline < info.output_height)
+			{
+				JSAMPROW rows[16];
+				JDIMENSION rowCount = info.output_height - info.output_scanline;
+				if (rowCount > 16)
+				{
+					rowCount = 16;
+				}
+				for (JDIMENSION row = 0; row < rowCount; row++)
+				{
+					rows[row] = image.pixels.data() + (info.output_scanline + row) * rowBytes;
+				}
+				jpeg_read_scanlines(&info, rows, rowCount);
+			}
+
+			jpeg_finish_decompress(&info);
+			jpeg_destroy_decompress(&info);
+			return(true);
+		}
+	};
+#endif
+
+#ifdef IMAGE_DECODER_LIBPNG
+	/***********************************************************
+	 *  LibPngDecoder
+	 *
+	 *  This class decodes PNG with libpng, which inflates with
+	 *  zlib and filters the rows faster than stb_image.  Palette,
+	 *  grey and 16 bit files are converted to 8 bit RGB, or to
+	 *  RGBA when they have transparency.
+	 ***********************************************************/
+	class LibPngDecoder : public ImageDecoder
+	{
+	public:
+		const char* GetName() const { return "libpng"; }
+		bool SupportsFormat(IMAGE_FORMAT format) const { return format == IMAGE_FORMAT_PNG; }
+
+		bool Decode(const unsigned char* data, size_t size, DECODED_IMAGE& image) const
+		{
+			png_image png;
+			memset(&png, 0, sizeof(png));
+			png.version = PNG_IMAGE_VERSION;
+			if (!png_image_begin_read_from_memory(&png, data, size))
+			{
+				return(false);
+			}
+
+			bool bAlpha = (png.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+			png.format = bAlpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+			image.width = (int)png.width;
+			image.height = (int)png.height;
+			image.channels = bAlpha ? 4 : 3;
+			image.pixels.resize(PNG_IMAGE_SIZE(png));
+			if (!png_image_finish_read(&png, NULL, image.pixels.data(), 0, NULL))
+			{
+				png_image_free(&png);
+				return(false);
+			}
+			return(true);
+		}
+	};
+#endif
+
+#ifdef IMAGE_DECODER_LIBWEBP
+	/***********************************************************
+	 *  LibWebpDecoder
+	 *
+	 *  This class decodes still WebP images with libwebp, into
+	 *  RGBA when they have transparency and RGB otherwise.
+	 ***********************************************************/
+	class LibWebpDecoder : public ImageDecoder
+	{
+	public:
+		const char* GetName() const { return "libwebp"; }
+		bool SupportsFormat(IMAGE_FORMAT format) const { return format == IMAGE_FORMAT_WEBP; }
+
+		bool Decode(const unsigned char* data, size_t size, DECODED_IMAGE& image) const
+		{
+			WebPBitstreamFeatures features;
+			if (WebPGetFeatures(data, size, &features) != VP8_STATUS_OK)
+			{
+				return(false);
+			}
+
+			image.width = features.width;
+			image.height = features.height;
+			image.channels = features.has_alpha ? 4 : 3;
+			int stride = image.width * image.channels;
+			image.pixels.resize((size_t)stride * image.height);
+			uint8_t* pixels = features.has_alpha ?
+				WebPDecodeRGBAInto(data, size, image.pixels.data(), image.pixels.size(), stride) :
+				WebPDecodeRGBInto(data, size, image.pixels.data(), image.pixels.size(), stride);
+			return(NULL != pixels);
+		}
+	};
+#endif
+
+	// the decoders, tried in this order for each format
+#ifdef IMAGE_DECODER_LIBJPEG
+	const LibJpegDecoder g_LibJpegDecoder;
+#endif
+#ifdef IMAGE_DECODER_LIBPNG
+	const LibPngDecoder g_LibPngDecoder;
+#endif
+#ifdef IMAGE_DECODER_LIBWEBP
+	const LibWebpDecoder g_LibWebpDecoder;
+#endif
+	const StbImageDecoder g_StbImageDecoder;
+
+	/***********************************************************
+	 *  ReadPeakMemory()
+	 *
+	 *  This function is used for reading the peak resident
+	 *  memory of the process since the last reset in bytes, or
+	 *  -1 where it cannot be measured.
+	 ***********************************************************/
+	long long ReadPeakMemory()
+	{
+#if defined(__linux__)
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.compare(0, 6, "VmHWM:") == 0)
+			{
+				return(atoll(line.c_str() + 6) * 1024);
+			}
+		}
+#endif
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  ResetPeakMemory()
+	 *
+	 *  This function is used for starting a new peak of the
+	 *  resident memory of the process, returning it in bytes,
+	 *  or -1 where it cannot be measured.  The memory freed by
+	 *  the last run is handed back first, so each run starts
+	 *  from the same point.
+	 ***********************************************************/
+	long long ResetPeakMemory()
+	{
+#if defined(__linux__)
+#if defined(__GLIBC__)
+		malloc_trim(0);
+#endif
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5";
+		clearRefs.close();
+		if (!clearRefs)
+		{
+			return(-1);
+		}
+		return(ReadPeakMemory());
+#else
+		return(-1);
+#endif
+	}
+}
+
+/***********************************************************
+ *  DetectImageFormat()
+ *
+ *  This function is used for telling the format of an image
+ *  file by its signature, whatever its name.
+ ***********************************************************/
+IMAGE_FORMAT DetectImageFormat(const unsigned char* data, size_t size)
+{
+	static const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	if ((size >= 3) && (data[0] == 0xFF) && (data[1] == 0xD8) && (data[2] == 0xFF))
+	{
+		return(IMAGE_FORMAT_JPEG);
+	}
+	if ((size >= sizeof(PNG_SIGNATURE)) && (memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0))
+	{
+		return(IMAGE_FORMAT_PNG);
+	}
+	if ((size >= 12) && (memcmp(data, "RIFF", 4) == 0) && (memcmp(data + 8, "WEBP", 4) == 0))
+	{
+		return(IMAGE_FORMAT_WEBP);
+	}
+	return(IMAGE_FORMAT_OTHER);
+}
+
+/***********************************************************
+ *  GetImageFormatName()
+ *
+ *  This function is used for getting the name of a format
+ *  for reporting.
+ ***********************************************************/
+const char* GetImageFormatName(IMAGE_FORMAT format)
+{
+	switch (format)
+	{
+	case IMAGE_FORMAT_JPEG:
+		return("JPEG");
+	case IMAGE_FORMAT_PNG:
+		return("PNG");
+	case IMAGE_FORMAT_WEBP:
+		return("WebP");
+	default:
+		return("other");
+	}
+}
+
+/***********************************************************
+ *  GetImageDecoders()
+ *
+ *  This function is used for getting every decoder compiled
+ *  in, the specialized libraries before stb_image.
+ ***********************************************************/
+void GetImageDecoders(std::vector<const ImageDecoder*>& decoders)
+{
+	decoders.clear();
+#ifdef IMAGE_DECODER_LIBJPEG
+	decoders.push_back(&g_LibJpegDecoder);
+#endif
+#ifdef IMAGE_DECODER_LIBPNG
+	decoders.push_back(&g_LibPngDecoder);
+#endif
+#ifdef IMAGE_DECODER_LIBWEBP
+	decoders.push_back(&g_LibWebpDecoder);
+#endif
+	decoders.push_back(&g_StbImageDecoder);
+}
+
+/***********************************************************
+ *  GetImageDecoder()
+ *
+ *  This function is used for choosing the decoder of a
+ *  format.  A library made for the format is used when it is
+ *  compiled in, and stb_image otherwise, which fails the
+ *  decode of the formats it cannot read.
+ ***********************************************************/
+const ImageDecoder* GetImageDecoder(IMAGE_FORMAT format)
+{
+	std::vector<const ImageDecoder*> decoders;
+	GetImageDecoders(decoders);
+	for (size_t i = 0; i < decoders.size(); i++)
+	{
+		if (decoders[i]->SupportsFormat(format))
+		{
+			return(decoders[i]);
+		}
+	}
+	return(&g_StbImageDecoder);
+}
+
+/***********************************************************
+ *  RunImageDecodeBenchmark()
+ *
+ *  This function is used for timing every decoder on the
+ *  files of each format it supports.  The throughput is over
+ *  the file bytes, and the peak is the resident memory the
+ *  decoder grew the process by while decoding them one at a
+ *  time.  The decoder that is chosen for a format is marked.
+ ***********************************************************/
+void RunImageDecodeBenchmark(const std::vector<std::string>& filenames, int iterations)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::vector<std::vector<unsigned char> > files;
+	std::vector<IMAGE_FORMAT> formats;
+	int formatCounts[IMAGE_FORMAT_COUNT] = { 0 };
+	size_t totalBytes = 0;
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		std::ifstream file(filenames[i].c_str(), std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open image:" << filenames[i] << std::endl;
+			continue;
+		}
+		std::vector<unsigned char> contents((size_t)file.tellg());
+		file.seekg(0);
+		file.read((char*)contents.data(), contents.size());
+		if (!file)
+		{
+			std::cout << "Could not read image:" << filenames[i] << std::endl;
+			continue;
+		}
+		IMAGE_FORMAT format = DetectImageFormat(contents.data(), contents.size());
+		formatCounts[format]++;
+		totalBytes += contents.size();
+		formats.push_back(format);
+		files.push_back(contents);
+	}
+
+	std::vector<const ImageDecoder*> decoders;
+	GetImageDecoders(decoders);
+	std::cout << "INFO: Decoding " << files.size() << " images, " << totalBytes / (1024.0 * 1024.0) << " MB, "
+		<< iterations << " times with " << decoders.size() << " decoders" << std::endl;
+
+	for (int format = 0; format < IMAGE_FORMAT_COUNT; format++)
+	{
+		if (formatCounts[format] == 0)
+		{
+			continue;
+		}
+		std::cout << GetImageFormatName((IMAGE_FORMAT)format) << ", " << formatCounts[format] << " images:" << std::endl;
+
+		for (size_t decoder = 0; decoder < decoders.size(); decoder++)
+		{
+			const ImageDecoder* pDecoder = decoders[decoder];
+			if (!pDecoder->SupportsFormat((IMAGE_FORMAT)format))
+			{
+				continue;
+			}
+
+			long long baseline = ResetPeakMemory();
+			size_t fileBytes = 0;
+			size_t pixelBytes = 0;
+			int failed = 0;
+			Clock::time_point startTime = Clock::now();
+			for (int iteration = 0; iteration < iterations; iteration++)
+			{
+				for (size_t i = 0; i < files.size(); i++)
+				{
+					if (formats[i] != format)
+					{
+						continue;
+					}
+					DECODED_IMAGE image;
+					if (pDecoder->Decode(files[i].data(), files[i].size(), image))
+					{
+						fileBytes += files[i].size();
+						pixelBytes += image.pixels.size();
+					}
+					else if (iteration == 0)
+					{
+						failed++;
+					}
+				}
+			}
+			double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+			long long peak = ReadPeakMemory();
+
+			std::cout << ((GetImageDecoder((IMAGE_FORMAT)format) == pDecoder) ? "* " : "  ") << pDecoder->GetName() << ": "
+				<< seconds * 1000.0 / iterations << " ms, "
+				<< fileBytes / seconds / (1024.0 * 1024.0) << " MB/s, "
+				<< pixelBytes / seconds / (1024.0 * 1024.0) << " MB/s decoded, peak memory:";
+			if ((baseline >= 0) && (peak >= 0))
+			{
+				std::cout << (peak - baseline) / (1024.0 * 1024.0) << " MB";
+			}
+			else
+			{
+				std::cout << "not measured";
+			}
+			if (failed > 0)
+			{
+				std::cout << ", failed:" << failed;
+			}
+			std::cout << std::endl;
+		}
+	}
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagedecoder.h
+// ============
+// decode JPEG, PNG and WebP files with the fastest library compiled in for
+// each format - stb_image always, libjpeg-turbo when IMAGE_DECODER_LIBJPEG
+// is defined, libpng when IMAGE_DECODER_LIBPNG is defined and libwebp when
+// IMAGE_DECODER_LIBWEBP is defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// formats told apart by the first bytes of a file
+enum IMAGE_FORMAT
+{
+	IMAGE_FORMAT_JPEG,
+	IMAGE_FORMAT_PNG,
+	IMAGE_FORMAT_WEBP,
+	// anything else, left to stb_image
+	IMAGE_FORMAT_OTHER,
+	IMAGE_FORMAT_COUNT
+};
+
+// an image decoded to 8 bits per channel, the rows from the
+// top down as they are stored in the file
+struct DECODED_IMAGE
+{
+	int width;
+	int height;
+	// 3 for RGB and 4 for RGBA, and what stb_image leaves
+	// grey images as
+	int channels;
+	std::vector<unsigned char> pixels;
+};
+
+/***********************************************************
+ *  ImageDecoder
+ *
+ *  This class decodes image files held in memory with one
+ *  library.  The decoders keep no state between images, so
+ *  one is used from any number of threads at once.
+ ***********************************************************/
+class ImageDecoder
+{
+public:
+	virtual ~ImageDecoder() {}
+
+	virtual const char* GetName() const = 0;
+	virtual bool SupportsFormat(IMAGE_FORMAT format) const = 0;
+	// decode the passed in file contents, RGB or RGBA as the
+	// file has them
+	virtual bool Decode(const unsigned char* data, size_t size, DECODED_IMAGE& image) const = 0;
+};
+
+// get the format of the passed in file contents
+IMAGE_FORMAT DetectImageFormat(const unsigned char* data, size_t size);
+const char* GetImageFormatName(IMAGE_FORMAT format);
+
+// every decoder compiled in, stb_image last
+void GetImageDecoders(std::vector<const ImageDecoder*>& decoders);
+// the decoder used for the passed in format, the first one
+// compiled in that supports it
+const ImageDecoder* GetImageDecoder(IMAGE_FORMAT format);
+
+// decode every passed in file with each decoder that supports
+// it and print the MB/s of file data and the peak memory
+void RunImageDecodeBenchmark(const std::vector<std::string>& filenames, int iterations);
@@ -0,0 +1,647 @@
+///////////////////////////////////////////////////////////////////////////////
+// imageprocessing.cpp
+// ============
+// prepare decoded texture images for upload - flip, RGBA expansion,
+// premultiplied alpha and sRGB correct mipmap generation
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageProcessing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define IMAGE_PROCESSING_SSE2
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define IMAGE_PROCESSING_SSSE3
+#endif
+
+// declaration of global variables
+namespace
+{
+	// below this many texels the work is not split over threads
+	const size_t PARALLEL_MINIMUM_TEXELS = 64 * 1024;
+	// entries in the linear to sRGB table
+	const int LINEAR_TABLE_SIZE = 4096;
+	// Kaiser window shape and half width in source texels
+	const float KAISER_ALPHA = 4.0f;
+	const int KAISER_TAPS = 6;
+
+	// a texel as four floats, which is one SSE register
+	struct FLOAT_TEXEL
+	{
+		float value[4];
+	};
+
+	/***********************************************************
+	 *  SRGB_TABLES
+	 *
+	 *  Conversion tables between 8 bit sRGB and linear values,
+	 *  filled once on first use.
+	 ***********************************************************/
+	struct SRGB_TABLES
+	{
+		float toLinear[256];
+		unsigned char fromLinear[LINEAR_TABLE_SIZE];
+
+		SRGB_TABLES()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				float c = i / 255.0f;
+				toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i < LINEAR_TABLE_SIZE; i++)
+			{
+				float c = i / (float)(LINEAR_TABLE_SIZE - 1);
+				float encoded = (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+				fromLinear[i] = (unsigned char)(std::min(std::max(encoded, 0.0f), 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	const SRGB_TABLES& GetSRGBTables()
+	{
+		static const SRGB_TABLES tables;
+		return(tables);
+	}
+
+	/***********************************************************
+	 *  ParallelRows()
+	 *
+	 *  This function is used for splitting a range of rows
+	 *  evenly over the hardware threads, running small images
+	 *  on the calling thread since starting workers costs more.
+	 ***********************************************************/
+	void ParallelRows(int rows, size_t texels, const std::function<void(int, int)>& work)
+	{
+		int threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		threadCount = std::min(threadCount, rows);
+		if ((threadCount <= 1) || (texels < PARALLEL_MINIMUM_TEXELS))
+		{
+			work(0, rows);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threadCount; i++)
+		{
+			workers.push_back(std::thread(work, rows * i / threadCount, rows * (i + 1) / threadCount));
+		}
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+
+	/***********************************************************
+	 *  SwapRows()
+	 *
+	 *  This function is used for exchanging two rows of bytes,
+	 *  32 or 16 bytes at a time when SIMD is available.
+	 ***********************************************************/
+	void SwapRows(unsigned char* top, unsigned char* bottom, size_t bytes)
+	{
+		size_t i = 0;
+#if defined(__AVX2__)
+		for (; i + 32 <= bytes; i += 32)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(top + i));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(bottom + i));
+			_mm256_storeu_si256((__m256i*)(top + i), b);
+			_mm256_storeu_si256((__m256i*)(bottom + i), a);
+		}
+#endif
+#ifdef IMAGE_PROCESSING_SSE2
+		for (; i + 16 <= bytes; i += 16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(top + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(bottom + i));
+			_mm_storeu_si128((__m128i*)(top + i), b);
+			_mm_storeu_si128((__m128i*)(bottom + i), a);
+		}
+#endif
+		for (; i < bytes; i++)
+		{
+			std::swap(top[i], bottom[i]);
+		}
+	}
+
+	/***********************************************************
+	 *  ExpandRange()
+	 *
+	 *  This function is used for widening a run of RGB texels.
+	 *  With SSSE3 one shuffle places four texels into RGBA
+	 *  order, reading 16 bytes of which 12 are used, so the
+	 *  last texels are always done one at a time.
+	 ***********************************************************/
+	void ExpandRange(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount)
+	{
+		size_t i = 0;
+#ifdef IMAGE_PROCESSING_SSSE3
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+		for (; i + 6 <= pixelCount; i += 4)
+		{
+			__m128i source = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+			__m128i expanded = _mm_or_si128(_mm_shuffle_epi8(source, shuffle), alpha);
+			_mm_storeu_si128((__m128i*)(rgba + i * 4), expanded);
+		}
+#endif
+		for (; i < pixelCount; i++)
+		{
+			rgba[i * 4 + 0] = rgb[i * 3 + 0];
+			rgba[i * 4 + 1] = rgb[i * 3 + 1];
+			rgba[i * 4 + 2] = rgb[i * 3 + 2];
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	// exact division by 255 with rounding for a product of two bytes
+	inline unsigned char MultiplyBytes(unsigned int a, unsigned int b)
+	{
+		unsigned int x = a * b + 128;
+		return((unsigned char)((x + (x >> 8)) >> 8));
+	}
+
+	/***********************************************************
+	 *  PremultiplyRange()
+	 *
+	 *  This function is used for premultiplying a run of RGBA
+	 *  texels.  With AVX2 eight texels are widened to 16 bits,
+	 *  multiplied by their broadcast alpha and narrowed again,
+	 *  with alpha itself blended back unchanged.
+	 ***********************************************************/
+	void PremultiplyRange(unsigned char* rgba, size_t pixelCount)
+	{
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i rounding = _mm256_set1_epi16(128);
+		const __m256i broadcastAlpha = _mm256_setr_epi8(
+			6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+			6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m256i source = _mm256_loadu_si256((const __m256i*)(rgba + i * 4));
+			__m256i halves[2] = { _mm256_unpacklo_epi8(source, zero), _mm256_unpackhi_epi8(source, zero) };
+			for (int h = 0; h < 2; h++)
+			{
+				__m256i alpha = _mm256_shuffle_epi8(halves[h], broadcastAlpha);
+				__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(halves[h], alpha), rounding);
+				product = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+				halves[h] = _mm256_blend_epi16(product, halves[h], 0x88);
+			}
+			_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_packus_epi16(halves[0], halves[1]));
+		}
+#endif
+		for (; i < pixelCount; i++)
+		{
+			unsigned char* texel = rgba + i * 4;
+			texel[0] = MultiplyBytes(texel[0], texel[3]);
+			texel[1] = MultiplyBytes(texel[1], texel[3]);
+			texel[2] = MultiplyBytes(texel[2], texel[3]);
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeLevel()
+	 *
+	 *  This function is used for converting an RGBA8 level to
+	 *  float texels, with the colors made linear when sRGB.
+	 ***********************************************************/
+	void DecodeLevel(const IMAGE_LEVEL& level, bool bSRGB, std::vector<FLOAT_TEXEL>& texels)
+	{
+		const SRGB_TABLES& tables = GetSRGBTables();
+		size_t count = (size_t)level.width * level.height;
+		texels.resize(count);
+
+		ParallelRows(level.height, count, [&](int firstRow, int lastRow)
+		{
+			for (size_t i = (size_t)firstRow * level.width; i < (size_t)lastRow * level.width; i++)
+			{
+				const unsigned char* source = &level.pixels[i * 4];
+				for (int c = 0; c < 3; c++)
+				{
+					texels[i].value[c] = bSRGB ? tables.toLinear[source[c]] : source[c] / 255.0f;
+				}
+				texels[i].value[3] = source[3] / 255.0f;
+			}
+		});
+	}
+
+	/***********************************************************
+	 *  EncodeLevel()
+	 *
+	 *  This function is used for converting float texels back
+	 *  to an RGBA8 level, re-encoding the colors when sRGB.
+	 ***********************************************************/
+	void EncodeLevel(const std::vector<FLOAT_TEXEL>& texels, bool bSRGB, IMAGE_LEVEL& level)
+	{
+		const SRGB_TABLES& tables = GetSRGBTables();
+		size_t count = (size_t)level.width * level.height;
+		level.pixels.resize(count * 4);
+
+		ParallelRows(level.height, count, [&](int firstRow, int lastRow)
+		{
+			for (size_t i = (size_t)firstRow * level.width; i < (size_t)lastRow * level.width; i++)
+			{
+				unsigned char* target = &level.pixels[i * 4];
+				for (int c = 0; c < 4; c++)
+				{
+					float value = std::min(std::max(texels[i].value[c], 0.0f), 1.0f);
+					if (bSRGB && (c < 3))
+					{
+						target[c] = tables.fromLinear[(int)(value * (LINEAR_TABLE_SIZE - 1) + 0.5f)];
+					}
+					else
+					{
+						target[c] = (unsigned char)(value * 255.0f + 0.5f);
+					}
+				}
+			}
+		});
+	}
+
+	/***********************************************************
+	 *  BoxDownsample()
+	 *
+	 *  This function is used for averaging 2x2 float texels,
+	 *  one SSE register per texel.  Odd edges repeat the last
+	 *  row or column.
+	 ***********************************************************/
+	void BoxDownsample(const std::vector<FLOAT_TEXEL>& source, int width, int height, std::vector<FLOAT_TEXEL>& target, int targetWidth, int targetHeight)
+	{
+		target.resize((size_t)targetWidth * targetHeight);
+
+		ParallelRows(targetHeight, target.size(), [&](int firstRow, int lastRow)
+		{
+			for (int y = firstRow; y < lastRow; y++)
+			{
+				const FLOAT_TEXEL* row0 = &source[(size_t)std::min(y * 2, height - 1) * width];
+				const FLOAT_TEXEL* row1 = &source[(size_t)std::min(y * 2 + 1, height - 1) * width];
+				for (int x = 0; x < targetWidth; x++)
+				{
+					int x0 = std::min(x * 2, width - 1);
+					int x1 = std::min(x * 2 + 1, width - 1);
+					FLOAT_TEXEL& result = target[(size_t)y * targetWidth + x];
+#ifdef IMAGE_PROCESSING_SSE2
+					__m128 sum = _mm_add_ps(
+						_mm_add_ps(_mm_loadu_ps(row0[x0].value), _mm_loadu_ps(row0[x1].value)),
+						_mm_add_ps(_mm_loadu_ps(row1[x0].value), _mm_loadu_ps(row1[x1].value)));
+					_mm_storeu_ps(result.value, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+					for (int c = 0; c < 4; c++)
+					{
+						result.value[c] = (row0[x0].value[c] + row0[x1].value[c] + row1[x0].value[c] + row1[x1].value[c]) * 0.25f;
+					}
+#endif
+				}
+			}
+		});
+	}
+
+	/***********************************************************
+	 *  KAISER_WEIGHTS
+	 *
+	 *  The taps of a Kaiser windowed sinc that halves the
+	 *  resolution, built once on first use.  The taps sit at
+	 *  half texel offsets around the output texel center.
+	 ***********************************************************/
+	struct KAISER_WEIGHTS
+	{
+		float weights[KAISER_TAPS];
+
+		// zeroth order modified Bessel function of the first kind
+		static float BesselI0(float x)
+		{
+			float sum = 1.0f;
+			float term = 1.0f;
+			for (int k = 1; k < 16; k++)
+			{
+				term *= (x / (2.0f * k)) * (x / (2.0f * k));
+				sum += term;
+			}
+			return(sum);
+		}
+
+		KAISER_WEIGHTS()
+		{
+			const float pi = 3.14159265f;
+			const float halfWidth = KAISER_TAPS * 0.5f;
+			float total = 0.0f;
+			for (int i = 0; i < KAISER_TAPS; i++)
+			{
+				float offset = i - halfWidth + 0.5f;
+				float t = offset * 0.5f;
+				float sinc = sinf(pi * t) / (pi * t);
+				float u = offset / halfWidth;
+				float window = BesselI0(KAISER_ALPHA * sqrtf(std::max(0.0f, 1.0f - u * u))) / BesselI0(KAISER_ALPHA);
+				weights[i] = sinc * window;
+				total += weights[i];
+			}
+			for (int i = 0; i < KAISER_TAPS; i++)
+			{
+				weights[i] /= total;
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  KaiserDownsample()
+	 *
+	 *  This function is used for halving the resolution with
+	 *  the separable Kaiser filter, horizontally into a scratch
+	 *  image and then vertically, clamping taps at the edges.
+	 ***********************************************************/
+	void KaiserDownsample(const std::vector<FLOAT_TEXEL>& source, int width, int height, std::vector<FLOAT_TEXEL>& target, int targetWidth, int targetHeight)
+	{
+		static const KAISER_WEIGHTS kaiser;
+		const float* weights = kaiser.weights;
+		const int firstTap = -(KAISER_TAPS / 2 - 1);
+		std::vector<FLOAT_TEXEL> horizontal((size_t)targetWidth * height);
+		target.resize((size_t)targetWidth * targetHeight);
+
+		// the filter rings slightly below zero at hard edges,
+		// which EncodeLevel() clamps away
+		auto filterTexel = [&](const std::vector<FLOAT_TEXEL>& image, size_t base, size_t stride, int center, int limit, FLOAT_TEXEL& result)
+		{
+#ifdef IMAGE_PROCESSING_SSE2
+			__m128 sum = _mm_setzero_ps();
+			for (int tap = 0; tap < KAISER_TAPS; tap++)
+			{
+				int position = std::min(std::max(center + firstTap + tap, 0), limit - 1);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(image[base + position * stride].value), _mm_set1_ps(weights[tap])));
+			}
+			_mm_storeu_ps(result.value, sum);
+#else
+			for (int c = 0; c < 4; c++)
+			{
+				result.value[c] = 0.0f;
+			}
+			for (int tap = 0; tap < KAISER_TAPS; tap++)
+			{
+				int position = std::min(std::max(center + firstTap + tap, 0), limit - 1);
+				for (int c = 0; c < 4; c++)
+				{
+					result.value[c] += image[base + position * stride].value[c] * weights[tap];
+				}
+			}
+#endif
+		};
+
+		ParallelRows(height, horizontal.size(), [&](int firstRow, int lastRow)
+		{
+			for (int y = firstRow; y < lastRow; y++)
+			{
+				for (int x = 0; x < targetWidth; x++)
+				{
+					filterTexel(source, (size_t)y * width, 1, x * 2, width, horizontal[(size_t)y * targetWidth + x]);
+				}
+			}
+		});
+		ParallelRows(targetHeight, target.size(), [&](int firstRow, int lastRow)
+		{
+			for (int y = firstRow; y < lastRow; y++)
+			{
+				for (int x = 0; x < targetWidth; x++)
+				{
+					filterTexel(horizontal, x, targetWidth, y * 2, height, target[(size_t)y * targetWidth + x]);
+				}
+			}
+		});
+	}
+
+	// fill an image with a pattern that is not trivially compressible
+	void FillBenchmarkImage(std::vector<unsigned char>& pixels, int width, int height, int channels)
+	{
+		pixels.resize((size_t)width * height * channels);
+		uint32_t state = 0x12345678u;
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			pixels[i] = (unsigned char)(state >> 24);
+		}
+	}
+}
+
+/***********************************************************
+ *  FlipImageVertical()
+ *
+ *  This function is used for reversing the row order of an
+ *  image in place, with the row pairs split over threads.
+ ***********************************************************/
+void FlipImageVertical(unsigned char* pixels, int width, int height, int channels)
+{
+	const size_t rowBytes = (size_t)width * channels;
+
+	ParallelRows(height / 2, (size_t)width * height, [&](int firstRow, int lastRow)
+	{
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			SwapRows(pixels + y * rowBytes, pixels + (height - 1 - y) * rowBytes, rowBytes);
+		}
+	});
+}
+
+/***********************************************************
+ *  ExpandRGBToRGBA()
+ *
+ *  This function is used for widening RGB8 texels to RGBA8,
+ *  which also removes the dependence on GL_UNPACK_ALIGNMENT
+ *  for images with odd widths.
+ ***********************************************************/
+void ExpandRGBToRGBA(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount)
+{
+	const int rows = (int)std::min<size_t>(pixelCount / 1024 + 1, 1 << 20);
+
+	ParallelRows(rows, pixelCount, [&](int firstRow, int lastRow)
+	{
+		size_t first = pixelCount * firstRow / rows;
+		size_t last = pixelCount * lastRow / rows;
+		ExpandRange(rgb + first * 3, rgba + first * 4, last - first);
+	});
+}
+
+/***********************************************************
+ *  PremultiplyAlpha()
+ *
+ *  This function is used for multiplying the colors of RGBA8
+ *  texels by their alpha, so that filtering does not bleed
+ *  the color of transparent texels into their neighbours.
+ ***********************************************************/
+void PremultiplyAlpha(unsigned char* rgba, size_t pixelCount)
+{
+	const int rows = (int)std::min<size_t>(pixelCount / 1024 + 1, 1 << 20);
+
+	ParallelRows(rows, pixelCount, [&](int firstRow, int lastRow)
+	{
+		size_t first = pixelCount * firstRow / rows;
+		size_t last = pixelCount * lastRow / rows;
+		PremultiplyRange(rgba + first * 4, last - first);
+	});
+}
+
+/***********************************************************
+ *  GenerateMipChain()
+ *
+ *  This function is used for building every level below the
+ *  first one in the chain.  The filtering works on float
+ *  texels that stay linear from level to level, so rounding
+ *  to 8 bits only happens once per level.
+ ***********************************************************/
+void GenerateMipChain(std::vector<IMAGE_LEVEL>& levels, MIP_FILTER filter, bool bSRGB)
+{
+	if (levels.size() == 0)
+	{
+		return;
+	}
+	levels.resize(1);
+
+	std::vector<FLOAT_TEXEL> current;
+	std::vector<FLOAT_TEXEL> next;
+	DecodeLevel(levels[0], bSRGB, current);
+
+	int width = levels[0].width;
+	int height = levels[0].height;
+	while ((width > 1) || (height > 1))
+	{
+		IMAGE_LEVEL level;
+		level.width = std::max(1, width / 2);
+		level.height = std::max(1, height / 2);
+
+		if (filter == MIP_FILTER_KAISER)
+		{
+			KaiserDownsample(current, width, height, next, level.width, level.height);
+		}
+		else
+		{
+			BoxDownsample(current, width, height, next, level.width, level.height);
+		}
+
+		EncodeLevel(next, bSRGB, level);
+		levels.push_back(level);
+
+		current.swap(next);
+		width = level.width;
+		height = level.height;
+	}
+}
+
+/***********************************************************
+ *  PrepareImage()
+ *
+ *  This function is used for running the preparation steps
+ *  on a decoded image and returning its RGBA8 levels.
+ ***********************************************************/
+bool PrepareImage(
+	unsigned char* pixels,
+	int width,
+	int height,
+	int channels,
+	const IMAGE_PREP_OPTIONS& options,
+	std::vector<IMAGE_LEVEL>& levels)
+{
+	if ((NULL == pixels) || (width <= 0) || (height <= 0) || ((channels != 3) && (channels != 4)))
+	{
+		return(false);
+	}
+
+	if (options.bFlipVertical)
+	{
+		FlipImageVertical(pixels, width, height, channels);
+	}
+
+	const size_t texels = (size_t)width * height;
+	levels.resize(1);
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].pixels.resize(texels * 4);
+	if (channels == 3)
+	{
+		ExpandRGBToRGBA(pixels, levels[0].pixels.data(), texels);
+	}
+	else
+	{
+		memcpy(levels[0].pixels.data(), pixels, texels * 4);
+		if (options.bPremultiplyAlpha)
+		{
+			PremultiplyAlpha(levels[0].pixels.data(), texels);
+		}
+	}
+
+	if (options.bMipmaps)
+	{
+		GenerateMipChain(levels, options.mipFilter, options.bSRGB);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunImageProcessingBenchmark()
+ *
+ *  This function is used for timing each step on a generated
+ *  image and printing its throughput over the source bytes.
+ ***********************************************************/
+void RunImageProcessingBenchmark(int width, int height, int iterations)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	const size_t texels = (size_t)width * height;
+	std::vector<unsigned char> rgb;
+	std::vector<unsigned char> rgba;
+	FillBenchmarkImage(rgb, width, height, 3);
+	FillBenchmarkImage(rgba, width, height, 4);
+	std::vector<unsigned char> expanded(texels * 4);
+
+	auto report = [&](const char* name, size_t bytes, const std::function<void()>& step)
+	{
+		step();
+		Clock::time_point startTime = Clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			step();
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - startTime).count() / iterations;
+		std::cout << "  " << name << ": " << seconds * 1000.0 << " ms, "
+			<< bytes / seconds / (1024.0 * 1024.0) << " MB/s" << std::endl;
+	};
+
+	std::cout << "INFO: Image processing on " << width << "x" << height
+		<< " with " << std::max(1u, std::thread::hardware_concurrency()) << " threads"
+#if defined(__AVX2__)
+		<< " (AVX2)"
+#elif defined(IMAGE_PROCESSING_SSSE3)
+		<< " (SSSE3)"
+#elif defined(IMAGE_PROCESSING_SSE2)
+		<< " (SSE2)"
+#else
+		<< " (scalar)"
+#endif
+		<< std::endl;
+
+	report("vertical flip RGBA8", rgba.size(), [&]() { FlipImageVertical(rgba.data(), width, height, 4); });
+	report("RGB8 to RGBA8", rgb.size(), [&]() { ExpandRGBToRGBA(rgb.data(), expanded.data(), texels); });
+	report("premultiply alpha", rgba.size(), [&]() { PremultiplyAlpha(rgba.data(), texels); });
+
+	std::vector<IMAGE_LEVEL> levels(1);
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].pixels = rgba;
+	report("sRGB box mip chain", rgba.size(), [&]() { GenerateMipChain(levels, MIP_FILTER_BOX, true); });
+	report("sRGB Kaiser mip chain", rgba.size(), [&]() { GenerateMipChain(levels, MIP_FILTER_KAISER, true); });
+}
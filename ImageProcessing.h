@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// imageprocessing.h
+// ============
+// prepare decoded texture images for upload - flip, RGBA expansion,
+// premultiplied alpha and sRGB correct mipmap generation
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// filter used to build the lower mipmap levels
+enum MIP_FILTER
+{
+	// 2x2 average, cheapest
+	MIP_FILTER_BOX,
+	// 6 tap windowed sinc, keeps more detail without ringing
+	MIP_FILTER_KAISER
+};
+
+// one RGBA8 image level
+struct IMAGE_LEVEL
+{
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+};
+
+/***********************************************************
+ *  IMAGE_PREP_OPTIONS
+ *
+ *  The processing steps applied by PrepareImage().
+ ***********************************************************/
+struct IMAGE_PREP_OPTIONS
+{
+	// flip rows so the first row is the bottom of the image,
+	// which is the order GL expects
+	bool bFlipVertical;
+	// multiply the colors by alpha before filtering
+	bool bPremultiplyAlpha;
+	// build the full mipmap chain
+	bool bMipmaps;
+	// filter the colors in linear space, the data is sRGB encoded
+	bool bSRGB;
+	MIP_FILTER mipFilter;
+
+	IMAGE_PREP_OPTIONS()
+	{
+		bFlipVertical = true;
+		bPremultiplyAlpha = false;
+		bMipmaps = true;
+		bSRGB = true;
+		mipFilter = MIP_FILTER_BOX;
+	}
+};
+
+// swap the rows of an image in place
+void FlipImageVertical(unsigned char* pixels, int width, int height, int channels);
+// widen tightly packed RGB8 texels to RGBA8 with opaque alpha
+void ExpandRGBToRGBA(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount);
+// multiply the color of RGBA8 texels by their alpha in place
+void PremultiplyAlpha(unsigned char* rgba, size_t pixelCount);
+// append the lower mipmap levels to a chain holding the top level
+void GenerateMipChain(std::vector<IMAGE_LEVEL>& levels, MIP_FILTER filter, bool bSRGB);
+
+// run the passed in steps on a decoded RGB or RGBA image and
+// return the RGBA8 levels ready for upload or compression -
+// the flip is done in place on the passed in pixels
+bool PrepareImage(
+	unsigned char* pixels,
+	int width,
+	int height,
+	int channels,
+	const IMAGE_PREP_OPTIONS& options,
+	std::vector<IMAGE_LEVEL>& levels);
+
+// time every step on a generated image and print the MB/s
+void RunImageProcessingBenchmark(int width, int height, int iterations);
@@ -0,0 +1,467 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostorrenderer.cpp
+// ============
+// draw distant prop groups as octahedral impostors baked at load time
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImpostorRenderer.h"
+#include "GpuMemoryTracker.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ImpostorVertexShader = "./Source/shaders/impostorVertexShader.glsl";
+	const char* g_ImpostorFragmentShader = "./Source/shaders/impostorFragmentShader.glsl";
+
+	// the atlas is sampled from units free between the scene
+	// textures and the render hardware interface
+	const int COLOR_ATLAS_TEXTURE_UNIT = 7;
+	const int DEPTH_ATLAS_TEXTURE_UNIT = 8;
+
+	// directions baked per side of the octahedral grid and the
+	// size of one frame, so each layer is 512x512
+	const int FRAMES_PER_SIDE = 8;
+	const int FRAME_SIZE = 64;
+	const int ATLAS_SIZE = FRAMES_PER_SIDE * FRAME_SIZE;
+	// the smallest mipmap keeps 4x4 texels per frame, so the
+	// frames do not bleed into each other
+	const int ATLAS_LEVELS = 5;
+
+	// default impostor distance and crossfade band in world units
+	const float DEFAULT_DISTANCE = 40.0f;
+	const float DEFAULT_FADE_DISTANCE = 8.0f;
+	// while fading, the impostor is pulled this share of its radius
+	// toward the camera, so its pixels cover the full geometry
+	const float FADE_DEPTH_BIAS = 0.05f;
+
+	/***********************************************************
+	 *  OctahedralDecode()
+	 *
+	 *  This function is used for getting the direction of a
+	 *  point of the octahedral square, with +Y at the centre.
+	 *  It must match OctahedralDecode() in the vertex shader.
+	 ***********************************************************/
+	glm::vec3 OctahedralDecode(const glm::vec2& textureCoordinate)
+	{
+		glm::vec2 square(textureCoordinate.x * 2.0f - 1.0f, textureCoordinate.y * 2.0f - 1.0f);
+		glm::vec3 direction(square.x, 1.0f - std::fabs(square.x) - std::fabs(square.y), square.y);
+		if (direction.y < 0.0f)
+		{
+			float x = (1.0f - std::fabs(direction.z)) * ((direction.x >= 0.0f) ? 1.0f : -1.0f);
+			float z = (1.0f - std::fabs(direction.x)) * ((direction.z >= 0.0f) ? 1.0f : -1.0f);
+			direction.x = x;
+			direction.z = z;
+		}
+		return(glm::normalize(direction));
+	}
+}
+
+/***********************************************************
+ *  ImpostorRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ImpostorRenderer::ImpostorRenderer()
+{
+	m_pImpostorShader = NULL;
+	m_colorArray = 0;
+	m_depthArray = 0;
+	m_vertexArray = 0;
+	m_instanceBuffer = 0;
+	m_instanceCapacity = 0;
+	m_textureBytes = 0;
+	m_distance = DEFAULT_DISTANCE;
+	m_fadeDistance = DEFAULT_FADE_DISTANCE;
+}
+
+/***********************************************************
+ *  ~ImpostorRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ImpostorRenderer::~ImpostorRenderer()
+{
+	// the program stays in the resource cache for the next scene
+	if (NULL != m_pImpostorShader)
+	{
+		delete m_pImpostorShader;
+		m_pImpostorShader = NULL;
+	}
+	m_program.Release();
+
+	if (0 != m_colorArray)
+	{
+		glDeleteTextures(1, &m_colorArray);
+		glDeleteTextures(1, &m_depthArray);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -m_textureBytes);
+		m_colorArray = 0;
+		m_depthArray = 0;
+		m_textureBytes = 0;
+	}
+	if (0 != m_instanceBuffer)
+	{
+		glDeleteBuffers(1, &m_instanceBuffer);
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)(m_instanceCapacity * sizeof(IMPOSTOR_INSTANCE)));
+		m_instanceBuffer = 0;
+		m_instanceCapacity = 0;
+	}
+	if (0 != m_vertexArray)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the impostor program,
+ *  creating the instance buffer and baking the impostors.
+ ***********************************************************/
+bool ImpostorRenderer::Initialize(SceneManager* pSceneManager)
+{
+	m_program = pSceneManager->GetResourceCache()->AcquireProgram(g_ImpostorVertexShader, NULL, g_ImpostorFragmentShader);
+	if (!m_program.IsValid())
+	{
+		return(false);
+	}
+
+	m_pImpostorShader = new ShaderManager();
+	m_pImpostorShader->m_programID = m_program.GetID();
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	m_pImpostorShader->use();
+	m_pImpostorShader->setSampler2DValue("colorAtlas", COLOR_ATLAS_TEXTURE_UNIT);
+	m_pImpostorShader->setSampler2DValue("depthAtlas", DEPTH_ATLAS_TEXTURE_UNIT);
+	m_pImpostorShader->setIntValue("framesPerSide", FRAMES_PER_SIDE);
+	glUseProgram(previousProgram);
+
+	// the quad corners come from gl_VertexID, so the only
+	// attributes are the per instance ones
+	glGenVertexArrays(1, &m_vertexArray);
+	glGenBuffers(1, &m_instanceBuffer);
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	for (GLuint location = 0; location < 2; location++)
+	{
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(IMPOSTOR_INSTANCE),
+			(void*)(location * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return(Bake(pSceneManager));
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for rendering every prop group into
+ *  its layer of the atlas.  Each frame is an orthographic
+ *  view of the bounding sphere from one direction of the
+ *  octahedral grid, shaded by the scene shader with the
+ *  scene lights.  The GL state and the view transform of the
+ *  scene are put back afterwards, since the scene may be
+ *  baked while another one is rendering.
+ ***********************************************************/
+bool ImpostorRenderer::Bake(SceneManager* pSceneManager)
+{
+	ShaderManager* pSceneShader = pSceneManager->GetShaderManager();
+	if (NULL == pSceneShader)
+	{
+		return(false);
+	}
+
+	const std::vector<SceneManager::DRAW_ITEM>& drawList = pSceneManager->RecordScene();
+	const std::vector<int>& groupStarts = pSceneManager->GetPropGroupStarts();
+	int groupCount = std::max(0, (int)groupStarts.size() - 1);
+	if (groupCount == 0)
+	{
+		return(false);
+	}
+
+	// bounding sphere of each group around its bounding box
+	m_props.resize(groupCount);
+	for (int group = 0; group < groupCount; group++)
+	{
+		PROP_IMPOSTOR& prop = m_props[group];
+		prop.bBaked = false;
+		prop.coverage = 0.0f;
+		prop.bounds.min = glm::vec3(1.0e30f);
+		prop.bounds.max = glm::vec3(-1.0e30f);
+		for (int i = groupStarts[group]; i < groupStarts[group + 1]; i++)
+		{
+			BOUNDING_BOX localBounds;
+			SceneManager::GetMeshBounds(drawList[i].mesh, localBounds.min, localBounds.max);
+			BOUNDING_BOX itemBounds = TransformBoundingBox(localBounds, drawList[i].model);
+			prop.bounds.min = glm::min(prop.bounds.min, itemBounds.min);
+			prop.bounds.max = glm::max(prop.bounds.max, itemBounds.max);
+			prop.bBaked = true;
+		}
+		prop.center = (prop.bounds.min + prop.bounds.max) * 0.5f;
+		prop.radius = prop.bBaked ? glm::length(prop.bounds.max - prop.bounds.min) * 0.5f : 0.0f;
+		if (prop.radius <= 0.0f)
+		{
+			prop.bBaked = false;
+		}
+	}
+
+	glGenTextures(1, &m_colorArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_colorArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, ATLAS_LEVELS, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, groupCount);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenTextures(1, &m_depthArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT16, ATLAS_SIZE, ATLAS_SIZE, groupCount);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	m_textureBytes = 0;
+	for (int level = 0; level < ATLAS_LEVELS; level++)
+	{
+		long long levelSize = ATLAS_SIZE >> level;
+		m_textureBytes += levelSize * levelSize * 4 * groupCount;
+	}
+	m_textureBytes += (long long)ATLAS_SIZE * ATLAS_SIZE * 2 * groupCount;
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, m_textureBytes);
+
+	// keep the state the current frame relies on
+	GLint previousFramebuffer = 0;
+	GLint previousViewport[4] = { 0, 0, 0, 0 };
+	GLint previousProgram = 0;
+	GLint previousActiveTexture = 0;
+	GLint previousTextures[16];
+	GLfloat previousClearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+	for (int unit = 0; unit < 16; unit++)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTextures[unit]);
+	}
+	glm::mat4 previousView = pSceneManager->GetViewMatrix();
+	glm::mat4 previousProjection = pSceneManager->GetProjectionMatrix();
+	glm::vec3 previousViewPosition = pSceneManager->GetViewPosition();
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	pSceneManager->BindGLTextures();
+	pSceneManager->BindMeshes();
+	pSceneShader->use();
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+	bool bComplete = true;
+	for (int group = 0; (group < groupCount) && bComplete; group++)
+	{
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorArray, 0, group);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthArray, 0, group);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Impostor atlas framebuffer is not complete" << std::endl;
+			bComplete = false;
+			break;
+		}
+
+		glViewport(0, 0, ATLAS_SIZE, ATLAS_SIZE);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		const PROP_IMPOSTOR& prop = m_props[group];
+		if (!prop.bBaked)
+		{
+			continue;
+		}
+
+		// the eye is twice the radius out with the near and far
+		// planes one radius either side of the centre, the shader
+		// rebuilds the depth offset from the same distances
+		glm::mat4 projection = glm::ortho(-prop.radius, prop.radius, -prop.radius, prop.radius, prop.radius, 3.0f * prop.radius);
+		for (int y = 0; y < FRAMES_PER_SIDE; y++)
+		{
+			for (int x = 0; x < FRAMES_PER_SIDE; x++)
+			{
+				glm::vec3 direction = OctahedralDecode(glm::vec2((x + 0.5f) / FRAMES_PER_SIDE, (y + 0.5f) / FRAMES_PER_SIDE));
+				glm::vec3 worldUp = (std::fabs(direction.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+				glm::vec3 eye = prop.center + direction * (2.0f * prop.radius);
+
+				glViewport(x * FRAME_SIZE, y * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+				pSceneManager->SetViewTransform(glm::lookAt(eye, prop.center, worldUp), projection, eye);
+				pSceneManager->ApplyViewTransform();
+				for (int i = groupStarts[group]; i < groupStarts[group + 1]; i++)
+				{
+					pSceneManager->SubmitDrawItem(drawList[i]);
+				}
+			}
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glDeleteFramebuffers(1, &framebuffer);
+
+	if (bComplete)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_colorArray);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	// put the state of the current frame back
+	pSceneManager->SetViewTransform(previousView, previousProjection, previousViewPosition);
+	pSceneManager->ApplyViewTransform();
+	for (int unit = 0; unit < 16; unit++)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, previousTextures[unit]);
+	}
+	glActiveTexture(previousActiveTexture);
+	glUseProgram(previousProgram);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	glClearColor(previousClearColor[0], previousClearColor[1], previousClearColor[2], previousClearColor[3]);
+	bDepthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+	bBlend ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+
+	return(bComplete);
+}
+
+/***********************************************************
+ *  SelectImpostors()
+ *
+ *  This method is used for working out the coverage of each
+ *  prop group from its distance to the camera, and gathering
+ *  the impostors in view into the instance list.  A group
+ *  that is fully replaced but out of view draws nothing.
+ ***********************************************************/
+void ImpostorRenderer::SelectImpostors(const glm::vec3& viewPosition, const FRUSTUM& frustum)
+{
+	float fadeStart = m_distance - m_fadeDistance;
+
+	m_instances.clear();
+	for (size_t group = 0; group < m_props.size(); group++)
+	{
+		PROP_IMPOSTOR& prop = m_props[group];
+		prop.coverage = 0.0f;
+		if (!prop.bBaked)
+		{
+			continue;
+		}
+
+		float distance = glm::length(viewPosition - prop.center);
+		if (distance <= fadeStart)
+		{
+			continue;
+		}
+		prop.coverage = (m_fadeDistance > 0.0f) ? std::min(1.0f, (distance - fadeStart) / m_fadeDistance) : 1.0f;
+
+		if (IsBoxInFrustum(frustum, prop.bounds))
+		{
+			IMPOSTOR_INSTANCE instance;
+			instance.centerRadius = glm::vec4(prop.center, prop.radius);
+			instance.params = glm::vec4((float)group, prop.coverage,
+				(prop.coverage < 1.0f) ? FADE_DEPTH_BIAS * prop.radius : 0.0f, 0.0f);
+			m_instances.push_back(instance);
+		}
+	}
+}
+
+/***********************************************************
+ *  IsReplaced()
+ *
+ *  This method is used for checking whether the full geometry
+ *  of the group can be skipped this frame.
+ ***********************************************************/
+bool ImpostorRenderer::IsReplaced(int group) const
+{
+	return((group >= 0) && (group < (int)m_props.size()) && (m_props[group].coverage >= 1.0f));
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing the selected impostors
+ *  with a single instanced draw over the opaque pass.
+ ***********************************************************/
+void ImpostorRenderer::Render(SceneManager* pSceneManager)
+{
+	if (m_instances.empty())
+	{
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	if (m_instances.size() > m_instanceCapacity)
+	{
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)(m_instanceCapacity * sizeof(IMPOSTOR_INSTANCE)));
+		m_instanceCapacity = m_instances.size() * 2;
+		TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)(m_instanceCapacity * sizeof(IMPOSTOR_INSTANCE)));
+	}
+	// orphan the storage so the upload does not wait for the
+	// previous frame to finish drawing from it
+	glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(IMPOSTOR_INSTANCE), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_instances.size() * sizeof(IMPOSTOR_INSTANCE), m_instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_pImpostorShader->use();
+	m_pImpostorShader->setMat4Value("view", pSceneManager->GetViewMatrix());
+	m_pImpostorShader->setMat4Value("projection", pSceneManager->GetProjectionMatrix());
+	m_pImpostorShader->setVec3Value("viewPosition", pSceneManager->GetViewPosition());
+
+	glActiveTexture(GL_TEXTURE0 + COLOR_ATLAS_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_colorArray);
+	glActiveTexture(GL_TEXTURE0 + DEPTH_ATLAS_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray);
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	// the scene meshes stay bound through the frame
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glBindVertexArray(m_vertexArray);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)m_instances.size());
+	glBindVertexArray(previousVertexArray);
+
+	ShaderManager* pSceneShader = pSceneManager->GetShaderManager();
+	if (NULL != pSceneShader)
+	{
+		pSceneShader->use();
+	}
+}
+
+/***********************************************************
+ *  SetDistance()
+ *
+ *  This method is used for setting the distance at which the
+ *  impostors replace the props and the crossfade band width.
+ ***********************************************************/
+void ImpostorRenderer::SetDistance(float distance, float fadeDistance)
+{
+	m_distance = distance;
+	m_fadeDistance = std::max(0.0f, std::min(fadeDistance, distance));
+}
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostorrenderer.h
+// ============
+// draw distant prop groups as octahedral impostors baked at load time
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "ResourceCache.h"
+#include "FrustumCulling.h"
+
+#include <vector>
+
+/***********************************************************
+ *  ImpostorRenderer
+ *
+ *  This class replaces the prop groups far from the camera
+ *  with impostors.  At load time each group is rendered with
+ *  the scene shader from a grid of directions spread over the
+ *  sphere by an octahedral mapping, into one layer of a color
+ *  and a depth texture array.  Beyond the impostor distance a
+ *  group is drawn as a single quad showing the frame nearest
+ *  the view direction, all groups in one instanced draw, and
+ *  the baked depth is written so the impostors intersect the
+ *  rest of the scene.  Over a band before the distance the
+ *  impostor is dithered in over the full geometry.
+ ***********************************************************/
+class ImpostorRenderer
+{
+public:
+	// constructor
+	ImpostorRenderer();
+	// destructor
+	~ImpostorRenderer();
+
+	// load the program and bake the impostors of every prop group
+	bool Initialize(SceneManager* pSceneManager);
+
+	// decide how each prop group is drawn from the view position,
+	// and gather the visible impostors for Render()
+	void SelectImpostors(const glm::vec3& viewPosition, const FRUSTUM& frustum);
+	// true when the group is drawn only as an impostor this frame
+	bool IsReplaced(int group) const;
+	// draw the impostors selected for this frame
+	void Render(SceneManager* pSceneManager);
+
+	// the distance at which the impostors fully replace the props,
+	// and the width of the crossfade band before it
+	void SetDistance(float distance, float fadeDistance);
+	int GetImpostorCount() const { return (int)m_instances.size(); }
+
+private:
+	// bounding sphere and current state of one prop group
+	struct PROP_IMPOSTOR
+	{
+		BOUNDING_BOX bounds;
+		glm::vec3 center;
+		float radius;
+		bool bBaked;
+		// share of the impostor drawn this frame, 1 replaces the props
+		float coverage;
+	};
+
+	// per instance attributes of the impostor quads
+	struct IMPOSTOR_INSTANCE
+	{
+		glm::vec4 centerRadius;
+		// atlas layer, coverage, depth bias and padding
+		glm::vec4 params;
+	};
+
+	std::vector<PROP_IMPOSTOR> m_props;
+	std::vector<IMPOSTOR_INSTANCE> m_instances;
+	// reference to the program in the resource cache
+	ResourceHandle m_program;
+	ShaderManager* m_pImpostorShader;
+	// one layer per prop group, with the frames tiled in each layer
+	GLuint m_colorArray;
+	GLuint m_depthArray;
+	GLuint m_vertexArray;
+	GLuint m_instanceBuffer;
+	size_t m_instanceCapacity;
+	long long m_textureBytes;
+	float m_distance;
+	float m_fadeDistance;
+
+	bool Bake(SceneManager* pSceneManager);
+};
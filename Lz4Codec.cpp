@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+// lz4codec.cpp
+// ============
+// compress and decompress data in the LZ4 block format, which decodes fast
+// enough for the asset pack to be read at disk speed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Lz4Codec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// the format's limits - a match is at least 4 bytes, reaches
+	// back at most 64 KiB, and the last 5 bytes of a block are
+	// always literals, with the last match starting at least 12
+	// bytes before the end
+	const size_t MIN_MATCH = 4;
+	const size_t LAST_LITERALS = 5;
+	const size_t MATCH_FIND_LIMIT = 12;
+	const size_t MAX_OFFSET = 65535;
+
+	// positions of the last 4 byte sequences seen, by hash
+	const int HASH_BITS = 12;
+
+	/***********************************************************
+	 *  Read32()
+	 *
+	 *  This function is used for reading 4 bytes at any
+	 *  alignment.
+	 ***********************************************************/
+	uint32_t Read32(const unsigned char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return(value);
+	}
+
+	/***********************************************************
+	 *  HashSequence()
+	 *
+	 *  This function is used for hashing 4 bytes to a slot of
+	 *  the match table.
+	 ***********************************************************/
+	uint32_t HashSequence(uint32_t sequence)
+	{
+		return((sequence * 2654435761u) >> (32 - HASH_BITS));
+	}
+
+	/***********************************************************
+	 *  WriteLength()
+	 *
+	 *  This function is used for writing the part of a length
+	 *  that did not fit in its 4 bits of the token, as bytes of
+	 *  255 followed by the remainder.
+	 ***********************************************************/
+	void WriteLength(unsigned char*& output, size_t length)
+	{
+		length -= 15;
+		while (length >= 255)
+		{
+			*output++ = 255;
+			length -= 255;
+		}
+		*output++ = (unsigned char)length;
+	}
+
+	/***********************************************************
+	 *  WriteSequence()
+	 *
+	 *  This function is used for writing the literals before a
+	 *  match and the match itself.  A match length of 0 writes
+	 *  the literals that end the block.  False is returned when
+	 *  the sequence does not fit.
+	 ***********************************************************/
+	bool WriteSequence(
+		unsigned char*& output,
+		const unsigned char* outputEnd,
+		const unsigned char* literals,
+		size_t literalLength,
+		size_t offset,
+		size_t matchLength)
+	{
+		size_t needed = 1 + (literalLength / 255 + 1) + literalLength + 2 + (matchLength / 255 + 1);
+		if ((size_t)(outputEnd - output) < needed)
+		{
+			return(false);
+		}
+
+		size_t matchCode = (matchLength > 0) ? matchLength - MIN_MATCH : 0;
+		unsigned char* token = output++;
+		*token = (unsigned char)((((literalLength < 15) ? literalLength : 15) << 4) | ((matchCode < 15) ? matchCode : 15));
+		if (literalLength >= 15)
+		{
+			WriteLength(output, literalLength);
+		}
+		if (literalLength > 0)
+		{
+			memcpy(output, literals, literalLength);
+			output += literalLength;
+		}
+
+		if (matchLength > 0)
+		{
+			*output++ = (unsigned char)(offset & 0xFF);
+			*output++ = (unsigned char)(offset >> 8);
+			if (matchCode >= 15)
+			{
+				WriteLength(output, matchCode);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadLength()
+	 *
+	 *  This function is used for adding the extra bytes of a
+	 *  length to the 15 held in its token.  False is returned
+	 *  when the input ends first.
+	 ***********************************************************/
+	bool ReadLength(const unsigned char*& input, const unsigned char* inputEnd, size_t& length)
+	{
+		unsigned char value = 255;
+		while (value == 255)
+		{
+			if (input >= inputEnd)
+			{
+				return(false);
+			}
+			value = *input++;
+			length += value;
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  Lz4CompressBound()
+ *
+ *  This function is used for getting the largest size a block
+ *  can compress to, which is a little more than its size when
+ *  nothing in it repeats.
+ ***********************************************************/
+size_t Lz4CompressBound(size_t size)
+{
+	return(size + size / 255 + 16);
+}
+
+/***********************************************************
+ *  Lz4Compress()
+ *
+ *  This function is used for compressing a block with a
+ *  single pass over it, taking the first match the hash table
+ *  finds at each position.  That trades some ratio for speed,
+ *  which suits assets packed on every build.
+ ***********************************************************/
+size_t Lz4Compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t capacity)
+{
+	unsigned char* output = destination;
+	const unsigned char* outputEnd = destination + capacity;
+	size_t anchor = 0;
+
+	if (sourceSize > MATCH_FIND_LIMIT)
+	{
+		std::vector<int64_t> table((size_t)1 << HASH_BITS, -1);
+		size_t matchLimit = sourceSize - LAST_LITERALS;
+		size_t position = 0;
+
+		while (position + MATCH_FIND_LIMIT < sourceSize)
+		{
+			uint32_t sequence = Read32(source + position);
+			uint32_t hash = HashSequence(sequence);
+			int64_t candidate = table[hash];
+			table[hash] = (int64_t)position;
+
+			if ((candidate < 0) ||
+				(position - (size_t)candidate > MAX_OFFSET) ||
+				(Read32(source + candidate) != sequence))
+			{
+				position++;
+				continue;
+			}
+
+			size_t matchLength = MIN_MATCH;
+			while ((position + matchLength < matchLimit) &&
+				(source[candidate + matchLength] == source[position + matchLength]))
+			{
+				matchLength++;
+			}
+
+			if (!WriteSequence(output, outputEnd, source + anchor, position - anchor,
+				position - (size_t)candidate, matchLength))
+			{
+				return(0);
+			}
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	if (!WriteSequence(output, outputEnd, source + anchor, sourceSize - anchor, 0, 0))
+	{
+		return(0);
+	}
+	return((size_t)(output - destination));
+}
+
+/***********************************************************
+ *  Lz4Decompress()
+ *
+ *  This function is used for decompressing a block, checking
+ *  every length and offset against both buffers, since the
+ *  data comes from a file that may be damaged.
+ ***********************************************************/
+bool Lz4Decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize)
+{
+	const unsigned char* input = source;
+	const unsigned char* inputEnd = source + sourceSize;
+	unsigned char* output = destination;
+	unsigned char* outputEnd = destination + destinationSize;
+
+	while (input < inputEnd)
+	{
+		unsigned char token = *input++;
+
+		size_t literalLength = token >> 4;
+		if ((literalLength == 15) && !ReadLength(input, inputEnd, literalLength))
+		{
+			return(false);
+		}
+		if (((size_t)(inputEnd - input) < literalLength) || ((size_t)(outputEnd - output) < literalLength))
+		{
+			return(false);
+		}
+		memcpy(output, input, literalLength);
+		input += literalLength;
+		output += literalLength;
+
+		// the last sequence of a block has no match
+		if (input == inputEnd)
+		{
+			break;
+		}
+
+		if (inputEnd - input < 2)
+		{
+			return(false);
+		}
+		size_t offset = (size_t)input[0] | ((size_t)input[1] << 8);
+		input += 2;
+		if ((offset == 0) || (offset > (size_t)(output - destination)))
+		{
+			return(false);
+		}
+
+		size_t matchLength = token & 15;
+		if ((matchLength == 15) && !ReadLength(input, inputEnd, matchLength))
+		{
+			return(false);
+		}
+		matchLength += MIN_MATCH;
+		if ((size_t)(outputEnd - output) < matchLength)
+		{
+			return(false);
+		}
+
+		// a match may overlap the bytes it writes, which repeats
+		// them, so it is copied a byte at a time
+		const unsigned char* match = output - offset;
+		for (size_t i = 0; i < matchLength; i++)
+		{
+			output[i] = match[i];
+		}
+		output += matchLength;
+	}
+
+	return(output == outputEnd);
+}
@@ -0,0 +1,24 @@
+///////////////////////////////////////////////////////////////////////////////
+// lz4codec.h
+// ============
+// compress and decompress data in the LZ4 block format, which decodes fast
+// enough for the asset pack to be read at disk speed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+// largest compressed size of a block of the passed in size, for sizing the
+// output of Lz4Compress()
+size_t Lz4CompressBound(size_t size);
+
+// compress a block, returning the compressed size, or 0 when it does not
+// fit in the passed in capacity
+size_t Lz4Compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t capacity);
+
+// decompress a block, returning false when the data is damaged or does not
+// decompress to exactly the passed in size - the output is never written
+// past that size, whatever the input holds
+bool Lz4Decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize);
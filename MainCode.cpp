@@ -10,9 +10,22 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "SceneManager.h"
+#include "ResourceCache.h"
+#include "ScenePreloader.h"
+#include "AssetStreamer.h"
+#include "ResourceUploader.h"
 #include "ViewManager.h"
-#include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "FrameCapture.h"
+#include "PerformanceHUD.h"
+#include "MetricsExporter.h"
+#include "ShaderLoader.h"
+#include "TaskGraph.h"
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 // Namespace for declaring global variables
 namespace
@@ -25,16 +38,56 @@ namespace
 
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
+	// cache of the textures, meshes and programs shared by the scenes
+	ResourceCache* g_ResourceCache = nullptr;
+	// loads the next scene while the current one renders
+	ScenePreloader* g_ScenePreloader = nullptr;
+	// loads the assets of the first scene after it is shown
+	AssetStreamer* g_AssetStreamer = nullptr;
+	// uploads the textures of both through a second context
+	ResourceUploader* g_ResourceUploader = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// performance overlay drawn over the finished frame
+	PerformanceHUD* g_PerformanceHUD = nullptr;
+	// publishes the frame statistics for the ops tooling to scrape
+	MetricsExporter* g_MetricsExporter = nullptr;
+
+	// the metrics are served over HTTP on localhost at this port,
+	// or on a Unix domain socket when a path is given, and each
+	// frame is appended to the JSON-lines log when a path is given
+	const int g_MetricsPort = 9464;
+	const char* const g_MetricsSocketPath = "";
+	const char* const g_MetricsLogPath = "";
+
+	// time each frame may spend on the GL work of loading the
+	// next scene, a small part of a 60 Hz frame
+	const double g_PreloadBudgetMilliseconds = 2.0;
+
+	// the timeline of the startup tasks is written here
+	const char* const g_StartupTracePath = "startup_trace.json";
+	// the textures, meshes and shaders are read from this pack
+	// when it is there, and from the loose files when it is not
+	const char* const g_AssetPackPath = "assets.pak";
+	// the shader files read ahead while the window is created
+	const char* const g_ShaderDirectory = "./Source/shaders";
+
+	// time each frame may spend on uploading the assets of the
+	// first scene, which show as placeholders until then
+	const double g_StreamBudgetMilliseconds = 4.0;
+
+	// the time to the first frame and to the fully loaded scene
+	// are measured from here
+	std::chrono::steady_clock::time_point g_LaunchTime;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool RunStartup();
 
 
 /***********************************************************
@@ -45,37 +98,17 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+	g_LaunchTime = std::chrono::steady_clock::now();
+	bool bFirstFrame = true;
 
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
+	// create the window and prepare the scene as a graph of
+	// tasks, the file reads overlapping the GL work - the scene
+	// textures and meshes keep loading after the first frame
+	if (RunStartup() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
@@ -87,26 +120,138 @@ int main(int argc, char* argv[])
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// load the next scene a little every frame once a switch
+		// is asked for, and swap to it at the start of the frame
+		// after it is ready - this goes before the view is set, as
+		// baking the impostors changes the view of the main shader
+		if (g_ScenePreloader->Update(g_PreloadBudgetMilliseconds))
+		{
+			SceneManager* pNextScene = g_ScenePreloader->TakeScene();
+			delete g_SceneManager;
+			g_SceneManager = pNextScene;
+		}
+
+		// swap the placeholders of the first scene for its assets
+		// as they finish loading, for the same reason before the
+		// view is set
+		if (g_AssetStreamer->Update(g_StreamBudgetMilliseconds) && (NULL != g_MetricsExporter))
+		{
+			const std::vector<SceneManager::LOAD_TIME>& loadTimes = g_SceneManager->GetLoadTimes();
+			for (size_t i = 0; i < loadTimes.size(); i++)
+			{
+				g_MetricsExporter->PublishLoadTime(loadTimes[i].name, loadTimes[i].milliseconds);
+			}
+			g_MetricsExporter->PublishLoadTime("fully_loaded",
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_LaunchTime).count());
+		}
+
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
 
+		// the scene the assets stream into stays until they are in
+		if (g_ViewManager->GetRenderOptions().bNextScene && !g_ScenePreloader->IsBusy() && !g_AssetStreamer->IsBusy())
+		{
+			g_ScenePreloader->Start(new SceneManager(g_ShaderManager, g_ResourceCache));
+		}
+		if ((NULL != g_MetricsExporter) && g_ScenePreloader->HasNewStats())
+		{
+			const ScenePreloader::SWITCH_STATS& switchStats = g_ScenePreloader->GetLastStats();
+			g_MetricsExporter->PublishLoadTime("scene_switch", switchStats.switchMilliseconds);
+			g_MetricsExporter->PublishLoadTime("scene_switch_max_frame", switchStats.maxFrameMilliseconds);
+		}
+		g_SceneManager->SetViewTransform(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition());
+		g_SceneManager->SetRenderOptions(g_ViewManager->GetRenderOptions());
+
+		// the frame timing runs while the overlay is hidden so
+		// the graph is already filled when it is shown
+		if (NULL != g_PerformanceHUD)
+		{
+			g_PerformanceHUD->BeginFrame();
+		}
+
+		// record this frame's GL calls when a capture was requested
+		bool bCaptureFrame = g_ViewManager->GetRenderOptions().bCaptureFrame;
+		if (bCaptureFrame)
+		{
+			FrameCapture::BeginCapture("frame_capture.glcap");
+		}
+
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
 
+		if (bCaptureFrame)
+		{
+			FrameCapture::EndCapture();
+		}
+
+		// draw the performance overlay over the finished frame
+		if (NULL != g_PerformanceHUD)
+		{
+			g_PerformanceHUD->EndFrame(g_SceneManager->GetFrameStats());
+			if (g_ViewManager->GetRenderOptions().bShowHUD)
+			{
+				g_PerformanceHUD->Render();
+			}
+		}
+		if (NULL != g_MetricsExporter)
+		{
+			g_MetricsExporter->PublishFrame(g_SceneManager->GetFrameStats());
+		}
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
+		if (bFirstFrame && (NULL != g_MetricsExporter))
+		{
+			g_MetricsExporter->PublishLoadTime("first_frame",
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_LaunchTime).count());
+		}
+		bFirstFrame = false;
+
 		// query the latest GLFW events
 		glfwPollEvents();
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_MetricsExporter)
+	{
+		delete g_MetricsExporter;
+		g_MetricsExporter = NULL;
+	}
+	if (NULL != g_PerformanceHUD)
+	{
+		delete g_PerformanceHUD;
+		g_PerformanceHUD = NULL;
+	}
+	if (NULL != g_AssetStreamer)
+	{
+		delete g_AssetStreamer;
+		g_AssetStreamer = NULL;
+	}
+	if (NULL != g_ScenePreloader)
+	{
+		delete g_ScenePreloader;
+		g_ScenePreloader = NULL;
+	}
+	// after the loaders, which abandon the uploads they hold
+	if (NULL != g_ResourceUploader)
+	{
+		delete g_ResourceUploader;
+		g_ResourceUploader = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	if (NULL != g_ResourceCache)
+	{
+		delete g_ResourceCache;
+		g_ResourceCache = NULL;
+	}
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
@@ -117,11 +262,193 @@ int main(int argc, char* argv[])
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
+	UnmountAssetPack();
 
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
 }
 
+/***********************************************************
+ *	RunStartup()
+ *
+ *  This function is used to create the window and prepare the
+ *  3D scene as a graph of tasks.  GLFW, the window, GLEW and
+ *  every step that makes GL calls run on this thread, which
+ *  owns the context, while the shader sources are preprocessed
+ *  on worker threads.  The scene textures and meshes are not
+ *  waited for - the asset streamer starts reading them first
+ *  and the scene draws placeholders until they are uploaded.
+ *  The timeline is written to a trace file with the critical
+ *  path marked.
+ ***********************************************************/
+bool RunStartup()
+{
+	bool bContextReady = false;
+
+	// mapped before any thread loads an asset, so every load
+	// after this reads the one open file
+	if (MountAssetPack(g_AssetPackPath))
+	{
+		std::cout << "INFO: Reading assets from pack:" << g_AssetPackPath << std::endl;
+	}
+
+	// the scene manager makes no GL calls until it is prepared,
+	// so it is made first for its assets to start loading, and
+	// is given the shader manager once GLFW is up
+	g_ResourceCache = new ResourceCache();
+	g_SceneManager = new SceneManager(NULL, g_ResourceCache);
+	g_ScenePreloader = new ScenePreloader();
+	g_AssetStreamer = new AssetStreamer();
+	g_AssetStreamer->Start(g_SceneManager);
+
+	// the GL steps are skipped once creating the context failed
+	auto onContext = [&bContextReady](const std::function<void()>& work)
+	{
+		return [&bContextReady, work]()
+		{
+			if (bContextReady)
+			{
+				work();
+			}
+		};
+	};
+	auto prepareStep = [&onContext](SceneManager::PREPARE_STEP step)
+	{
+		return onContext([step]() { g_SceneManager->RunPrepareStep(step); });
+	};
+
+	TaskGraph startup;
+	const TaskGraph::TASK_THREAD CONTEXT = TaskGraph::TASK_CONTEXT_THREAD;
+	const TaskGraph::TASK_THREAD ANY = TaskGraph::TASK_ANY_THREAD;
+
+	int initializeGLFW = startup.AddTask("initialize GLFW", CONTEXT, []()
+	{
+		InitializeGLFW();
+	});
+	int createWindow = startup.AddTask("create window", CONTEXT, []()
+	{
+		g_ShaderManager = new ShaderManager();
+		g_ViewManager = new ViewManager(g_ShaderManager);
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+		g_SceneManager->SetShaderManager(g_ShaderManager);
+	}, { initializeGLFW });
+	int initializeGLEW = startup.AddTask("initialize GLEW", CONTEXT, [&bContextReady]()
+	{
+		bContextReady = (NULL != g_Window) && InitializeGLEW();
+	}, { createWindow });
+
+	// load the shader code from the external GLSL files
+	int loadShaders = startup.AddTask("load main shaders", CONTEXT, onContext([]()
+	{
+		g_ShaderManager->LoadShaders(
+			"../../Utilities/shaders/vertexShader.glsl",
+			"../../Utilities/shaders/fragmentShader.glsl");
+		g_ShaderManager->use();
+	}), { initializeGLEW });
+	int preloadShaders = startup.AddTask("preprocess shaders", ANY, []()
+	{
+		PreloadShaderSources(g_ShaderDirectory);
+	});
+
+	// the metrics collector is started early so the load times
+	// are published, the viewer runs without it when the
+	// endpoint cannot be opened
+	startup.AddTask("start metrics", ANY, []()
+	{
+		METRICS_OPTIONS metricsOptions;
+		metricsOptions.port = g_MetricsPort;
+		metricsOptions.unixSocketPath = g_MetricsSocketPath;
+		metricsOptions.jsonLogPath = g_MetricsLogPath;
+		g_MetricsExporter = new MetricsExporter();
+		if (!g_MetricsExporter->Start(metricsOptions))
+		{
+			std::cout << "Metrics endpoint not opened, the frame statistics are not exported" << std::endl;
+			delete g_MetricsExporter;
+			g_MetricsExporter = NULL;
+		}
+	});
+
+	// the textures are uploaded on a thread with a context of its
+	// own, and on this thread when that context cannot be made
+	startup.AddTask("start resource uploader", CONTEXT, onContext([]()
+	{
+		g_ResourceUploader = new ResourceUploader();
+		if (!g_ResourceUploader->Initialize(g_Window))
+		{
+			std::cout << "Resource upload context not created, the textures are uploaded on the render thread" << std::endl;
+			delete g_ResourceUploader;
+			g_ResourceUploader = NULL;
+			return;
+		}
+		g_AssetStreamer->SetUploader(g_ResourceUploader);
+		g_ScenePreloader->SetUploader(g_ResourceUploader);
+	}), { initializeGLEW });
+
+	int createPlaceholders = startup.AddTask("create placeholders", CONTEXT, onContext([]()
+	{
+		g_AssetStreamer->CreatePlaceholders();
+	}), { initializeGLEW });
+
+	// the prepare steps keep their order, as some leave another
+	// program current and the materials set the lights of the
+	// main one - running on one thread they lose nothing by it,
+	// and the impostors are baked by the asset streamer once the
+	// real textures and meshes are in
+	int materials = startup.AddTask("prepare materials", CONTEXT,
+		prepareStep(SceneManager::PREPARE_MATERIALS), { loadShaders });
+	int proceduralTextures = startup.AddTask("bake procedural textures", CONTEXT,
+		prepareStep(SceneManager::PREPARE_PROCEDURAL_TEXTURES), { materials, preloadShaders });
+	int transparency = startup.AddTask("prepare transparency", CONTEXT,
+		prepareStep(SceneManager::PREPARE_TRANSPARENCY), { proceduralTextures });
+	int depthPrepass = startup.AddTask("prepare depth prepass", CONTEXT,
+		prepareStep(SceneManager::PREPARE_DEPTH_PREPASS), { transparency });
+	int deferred = startup.AddTask("prepare deferred", CONTEXT,
+		prepareStep(SceneManager::PREPARE_DEFERRED), { depthPrepass, createPlaceholders });
+	int multiView = startup.AddTask("prepare multi-view", CONTEXT,
+		prepareStep(SceneManager::PREPARE_MULTIVIEW), { deferred });
+
+	// the scene still renders when the overlay cannot be loaded
+	startup.AddTask("initialize HUD", CONTEXT, onContext([]()
+	{
+		g_PerformanceHUD = new PerformanceHUD();
+		if (!g_PerformanceHUD->Initialize())
+		{
+			std::cout << "Performance HUD shaders not loaded, the HUD is unavailable" << std::endl;
+			delete g_PerformanceHUD;
+			g_PerformanceHUD = NULL;
+		}
+	}), { multiView });
+
+	// one thread is left for the context
+	int workerCount = std::max(1, std::min(4, (int)std::thread::hardware_concurrency() - 1));
+	startup.Run(workerCount);
+	ClearPreloadedShaderSources();
+
+	std::vector<int> criticalPath;
+	startup.GetCriticalPath(criticalPath);
+	std::cout << "INFO: Startup took " << startup.GetTotalMilliseconds() << " ms on " << workerCount << " workers, critical path:";
+	for (size_t i = 0; i < criticalPath.size(); i++)
+	{
+		std::cout << ((i > 0) ? " > " : " ") << startup.GetTaskName(criticalPath[i])
+			<< " (" << startup.GetTaskMilliseconds(criticalPath[i]) << " ms)";
+	}
+	std::cout << std::endl;
+	startup.WriteTrace(g_StartupTracePath);
+
+	if (!bContextReady)
+	{
+		g_AssetStreamer->Cancel();
+		return(false);
+	}
+
+	if (NULL != g_MetricsExporter)
+	{
+		g_MetricsExporter->PublishLoadTime("startup", startup.GetTotalMilliseconds());
+	}
+
+	return(true);
+}
+
 /***********************************************************
  *	InitializeGLFW()
  * 
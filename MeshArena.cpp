@@ -0,0 +1,311 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.cpp
+// ============
+// static meshes suballocated from one vertex buffer and one index buffer
+// with a shared vertex format
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshArena.h"
+#include "GpuMemoryTracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+/***********************************************************
+ *  AppendMesh()
+ *
+ *  This function is used for adding a mesh to the end of the
+ *  passed in mesh data, with its indices kept relative to its
+ *  own first vertex.
+ ***********************************************************/
+void AppendMesh(MESH_DATA& data, const std::vector<MESH_VERTEX>& vertices, const std::vector<GLuint>& indices)
+{
+	MESH_RANGE range;
+	range.indexCount = (unsigned int)indices.size();
+	range.firstIndex = (unsigned int)data.indices.size();
+	range.baseVertex = (int)data.vertices.size();
+	range.vertexCount = (unsigned int)vertices.size();
+	data.ranges.push_back(range);
+
+	data.vertices.insert(data.vertices.end(), vertices.begin(), vertices.end());
+	data.indices.insert(data.indices.end(), indices.begin(), indices.end());
+}
+
+/***********************************************************
+ *  MeshArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshArena::MeshArena()
+{
+	m_vertexArray = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_vertexCapacity = 0;
+	m_indexCapacity = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+}
+
+/***********************************************************
+ *  ~MeshArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshArena::~MeshArena()
+{
+	TrackGpuMemory(GPU_MEMORY_BUFFER, -GetBytes());
+	if (0 != m_vertexArray)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+	GLuint buffers[2] = { m_vertexBuffer, m_indexBuffer };
+	glDeleteBuffers(2, buffers);
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_vertexCapacity = 0;
+	m_indexCapacity = 0;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the vertex and index
+ *  buffers with the passed in capacities, and the vertex
+ *  array that reads them.
+ ***********************************************************/
+bool MeshArena::Initialize(unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+	glGenVertexArrays(1, &m_vertexArray);
+	glGenBuffers(1, &m_vertexBuffer);
+	glGenBuffers(1, &m_indexBuffer);
+	if ((0 == m_vertexArray) || (0 == m_vertexBuffer) || (0 == m_indexBuffer))
+	{
+		std::cout << "Failed to create the mesh arena buffers" << std::endl;
+		return(false);
+	}
+
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * sizeof(MESH_VERTEX), NULL, GL_STATIC_DRAW);
+	// the index buffer binding is part of the vertex array
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+	SetVertexFormat();
+
+	glBindVertexArray(previousVertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_vertexCapacity = vertexCapacity;
+	m_indexCapacity = indexCapacity;
+	TrackGpuMemory(GPU_MEMORY_BUFFER, GetBytes());
+	return(true);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for copying a mesh into the free end
+ *  of the buffers.  The indices stay relative to the first
+ *  vertex of the mesh, which is passed as the base vertex
+ *  when it is drawn.
+ ***********************************************************/
+int MeshArena::AddMesh(const std::vector<MESH_VERTEX>& vertices, const std::vector<GLuint>& indices)
+{
+	if (vertices.empty() || indices.empty())
+	{
+		return(-1);
+	}
+
+	MESH_RANGE range;
+	range.indexCount = (unsigned int)indices.size();
+	range.firstIndex = 0;
+	range.baseVertex = 0;
+	range.vertexCount = (unsigned int)vertices.size();
+	return(AddRanges(&vertices[0], range.vertexCount, &indices[0], range.indexCount, &range, 1));
+}
+
+/***********************************************************
+ *  AddMeshes()
+ *
+ *  This method is used for copying a set of meshes into the
+ *  free end of the buffers, all the vertices and all the
+ *  indices in one upload each.
+ ***********************************************************/
+int MeshArena::AddMeshes(const MESH_DATA& data)
+{
+	if (data.vertices.empty() || data.indices.empty() || data.ranges.empty())
+	{
+		return(-1);
+	}
+
+	return(AddRanges(&data.vertices[0], (unsigned int)data.vertices.size(),
+		&data.indices[0], (unsigned int)data.indices.size(),
+		&data.ranges[0], (unsigned int)data.ranges.size()));
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the vertex array of the
+ *  arena, which every mesh in it is drawn with.
+ ***********************************************************/
+void MeshArena::Bind() const
+{
+	glBindVertexArray(m_vertexArray);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing one mesh of the arena.
+ ***********************************************************/
+void MeshArena::Draw(int mesh) const
+{
+	if ((mesh < 0) || (mesh >= (int)m_ranges.size()))
+	{
+		return;
+	}
+
+	const MESH_RANGE& range = m_ranges[mesh];
+	glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+		(void*)((size_t)range.firstIndex * sizeof(GLuint)), range.baseVertex);
+}
+
+/***********************************************************
+ *  GetBytes()
+ *
+ *  This method is used for getting the size of the buffers.
+ ***********************************************************/
+long long MeshArena::GetBytes() const
+{
+	return((long long)m_vertexCapacity * sizeof(MESH_VERTEX) + (long long)m_indexCapacity * sizeof(GLuint));
+}
+
+/***********************************************************
+ *  AddRanges()
+ *
+ *  This method is used for uploading vertices and indices to
+ *  the free end of the buffers, growing them when needed, and
+ *  keeping the passed in ranges offset to where they landed.
+ ***********************************************************/
+int MeshArena::AddRanges(
+	const MESH_VERTEX* pVertices,
+	unsigned int vertexCount,
+	const GLuint* pIndices,
+	unsigned int indexCount,
+	const MESH_RANGE* pRanges,
+	unsigned int rangeCount)
+{
+	if (0 == m_vertexArray)
+	{
+		return(-1);
+	}
+
+	if ((m_vertexCount + vertexCount > m_vertexCapacity) || (m_indexCount + indexCount > m_indexCapacity))
+	{
+		// at least double, so adding many meshes stays linear
+		unsigned int newVertexCapacity = std::max(m_vertexCapacity * 2, m_vertexCount + vertexCount);
+		unsigned int newIndexCapacity = std::max(m_indexCapacity * 2, m_indexCount + indexCount);
+		if (!Grow(newVertexCapacity, newIndexCapacity))
+		{
+			return(-1);
+		}
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m_vertexCount * sizeof(MESH_VERTEX),
+		(GLsizeiptr)vertexCount * sizeof(MESH_VERTEX), pVertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m_indexCount * sizeof(GLuint),
+		(GLsizeiptr)indexCount * sizeof(GLuint), pIndices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	int first = (int)m_ranges.size();
+	for (unsigned int i = 0; i < rangeCount; i++)
+	{
+		MESH_RANGE range = pRanges[i];
+		range.firstIndex += m_indexCount;
+		range.baseVertex += (int)m_vertexCount;
+		m_ranges.push_back(range);
+	}
+
+	m_vertexCount += vertexCount;
+	m_indexCount += indexCount;
+	return(first);
+}
+
+/***********************************************************
+ *  Grow()
+ *
+ *  This method is used for moving the meshes into larger
+ *  buffers.  The used parts are copied on the GPU and the
+ *  vertex array is pointed at the new buffers, so the ranges
+ *  handed out before stay valid.
+ ***********************************************************/
+bool MeshArena::Grow(unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+	GLuint buffers[2] = { 0, 0 };
+	glGenBuffers(2, buffers);
+	if ((0 == buffers[0]) || (0 == buffers[1]))
+	{
+		std::cout << "Failed to grow the mesh arena" << std::endl;
+		return(false);
+	}
+
+	long long oldBytes = GetBytes();
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * sizeof(MESH_VERTEX), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)m_vertexCount * sizeof(MESH_VERTEX));
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)m_indexCount * sizeof(GLuint));
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	GLuint oldBuffers[2] = { m_vertexBuffer, m_indexBuffer };
+	glDeleteBuffers(2, oldBuffers);
+	m_vertexBuffer = buffers[0];
+	m_indexBuffer = buffers[1];
+	m_vertexCapacity = vertexCapacity;
+	m_indexCapacity = indexCapacity;
+
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	SetVertexFormat();
+	glBindVertexArray(previousVertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	TrackGpuMemory(GPU_MEMORY_BUFFER, GetBytes() - oldBytes);
+	return(true);
+}
+
+/***********************************************************
+ *  SetVertexFormat()
+ *
+ *  This method is used for pointing the attributes of the
+ *  bound vertex array at the bound vertex buffer.
+ ***********************************************************/
+void MeshArena::SetVertexFormat()
+{
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, normal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, textureCoordinate));
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.h
+// ============
+// static meshes suballocated from one vertex buffer and one index buffer
+// with a shared vertex format
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  MESH_VERTEX
+ *
+ *  The vertex format shared by every mesh in the arena, with
+ *  the attribute locations the scene shaders expect - the
+ *  position at 0, the normal at 1 and the texture coordinate
+ *  at 2.
+ ***********************************************************/
+struct MESH_VERTEX
+{
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 textureCoordinate;
+};
+
+/***********************************************************
+ *  MESH_RANGE
+ *
+ *  Where a mesh lives in the arena.  The first three fields
+ *  are in the order of a CULL_MESH, so the ranges can go
+ *  straight into an indirect draw.
+ ***********************************************************/
+struct MESH_RANGE
+{
+	unsigned int indexCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int vertexCount;
+};
+
+/***********************************************************
+ *  MESH_DATA
+ *
+ *  The geometry of a set of meshes laid out one after the
+ *  other, as it is uploaded into the arena.  The ranges are
+ *  relative to the start of these arrays.
+ ***********************************************************/
+struct MESH_DATA
+{
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<GLuint> indices;
+	std::vector<MESH_RANGE> ranges;
+};
+
+// append a mesh to the end of the passed in mesh data
+void AppendMesh(MESH_DATA& data, const std::vector<MESH_VERTEX>& vertices, const std::vector<GLuint>& indices);
+
+/***********************************************************
+ *  MeshArena
+ *
+ *  This class keeps static triangle meshes in one vertex
+ *  buffer and one index buffer behind a single vertex array.
+ *  A mesh is added once, gets the next free range of both
+ *  buffers, and is drawn with glDrawElementsBaseVertex, so
+ *  with the vertex array bound no state changes between the
+ *  draws of different meshes.  The buffers grow by copying
+ *  on the GPU when a mesh does not fit.
+ ***********************************************************/
+class MeshArena
+{
+public:
+	// constructor
+	MeshArena();
+	// destructor
+	~MeshArena();
+
+	// starting sizes of the buffers
+	static const unsigned int DEFAULT_VERTEX_CAPACITY = 16384;
+	static const unsigned int DEFAULT_INDEX_CAPACITY = 49152;
+
+	// create the buffers and the vertex array
+	bool Initialize(
+		unsigned int vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+		unsigned int indexCapacity = DEFAULT_INDEX_CAPACITY);
+
+	// copy a mesh into the arena, returning its index, or -1
+	// when it could not be added
+	int AddMesh(const std::vector<MESH_VERTEX>& vertices, const std::vector<GLuint>& indices);
+	// copy a set of meshes into the arena with one upload per
+	// buffer, returning the index of the first, or -1
+	int AddMeshes(const MESH_DATA& data);
+
+	// bind the vertex array, once before any number of draws
+	void Bind() const;
+	// draw a mesh, with the arena bound
+	void Draw(int mesh) const;
+
+	const MESH_RANGE& GetRange(int mesh) const { return m_ranges[mesh]; }
+	int GetMeshCount() const { return (int)m_ranges.size(); }
+	GLuint GetVertexArray() const { return m_vertexArray; }
+	// bytes of both buffers, used or not
+	long long GetBytes() const;
+
+private:
+	GLuint m_vertexArray;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+	unsigned int m_vertexCapacity;
+	unsigned int m_indexCapacity;
+	unsigned int m_vertexCount;
+	unsigned int m_indexCount;
+	std::vector<MESH_RANGE> m_ranges;
+
+	int AddRanges(
+		const MESH_VERTEX* pVertices,
+		unsigned int vertexCount,
+		const GLuint* pIndices,
+		unsigned int indexCount,
+		const MESH_RANGE* pRanges,
+		unsigned int rangeCount);
+	bool Grow(unsigned int vertexCapacity, unsigned int indexCapacity);
+	void SetVertexFormat();
+};
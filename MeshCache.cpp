@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// store generated mesh data on disk, so later runs only read it back and
+// upload it instead of generating it again
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+#include "AssetPack.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char g_MeshCacheMagic[4] = { 'M', 'S', 'H', 'C' };
+	const uint32_t MESH_CACHE_VERSION = 1;
+
+	/***********************************************************
+	 *  MESH_CACHE_HEADER
+	 *
+	 *  The start of a cache file, followed by the ranges, the
+	 *  vertices and the indices.  The vertex size guards against
+	 *  a file from a build with another vertex format.
+	 ***********************************************************/
+	struct MESH_CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t contentVersion;
+		uint32_t vertexSize;
+		uint32_t rangeCount;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+	};
+
+	/***********************************************************
+	 *  IsMeshDataValid()
+	 *
+	 *  This function is used for checking that every range and
+	 *  index read from a file stays inside the data, so a bad
+	 *  file cannot make a draw read past the buffers.
+	 ***********************************************************/
+	bool IsMeshDataValid(const MESH_DATA& data)
+	{
+		for (size_t i = 0; i < data.ranges.size(); i++)
+		{
+			const MESH_RANGE& range = data.ranges[i];
+			if ((range.baseVertex < 0) ||
+				((size_t)range.baseVertex + range.vertexCount > data.vertices.size()) ||
+				((size_t)range.firstIndex + range.indexCount > data.indices.size()))
+			{
+				return(false);
+			}
+			for (unsigned int index = 0; index < range.indexCount; index++)
+			{
+				if (data.indices[range.firstIndex + index] >= range.vertexCount)
+				{
+					return(false);
+				}
+			}
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  ReadMeshCacheData()
+ *
+ *  This function is used for reading mesh data from the
+ *  contents of a cache file that are already in memory.
+ ***********************************************************/
+bool ReadMeshCacheData(
+	const unsigned char* contents,
+	size_t size,
+	unsigned int contentVersion,
+	MESH_DATA& data,
+	const char* filename)
+{
+	MESH_CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	if (size >= sizeof(header))
+	{
+		memcpy(&header, contents, sizeof(header));
+	}
+	if ((memcmp(header.magic, g_MeshCacheMagic, sizeof(g_MeshCacheMagic)) != 0) ||
+		(header.version != MESH_CACHE_VERSION) ||
+		(header.contentVersion != contentVersion) ||
+		(header.vertexSize != sizeof(MESH_VERTEX)))
+	{
+		std::cout << "Mesh cache is out of date:" << filename << std::endl;
+		return(false);
+	}
+
+	size_t rangeBytes = (size_t)header.rangeCount * sizeof(MESH_RANGE);
+	size_t vertexBytes = (size_t)header.vertexCount * sizeof(MESH_VERTEX);
+	size_t indexBytes = (size_t)header.indexCount * sizeof(GLuint);
+	if (size != sizeof(header) + rangeBytes + vertexBytes + indexBytes)
+	{
+		std::cout << "Mesh cache is damaged:" << filename << std::endl;
+		return(false);
+	}
+
+	const unsigned char* read = contents + sizeof(header);
+	data.ranges.resize(header.rangeCount);
+	memcpy(data.ranges.data(), read, rangeBytes);
+	read += rangeBytes;
+	data.vertices.resize(header.vertexCount);
+	memcpy(data.vertices.data(), read, vertexBytes);
+	read += vertexBytes;
+	data.indices.resize(header.indexCount);
+	memcpy(data.indices.data(), read, indexBytes);
+	if (!IsMeshDataValid(data))
+	{
+		std::cout << "Mesh cache is damaged:" << filename << std::endl;
+		data = MESH_DATA();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadMeshCache()
+ *
+ *  This function is used for reading back mesh data that was
+ *  written to a cache file.  The copy in the asset pack is
+ *  used when there is one for this content version, and the
+ *  loose file otherwise, as that is where a cache written by
+ *  a newer build ends up.
+ ***********************************************************/
+bool ReadMeshCache(const char* filename, unsigned int contentVersion, MESH_DATA& data)
+{
+	ASSET_DATA asset;
+	if (LoadPackedAsset(filename, asset) &&
+		ReadMeshCacheData(asset.pData, asset.size, contentVersion, data, filename))
+	{
+		return(true);
+	}
+
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return(false);
+	}
+	std::vector<unsigned char> contents((size_t)file.tellg());
+	file.seekg(0);
+	file.read((char*)contents.data(), contents.size());
+	if (!file)
+	{
+		std::cout << "Mesh cache is damaged:" << filename << std::endl;
+		return(false);
+	}
+
+	return(ReadMeshCacheData(contents.data(), contents.size(), contentVersion, data, filename));
+}
+
+/***********************************************************
+ *  WriteMeshCache()
+ *
+ *  This function is used for writing mesh data to a cache
+ *  file.  The file is written under a temporary name and then
+ *  renamed, so a run that stops part way never leaves a half
+ *  written cache behind.
+ ***********************************************************/
+bool WriteMeshCache(const char* filename, unsigned int contentVersion, const MESH_DATA& data)
+{
+	MESH_CACHE_HEADER header;
+	memcpy(header.magic, g_MeshCacheMagic, sizeof(g_MeshCacheMagic));
+	header.version = MESH_CACHE_VERSION;
+	header.contentVersion = contentVersion;
+	header.vertexSize = sizeof(MESH_VERTEX);
+	header.rangeCount = (uint32_t)data.ranges.size();
+	header.vertexCount = (uint32_t)data.vertices.size();
+	header.indexCount = (uint32_t)data.indices.size();
+
+	std::string temporaryName = std::string(filename) + ".tmp";
+	{
+		std::ofstream file(temporaryName.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			std::cout << "Could not write mesh cache:" << filename << std::endl;
+			return(false);
+		}
+
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)data.ranges.data(), data.ranges.size() * sizeof(MESH_RANGE));
+		file.write((const char*)data.vertices.data(), data.vertices.size() * sizeof(MESH_VERTEX));
+		file.write((const char*)data.indices.data(), data.indices.size() * sizeof(GLuint));
+		if (!file)
+		{
+			std::cout << "Could not write mesh cache:" << filename << std::endl;
+			return(false);
+		}
+	}
+
+	// rename does not replace an existing file on every platform
+	std::remove(filename);
+	if (0 != std::rename(temporaryName.c_str(), filename))
+	{
+		std::cout << "Could not write mesh cache:" << filename << std::endl;
+		std::remove(temporaryName.c_str());
+		return(false);
+	}
+
+	return(true);
+}
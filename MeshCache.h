@@ -0,0 +1,27 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// store generated mesh data on disk, so later runs only read it back and
+// upload it instead of generating it again
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshArena.h"
+
+// read mesh data written by WriteMeshCache(), failing when the file is
+// missing, damaged or was written for another content version
+bool ReadMeshCache(const char* filename, unsigned int contentVersion, MESH_DATA& data);
+// the same for the contents of a cache file already read into memory,
+// with the file name used in the messages
+bool ReadMeshCacheData(
+	const unsigned char* contents,
+	size_t size,
+	unsigned int contentVersion,
+	MESH_DATA& data,
+	const char* filename);
+
+// write mesh data to a cache file, tagged with the version of the code
+// that generated it
+bool WriteMeshCache(const char* filename, unsigned int contentVersion, const MESH_DATA& data);
@@ -0,0 +1,636 @@
+///////////////////////////////////////////////////////////////////////////////
+// metricsexporter.cpp
+// ============
+// publish the per-frame statistics in the Prometheus text format and
+// to an optional JSON-lines log, collected off the render thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MetricsExporter.h"
+#include "GpuMemoryTracker.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+#ifdef _WIN32
+	typedef SOCKET SOCKET_HANDLE;
+	const SOCKET_HANDLE NO_SOCKET = INVALID_SOCKET;
+	void CloseSocket(SOCKET_HANDLE handle) { closesocket(handle); }
+#else
+	typedef int SOCKET_HANDLE;
+	const SOCKET_HANDLE NO_SOCKET = -1;
+	void CloseSocket(SOCKET_HANDLE handle) { close(handle); }
+#endif
+
+	// a scraper that hangs up early must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+	const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+	const int SEND_FLAGS = 0;
+#endif
+
+	// records in flight between the render and collector
+	// threads, a power of two so the index wraps with a mask
+	const size_t RING_CAPACITY = 1024;
+
+	// how long the collector waits for a connection before it
+	// drains the ring again
+	const int COLLECT_INTERVAL_MICROSECONDS = 20000;
+
+	// upper bounds of the frame time histogram buckets in
+	// seconds, with +Inf implied after the last
+	const double FRAME_TIME_BUCKETS[] =
+	{
+		0.002, 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25
+	};
+	const int FRAME_TIME_BUCKET_COUNT = (int)(sizeof(FRAME_TIME_BUCKETS) / sizeof(FRAME_TIME_BUCKETS[0]));
+
+	/***********************************************************
+	 *  EscapeLabel()
+	 *
+	 *  This function is used for escaping a string for use as a
+	 *  Prometheus label value or a JSON string, which share the
+	 *  backslash, quote and newline escapes.
+	 ***********************************************************/
+	std::string EscapeLabel(const std::string& value)
+	{
+		std::string escaped;
+		escaped.reserve(value.size());
+		for (size_t i = 0; i < value.size(); i++)
+		{
+			char character = value[i];
+			if ((character == '\\') || (character == '"'))
+			{
+				escaped += '\\';
+				escaped += character;
+			}
+			else if (character == '\n')
+			{
+				escaped += "\\n";
+			}
+			else
+			{
+				escaped += character;
+			}
+		}
+
+		return(escaped);
+	}
+
+	/***********************************************************
+	 *  AppendMetric()
+	 *
+	 *  This function is used for appending the help and type
+	 *  lines of a metric family to the exposition text.
+	 ***********************************************************/
+	void AppendMetric(std::string& text, const char* name, const char* type, const char* help)
+	{
+		text += "# HELP ";
+		text += name;
+		text += " ";
+		text += help;
+		text += "\n# TYPE ";
+		text += name;
+		text += " ";
+		text += type;
+		text += "\n";
+	}
+
+	/***********************************************************
+	 *  AppendSample()
+	 *
+	 *  This function is used for appending one sample line, with
+	 *  an optional label, to the exposition text.
+	 ***********************************************************/
+	void AppendSample(std::string& text, const char* name, const char* label, double value)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "%s%s %.9g\n", name, label, value);
+		text += line;
+	}
+}
+
+/***********************************************************
+ *  MetricsExporter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MetricsExporter::MetricsExporter()
+{
+	m_ring.resize(RING_CAPACITY);
+	m_writeIndex = 0;
+	m_readIndex = 0;
+	m_droppedRecords = 0;
+	m_bRunning = false;
+	m_listenSocket = (long long)NO_SOCKET;
+	m_frameTimeBuckets.assign(FRAME_TIME_BUCKET_COUNT + 1, 0);
+	m_frameTimeSumSeconds = 0.0;
+	m_frames = 0;
+	m_drawCallsTotal = 0;
+	m_lastFrameStats = SceneManager::FRAME_STATS();
+	m_bHasLastFrame = false;
+}
+
+/***********************************************************
+ *  ~MetricsExporter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MetricsExporter::~MetricsExporter()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for opening the metrics endpoint and
+ *  the optional log, then starting the collector thread.
+ ***********************************************************/
+bool MetricsExporter::Start(const METRICS_OPTIONS& options)
+{
+	if (m_bRunning)
+	{
+		return(true);
+	}
+
+	m_options = options;
+	if (!OpenEndpoint())
+	{
+		return(false);
+	}
+
+	if (!m_options.jsonLogPath.empty())
+	{
+		m_jsonLog.open(m_options.jsonLogPath.c_str(), std::ios::out | std::ios::app);
+		if (!m_jsonLog.is_open())
+		{
+			std::cout << "Could not open metrics log:" << m_options.jsonLogPath << std::endl;
+		}
+	}
+
+	m_bRunning = true;
+	m_collector = std::thread(&MetricsExporter::CollectorLoop, this);
+
+	if (m_options.unixSocketPath.empty())
+	{
+		std::cout << "INFO: Serving metrics on http://127.0.0.1:" << m_options.port << "/metrics" << std::endl;
+	}
+	else
+	{
+		std::cout << "INFO: Serving metrics on unix socket " << m_options.unixSocketPath << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the collector thread
+ *  after it has drained the last records, then closing the
+ *  endpoint and the log.
+ ***********************************************************/
+void MetricsExporter::Stop()
+{
+	if (m_bRunning)
+	{
+		m_bRunning = false;
+		m_collector.join();
+	}
+
+	CloseEndpoint();
+	if (m_jsonLog.is_open())
+	{
+		m_jsonLog.close();
+	}
+}
+
+/***********************************************************
+ *  PushRecord()
+ *
+ *  This method is used for copying a record into the ring
+ *  from the render thread.  The slot is written before the
+ *  write index is released, so the collector never reads a
+ *  partly written record.
+ ***********************************************************/
+bool MetricsExporter::PushRecord(const METRICS_RECORD& record)
+{
+	size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+	if (writeIndex - readIndex >= RING_CAPACITY)
+	{
+		m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+		return(false);
+	}
+
+	m_ring[writeIndex & (RING_CAPACITY - 1)] = record;
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+
+	return(true);
+}
+
+/***********************************************************
+ *  PublishFrame()
+ *
+ *  This method is used for handing the counters of a frame
+ *  to the collector.  The frame time is worked out by the
+ *  collector from the timestamps of consecutive frames.
+ ***********************************************************/
+void MetricsExporter::PublishFrame(const SceneManager::FRAME_STATS& frameStats)
+{
+	if (!m_bRunning)
+	{
+		return;
+	}
+
+	METRICS_RECORD record;
+	record.type = RECORD_FRAME;
+	record.timestamp = std::chrono::steady_clock::now();
+	record.frameStats = frameStats;
+	record.name[0] = '\0';
+	record.milliseconds = 0.0;
+	PushRecord(record);
+}
+
+/***********************************************************
+ *  PublishLoadTime()
+ *
+ *  This method is used for handing the load time of a named
+ *  asset to the collector.  Long names are truncated.
+ ***********************************************************/
+void MetricsExporter::PublishLoadTime(const std::string& name, double milliseconds)
+{
+	if (!m_bRunning)
+	{
+		return;
+	}
+
+	METRICS_RECORD record;
+	record.type = RECORD_LOAD_TIME;
+	record.timestamp = std::chrono::steady_clock::now();
+	record.frameStats = SceneManager::FRAME_STATS();
+	strncpy(record.name, name.c_str(), sizeof(record.name) - 1);
+	record.name[sizeof(record.name) - 1] = '\0';
+	record.milliseconds = milliseconds;
+	PushRecord(record);
+}
+
+/***********************************************************
+ *  OpenEndpoint()
+ *
+ *  This method is used for opening the listening socket,
+ *  either a Unix domain socket or a TCP socket bound to the
+ *  loopback address so the metrics are not exposed remotely.
+ ***********************************************************/
+bool MetricsExporter::OpenEndpoint()
+{
+#ifdef _WIN32
+	WSADATA wsaData;
+	if (0 != WSAStartup(MAKEWORD(2, 2), &wsaData))
+	{
+		std::cout << "Could not initialize sockets for the metrics endpoint" << std::endl;
+		return(false);
+	}
+	if (!m_options.unixSocketPath.empty())
+	{
+		std::cout << "Unix domain sockets are not supported here, use the TCP port for metrics" << std::endl;
+		WSACleanup();
+		return(false);
+	}
+#endif
+
+	SOCKET_HANDLE listenSocket = NO_SOCKET;
+	int bindResult = -1;
+
+#ifndef _WIN32
+	if (!m_options.unixSocketPath.empty())
+	{
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		if (m_options.unixSocketPath.size() >= sizeof(address.sun_path))
+		{
+			std::cout << "Metrics socket path is too long:" << m_options.unixSocketPath << std::endl;
+			return(false);
+		}
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, m_options.unixSocketPath.c_str(), sizeof(address.sun_path) - 1);
+
+		// a socket file left by an earlier run would fail the bind
+		unlink(m_options.unixSocketPath.c_str());
+		listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (NO_SOCKET != listenSocket)
+		{
+			bindResult = bind(listenSocket, (sockaddr*)&address, sizeof(address));
+		}
+	}
+	else
+#endif
+	{
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons((unsigned short)m_options.port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (NO_SOCKET != listenSocket)
+		{
+			int reuse = 1;
+			setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+			bindResult = bind(listenSocket, (sockaddr*)&address, sizeof(address));
+		}
+	}
+
+	if ((NO_SOCKET == listenSocket) || (0 != bindResult) || (0 != listen(listenSocket, 4)))
+	{
+		std::cout << "Could not open the metrics endpoint" << std::endl;
+		if (NO_SOCKET != listenSocket)
+		{
+			CloseSocket(listenSocket);
+		}
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return(false);
+	}
+
+	m_listenSocket = (long long)listenSocket;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CloseEndpoint()
+ *
+ *  This method is used for closing the listening socket and
+ *  removing the socket file of a Unix domain endpoint.
+ ***********************************************************/
+void MetricsExporter::CloseEndpoint()
+{
+	if ((long long)NO_SOCKET == m_listenSocket)
+	{
+		return;
+	}
+
+	CloseSocket((SOCKET_HANDLE)m_listenSocket);
+	m_listenSocket = (long long)NO_SOCKET;
+#ifdef _WIN32
+	WSACleanup();
+#else
+	if (!m_options.unixSocketPath.empty())
+	{
+		unlink(m_options.unixSocketPath.c_str());
+	}
+#endif
+}
+
+/***********************************************************
+ *  CollectorLoop()
+ *
+ *  This method is the body of the collector thread.  It waits
+ *  a short time for a scrape, answers it if one came in and
+ *  drains the ring, until it is stopped.
+ ***********************************************************/
+void MetricsExporter::CollectorLoop()
+{
+	SOCKET_HANDLE listenSocket = (SOCKET_HANDLE)m_listenSocket;
+
+	while (m_bRunning.load(std::memory_order_acquire))
+	{
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(listenSocket, &readSet);
+		timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = COLLECT_INTERVAL_MICROSECONDS;
+
+		// the records are drained before answering so the scrape
+		// sees the latest frame
+		int ready = select((int)listenSocket + 1, &readSet, NULL, NULL, &timeout);
+		DrainRecords();
+		if ((ready > 0) && FD_ISSET(listenSocket, &readSet))
+		{
+			ServeConnection();
+		}
+	}
+
+	DrainRecords();
+	if (m_jsonLog.is_open())
+	{
+		m_jsonLog.flush();
+	}
+}
+
+/***********************************************************
+ *  DrainRecords()
+ *
+ *  This method is used for taking every queued record out of
+ *  the ring on the collector thread.
+ ***********************************************************/
+void MetricsExporter::DrainRecords()
+{
+	size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+	size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+	while (readIndex != writeIndex)
+	{
+		ProcessRecord(m_ring[readIndex & (RING_CAPACITY - 1)]);
+		readIndex++;
+		m_readIndex.store(readIndex, std::memory_order_release);
+	}
+}
+
+/***********************************************************
+ *  ProcessRecord()
+ *
+ *  This method is used for folding one record into the
+ *  aggregates and writing it to the JSON-lines log.
+ ***********************************************************/
+void MetricsExporter::ProcessRecord(const METRICS_RECORD& record)
+{
+	char line[512];
+
+	if (record.type == RECORD_LOAD_TIME)
+	{
+		LOAD_TIME loadTime;
+		loadTime.name = record.name;
+		loadTime.milliseconds = record.milliseconds;
+		m_loadTimes.push_back(loadTime);
+
+		if (m_jsonLog.is_open())
+		{
+			snprintf(line, sizeof(line), "{\"type\":\"load\",\"asset\":\"%s\",\"ms\":%.3f}\n",
+				EscapeLabel(loadTime.name).c_str(), loadTime.milliseconds);
+			m_jsonLog << line;
+		}
+		return;
+	}
+
+	// the first frame only starts the clock
+	double frameSeconds = 0.0;
+	bool bHasFrameTime = m_bHasLastFrame;
+	if (bHasFrameTime)
+	{
+		frameSeconds = std::chrono::duration<double>(record.timestamp - m_lastFrameTime).count();
+		int bucket = 0;
+		while ((bucket < FRAME_TIME_BUCKET_COUNT) && (frameSeconds > FRAME_TIME_BUCKETS[bucket]))
+		{
+			bucket++;
+		}
+		m_frameTimeBuckets[bucket]++;
+		m_frameTimeSumSeconds += frameSeconds;
+	}
+	m_lastFrameTime = record.timestamp;
+	m_bHasLastFrame = true;
+
+	m_frames++;
+	m_drawCallsTotal += (unsigned long long)record.frameStats.drawCalls;
+	m_lastFrameStats = record.frameStats;
+
+	if (m_jsonLog.is_open())
+	{
+		const SceneManager::FRAME_STATS& stats = record.frameStats;
+		snprintf(line, sizeof(line),
+			"{\"type\":\"frame\",\"frame\":%llu,\"frame_ms\":%.3f,\"draw_calls\":%d,\"state_changes\":%d,"
+			"\"visible\":%d,\"culled\":%d,\"gpu_culled\":%d,\"opaque_gpu_ms\":%.3f,\"transparent_gpu_ms\":%.3f,"
+			"\"texture_bytes\":%lld,\"buffer_bytes\":%lld}\n",
+			m_frames, frameSeconds * 1000.0, stats.drawCalls, stats.stateChanges,
+			stats.visibleObjects, stats.culledObjects, stats.gpuCulledObjects, stats.opaqueGpuMilliseconds, stats.transparentGpuMilliseconds,
+			GetGpuMemory(GPU_MEMORY_TEXTURE), GetGpuMemory(GPU_MEMORY_BUFFER));
+		m_jsonLog << line;
+	}
+}
+
+/***********************************************************
+ *  ServeConnection()
+ *
+ *  This method is used for accepting one connection and
+ *  answering it with the metrics.  Any request is answered
+ *  the same way, so only the request head is read.
+ ***********************************************************/
+void MetricsExporter::ServeConnection()
+{
+	SOCKET_HANDLE connection = accept((SOCKET_HANDLE)m_listenSocket, NULL, NULL);
+	if (NO_SOCKET == connection)
+	{
+		return;
+	}
+
+	// a client that connects without sending is not waited on
+	// for longer than one collect interval
+#ifdef _WIN32
+	DWORD receiveTimeout = COLLECT_INTERVAL_MICROSECONDS / 1000;
+#else
+	timeval receiveTimeout;
+	receiveTimeout.tv_sec = 0;
+	receiveTimeout.tv_usec = COLLECT_INTERVAL_MICROSECONDS;
+#endif
+	setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, (const char*)&receiveTimeout, sizeof(receiveTimeout));
+
+	char request[1024];
+	recv(connection, request, sizeof(request), 0);
+
+	std::string body = FormatMetrics();
+	char header[256];
+	snprintf(header, sizeof(header),
+		"HTTP/1.1 200 OK\r\n"
+		"Content-Type: text/plain; version=0.0.4\r\n"
+		"Content-Length: %zu\r\n"
+		"Connection: close\r\n\r\n", body.size());
+	std::string response = std::string(header) + body;
+
+	size_t sent = 0;
+	while (sent < response.size())
+	{
+		int result = (int)send(connection, response.data() + sent, (int)(response.size() - sent), SEND_FLAGS);
+		if (result <= 0)
+		{
+			break;
+		}
+		sent += (size_t)result;
+	}
+
+	CloseSocket(connection);
+}
+
+/***********************************************************
+ *  FormatMetrics()
+ *
+ *  This method is used for writing the aggregates out in the
+ *  Prometheus text exposition format.
+ ***********************************************************/
+std::string MetricsExporter::FormatMetrics() const
+{
+	std::string text;
+	char label[128];
+	text.reserve(4096);
+
+	AppendMetric(text, "viewer_frame_time_seconds", "histogram", "Wall clock time between rendered frames.");
+	unsigned long long cumulative = 0;
+	for (int i = 0; i <= FRAME_TIME_BUCKET_COUNT; i++)
+	{
+		cumulative += m_frameTimeBuckets[i];
+		if (i < FRAME_TIME_BUCKET_COUNT)
+		{
+			snprintf(label, sizeof(label), "{le=\"%g\"}", FRAME_TIME_BUCKETS[i]);
+		}
+		else
+		{
+			snprintf(label, sizeof(label), "{le=\"+Inf\"}");
+		}
+		AppendSample(text, "viewer_frame_time_seconds_bucket", label, (double)cumulative);
+	}
+	AppendSample(text, "viewer_frame_time_seconds_sum", "", m_frameTimeSumSeconds);
+	AppendSample(text, "viewer_frame_time_seconds_count", "", (double)cumulative);
+
+	AppendMetric(text, "viewer_frames_total", "counter", "Frames rendered.");
+	AppendSample(text, "viewer_frames_total", "", (double)m_frames);
+	AppendMetric(text, "viewer_draw_calls_total", "counter", "Mesh draw calls issued.");
+	AppendSample(text, "viewer_draw_calls_total", "", (double)m_drawCallsTotal);
+
+	AppendMetric(text, "viewer_draw_calls", "gauge", "Mesh draw calls in the last frame.");
+	AppendSample(text, "viewer_draw_calls", "", m_lastFrameStats.drawCalls);
+	AppendMetric(text, "viewer_state_changes", "gauge", "Program, texture or material changes in the last frame.");
+	AppendSample(text, "viewer_state_changes", "", m_lastFrameStats.stateChanges);
+	AppendMetric(text, "viewer_objects", "gauge", "Scene objects in the last frame by culling result.");
+	AppendSample(text, "viewer_objects", "{state=\"visible\"}", m_lastFrameStats.visibleObjects);
+	AppendSample(text, "viewer_objects", "{state=\"culled\"}", m_lastFrameStats.culledObjects);
+	AppendSample(text, "viewer_objects", "{state=\"gpu_culled\"}", m_lastFrameStats.gpuCulledObjects);
+
+	AppendMetric(text, "viewer_gpu_pass_seconds", "gauge", "GPU time of the last measured frame by pass.");
+	AppendSample(text, "viewer_gpu_pass_seconds", "{pass=\"opaque\"}", m_lastFrameStats.opaqueGpuMilliseconds / 1000.0);
+	AppendSample(text, "viewer_gpu_pass_seconds", "{pass=\"transparent\"}", m_lastFrameStats.transparentGpuMilliseconds / 1000.0);
+
+	AppendMetric(text, "viewer_gpu_memory_bytes", "gauge", "Tracked GPU memory by kind of allocation.");
+	AppendSample(text, "viewer_gpu_memory_bytes", "{kind=\"texture\"}", (double)GetGpuMemory(GPU_MEMORY_TEXTURE));
+	AppendSample(text, "viewer_gpu_memory_bytes", "{kind=\"buffer\"}", (double)GetGpuMemory(GPU_MEMORY_BUFFER));
+
+	AppendMetric(text, "viewer_load_seconds", "gauge", "Time taken to load each asset.");
+	for (size_t i = 0; i < m_loadTimes.size(); i++)
+	{
+		snprintf(label, sizeof(label), "{asset=\"%s\"}", EscapeLabel(m_loadTimes[i].name).c_str());
+		AppendSample(text, "viewer_load_seconds", label, m_loadTimes[i].milliseconds / 1000.0);
+	}
+
+	AppendMetric(text, "viewer_metrics_dropped_total", "counter", "Records dropped because the collector fell behind.");
+	AppendSample(text, "viewer_metrics_dropped_total", "", (double)m_droppedRecords.load(std::memory_order_relaxed));
+
+	return(text);
+}
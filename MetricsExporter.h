@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// metricsexporter.h
+// ============
+// publish the per-frame statistics in the Prometheus text format and
+// to an optional JSON-lines log, collected off the render thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  METRICS_OPTIONS
+ *
+ *  Where the metrics are served and logged.
+ ***********************************************************/
+struct METRICS_OPTIONS
+{
+	// serve on this Unix domain socket path instead of TCP
+	// when it is not empty
+	std::string unixSocketPath;
+	// localhost TCP port for the HTTP endpoint
+	int port;
+	// append one JSON object per frame to this file when it is
+	// not empty
+	std::string jsonLogPath;
+
+	METRICS_OPTIONS()
+	{
+		port = 9464;
+	}
+};
+
+/***********************************************************
+ *  MetricsExporter
+ *
+ *  This class publishes the viewer statistics for scraping.
+ *  The render thread only copies a small record into a fixed
+ *  single producer, single consumer ring and never waits - a
+ *  full ring drops the record and counts the drop.  A
+ *  collector thread drains the ring, keeps the frame time
+ *  histogram and the latest counters, writes the JSON-lines
+ *  log and answers HTTP GET requests with the Prometheus text
+ *  exposition, so a scrape never touches the render thread.
+ ***********************************************************/
+class MetricsExporter
+{
+public:
+	// constructor
+	MetricsExporter();
+	// destructor
+	~MetricsExporter();
+
+	// open the endpoint and the log and start the collector
+	bool Start(const METRICS_OPTIONS& options);
+	// stop the collector and close the endpoint and the log
+	void Stop();
+
+	// hand the counters of a rendered frame to the collector,
+	// called once per frame from the render thread only
+	void PublishFrame(const SceneManager::FRAME_STATS& frameStats);
+	// hand the time taken to load a named asset to the collector,
+	// called from the render thread only
+	void PublishLoadTime(const std::string& name, double milliseconds);
+
+private:
+	// kinds of record passed through the ring
+	enum RECORD_TYPE
+	{
+		RECORD_FRAME,
+		RECORD_LOAD_TIME
+	};
+
+	// one record passed from the render thread, kept trivially
+	// copyable so publishing never allocates
+	struct METRICS_RECORD
+	{
+		RECORD_TYPE type;
+		std::chrono::steady_clock::time_point timestamp;
+		SceneManager::FRAME_STATS frameStats;
+		char name[48];
+		double milliseconds;
+	};
+
+	// time taken to load one asset
+	struct LOAD_TIME
+	{
+		std::string name;
+		double milliseconds;
+	};
+
+	// single producer, single consumer ring of records - each
+	// index is only written by one side, on its own cache line
+	std::vector<METRICS_RECORD> m_ring;
+	alignas(64) std::atomic<size_t> m_writeIndex;
+	alignas(64) std::atomic<size_t> m_readIndex;
+	alignas(64) std::atomic<unsigned long long> m_droppedRecords;
+
+	// collector thread and the endpoint it serves
+	std::thread m_collector;
+	std::atomic<bool> m_bRunning;
+	METRICS_OPTIONS m_options;
+	long long m_listenSocket;
+	std::ofstream m_jsonLog;
+
+	// aggregates, only touched by the collector thread
+	std::vector<unsigned long long> m_frameTimeBuckets;
+	double m_frameTimeSumSeconds;
+	unsigned long long m_frames;
+	unsigned long long m_drawCallsTotal;
+	SceneManager::FRAME_STATS m_lastFrameStats;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+	bool m_bHasLastFrame;
+	std::vector<LOAD_TIME> m_loadTimes;
+
+	// push a record without waiting, false when the ring is full
+	bool PushRecord(const METRICS_RECORD& record);
+	// open the listening socket for the configured endpoint
+	bool OpenEndpoint();
+	void CloseEndpoint();
+	// body of the collector thread
+	void CollectorLoop();
+	// fold the queued records into the aggregates
+	void DrainRecords();
+	void ProcessRecord(const METRICS_RECORD& record);
+	// answer one connection waiting on the listening socket
+	void ServeConnection();
+	// format the aggregates in the Prometheus text format
+	std::string FormatMetrics() const;
+};
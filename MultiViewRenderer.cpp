@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////
+// multiviewrenderer.cpp
+// ============
+// render the 3D scene from many viewpoints in one layered pass
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MultiViewRenderer.h"
+#include "FrustumCulling.h"
+#include "GpuMemoryTracker.h"
+
+#include <chrono>
+
+// declaration of global variables
+namespace
+{
+	// must match MAX_BATCH_VIEWS in the geometry shader, which is
+	// the minimum geometry shader invocation count OpenGL allows
+	const int MAX_BATCH_VIEWS = 32;
+
+	const char* g_MultiViewVertexShader = "./Source/shaders/multiViewVertexShader.glsl";
+	const char* g_MultiViewGeometryShader = "./Source/shaders/multiViewGeometryShader.glsl";
+	const char* g_MultiViewFragmentShader = "./Source/shaders/multiViewFragmentShader.glsl";
+
+	// bytes per pixel of each color and depth layer
+	const int LAYER_BYTES_PER_PIXEL = 4 + 4;
+	// views rendered between two throughput reports
+	const int REPORT_VIEWS = 1000;
+}
+
+/***********************************************************
+ *  MultiViewRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MultiViewRenderer::MultiViewRenderer()
+{
+	m_pMultiViewShader = NULL;
+	m_viewMaskLocation = -1;
+	m_framebuffer = 0;
+	m_colorTextureArray = 0;
+	m_depthTextureArray = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_targetLayers = 0;
+	m_timerQueries[0] = 0;
+	m_timerQueries[1] = 0;
+	m_bQueryPending[0] = false;
+	m_bQueryPending[1] = false;
+	m_queryIndex = 0;
+	m_stats = MULTIVIEW_STATS();
+}
+
+/***********************************************************
+ *  ~MultiViewRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MultiViewRenderer::~MultiViewRenderer()
+{
+	DestroyRenderTarget();
+
+	if (0 != m_timerQueries[0])
+	{
+		glDeleteQueries(2, m_timerQueries);
+		m_timerQueries[0] = m_timerQueries[1] = 0;
+	}
+	// the program stays in the resource cache for the next scene
+	if (NULL != m_pMultiViewShader)
+	{
+		delete m_pMultiViewShader;
+		m_pMultiViewShader = NULL;
+	}
+	m_program.Release();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the layered rendering
+ *  program, setting the scene lights into it and creating
+ *  the timer queries.
+ ***********************************************************/
+bool MultiViewRenderer::Initialize(SceneManager* pSceneManager)
+{
+	m_program = pSceneManager->GetResourceCache()->AcquireProgram(
+		g_MultiViewVertexShader,
+		g_MultiViewGeometryShader,
+		g_MultiViewFragmentShader);
+	if (!m_program.IsValid())
+	{
+		return(false);
+	}
+
+	m_pMultiViewShader = new ShaderManager();
+	m_pMultiViewShader->m_programID = m_program.GetID();
+	m_viewMaskLocation = glGetUniformLocation(m_program.GetID(), "viewMask");
+
+	// uniforms belong to a program, so the lights are set into
+	// the layered program through the scene manager
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+	m_pMultiViewShader->use();
+	pSceneManager->SetShaderManager(m_pMultiViewShader);
+	pSceneManager->SetupSceneLights();
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	glGenQueries(2, m_timerQueries);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating the color and depth
+ *  texture arrays with one layer per view.  The target is
+ *  only rebuilt when the size or layer count changes.
+ ***********************************************************/
+bool MultiViewRenderer::CreateRenderTarget(int width, int height, int layers)
+{
+	if ((0 != m_framebuffer) &&
+		(width == m_targetWidth) &&
+		(height == m_targetHeight) &&
+		(layers == m_targetLayers))
+	{
+		return(true);
+	}
+
+	DestroyRenderTarget();
+
+	glGenTextures(1, &m_colorTextureArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_colorTextureArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, width, height, layers);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glGenTextures(1, &m_depthTextureArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthTextureArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, width, height, layers);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// attaching the whole arrays makes the framebuffer layered,
+	// so gl_Layer in the geometry shader selects the view
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorTextureArray, 0);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTextureArray, 0);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "Layered framebuffer is incomplete, status:" << status << std::endl;
+		DestroyRenderTarget();
+		return(false);
+	}
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+	m_targetLayers = layers;
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)width * height * layers * LAYER_BYTES_PER_PIXEL);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing the layered render target.
+ ***********************************************************/
+void MultiViewRenderer::DestroyRenderTarget()
+{
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (0 != m_colorTextureArray)
+	{
+		glDeleteTextures(1, &m_colorTextureArray);
+		m_colorTextureArray = 0;
+	}
+	if (0 != m_depthTextureArray)
+	{
+		glDeleteTextures(1, &m_depthTextureArray);
+		m_depthTextureArray = 0;
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)m_targetWidth * m_targetHeight * m_targetLayers * LAYER_BYTES_PER_PIXEL);
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_targetLayers = 0;
+}
+
+/***********************************************************
+ *  RenderViews()
+ *
+ *  This method is used for rendering the scene from every
+ *  passed in view.  The scene is recorded once, each object
+ *  is culled against every view frustum, and the surviving
+ *  objects are drawn once per batch of up to 32 views with a
+ *  mask telling the geometry shader which layers to emit.
+ *  The pass is timed with a query that is read in a later
+ *  call, so the CPU never waits on the GPU here.
+ ***********************************************************/
+bool MultiViewRenderer::RenderViews(
+	SceneManager* pSceneManager,
+	const std::vector<glm::mat4>& views,
+	const std::vector<glm::mat4>& projections,
+	int width,
+	int height)
+{
+	if ((NULL == pSceneManager) ||
+		(NULL == m_pMultiViewShader) ||
+		(views.size() == 0) ||
+		(views.size() != projections.size()))
+	{
+		return(false);
+	}
+
+	CollectStatistics();
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	const int viewCount = (int)views.size();
+
+	if (!CreateRenderTarget(width, height, viewCount))
+	{
+		return(false);
+	}
+
+	// combine the matrices and build the frustum for every view
+	std::vector<glm::mat4> viewProjections(viewCount);
+	std::vector<glm::vec3> viewPositions(viewCount);
+	std::vector<FRUSTUM> frustums(viewCount);
+	for (int i = 0; i < viewCount; i++)
+	{
+		viewProjections[i] = projections[i] * views[i];
+		viewPositions[i] = glm::vec3(glm::inverse(views[i])[3]);
+		frustums[i] = ExtractFrustum(viewProjections[i]);
+	}
+
+	// the scene is recorded once and shared by all views
+	const std::vector<SceneManager::DRAW_ITEM>& drawList = pSceneManager->RecordScene();
+	std::vector<BOUNDING_BOX> worldBounds(drawList.size());
+	for (size_t i = 0; i < drawList.size(); i++)
+	{
+		BOUNDING_BOX localBounds;
+		SceneManager::GetMeshBounds(drawList[i].mesh, localBounds.min, localBounds.max);
+		worldBounds[i] = TransformBoundingBox(localBounds, drawList[i].model);
+	}
+
+	// save the state that the layered pass changes
+	GLint previousViewport[4];
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+
+	pSceneManager->SetShaderManager(m_pMultiViewShader);
+	m_pMultiViewShader->use();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, width, height);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	pSceneManager->BindMeshes();
+
+	// the query slot is only reused after its result was read
+	bool bTiming = !m_bQueryPending[m_queryIndex];
+	if (bTiming)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_queryIndex]);
+	}
+
+	for (int batchStart = 0; batchStart < viewCount; batchStart += MAX_BATCH_VIEWS)
+	{
+		int batchCount = glm::min(MAX_BATCH_VIEWS, viewCount - batchStart);
+
+		for (int i = 0; i < batchCount; i++)
+		{
+			std::string index = "[" + std::to_string(i) + "]";
+			m_pMultiViewShader->setMat4Value("viewProjections" + index, viewProjections[batchStart + i]);
+			m_pMultiViewShader->setVec3Value("viewPositions" + index, viewPositions[batchStart + i]);
+		}
+		m_pMultiViewShader->setIntValue("viewCount", batchCount);
+		m_pMultiViewShader->setIntValue("layerBase", batchStart);
+
+		for (size_t item = 0; item < drawList.size(); item++)
+		{
+			GLuint viewMask = 0;
+			for (int i = 0; i < batchCount; i++)
+			{
+				if (IsBoxInFrustum(frustums[batchStart + i], worldBounds[item]))
+				{
+					viewMask |= (1u << i);
+				}
+			}
+
+			if (0 == viewMask)
+			{
+				m_stats.drawsCulled++;
+				continue;
+			}
+
+			glUniform1ui(m_viewMaskLocation, viewMask);
+			pSceneManager->SubmitDrawItem(drawList[item]);
+			m_stats.drawsSubmitted++;
+		}
+	}
+
+	if (bTiming)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_bQueryPending[m_queryIndex] = true;
+		m_queryIndex = 1 - m_queryIndex;
+	}
+
+	// restore the state for the main window rendering
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	std::chrono::duration<double, std::milli> cpuTime = std::chrono::high_resolution_clock::now() - startTime;
+	m_stats.frames++;
+	m_stats.views += viewCount;
+	m_stats.cpuMilliseconds += cpuTime.count();
+
+	return(true);
+}
+
+/***********************************************************
+ *  CollectStatistics()
+ *
+ *  This method is used for reading the finished queries
+ *  without waiting on the GPU, and for printing the views
+ *  per second once enough views were rendered.  The rate is
+ *  set by the slower of the CPU and the GPU side.
+ ***********************************************************/
+void MultiViewRenderer::CollectStatistics()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (!m_bQueryPending[i])
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &nanoseconds);
+			m_stats.gpuFrames++;
+			m_stats.gpuMilliseconds += nanoseconds / 1000000.0;
+			m_bQueryPending[i] = false;
+		}
+	}
+
+	if ((m_stats.views < REPORT_VIEWS) || (0 == m_stats.gpuFrames))
+	{
+		return;
+	}
+
+	double cpuMilliseconds = m_stats.cpuMilliseconds / m_stats.frames;
+	double gpuMilliseconds = m_stats.gpuMilliseconds / m_stats.gpuFrames;
+	double viewsPerFrame = (double)m_stats.views / m_stats.frames;
+	double frameMilliseconds = glm::max(cpuMilliseconds, gpuMilliseconds);
+	std::cout << "INFO: Multi-view pass per frame: " << viewsPerFrame << " views, "
+		<< m_stats.drawsSubmitted / m_stats.frames << " draws submitted, "
+		<< m_stats.drawsCulled / m_stats.frames << " culled, "
+		<< cpuMilliseconds << " ms CPU, "
+		<< gpuMilliseconds << " ms GPU, "
+		<< ((frameMilliseconds > 0.0) ? viewsPerFrame * 1000.0 / frameMilliseconds : 0.0)
+		<< " views per second" << std::endl;
+	m_stats = MULTIVIEW_STATS();
+}
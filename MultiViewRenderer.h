@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// multiviewrenderer.h
+// ============
+// render the 3D scene from many viewpoints in one layered pass
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MultiViewRenderer
+ *
+ *  This class renders the recorded scene into the layers of
+ *  a texture array, one layer per view.  Each draw is issued
+ *  once per batch of views and a geometry shader replicates
+ *  the triangles into every view the object was not culled
+ *  from, so the geometry and state setup are shared.  The
+ *  GPU time of each call is read a frame late, and the
+ *  throughput is printed every few hundred views.
+ ***********************************************************/
+class MultiViewRenderer
+{
+public:
+	// constructor
+	MultiViewRenderer();
+	// destructor
+	~MultiViewRenderer();
+
+	// running cost of the calls to RenderViews() since the last
+	// report
+	struct MULTIVIEW_STATS
+	{
+		int frames;
+		int views;
+		int drawsSubmitted;
+		int drawsCulled;
+		double cpuMilliseconds;
+		// frames and time of the finished GPU timer queries
+		int gpuFrames;
+		double gpuMilliseconds;
+	};
+
+	// load the layered rendering program through the cache and
+	// set the scene lights into it
+	bool Initialize(SceneManager* pSceneManager);
+
+	// render the scene once for each view/projection pair into
+	// the layers of the color texture array
+	bool RenderViews(
+		SceneManager* pSceneManager,
+		const std::vector<glm::mat4>& views,
+		const std::vector<glm::mat4>& projections,
+		int width,
+		int height);
+
+	// texture array holding one rendered view per layer
+	GLuint GetColorTextureArray() const { return m_colorTextureArray; }
+	const MULTIVIEW_STATS& GetStats() const { return m_stats; }
+
+private:
+	// shader manager wrapping the layered rendering program
+	ShaderManager* m_pMultiViewShader;
+	// reference to the program in the resource cache
+	ResourceHandle m_program;
+	// location of the per draw view mask
+	GLint m_viewMaskLocation;
+	// layered render target
+	GLuint m_framebuffer;
+	GLuint m_colorTextureArray;
+	GLuint m_depthTextureArray;
+	int m_targetWidth;
+	int m_targetHeight;
+	int m_targetLayers;
+	// timer queries of the layered pass, alternated so the
+	// results are read a frame late without stalling
+	GLuint m_timerQueries[2];
+	bool m_bQueryPending[2];
+	int m_queryIndex;
+	MULTIVIEW_STATS m_stats;
+
+	// create or resize the layered render target
+	bool CreateRenderTarget(int width, int height, int layers);
+	// free the layered render target
+	void DestroyRenderTarget();
+	// collect finished queries and report the throughput
+	void CollectStatistics();
+};
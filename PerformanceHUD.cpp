@@ -0,0 +1,610 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.cpp
+// ============
+// on-screen overlay with the frame time graph, scene counters and
+// GPU pass timings, drawn over the finished frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerformanceHUD.h"
+#include "ShaderLoader.h"
+#include "GpuMemoryTracker.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_HUDVertexShader = "./Source/shaders/hudVertexShader.glsl";
+	const char* g_HUDFragmentShader = "./Source/shaders/hudFragmentShader.glsl";
+
+	// above the scene textures and below the G-buffer and OIT units
+	const int ATLAS_TEXTURE_UNIT = 10;
+
+	// glyph cell size in texels, which must match the shaders,
+	// and the number of screen pixels per texel
+	const int GLYPH_COLUMNS = 3;
+	const int GLYPH_ROWS = 5;
+	const float GLYPH_SCALE = 2.0f;
+	const float GLYPH_ADVANCE = (GLYPH_COLUMNS + 1) * GLYPH_SCALE;
+	const float LINE_HEIGHT = (GLYPH_ROWS + 2) * GLYPH_SCALE;
+
+	// layout of the overlay panel in pixels
+	const float PANEL_X = 8.0f;
+	const float PANEL_Y = 8.0f;
+	const float PANEL_PADDING = 6.0f;
+	const float PANEL_WIDTH = 300.0f;
+	const float GRAPH_HEIGHT = 48.0f;
+	const float GRAPH_BAR_WIDTH = 2.0f;
+	// frame time shown at the top of the graph, 30 FPS
+	const float GRAPH_MAX_MILLISECONDS = 33.3f;
+	const float TARGET_MILLISECONDS = 16.7f;
+
+	// enough for the text lines, the graph and the panel
+	const int MAX_INSTANCES = 1024;
+	const int FRAME_HISTORY = 120;
+
+	/***********************************************************
+	 *  GLYPH_BITMAP
+	 *
+	 *  One character of the built-in font, five rows from the
+	 *  top with the left column in the highest of the 3 bits.
+	 ***********************************************************/
+	struct GLYPH_BITMAP
+	{
+		char character;
+		unsigned char rows[GLYPH_ROWS];
+	};
+
+	// the font only covers what the overlay prints, lower case
+	// is drawn with the upper case glyphs - the solid block
+	// at the end stretches into the panel and the graph bars
+	const GLYPH_BITMAP g_Font[] =
+	{
+		{ '0', { 7, 5, 5, 5, 7 } }, { '1', { 2, 6, 2, 2, 7 } },
+		{ '2', { 7, 1, 7, 4, 7 } }, { '3', { 7, 1, 3, 1, 7 } },
+		{ '4', { 5, 5, 7, 1, 1 } }, { '5', { 7, 4, 7, 1, 7 } },
+		{ '6', { 7, 4, 7, 5, 7 } }, { '7', { 7, 1, 1, 2, 2 } },
+		{ '8', { 7, 5, 7, 5, 7 } }, { '9', { 7, 5, 7, 1, 7 } },
+		{ 'A', { 2, 5, 7, 5, 5 } }, { 'B', { 6, 5, 6, 5, 6 } },
+		{ 'C', { 3, 4, 4, 4, 3 } }, { 'D', { 6, 5, 5, 5, 6 } },
+		{ 'E', { 7, 4, 6, 4, 7 } }, { 'F', { 7, 4, 6, 4, 4 } },
+		{ 'G', { 3, 4, 5, 5, 3 } }, { 'H', { 5, 5, 7, 5, 5 } },
+		{ 'I', { 7, 2, 2, 2, 7 } }, { 'J', { 1, 1, 1, 5, 2 } },
+		{ 'K', { 5, 5, 6, 5, 5 } }, { 'L', { 4, 4, 4, 4, 7 } },
+		{ 'M', { 5, 7, 7, 5, 5 } }, { 'N', { 6, 5, 5, 5, 5 } },
+		{ 'O', { 2, 5, 5, 5, 2 } }, { 'P', { 6, 5, 6, 4, 4 } },
+		{ 'Q', { 2, 5, 5, 6, 3 } }, { 'R', { 6, 5, 6, 5, 5 } },
+		{ 'S', { 3, 4, 2, 1, 6 } }, { 'T', { 7, 2, 2, 2, 2 } },
+		{ 'U', { 5, 5, 5, 5, 7 } }, { 'V', { 5, 5, 5, 5, 2 } },
+		{ 'W', { 5, 5, 7, 7, 5 } }, { 'X', { 5, 5, 2, 5, 5 } },
+		{ 'Y', { 5, 5, 2, 2, 2 } }, { 'Z', { 7, 1, 2, 4, 7 } },
+		{ ' ', { 0, 0, 0, 0, 0 } }, { '.', { 0, 0, 0, 0, 2 } },
+		{ ':', { 0, 2, 0, 2, 0 } }, { '/', { 1, 1, 2, 4, 4 } },
+		{ '%', { 5, 1, 2, 4, 5 } }, { '-', { 0, 0, 7, 0, 0 } },
+		{ '(', { 1, 2, 2, 2, 1 } }, { ')', { 4, 2, 2, 2, 4 } },
+		{ '=', { 0, 7, 0, 7, 0 } }, { '\0', { 7, 7, 7, 7, 7 } }
+	};
+	const int GLYPH_COUNT = (int)(sizeof(g_Font) / sizeof(g_Font[0]));
+
+	/***********************************************************
+	 *  PackColor()
+	 *
+	 *  This function is used for packing a color into the RGBA8
+	 *  layout read by the overlay vertex shader.
+	 ***********************************************************/
+	unsigned int PackColor(int red, int green, int blue, int alpha)
+	{
+		return((unsigned int)red | ((unsigned int)green << 8) | ((unsigned int)blue << 16) | ((unsigned int)alpha << 24));
+	}
+
+	/***********************************************************
+	 *  GetFrameTimeColor()
+	 *
+	 *  This function is used for coloring a frame time green
+	 *  within the 60 FPS budget, yellow within 30 FPS and red
+	 *  above that.
+	 ***********************************************************/
+	unsigned int GetFrameTimeColor(float milliseconds)
+	{
+		if (milliseconds <= TARGET_MILLISECONDS)
+		{
+			return(PackColor(96, 220, 96, 255));
+		}
+		if (milliseconds <= GRAPH_MAX_MILLISECONDS)
+		{
+			return(PackColor(230, 200, 64, 255));
+		}
+
+		return(PackColor(230, 72, 64, 255));
+	}
+}
+
+/***********************************************************
+ *  PerformanceHUD()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerformanceHUD::PerformanceHUD()
+{
+	m_pHUDShader = NULL;
+	m_atlasTexture = 0;
+	m_instanceBuffer = 0;
+	m_vertexArray = 0;
+	m_atlasBytes = 0;
+	for (int i = 0; i < 128; i++)
+	{
+		m_glyphIndex[i] = -1;
+	}
+	m_solidGlyph = GLYPH_COUNT - 1;
+	m_bHasLastFrame = false;
+	m_frameStats = SceneManager::FRAME_STATS();
+	m_triangles = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		m_primitiveQueries[i] = 0;
+		m_timerQueries[i] = 0;
+		m_bPrimitivesPending[i] = false;
+		m_bTimerPending[i] = false;
+	}
+	m_primitiveIndex = 0;
+	m_timerIndex = 0;
+	m_bCountingPrimitives = false;
+	m_cpuMilliseconds = 0.0;
+	m_gpuMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~PerformanceHUD()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PerformanceHUD::~PerformanceHUD()
+{
+	if (NULL != m_pHUDShader)
+	{
+		glDeleteProgram(m_pHUDShader->m_programID);
+		delete m_pHUDShader;
+		m_pHUDShader = NULL;
+	}
+	if (0 != m_atlasTexture)
+	{
+		glDeleteTextures(1, &m_atlasTexture);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)m_atlasBytes);
+		m_atlasTexture = 0;
+	}
+	if (0 != m_instanceBuffer)
+	{
+		glDeleteBuffers(1, &m_instanceBuffer);
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)(MAX_INSTANCES * sizeof(GLYPH_INSTANCE)));
+		m_instanceBuffer = 0;
+	}
+	if (0 != m_vertexArray)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+	if (0 != m_primitiveQueries[0])
+	{
+		glDeleteQueries(2, m_primitiveQueries);
+		glDeleteQueries(2, m_timerQueries);
+		m_primitiveQueries[0] = 0;
+		m_primitiveQueries[1] = 0;
+		m_timerQueries[0] = 0;
+		m_timerQueries[1] = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the overlay program and
+ *  creating the glyph atlas, the instance buffer and the
+ *  queries.  The quad corners come from gl_VertexID, so the
+ *  vertex array only reads per instance attributes.
+ ***********************************************************/
+bool PerformanceHUD::Initialize()
+{
+	GLuint programID = LoadShaderProgram(g_HUDVertexShader, NULL, g_HUDFragmentShader);
+	if (0 == programID)
+	{
+		return(false);
+	}
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	m_pHUDShader = new ShaderManager();
+	m_pHUDShader->m_programID = programID;
+	m_pHUDShader->use();
+	m_pHUDShader->setSampler2DValue("glyphAtlas", ATLAS_TEXTURE_UNIT);
+	glUseProgram(previousProgram);
+
+	if (!CreateGlyphAtlas())
+	{
+		return(false);
+	}
+
+	glGenBuffers(1, &m_instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, MAX_INSTANCES * sizeof(GLYPH_INSTANCE), NULL, GL_STREAM_DRAW);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)(MAX_INSTANCES * sizeof(GLYPH_INSTANCE)));
+
+	glGenVertexArrays(1, &m_vertexArray);
+	glBindVertexArray(m_vertexArray);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GLYPH_INSTANCE), (void*)offsetof(GLYPH_INSTANCE, x));
+	glVertexAttribDivisor(0, 1);
+	glEnableVertexAttribArray(1);
+	glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GLYPH_INSTANCE), (void*)offsetof(GLYPH_INSTANCE, glyph));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GLYPH_INSTANCE), (void*)offsetof(GLYPH_INSTANCE, color));
+	glVertexAttribDivisor(2, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenQueries(2, m_primitiveQueries);
+	glGenQueries(2, m_timerQueries);
+
+	m_instances.reserve(MAX_INSTANCES);
+	m_frameHistory.reserve(FRAME_HISTORY);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateGlyphAtlas()
+ *
+ *  This method is used for rasterizing the built-in font into
+ *  a single row R8 atlas, one 3x5 cell per glyph with the top
+ *  row of each glyph in the first texel row.
+ ***********************************************************/
+bool PerformanceHUD::CreateGlyphAtlas()
+{
+	const int atlasWidth = GLYPH_COUNT * GLYPH_COLUMNS;
+	std::vector<unsigned char> texels(atlasWidth * GLYPH_ROWS, 0);
+
+	for (int glyph = 0; glyph < GLYPH_COUNT; glyph++)
+	{
+		for (int row = 0; row < GLYPH_ROWS; row++)
+		{
+			for (int column = 0; column < GLYPH_COLUMNS; column++)
+			{
+				if (g_Font[glyph].rows[row] & (4 >> column))
+				{
+					texels[row * atlasWidth + glyph * GLYPH_COLUMNS + column] = 255;
+				}
+			}
+		}
+
+		char character = g_Font[glyph].character;
+		if (character != '\0')
+		{
+			m_glyphIndex[(int)character] = glyph;
+			if ((character >= 'A') && (character <= 'Z'))
+			{
+				m_glyphIndex[character - 'A' + 'a'] = glyph;
+			}
+		}
+	}
+
+	GLint previousAlignment = 4;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	glGenTextures(1, &m_atlasTexture);
+	glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, atlasWidth, GLYPH_ROWS);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, atlasWidth, GLYPH_ROWS, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+
+	m_atlasBytes = atlasWidth * GLYPH_ROWS;
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)m_atlasBytes);
+
+	return(0 != m_atlasTexture);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for recording the wall clock time of
+ *  the frame that just finished and starting the count of
+ *  the primitives drawn by the next one.
+ ***********************************************************/
+void PerformanceHUD::BeginFrame()
+{
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+	if (m_bHasLastFrame)
+	{
+		if ((int)m_frameHistory.size() >= FRAME_HISTORY)
+		{
+			m_frameHistory.erase(m_frameHistory.begin());
+		}
+		m_frameHistory.push_back(std::chrono::duration<float, std::milli>(now - m_lastFrameTime).count());
+	}
+	m_lastFrameTime = now;
+	m_bHasLastFrame = true;
+
+	CollectQueries();
+
+	// the query slot is only reused after its result was read
+	if ((0 != m_primitiveQueries[0]) && !m_bPrimitivesPending[m_primitiveIndex])
+	{
+		glBeginQuery(GL_PRIMITIVES_GENERATED, m_primitiveQueries[m_primitiveIndex]);
+		m_bCountingPrimitives = true;
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending the primitive count and
+ *  keeping the counters of the rendered frame.
+ ***********************************************************/
+void PerformanceHUD::EndFrame(const SceneManager::FRAME_STATS& frameStats)
+{
+	if (m_bCountingPrimitives)
+	{
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		m_bPrimitivesPending[m_primitiveIndex] = true;
+		m_primitiveIndex = 1 - m_primitiveIndex;
+		m_bCountingPrimitives = false;
+	}
+
+	m_frameStats = frameStats;
+}
+
+/***********************************************************
+ *  CollectQueries()
+ *
+ *  This method is used for reading the primitive counts and
+ *  overlay timings that have finished, without waiting on
+ *  the GPU.
+ ***********************************************************/
+void PerformanceHUD::CollectQueries()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		GLint available = 0;
+		if (m_bPrimitivesPending[i])
+		{
+			glGetQueryObjectiv(m_primitiveQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 primitives = 0;
+				glGetQueryObjectui64v(m_primitiveQueries[i], GL_QUERY_RESULT, &primitives);
+				m_triangles = (long long)primitives;
+				m_bPrimitivesPending[i] = false;
+			}
+		}
+		if (m_bTimerPending[i])
+		{
+			glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 nanoseconds = 0;
+				glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &nanoseconds);
+				m_gpuMilliseconds = nanoseconds / 1000000.0;
+				m_bTimerPending[i] = false;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  AddRectangle()
+ *
+ *  This method is used for adding a solid rectangle to the
+ *  overlay by stretching the solid glyph over it.
+ ***********************************************************/
+void PerformanceHUD::AddRectangle(float x, float y, float width, float height, unsigned int color)
+{
+	if ((int)m_instances.size() < MAX_INSTANCES)
+	{
+		GLYPH_INSTANCE instance = { x, y, width, height, (unsigned int)m_solidGlyph, color };
+		m_instances.push_back(instance);
+	}
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  This method is used for adding a line of text to the
+ *  overlay, one instance per visible character, and returns
+ *  the position after the last character.
+ ***********************************************************/
+float PerformanceHUD::AddText(float x, float y, const char* text, unsigned int color)
+{
+	for (const char* character = text; *character != '\0'; character++)
+	{
+		int glyph = ((unsigned char)*character < 128) ? m_glyphIndex[(int)*character] : -1;
+		if ((glyph >= 0) && (*character != ' ') && ((int)m_instances.size() < MAX_INSTANCES))
+		{
+			GLYPH_INSTANCE instance = { x, y, GLYPH_COLUMNS * GLYPH_SCALE, GLYPH_ROWS * GLYPH_SCALE, (unsigned int)glyph, color };
+			m_instances.push_back(instance);
+		}
+		x += GLYPH_ADVANCE;
+	}
+
+	return(x);
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for building the overlay instances
+ *  for the current figures and drawing them with one
+ *  instanced draw, with blending on and depth testing off.
+ *  The GL state changed by the overlay is restored after.
+ ***********************************************************/
+void PerformanceHUD::Render()
+{
+	if ((NULL == m_pHUDShader) || (0 == m_vertexArray))
+	{
+		return;
+	}
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	CollectQueries();
+
+	// the frame rate is averaged over the graph so it is readable
+	float lastMilliseconds = m_frameHistory.empty() ? 0.0f : m_frameHistory.back();
+	float totalMilliseconds = 0.0f;
+	for (size_t i = 0; i < m_frameHistory.size(); i++)
+	{
+		totalMilliseconds += m_frameHistory[i];
+	}
+	float framesPerSecond = (totalMilliseconds > 0.0f) ? 1000.0f * m_frameHistory.size() / totalMilliseconds : 0.0f;
+
+	const unsigned int textColor = PackColor(230, 230, 230, 255);
+	const unsigned int labelColor = PackColor(140, 170, 200, 255);
+	char line[96];
+
+	// the panel is the first instance so everything draws over
+	// it, its height is known once the lines are laid out
+	m_instances.clear();
+	AddRectangle(PANEL_X, PANEL_Y, PANEL_WIDTH, 0.0f, PackColor(0, 0, 0, 170));
+
+	float x = PANEL_X + PANEL_PADDING;
+	float y = PANEL_Y + PANEL_PADDING;
+
+	snprintf(line, sizeof(line), "%.2f MS", lastMilliseconds);
+	x = AddText(x, y, "FRAME ", labelColor);
+	x = AddText(x, y, line, GetFrameTimeColor(lastMilliseconds));
+	snprintf(line, sizeof(line), "%.1f", framesPerSecond);
+	x = AddText(x, y, "  FPS ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "%d", m_frameStats.drawCalls);
+	x = AddText(PANEL_X + PANEL_PADDING, y, "DRAWS ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%d", m_frameStats.stateChanges);
+	x = AddText(x, y, "  STATES ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%lld", m_triangles);
+	x = AddText(x, y, "  TRIS ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "%d", m_frameStats.visibleObjects);
+	x = AddText(PANEL_X + PANEL_PADDING, y, "VISIBLE ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%d", m_frameStats.culledObjects);
+	x = AddText(x, y, "  CULLED ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%d", m_frameStats.gpuCulledObjects);
+	x = AddText(x, y, "  GPU ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "%.1f MB", GetGpuMemory(GPU_MEMORY_TEXTURE) / (1024.0 * 1024.0));
+	x = AddText(PANEL_X + PANEL_PADDING, y, "TEXTURES ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%.2f MB", GetGpuMemory(GPU_MEMORY_BUFFER) / (1024.0 * 1024.0));
+	x = AddText(x, y, "  BUFFERS ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "%.3f MS", m_frameStats.opaqueGpuMilliseconds);
+	x = AddText(PANEL_X + PANEL_PADDING, y, "GPU OPAQUE ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%.3f MS", m_frameStats.transparentGpuMilliseconds);
+	x = AddText(x, y, "  TRANSP ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "%.3f MS", m_cpuMilliseconds);
+	x = AddText(PANEL_X + PANEL_PADDING, y, "HUD CPU ", labelColor);
+	x = AddText(x, y, line, textColor);
+	snprintf(line, sizeof(line), "%.3f MS", m_gpuMilliseconds);
+	x = AddText(x, y, "  GPU ", labelColor);
+	AddText(x, y, line, textColor);
+	y += LINE_HEIGHT;
+
+	// frame time graph, newest frame on the right, with a line
+	// across at the 60 FPS budget
+	float graphBottom = y + GRAPH_HEIGHT;
+	float graphRight = PANEL_X + PANEL_PADDING + FRAME_HISTORY * GRAPH_BAR_WIDTH;
+	for (size_t i = 0; i < m_frameHistory.size(); i++)
+	{
+		float milliseconds = m_frameHistory[m_frameHistory.size() - 1 - i];
+		float barHeight = GRAPH_HEIGHT * ((milliseconds < GRAPH_MAX_MILLISECONDS) ? milliseconds / GRAPH_MAX_MILLISECONDS : 1.0f);
+		AddRectangle(graphRight - (i + 1) * GRAPH_BAR_WIDTH, graphBottom - barHeight,
+			GRAPH_BAR_WIDTH, barHeight, GetFrameTimeColor(milliseconds));
+	}
+	AddRectangle(PANEL_X + PANEL_PADDING, graphBottom - GRAPH_HEIGHT * TARGET_MILLISECONDS / GRAPH_MAX_MILLISECONDS,
+		FRAME_HISTORY * GRAPH_BAR_WIDTH, 1.0f, PackColor(255, 255, 255, 96));
+	m_instances[0].height = graphBottom + PANEL_PADDING - PANEL_Y;
+
+	// orphan the buffer so the upload does not wait on the draw
+	// of the previous frame
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, MAX_INSTANCES * sizeof(GLYPH_INSTANCE), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_instances.size() * sizeof(GLYPH_INSTANCE), m_instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// save the state that the overlay changes
+	GLint previousProgram = 0;
+	GLint previousVertexArray = 0;
+	GLint previousActiveTexture = GL_TEXTURE0;
+	GLint previousViewport[4] = { 0, 0, 0, 0 };
+	GLint previousBlend[4] = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &previousBlend[0]);
+	glGetIntegerv(GL_BLEND_DST_RGB, &previousBlend[1]);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &previousBlend[2]);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &previousBlend[3]);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+
+	bool bTiming = !m_bTimerPending[m_timerIndex];
+	if (bTiming)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerIndex]);
+	}
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_DEPTH_TEST);
+
+	m_pHUDShader->use();
+	m_pHUDShader->setVec2Value("screenSize", (float)previousViewport[2], (float)previousViewport[3]);
+	glActiveTexture(GL_TEXTURE0 + ATLAS_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+	glBindVertexArray(m_vertexArray);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)m_instances.size());
+
+	if (bTiming)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_bTimerPending[m_timerIndex] = true;
+		m_timerIndex = 1 - m_timerIndex;
+	}
+
+	// restore the previous state
+	glBindVertexArray(previousVertexArray);
+	glActiveTexture(previousActiveTexture);
+	glUseProgram(previousProgram);
+	glBlendFuncSeparate(previousBlend[0], previousBlend[1], previousBlend[2], previousBlend[3]);
+	if (!bBlend)
+	{
+		glDisable(GL_BLEND);
+	}
+	if (bDepthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+
+	m_cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.h
+// ============
+// on-screen overlay with the frame time graph, scene counters and
+// GPU pass timings, drawn over the finished frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <vector>
+
+/***********************************************************
+ *  PerformanceHUD
+ *
+ *  This class draws the performance overlay.  The text uses
+ *  a small bitmap font baked into a glyph atlas at start up,
+ *  and every glyph, graph bar and the background panel is
+ *  one instance of a screen space quad, so the whole overlay
+ *  is a single instanced draw.  The overlay times its own
+ *  CPU and GPU cost and shows it with the other figures.
+ ***********************************************************/
+class PerformanceHUD
+{
+public:
+	// constructor
+	PerformanceHUD();
+	// destructor
+	~PerformanceHUD();
+
+	// load the overlay program and build the glyph atlas
+	bool Initialize();
+
+	// call around SceneManager::RenderScene() every frame, shown
+	// or not, so the frame time graph has no gaps when it is
+	// turned on - the triangles are counted between the two
+	void BeginFrame();
+	void EndFrame(const SceneManager::FRAME_STATS& frameStats);
+
+	// draw the overlay over the current framebuffer
+	void Render();
+
+private:
+	// one screen space quad of the overlay, positioned in pixels
+	// from the top left corner of the viewport
+	struct GLYPH_INSTANCE
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+		unsigned int glyph;
+		// RGBA8 with red in the lowest byte
+		unsigned int color;
+	};
+
+	// shader manager wrapping the overlay program
+	ShaderManager* m_pHUDShader;
+	// glyph atlas, instance buffer and the vertex array reading it
+	GLuint m_atlasTexture;
+	GLuint m_instanceBuffer;
+	GLuint m_vertexArray;
+	int m_atlasBytes;
+	// glyph index of each ASCII character, -1 when not in the font
+	int m_glyphIndex[128];
+	int m_solidGlyph;
+	// instances built for the current frame
+	std::vector<GLYPH_INSTANCE> m_instances;
+
+	// wall clock frame times in milliseconds, oldest first
+	std::vector<float> m_frameHistory;
+	std::chrono::high_resolution_clock::time_point m_lastFrameTime;
+	bool m_bHasLastFrame;
+	// counters of the last finished frame
+	SceneManager::FRAME_STATS m_frameStats;
+	long long m_triangles;
+
+	// triangle count and overlay timer queries, alternated so the
+	// results are read a frame late without stalling
+	GLuint m_primitiveQueries[2];
+	GLuint m_timerQueries[2];
+	bool m_bPrimitivesPending[2];
+	bool m_bTimerPending[2];
+	int m_primitiveIndex;
+	int m_timerIndex;
+	bool m_bCountingPrimitives;
+	// cost of drawing the overlay itself
+	double m_cpuMilliseconds;
+	double m_gpuMilliseconds;
+
+	// bake the bitmap font into the glyph atlas
+	bool CreateGlyphAtlas();
+	// read the finished queries without waiting on the GPU
+	void CollectQueries();
+	// append a solid rectangle or a line of text to the instances
+	void AddRectangle(float x, float y, float width, float height, unsigned int color);
+	float AddText(float x, float y, const char* text, unsigned int color);
+};
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// proceduraltextures.cpp
+// ============
+// generate wood, brick and speckled plastic textures on the GPU at load
+// time, in place of the image files that approximated them
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProceduralTextures.h"
+#include "GpuMemoryTracker.h"
+
+#include <algorithm>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ProceduralComputeShader = "./Source/shaders/proceduralTextureComputeShader.glsl";
+
+	// must match the local size of the compute shader
+	const int GROUP_SIZE = 8;
+}
+
+/***********************************************************
+ *  GetProceduralTextureKey()
+ *
+ *  This function is used for naming a procedural texture in
+ *  the resource cache by every parameter it is generated
+ *  from, so scenes that generate the same texture share it.
+ ***********************************************************/
+std::string GetProceduralTextureKey(const SceneManager::PROCEDURAL_TEXTURE& texture)
+{
+	std::ostringstream key;
+	key << "procedural|" << texture.tag << "|" << (int)texture.pattern << "|" << texture.size
+		<< "|" << texture.baseColor.r << "," << texture.baseColor.g << "," << texture.baseColor.b
+		<< "|" << texture.detailColor.r << "," << texture.detailColor.g << "," << texture.detailColor.b
+		<< "|" << texture.frequency << "|" << texture.variation << "|" << texture.detail << "|" << texture.seed;
+	return(key.str());
+}
+
+/***********************************************************
+ *  BakeProceduralTexture()
+ *
+ *  This function is used for generating a texture with the
+ *  compute shader.  Every mip level is generated from the
+ *  pattern itself rather than from the level below, each
+ *  texel averaging the pattern over the area it covers, so
+ *  the levels are filtered in linear light as the loaded
+ *  textures are.  The texture has the same sampling
+ *  parameters as a loaded one.
+ ***********************************************************/
+GLuint BakeProceduralTexture(
+	ResourceCache* pResourceCache,
+	const SceneManager::PROCEDURAL_TEXTURE& texture,
+	long long& textureBytes)
+{
+	textureBytes = 0;
+	if (texture.size <= 0)
+	{
+		return(0);
+	}
+
+	ResourceHandle program = pResourceCache->AcquireComputeProgram(g_ProceduralComputeShader);
+	if (!program.IsValid())
+	{
+		return(0);
+	}
+
+	int levels = 1;
+	while ((texture.size >> levels) > 0)
+	{
+		levels++;
+	}
+
+	GLint previousTexture = 0;
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, texture.size, texture.size);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	GLuint programID = program.GetID();
+	glUseProgram(programID);
+	glUniform1i(glGetUniformLocation(programID, "pattern"), (GLint)texture.pattern);
+	glUniform3f(glGetUniformLocation(programID, "baseColor"), texture.baseColor.r, texture.baseColor.g, texture.baseColor.b);
+	glUniform3f(glGetUniformLocation(programID, "detailColor"), texture.detailColor.r, texture.detailColor.g, texture.detailColor.b);
+	glUniform1f(glGetUniformLocation(programID, "frequency"), texture.frequency);
+	glUniform1f(glGetUniformLocation(programID, "variation"), texture.variation);
+	glUniform1f(glGetUniformLocation(programID, "detail"), texture.detail);
+	glUniform1ui(glGetUniformLocation(programID, "seed"), texture.seed);
+
+	// the levels do not read each other, so they are generated
+	// without waiting in between
+	for (int level = 0; level < levels; level++)
+	{
+		int levelSize = std::max(1, texture.size >> level);
+		glUniform1i(glGetUniformLocation(programID, "footprint"), 1 << level);
+		glBindImageTexture(0, textureID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		glDispatchCompute((levelSize + GROUP_SIZE - 1) / GROUP_SIZE, (levelSize + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+		textureBytes += (long long)levelSize * levelSize * 4;
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, textureBytes);
+
+	glUseProgram(previousProgram);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	return(textureID);
+}
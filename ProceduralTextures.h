@@ -0,0 +1,26 @@
+///////////////////////////////////////////////////////////////////////////////
+// proceduraltextures.h
+// ============
+// generate wood, brick and speckled plastic textures on the GPU at load
+// time, in place of the image files that approximated them
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <GL/glew.h>
+
+#include <string>
+
+// get the key a procedural texture is kept under in the
+// resource cache, which differs whenever any parameter does
+std::string GetProceduralTextureKey(const SceneManager::PROCEDURAL_TEXTURE& texture);
+
+// generate the passed in texture with its mipmaps, returning 0
+// when the generator program cannot be loaded
+GLuint BakeProceduralTexture(
+	ResourceCache* pResourceCache,
+	const SceneManager::PROCEDURAL_TEXTURE& texture,
+	long long& textureBytes);
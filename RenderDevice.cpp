@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderdevice.cpp
+// ============
+// thin render hardware interface over OpenGL and Vulkan - buffers,
+// textures, pipelines, render targets and command buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderDevice.h"
+#include "GLRenderDevice.h"
+#include "VulkanRenderDevice.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  CreateRenderDevice()
+ *
+ *  This function is used for creating the device of the
+ *  passed in backend.  The device still has to be
+ *  initialized by the caller.
+ ***********************************************************/
+RenderDevice* CreateRenderDevice(RENDER_BACKEND backend, bool bPreferCPU)
+{
+	switch (backend)
+	{
+	case RENDER_BACKEND_OPENGL:
+		return(new GLRenderDevice());
+	case RENDER_BACKEND_VULKAN:
+#ifdef RHI_VULKAN
+		return(new VulkanRenderDevice(bPreferCPU));
+#else
+		(void)bPreferCPU;
+		std::cout << "The Vulkan backend was not compiled in, define RHI_VULKAN to build it" << std::endl;
+		return(NULL);
+#endif
+	}
+	return(NULL);
+}
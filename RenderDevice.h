@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderdevice.h
+// ============
+// thin render hardware interface over OpenGL and Vulkan - buffers,
+// textures, pipelines, render targets and command buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// graphics APIs that can sit behind the interface
+enum RENDER_BACKEND
+{
+	RENDER_BACKEND_OPENGL,
+	RENDER_BACKEND_VULKAN
+};
+
+enum BUFFER_USAGE
+{
+	BUFFER_USAGE_VERTEX,
+	// 32 bit indices
+	BUFFER_USAGE_INDEX
+};
+
+enum TEXTURE_FORMAT
+{
+	TEXTURE_FORMAT_RGBA8,
+	TEXTURE_FORMAT_R8
+};
+
+enum VERTEX_FORMAT
+{
+	VERTEX_FORMAT_FLOAT2,
+	VERTEX_FORMAT_FLOAT3,
+	VERTEX_FORMAT_FLOAT4,
+	VERTEX_FORMAT_UNORM8X4
+};
+
+enum PRIMITIVE_TOPOLOGY
+{
+	PRIMITIVE_TRIANGLES,
+	PRIMITIVE_TRIANGLE_STRIP
+};
+
+// resource handles, 0 is never a valid resource
+typedef unsigned int BUFFER_HANDLE;
+typedef unsigned int TEXTURE_HANDLE;
+typedef unsigned int PIPELINE_HANDLE;
+typedef unsigned int RENDER_TARGET_HANDLE;
+
+// every pipeline shares one resource layout - the uniforms set with
+// SetUniforms() are the std140 block at binding 0 and the texture
+// is the sampler at RHI_TEXTURE_BINDING, which is also the GL
+// texture unit, above the scene textures and below the HUD atlas
+const unsigned int RHI_UNIFORM_BINDING = 0;
+const unsigned int RHI_TEXTURE_BINDING = 9;
+const size_t RHI_MAX_UNIFORM_BYTES = 256;
+
+// one vertex buffer slot of a pipeline
+struct VERTEX_BINDING
+{
+	unsigned int binding;
+	unsigned int stride;
+	bool bPerInstance;
+};
+
+// one vertex shader input read from a vertex buffer slot
+struct VERTEX_ATTRIBUTE
+{
+	unsigned int location;
+	unsigned int binding;
+	VERTEX_FORMAT format;
+	unsigned int offset;
+};
+
+/***********************************************************
+ *  PIPELINE_DESC
+ *
+ *  The shaders, vertex layout and fixed function state of a
+ *  pipeline.  The shader files are GLSL for the OpenGL
+ *  backend, and the Vulkan backend loads the SPIR-V compiled
+ *  from them, named with .spv appended.
+ ***********************************************************/
+struct PIPELINE_DESC
+{
+	std::string vertexShaderFile;
+	std::string fragmentShaderFile;
+	std::vector<VERTEX_BINDING> bindings;
+	std::vector<VERTEX_ATTRIBUTE> attributes;
+	PRIMITIVE_TOPOLOGY topology;
+	bool bDepthTest;
+	bool bDepthWrite;
+	// source alpha over the target
+	bool bBlend;
+
+	PIPELINE_DESC()
+	{
+		topology = PRIMITIVE_TRIANGLES;
+		bDepthTest = true;
+		bDepthWrite = true;
+		bBlend = false;
+	}
+};
+
+/***********************************************************
+ *  RenderCommandBuffer
+ *
+ *  This class records the commands of one pass.  Recording
+ *  makes no calls that need the device thread, so separate
+ *  command buffers can be recorded on separate threads and
+ *  handed to RenderDevice::Submit() afterwards.
+ ***********************************************************/
+class RenderCommandBuffer
+{
+public:
+	virtual ~RenderCommandBuffer() {}
+
+	// start recording, waiting for the previous submit of this
+	// command buffer to finish on the GPU
+	virtual void Begin() = 0;
+	virtual void End() = 0;
+
+	// clear the target and draw into it until the pass ends
+	virtual void BeginRenderPass(RENDER_TARGET_HANDLE target, const glm::vec4& clearColor) = 0;
+	virtual void EndRenderPass() = 0;
+
+	virtual void BindPipeline(PIPELINE_HANDLE pipeline) = 0;
+	virtual void BindVertexBuffer(unsigned int binding, BUFFER_HANDLE buffer, size_t offset) = 0;
+	virtual void BindIndexBuffer(BUFFER_HANDLE buffer, size_t offset) = 0;
+	virtual void BindTexture(TEXTURE_HANDLE texture) = 0;
+	// copy up to RHI_MAX_UNIFORM_BYTES of uniforms for the draws that follow
+	virtual void SetUniforms(const void* data, size_t size) = 0;
+
+	virtual void Draw(
+		unsigned int vertexCount,
+		unsigned int instanceCount,
+		unsigned int firstVertex,
+		unsigned int firstInstance) = 0;
+	virtual void DrawIndexed(
+		unsigned int indexCount,
+		unsigned int instanceCount,
+		unsigned int firstIndex,
+		int vertexOffset,
+		unsigned int firstInstance) = 0;
+};
+
+/***********************************************************
+ *  RenderDevice
+ *
+ *  This class creates the GPU resources and submits the
+ *  recorded command buffers.  Resources are created and
+ *  command buffers submitted from the thread that owns the
+ *  device, which for OpenGL is the thread with the context.
+ ***********************************************************/
+class RenderDevice
+{
+public:
+	virtual ~RenderDevice() {}
+
+	virtual bool Initialize() = 0;
+	virtual RENDER_BACKEND GetBackend() const = 0;
+	virtual const char* GetDeviceName() const = 0;
+
+	virtual BUFFER_HANDLE CreateBuffer(BUFFER_USAGE usage, size_t size, const void* data) = 0;
+	virtual void UpdateBuffer(BUFFER_HANDLE buffer, size_t offset, size_t size, const void* data) = 0;
+	virtual void DestroyBuffer(BUFFER_HANDLE buffer) = 0;
+
+	virtual TEXTURE_HANDLE CreateTexture(int width, int height, TEXTURE_FORMAT format, const void* pixels) = 0;
+	virtual void DestroyTexture(TEXTURE_HANDLE texture) = 0;
+
+	virtual PIPELINE_HANDLE CreatePipeline(const PIPELINE_DESC& desc) = 0;
+	virtual void DestroyPipeline(PIPELINE_HANDLE pipeline) = 0;
+
+	// offscreen RGBA8 color target with a depth buffer
+	virtual RENDER_TARGET_HANDLE CreateRenderTarget(int width, int height) = 0;
+	virtual void DestroyRenderTarget(RENDER_TARGET_HANDLE target) = 0;
+	// read the color of a target back as RGBA8 rows, top row first
+	virtual bool ReadRenderTarget(RENDER_TARGET_HANDLE target, std::vector<unsigned char>& pixels) = 0;
+
+	virtual RenderCommandBuffer* CreateCommandBuffer() = 0;
+	virtual void DestroyCommandBuffer(RenderCommandBuffer* pCommandBuffer) = 0;
+	// run a recorded command buffer, without waiting for it
+	virtual void Submit(RenderCommandBuffer* pCommandBuffer) = 0;
+	// wait until every submitted command buffer has finished
+	virtual void WaitIdle() = 0;
+};
+
+// create the device of the passed in backend, or return NULL when the
+// backend was not compiled in - a Vulkan device prefers a CPU device
+// such as lavapipe when bPreferCPU is set, for testing without a GPU
+RenderDevice* CreateRenderDevice(RENDER_BACKEND backend, bool bPreferCPU);
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderoptions.h
+// ============
+// runtime rendering options toggled from the keyboard by the view
+// manager and applied by the scene manager every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// how the blended draws are composited in the transparent pass
+enum TRANSPARENCY_MODE
+{
+	TRANSPARENCY_SORTED,
+	TRANSPARENCY_WEIGHTED_OIT
+};
+
+// how the opaque draws are lit
+enum SHADING_PATH
+{
+	SHADING_FORWARD,
+	SHADING_DEFERRED
+};
+
+/***********************************************************
+ *  RENDER_OPTIONS
+ *
+ *  The rendering options that can be changed while the
+ *  application is running.
+ ***********************************************************/
+struct RENDER_OPTIONS
+{
+	TRANSPARENCY_MODE transparencyMode;
+	SHADING_PATH shadingPath;
+	// draw the opaque depth first and shade with GL_LEQUAL
+	bool bDepthPrepass;
+	// record the GL calls of the next frame to a capture file
+	bool bCaptureFrame;
+	// draw the performance overlay over the finished frame
+	bool bShowHUD;
+	// load the next scene in the background and switch to it
+	bool bNextScene;
+	// draw the distant prop groups as impostors
+	bool bImpostors;
+	// cull the opaque draws of the deferred path on the GPU,
+	// and test them against the depth of the last frame too
+	bool bGpuCulling;
+	bool bOcclusionCulling;
+	// render the scene from a ring of views into a texture array
+	// each frame and report the views per second
+	bool bMultiView;
+
+	RENDER_OPTIONS()
+	{
+		transparencyMode = TRANSPARENCY_SORTED;
+		shadingPath = SHADING_FORWARD;
+		bDepthPrepass = false;
+		bCaptureFrame = false;
+		bShowHUD = false;
+		bNextScene = false;
+		bImpostors = true;
+		bGpuCulling = true;
+		bOcclusionCulling = false;
+		bMultiView = false;
+	}
+};
@@ -0,0 +1,436 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcecache.cpp
+// ============
+// reference counted textures, meshes and shader programs, with the
+// unreferenced ones kept in a least recently used cache
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceCache.h"
+#include "ShaderLoader.h"
+#include "GpuMemoryTracker.h"
+
+#include <GL/glew.h>
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ResourceKindNames[RESOURCE_KIND_COUNT] = { "texture", "mesh", "program" };
+}
+
+/***********************************************************
+ *  ResourceHandle()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceHandle::ResourceHandle()
+{
+	m_pCache = NULL;
+	m_pEntry = NULL;
+}
+
+/***********************************************************
+ *  ResourceHandle()
+ *
+ *  The copy constructor for the class, which adds a reference
+ ***********************************************************/
+ResourceHandle::ResourceHandle(const ResourceHandle& other)
+{
+	m_pCache = other.m_pCache;
+	m_pEntry = other.m_pEntry;
+	if (NULL != m_pEntry)
+	{
+		m_pCache->AddReference(m_pEntry);
+	}
+}
+
+/***********************************************************
+ *  ~ResourceHandle()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResourceHandle::~ResourceHandle()
+{
+	Release();
+}
+
+/***********************************************************
+ *  operator=()
+ *
+ *  This method is used for referencing the resource of the
+ *  passed in handle instead of the current one.
+ ***********************************************************/
+ResourceHandle& ResourceHandle::operator=(const ResourceHandle& other)
+{
+	if (m_pEntry != other.m_pEntry)
+	{
+		// the new reference is added first, so releasing the
+		// old one can never free a resource that is still wanted
+		if (NULL != other.m_pEntry)
+		{
+			other.m_pCache->AddReference(other.m_pEntry);
+		}
+		Release();
+		m_pCache = other.m_pCache;
+		m_pEntry = other.m_pEntry;
+	}
+	return(*this);
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for giving the reference back to the
+ *  cache and leaving the handle not valid.
+ ***********************************************************/
+void ResourceHandle::Release()
+{
+	if (NULL != m_pEntry)
+	{
+		m_pCache->ReleaseReference(m_pEntry);
+	}
+	m_pCache = NULL;
+	m_pEntry = NULL;
+}
+
+/***********************************************************
+ *  ResourceCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceCache::ResourceCache(long long budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+	m_totalBytes = 0;
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
+}
+
+/***********************************************************
+ *  ~ResourceCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResourceCache::~ResourceCache()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Acquire()
+ *
+ *  This method is used for getting a handle to the resource
+ *  of the passed in kind and key.  A resource found in the
+ *  unreferenced list is taken back out of it.  The returned
+ *  handle is not valid when the resource is not loaded.
+ ***********************************************************/
+ResourceHandle ResourceCache::Acquire(RESOURCE_KIND kind, const std::string& key)
+{
+	std::unordered_map<std::string, RESOURCE_ENTRY>::iterator found = m_entries[kind].find(key);
+	if (found == m_entries[kind].end())
+	{
+		m_misses++;
+		return(ResourceHandle());
+	}
+
+	m_hits++;
+	return(MakeHandle(&found->second));
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding a texture or program that
+ *  was just loaded.  The cache owns the OpenGL name from now
+ *  on.  The bytes of a texture are expected to be tracked
+ *  already, and are taken off when the texture is freed.
+ ***********************************************************/
+ResourceHandle ResourceCache::Add(RESOURCE_KIND kind, const std::string& key, unsigned int ID, long long bytes)
+{
+	RESOURCE_ENTRY entry;
+	entry.kind = kind;
+	entry.key = key;
+	entry.ID = ID;
+	entry.pObject = NULL;
+	entry.pDeleter = NULL;
+	entry.bytes = bytes;
+	entry.refCount = 0;
+	entry.bUnreferenced = false;
+
+	std::pair<std::unordered_map<std::string, RESOURCE_ENTRY>::iterator, bool> inserted = m_entries[kind].insert(std::make_pair(key, entry));
+	if (inserted.second == false)
+	{
+		// loaded twice, so the copy that was just loaded is freed
+		// and the one already in the cache is shared
+		std::cout << "The " << g_ResourceKindNames[kind] << " " << key << " is already cached, freeing the new copy" << std::endl;
+		Destroy(&entry);
+	}
+	else
+	{
+		m_totalBytes += bytes;
+	}
+
+	ResourceHandle handle = MakeHandle(&inserted.first->second);
+	Trim();
+	return(handle);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a mesh object that was just
+ *  loaded.  The object is freed through the passed in deleter
+ *  when it is evicted.
+ ***********************************************************/
+ResourceHandle ResourceCache::AddObject(
+	const std::string& key,
+	void* pObject,
+	RESOURCE_DELETER pDeleter,
+	long long bytes)
+{
+	RESOURCE_ENTRY entry;
+	entry.kind = RESOURCE_MESH;
+	entry.key = key;
+	entry.ID = 0;
+	entry.pObject = pObject;
+	entry.pDeleter = pDeleter;
+	entry.bytes = bytes;
+	entry.refCount = 0;
+	entry.bUnreferenced = false;
+
+	std::pair<std::unordered_map<std::string, RESOURCE_ENTRY>::iterator, bool> inserted = m_entries[RESOURCE_MESH].insert(std::make_pair(key, entry));
+	if (inserted.second == false)
+	{
+		std::cout << "The mesh " << key << " is already cached, freeing the new copy" << std::endl;
+		Destroy(&entry);
+	}
+	else
+	{
+		m_totalBytes += bytes;
+	}
+
+	ResourceHandle handle = MakeHandle(&inserted.first->second);
+	Trim();
+	return(handle);
+}
+
+/***********************************************************
+ *  AcquireProgram()
+ *
+ *  This method is used for getting the shader program built
+ *  from the passed in files, loading it on the first use.
+ *  The geometry shader file can be NULL.
+ ***********************************************************/
+ResourceHandle ResourceCache::AcquireProgram(
+	const char* vertexShaderFile,
+	const char* geometryShaderFile,
+	const char* fragmentShaderFile)
+{
+	std::string key = std::string(vertexShaderFile) + "|" +
+		((NULL != geometryShaderFile) ? geometryShaderFile : "") + "|" + fragmentShaderFile;
+
+	ResourceHandle handle = Acquire(RESOURCE_PROGRAM, key);
+	if (handle.IsValid())
+	{
+		return(handle);
+	}
+
+	unsigned int programID = LoadShaderProgram(vertexShaderFile, geometryShaderFile, fragmentShaderFile);
+	if (0 == programID)
+	{
+		return(ResourceHandle());
+	}
+	return(Add(RESOURCE_PROGRAM, key, programID, 0));
+}
+
+/***********************************************************
+ *  AcquireComputeProgram()
+ *
+ *  This method is used for getting the compute program built
+ *  from the passed in file, loading it on the first use.
+ ***********************************************************/
+ResourceHandle ResourceCache::AcquireComputeProgram(const char* computeShaderFile)
+{
+	std::string key = std::string("compute|") + computeShaderFile;
+
+	ResourceHandle handle = Acquire(RESOURCE_PROGRAM, key);
+	if (handle.IsValid())
+	{
+		return(handle);
+	}
+
+	unsigned int programID = LoadComputeProgram(computeShaderFile);
+	if (0 == programID)
+	{
+		return(ResourceHandle());
+	}
+	return(Add(RESOURCE_PROGRAM, key, programID, 0));
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method is used for changing the memory budget and
+ *  freeing the unreferenced resources down to it.
+ ***********************************************************/
+void ResourceCache::SetBudget(long long budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+	Trim();
+}
+
+/***********************************************************
+ *  Trim()
+ *
+ *  This method is used for freeing the least recently used
+ *  unreferenced resources until the cache is within its
+ *  budget.  Referenced resources are never freed, so the
+ *  cache can stay over the budget while they are in use.
+ ***********************************************************/
+void ResourceCache::Trim()
+{
+	while ((m_totalBytes > m_budgetBytes) && (!m_unreferenced.empty()))
+	{
+		RESOURCE_ENTRY* pEntry = m_unreferenced.front();
+		m_unreferenced.pop_front();
+		m_totalBytes -= pEntry->bytes;
+		m_evictions++;
+
+		RESOURCE_KIND kind = pEntry->kind;
+		std::string key = pEntry->key;
+		Destroy(pEntry);
+		m_entries[kind].erase(key);
+	}
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for freeing every resource.  Handles
+ *  still held at this point are reported, as they are left
+ *  pointing at freed resources.
+ ***********************************************************/
+void ResourceCache::Clear()
+{
+	for (int kind = 0; kind < RESOURCE_KIND_COUNT; kind++)
+	{
+		std::unordered_map<std::string, RESOURCE_ENTRY>::iterator entry = m_entries[kind].begin();
+		for (; entry != m_entries[kind].end(); ++entry)
+		{
+			if (entry->second.refCount > 0)
+			{
+				std::cout << "The " << g_ResourceKindNames[kind] << " " << entry->first << " is freed with "
+					<< entry->second.refCount << " references left" << std::endl;
+			}
+			Destroy(&entry->second);
+		}
+		m_entries[kind].clear();
+	}
+	m_unreferenced.clear();
+	m_totalBytes = 0;
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the counters of the cache.
+ ***********************************************************/
+ResourceCache::CACHE_STATS ResourceCache::GetStats() const
+{
+	CACHE_STATS stats;
+	stats.resources = 0;
+	stats.referenced = 0;
+	for (int kind = 0; kind < RESOURCE_KIND_COUNT; kind++)
+	{
+		stats.resources += (int)m_entries[kind].size();
+	}
+	stats.referenced = stats.resources - (int)m_unreferenced.size();
+	stats.bytes = m_totalBytes;
+	stats.hits = m_hits;
+	stats.misses = m_misses;
+	stats.evictions = m_evictions;
+	return(stats);
+}
+
+/***********************************************************
+ *  MakeHandle()
+ *
+ *  This method is used for creating a handle that holds a
+ *  new reference to the passed in entry.
+ ***********************************************************/
+ResourceHandle ResourceCache::MakeHandle(RESOURCE_ENTRY* pEntry)
+{
+	ResourceHandle handle;
+	AddReference(pEntry);
+	handle.m_pCache = this;
+	handle.m_pEntry = pEntry;
+	return(handle);
+}
+
+/***********************************************************
+ *  AddReference()
+ *
+ *  This method is used for adding a reference to the entry,
+ *  taking it out of the unreferenced list on the first one.
+ ***********************************************************/
+void ResourceCache::AddReference(RESOURCE_ENTRY* pEntry)
+{
+	if (pEntry->bUnreferenced)
+	{
+		m_unreferenced.erase(pEntry->lruPosition);
+		pEntry->bUnreferenced = false;
+	}
+	pEntry->refCount++;
+}
+
+/***********************************************************
+ *  ReleaseReference()
+ *
+ *  This method is used for releasing a reference to the
+ *  entry.  Once nothing references it, the entry becomes the
+ *  most recently used one of the unreferenced list, and is
+ *  only freed when the cache is over its budget.
+ ***********************************************************/
+void ResourceCache::ReleaseReference(RESOURCE_ENTRY* pEntry)
+{
+	pEntry->refCount--;
+	if (pEntry->refCount == 0)
+	{
+		pEntry->lruPosition = m_unreferenced.insert(m_unreferenced.end(), pEntry);
+		pEntry->bUnreferenced = true;
+		Trim();
+	}
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the OpenGL name or the
+ *  object of the entry.
+ ***********************************************************/
+void ResourceCache::Destroy(RESOURCE_ENTRY* pEntry)
+{
+	switch (pEntry->kind)
+	{
+	case RESOURCE_TEXTURE:
+		glDeleteTextures(1, &pEntry->ID);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -pEntry->bytes);
+		break;
+	case RESOURCE_PROGRAM:
+		glDeleteProgram(pEntry->ID);
+		break;
+	case RESOURCE_MESH:
+		if ((NULL != pEntry->pDeleter) && (NULL != pEntry->pObject))
+		{
+			pEntry->pDeleter(pEntry->pObject);
+		}
+		break;
+	default:
+		break;
+	}
+	pEntry->ID = 0;
+	pEntry->pObject = NULL;
+}
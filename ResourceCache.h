@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcecache.h
+// ============
+// reference counted textures, meshes and shader programs, with the
+// unreferenced ones kept in a least recently used cache
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// kinds of resource held by the cache
+enum RESOURCE_KIND
+{
+	RESOURCE_TEXTURE,
+	RESOURCE_MESH,
+	RESOURCE_PROGRAM,
+	RESOURCE_KIND_COUNT
+};
+
+// frees the object of a mesh resource
+typedef void (*RESOURCE_DELETER)(void* pObject);
+
+// one cached resource - textures and programs are OpenGL names,
+// meshes are objects freed through their deleter
+struct RESOURCE_ENTRY
+{
+	RESOURCE_KIND kind;
+	std::string key;
+	unsigned int ID;
+	void* pObject;
+	RESOURCE_DELETER pDeleter;
+	long long bytes;
+	int refCount;
+	// position in the least recently used list, only set while
+	// nothing references the entry
+	bool bUnreferenced;
+	std::list<RESOURCE_ENTRY*>::iterator lruPosition;
+};
+
+class ResourceCache;
+
+/***********************************************************
+ *  ResourceHandle
+ *
+ *  This class holds one reference to a cached resource.
+ *  Copies add a reference and the reference is given back
+ *  when the handle is released or destroyed.
+ ***********************************************************/
+class ResourceHandle
+{
+public:
+	// constructor
+	ResourceHandle();
+	ResourceHandle(const ResourceHandle& other);
+	// destructor
+	~ResourceHandle();
+
+	ResourceHandle& operator=(const ResourceHandle& other);
+
+	// give the reference back to the cache
+	void Release();
+
+	bool IsValid() const { return(NULL != m_pEntry); }
+	// OpenGL name of a texture or program, 0 when not valid
+	unsigned int GetID() const { return((NULL != m_pEntry) ? m_pEntry->ID : 0); }
+	// object of a mesh resource, NULL when not valid
+	void* GetObject() const { return((NULL != m_pEntry) ? m_pEntry->pObject : NULL); }
+
+private:
+	friend class ResourceCache;
+
+	ResourceCache* m_pCache;
+	RESOURCE_ENTRY* m_pEntry;
+};
+
+/***********************************************************
+ *  ResourceCache
+ *
+ *  This class owns the loaded textures, meshes and shader
+ *  programs, looked up by kind and key.  A resource stays
+ *  loaded while any handle references it.  When the last
+ *  handle is released it is kept in a least recently used
+ *  list instead of being freed, so switching back to a scene
+ *  does not load it again, and the oldest unreferenced
+ *  resources are freed whenever the cache is over its memory
+ *  budget.  All methods are called on the thread that owns
+ *  the OpenGL context.
+ ***********************************************************/
+class ResourceCache
+{
+public:
+	// constructor
+	ResourceCache(long long budgetBytes = DEFAULT_BUDGET_BYTES);
+	// destructor
+	~ResourceCache();
+
+	// bytes kept by default, referenced resources included
+	static const long long DEFAULT_BUDGET_BYTES = 256LL * 1024 * 1024;
+
+	// counters of the cache, for reporting
+	struct CACHE_STATS
+	{
+		int resources;
+		int referenced;
+		long long bytes;
+		long long hits;
+		long long misses;
+		long long evictions;
+	};
+
+	// get a handle to a loaded resource, not valid when the
+	// resource has to be loaded and added by the caller
+	ResourceHandle Acquire(RESOURCE_KIND kind, const std::string& key);
+	// add a texture or program that was just loaded
+	ResourceHandle Add(RESOURCE_KIND kind, const std::string& key, unsigned int ID, long long bytes);
+	// add a mesh object that was just loaded
+	ResourceHandle AddObject(
+		const std::string& key,
+		void* pObject,
+		RESOURCE_DELETER pDeleter,
+		long long bytes);
+	// get a program from the cache or load it from the shader files
+	ResourceHandle AcquireProgram(
+		const char* vertexShaderFile,
+		const char* geometryShaderFile,
+		const char* fragmentShaderFile);
+	// get a compute program from the cache or load it
+	ResourceHandle AcquireComputeProgram(const char* computeShaderFile);
+
+	// change the budget and free resources down to it
+	void SetBudget(long long budgetBytes);
+	long long GetBudget() const { return m_budgetBytes; }
+	// free the unreferenced resources down to the budget
+	void Trim();
+	// free every resource, on shutdown or to start afresh
+	void Clear();
+
+	CACHE_STATS GetStats() const;
+
+private:
+	friend class ResourceHandle;
+
+	long long m_budgetBytes;
+	long long m_totalBytes;
+	long long m_hits;
+	long long m_misses;
+	long long m_evictions;
+	// one map per kind, the entries do not move when it grows
+	std::unordered_map<std::string, RESOURCE_ENTRY> m_entries[RESOURCE_KIND_COUNT];
+	// unreferenced entries, least recently used first
+	std::list<RESOURCE_ENTRY*> m_unreferenced;
+
+	ResourceHandle MakeHandle(RESOURCE_ENTRY* pEntry);
+	void AddReference(RESOURCE_ENTRY* pEntry);
+	void ReleaseReference(RESOURCE_ENTRY* pEntry);
+	void Destroy(RESOURCE_ENTRY* pEntry);
+};
@@ -0,0 +1,519 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourceuploader.cpp
+// ============
+// upload decoded textures on a thread of its own, through a second GL
+// context that shares its objects with the one the scene renders with
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceUploader.h"
+#include "TextureCompressor.h"
+#include "GpuMemoryTracker.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// where a submitted upload is - a queued one is either
+	// finished by the upload thread or abandoned by its owner,
+	// whichever comes first, and the other side frees it
+	const int REQUEST_QUEUED = 0;
+	const int REQUEST_DONE = 1;
+	const int REQUEST_ABANDONED = 2;
+
+	// the upload thread checks the queue at least this often,
+	// in case a wake up is ever missed
+	const std::chrono::milliseconds SLEEP_TIMEOUT(100);
+
+	// start of each level in the pixel buffer
+	const size_t LEVEL_ALIGNMENT = 16;
+}
+
+// the upload and what became of it
+struct ResourceUploader::UPLOAD_REQUEST : public ResourceUploader::UPLOAD_NODE
+{
+	std::atomic<int> state;
+	SceneManager::DECODED_TEXTURE decoded;
+	// set by the upload thread before the request is done
+	bool bSucceeded;
+	UPLOADED_TEXTURE texture;
+	GLsync fence;
+};
+
+/***********************************************************
+ *  ResourceUploader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceUploader::ResourceUploader()
+{
+	m_pWindow = NULL;
+	m_bStopping = false;
+	m_stub.pNext = NULL;
+	m_pHead = &m_stub;
+	m_pTail = &m_stub;
+	m_bSleeping = false;
+	m_pixelBuffer = 0;
+	m_pixelBufferSize = 0;
+}
+
+/***********************************************************
+ *  ~ResourceUploader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResourceUploader::~ResourceUploader()
+{
+	if (m_thread.joinable())
+	{
+		m_bStopping = true;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bSleeping = false;
+		}
+		m_wake.notify_one();
+		m_thread.join();
+	}
+
+	if (NULL != m_pWindow)
+	{
+		glfwDestroyWindow(m_pWindow);
+		m_pWindow = NULL;
+	}
+
+	// requests left in the queue were never uploaded
+	UPLOAD_NODE* pNode = Pop();
+	while (NULL != pNode)
+	{
+		delete static_cast<UPLOAD_REQUEST*>(pNode);
+		pNode = Pop();
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the upload context in a
+ *  hidden window, sharing the textures, buffers and fences of
+ *  the passed in window's context, and starting the upload
+ *  thread that makes it current.  GLEW keeps its function
+ *  pointers for the process, and both contexts come from the
+ *  same driver, so they are used on the upload thread as
+ *  they are.
+ ***********************************************************/
+bool ResourceUploader::Initialize(GLFWwindow* pSharedWindow)
+{
+	if ((NULL == pSharedWindow) || (NULL != m_pWindow))
+	{
+		return(false);
+	}
+
+	// the version and profile hints set for the main window
+	// still hold, so the contexts match
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_pWindow = glfwCreateWindow(1, 1, "Resource uploads", NULL, pSharedWindow);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (NULL == m_pWindow)
+	{
+		std::cout << "Could not create the resource upload context" << std::endl;
+		return(false);
+	}
+
+	m_bStopping = false;
+	m_thread = std::thread(&ResourceUploader::UploadLoop, this);
+	return(true);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queuing the upload of a decoded
+ *  texture and waking the upload thread when it sleeps.  The
+ *  returned ticket is polled with TakeUploadedTexture().
+ ***********************************************************/
+ResourceUploader::UPLOAD_REQUEST* ResourceUploader::Submit(SceneManager::DECODED_TEXTURE& decoded)
+{
+	UPLOAD_REQUEST* pRequest = new UPLOAD_REQUEST();
+	pRequest->state = REQUEST_QUEUED;
+	pRequest->decoded = std::move(decoded);
+	pRequest->bSucceeded = false;
+	pRequest->texture.textureID = 0;
+	pRequest->texture.bytes = 0;
+	pRequest->texture.filename = pRequest->decoded.filename;
+	pRequest->texture.decodeMilliseconds = pRequest->decoded.decodeMilliseconds;
+	pRequest->texture.uploadMilliseconds = 0.0;
+	pRequest->fence = NULL;
+
+	Push(pRequest);
+	// the push and the check of the flag pair with the upload
+	// thread setting it and checking the queue, so either it
+	// sees the request or this sees it asleep
+	if (m_bSleeping.exchange(false))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_wake.notify_one();
+	}
+	return(pRequest);
+}
+
+/***********************************************************
+ *  TakeUploadedTexture()
+ *
+ *  This method is used for taking an upload once it is safe
+ *  to draw with.  The fence is checked without waiting, so a
+ *  texture the GPU is still copying stays pending until a
+ *  later frame.  A ready texture belongs to the caller, who
+ *  binds it again before drawing with it.
+ ***********************************************************/
+ResourceUploader::UPLOAD_STATUS ResourceUploader::TakeUploadedTexture(UPLOAD_REQUEST* pRequest, UPLOADED_TEXTURE& texture)
+{
+	if (pRequest->state.load() != REQUEST_DONE)
+	{
+		return(UPLOAD_PENDING);
+	}
+	if (!pRequest->bSucceeded)
+	{
+		delete pRequest;
+		return(UPLOAD_FAILED);
+	}
+
+	GLenum result = glClientWaitSync(pRequest->fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return(UPLOAD_PENDING);
+	}
+	if (result == GL_WAIT_FAILED)
+	{
+		FreeUpload(pRequest);
+		return(UPLOAD_FAILED);
+	}
+
+	texture = pRequest->texture;
+	glDeleteSync(pRequest->fence);
+	delete pRequest;
+	return(UPLOAD_READY);
+}
+
+/***********************************************************
+ *  Abandon()
+ *
+ *  This method is used for giving up on an upload that has
+ *  not been taken.  A queued one is marked for the upload
+ *  thread to drop, and a finished one is freed here.
+ ***********************************************************/
+void ResourceUploader::Abandon(UPLOAD_REQUEST* pRequest)
+{
+	int expected = REQUEST_QUEUED;
+	if (pRequest->state.compare_exchange_strong(expected, REQUEST_ABANDONED))
+	{
+		return;
+	}
+	FreeUpload(pRequest);
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding a node at the head of the
+ *  queue from any thread.  The head is swapped in one atomic
+ *  step and the old head is linked to the node after it, so
+ *  pushes never wait on each other.
+ ***********************************************************/
+void ResourceUploader::Push(UPLOAD_NODE* pNode)
+{
+	pNode->pNext.store(NULL, std::memory_order_relaxed);
+	UPLOAD_NODE* pPrevious = m_pHead.exchange(pNode);
+	pPrevious->pNext.store(pNode, std::memory_order_release);
+}
+
+/***********************************************************
+ *  Pop()
+ *
+ *  This method is used for taking the node at the tail of the
+ *  queue on the upload thread.  NULL is returned when it is
+ *  empty, and also when a push has swapped the head but not
+ *  yet linked its node, which is taken on a later call.
+ ***********************************************************/
+ResourceUploader::UPLOAD_NODE* ResourceUploader::Pop()
+{
+	UPLOAD_NODE* pTail = m_pTail;
+	UPLOAD_NODE* pNext = pTail->pNext.load(std::memory_order_acquire);
+
+	// step over the queue's own node
+	if (pTail == &m_stub)
+	{
+		if (NULL == pNext)
+		{
+			return(NULL);
+		}
+		m_pTail = pNext;
+		pTail = pNext;
+		pNext = pNext->pNext.load(std::memory_order_acquire);
+	}
+
+	if (NULL != pNext)
+	{
+		m_pTail = pNext;
+		return(pTail);
+	}
+
+	// the tail is the last node, so the queue's own node is put
+	// behind it before it is taken, unless a push is under way
+	if (pTail != m_pHead.load())
+	{
+		return(NULL);
+	}
+	Push(&m_stub);
+	pNext = pTail->pNext.load(std::memory_order_acquire);
+	if (NULL != pNext)
+	{
+		m_pTail = pNext;
+		return(pTail);
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  IsQueueEmpty()
+ *
+ *  This method is used for checking, on the upload thread,
+ *  whether anything has been pushed that is not yet taken.
+ ***********************************************************/
+bool ResourceUploader::IsQueueEmpty() const
+{
+	return((m_pTail == &m_stub) && (m_pHead.load() == &m_stub));
+}
+
+/***********************************************************
+ *  UploadLoop()
+ *
+ *  This method is used for running the upload thread.  The
+ *  queued textures are uploaded in the order they came, and
+ *  the thread sleeps whenever the queue is empty.
+ ***********************************************************/
+void ResourceUploader::UploadLoop()
+{
+	glfwMakeContextCurrent(m_pWindow);
+	glGenBuffers(1, &m_pixelBuffer);
+
+	while (true)
+	{
+		UPLOAD_NODE* pNode = Pop();
+		if (NULL != pNode)
+		{
+			UPLOAD_REQUEST* pRequest = static_cast<UPLOAD_REQUEST*>(pNode);
+			if (pRequest->state.load() == REQUEST_ABANDONED)
+			{
+				delete pRequest;
+			}
+			else
+			{
+				pRequest->bSucceeded = Upload(pRequest);
+				Publish(pRequest);
+			}
+			continue;
+		}
+		if (m_bStopping)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bSleeping = true;
+		if (IsQueueEmpty() && !m_bStopping)
+		{
+			m_wake.wait_for(lock, SLEEP_TIMEOUT, [this]()
+			{
+				return(!m_bSleeping.load() || m_bStopping.load());
+			});
+		}
+		m_bSleeping = false;
+	}
+
+	glDeleteBuffers(1, &m_pixelBuffer);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)m_pixelBufferSize);
+	m_pixelBuffer = 0;
+	m_pixelBufferSize = 0;
+	glfwMakeContextCurrent(NULL);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for uploading one texture.  Its levels
+ *  are copied into the pixel buffer, which is orphaned first
+ *  so the copy never waits on the upload before it, and the
+ *  texture is filled from the buffer by the GPU.  The fence
+ *  put after that is flushed, so it signals without this
+ *  context doing anything more.
+ ***********************************************************/
+bool ResourceUploader::Upload(UPLOAD_REQUEST* pRequest)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const SceneManager::DECODED_TEXTURE& decoded = pRequest->decoded;
+	if (!decoded.bDecoded)
+	{
+		return(false);
+	}
+
+	// lay the levels out in the buffer
+	std::vector<const unsigned char*> levelData;
+	std::vector<size_t> levelSizes;
+	std::vector<int> levelWidths;
+	std::vector<int> levelHeights;
+	if (decoded.bCompressed)
+	{
+		for (size_t level = 0; level < decoded.compressedImage.levels.size(); level++)
+		{
+			const COMPRESSED_LEVEL& compressedLevel = decoded.compressedImage.levels[level];
+			levelData.push_back(compressedLevel.data.data());
+			levelSizes.push_back(compressedLevel.data.size());
+			levelWidths.push_back(compressedLevel.width);
+			levelHeights.push_back(compressedLevel.height);
+		}
+	}
+	else
+	{
+		for (size_t level = 0; level < decoded.levels.size(); level++)
+		{
+			levelData.push_back(decoded.levels[level].pixels.data());
+			levelSizes.push_back(decoded.levels[level].pixels.size());
+			levelWidths.push_back(decoded.levels[level].width);
+			levelHeights.push_back(decoded.levels[level].height);
+		}
+	}
+	if (levelData.empty())
+	{
+		return(false);
+	}
+
+	std::vector<size_t> levelOffsets;
+	size_t bufferSize = 0;
+	for (size_t level = 0; level < levelSizes.size(); level++)
+	{
+		levelOffsets.push_back(bufferSize);
+		bufferSize += (levelSizes[level] + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+	if ((GLsizeiptr)bufferSize > m_pixelBufferSize)
+	{
+		TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)bufferSize - (long long)m_pixelBufferSize);
+		m_pixelBufferSize = (GLsizeiptr)bufferSize;
+	}
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pixelBufferSize, NULL, GL_STREAM_DRAW);
+	unsigned char* pMapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bufferSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL == pMapped)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		std::cout << "Could not map the upload buffer for image:" << decoded.filename << std::endl;
+		return(false);
+	}
+	for (size_t level = 0; level < levelData.size(); level++)
+	{
+		memcpy(pMapped + levelOffsets[level], levelData[level], levelSizes[level]);
+	}
+	// the contents are lost when the buffer is unmapped badly
+	if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		std::cout << "Could not fill the upload buffer for image:" << decoded.filename << std::endl;
+		return(false);
+	}
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// the same parameters as a texture uploaded by the scene
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	GLsizei levelCount = (GLsizei)levelData.size();
+	long long textureBytes = 0;
+	if (decoded.bCompressed)
+	{
+		GLenum internalFormat = GetBlockInternalFormat(decoded.blockFormat);
+		glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, levelWidths[0], levelHeights[0]);
+		for (GLsizei level = 0; level < levelCount; level++)
+		{
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidths[level], levelHeights[level],
+				internalFormat, (GLsizei)levelSizes[level], (const void*)levelOffsets[level]);
+		}
+		textureBytes = (long long)decoded.compressedImage.compressedBytes;
+	}
+	else
+	{
+		// the prepared levels are RGBA, so every row is 4 byte
+		// aligned whatever the width of the image
+		GLenum internalFormat = (decoded.colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+		glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, levelWidths[0], levelHeights[0]);
+		for (GLsizei level = 0; level < levelCount; level++)
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidths[level], levelHeights[level],
+				GL_RGBA, GL_UNSIGNED_BYTE, (const void*)levelOffsets[level]);
+			textureBytes += (long long)levelSizes[level];
+		}
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, textureBytes);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	pRequest->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	pRequest->texture.textureID = textureID;
+	pRequest->texture.bytes = textureBytes;
+	pRequest->texture.uploadMilliseconds =
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	// the decoded levels are not needed after the upload
+	pRequest->decoded = SceneManager::DECODED_TEXTURE();
+	return(true);
+}
+
+/***********************************************************
+ *  Publish()
+ *
+ *  This method is used for handing a finished upload to its
+ *  owner, or freeing it when the owner has abandoned it.
+ ***********************************************************/
+void ResourceUploader::Publish(UPLOAD_REQUEST* pRequest)
+{
+	int expected = REQUEST_QUEUED;
+	if (!pRequest->state.compare_exchange_strong(expected, REQUEST_DONE))
+	{
+		FreeUpload(pRequest);
+	}
+}
+
+/***********************************************************
+ *  FreeUpload()
+ *
+ *  This method is used for deleting a finished upload with
+ *  its texture and fence, from either context, as both share
+ *  them.
+ ***********************************************************/
+void ResourceUploader::FreeUpload(UPLOAD_REQUEST* pRequest)
+{
+	if (NULL != pRequest->fence)
+	{
+		glDeleteSync(pRequest->fence);
+	}
+	if (0 != pRequest->texture.textureID)
+	{
+		glDeleteTextures(1, &pRequest->texture.textureID);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -pRequest->texture.bytes);
+	}
+	delete pRequest;
+}
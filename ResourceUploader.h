@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourceuploader.h
+// ============
+// upload decoded textures on a thread of its own, through a second GL
+// context that shares its objects with the one the scene renders with
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/***********************************************************
+ *  ResourceUploader
+ *
+ *  This class keeps the texture uploads off the render
+ *  thread.  Any thread submits a decoded texture and gets a
+ *  ticket back.  The upload thread takes the submitted
+ *  textures from a lock-free queue, copies their levels into
+ *  a pixel buffer and fills a new texture from it in its own
+ *  context, then puts a fence after the upload.  The render
+ *  thread polls the ticket once per frame and takes the
+ *  texture only when its fence has signaled, so it never
+ *  waits on an upload and never draws with a texture that
+ *  is not complete.
+ *
+ *  The hidden window holding the upload context is made and
+ *  destroyed on the main thread, as GLFW requires.
+ ***********************************************************/
+class ResourceUploader
+{
+public:
+	// constructor
+	ResourceUploader();
+	// destructor, stops the upload thread - every ticket must
+	// have been taken or abandoned before this
+	~ResourceUploader();
+
+	// a submitted upload, owned by the uploader until it is
+	// taken or abandoned
+	struct UPLOAD_REQUEST;
+
+	// a texture filled by the upload thread, owned by whoever
+	// takes it
+	struct UPLOADED_TEXTURE
+	{
+		GLuint textureID;
+		long long bytes;
+		std::string filename;
+		// on the thread that decoded it, and on the upload thread
+		double decodeMilliseconds;
+		double uploadMilliseconds;
+	};
+
+	enum UPLOAD_STATUS
+	{
+		// still queued, or its fence has not signaled
+		UPLOAD_PENDING,
+		UPLOAD_READY,
+		UPLOAD_FAILED
+	};
+
+	// create the upload context sharing the objects of the
+	// passed in window's context and start the upload thread,
+	// called on the main thread
+	bool Initialize(GLFWwindow* pSharedWindow);
+
+	// hand a decoded texture to the upload thread, from any
+	// thread - its levels are moved out of the passed in one
+	UPLOAD_REQUEST* Submit(SceneManager::DECODED_TEXTURE& decoded);
+	// check an upload without waiting, on the render thread -
+	// the ticket is used up unless the upload is still pending
+	UPLOAD_STATUS TakeUploadedTexture(UPLOAD_REQUEST* pRequest, UPLOADED_TEXTURE& texture);
+	// give up on an upload, on the render thread, freeing its
+	// texture whenever it is done
+	void Abandon(UPLOAD_REQUEST* pRequest);
+
+private:
+	// link of the queue, the queue keeps one of its own so it
+	// is never empty
+	struct UPLOAD_NODE
+	{
+		std::atomic<UPLOAD_NODE*> pNext;
+	};
+
+	GLFWwindow* m_pWindow;
+	std::thread m_thread;
+	std::atomic<bool> m_bStopping;
+
+	// the queue, pushed to at its head by any thread and popped
+	// from its tail by the upload thread only
+	std::atomic<UPLOAD_NODE*> m_pHead;
+	UPLOAD_NODE* m_pTail;
+	UPLOAD_NODE m_stub;
+
+	// the upload thread sleeps while the queue is empty and is
+	// woken by the next push that finds it asleep
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::atomic<bool> m_bSleeping;
+
+	// pixel buffer the levels are copied into, grown to the
+	// largest texture uploaded and orphaned for each one
+	GLuint m_pixelBuffer;
+	GLsizeiptr m_pixelBufferSize;
+
+	void Push(UPLOAD_NODE* pNode);
+	UPLOAD_NODE* Pop();
+	bool IsQueueEmpty() const;
+	void UploadLoop();
+	bool Upload(UPLOAD_REQUEST* pRequest);
+	void Publish(UPLOAD_REQUEST* pRequest);
+	static void FreeUpload(UPLOAD_REQUEST* pRequest);
+};
@@ -8,14 +8,32 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
+#include "TransparencyRenderer.h"
+#include "DepthPrepassRenderer.h"
+#include "DeferredRenderer.h"
+#include "ImpostorRenderer.h"
+#include "MultiViewRenderer.h"
+#include "FrameCapture.h"
+#include "TextureCompressor.h"
+#include "ImageProcessing.h"
+#include "FrustumCulling.h"
+#include "GpuMemoryTracker.h"
+#include "AffineTransform.h"
+#include "BasicMeshes.h"
+#include "MeshCache.h"
+#include "AssetPack.h"
+#include "ImageDecoder.h"
+#include "ProceduralTextures.h"
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
 // declaration of global variables
 namespace
 {
@@ -24,6 +42,79 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+
+	// encode the scene textures into block compressed formats,
+	// BC1 for RGB and BC3 for RGBA, or BC7 for both when the
+	// higher quality is worth twice the size of BC1
+	const bool g_bCompressTextures = true;
+	const bool g_bPreferBC7 = false;
+
+	// the command list a thread is recording the Make* methods
+	// into, the Set* methods and DrawMesh() only record while set
+	thread_local CommandList* g_pRecordingList = NULL;
+
+	// below this many draws a frame is recorded on the calling
+	// thread, as waking the workers costs more than it saves
+	const int g_ParallelRecordThreshold = 4096;
+
+	// key of the basic meshes in the resource cache
+	const char* g_BasicMeshesKey = "basic_meshes";
+	// file the generated basic meshes are kept in between runs
+	const char* g_BasicMeshesCacheFile = "basic_meshes.meshcache";
+
+	// size of the 1x1 RGBA placeholder textures
+	const long long g_PlaceholderTextureBytes = 4;
+
+	// views around the camera and the size of each one in the
+	// multi-view pass
+	const int g_MultiViewCount = 64;
+	const int g_MultiViewSize = 256;
+
+	/***********************************************************
+	 *  DeleteMeshArena()
+	 *
+	 *  This function is used for freeing the basic meshes when
+	 *  the resource cache evicts them.
+	 ***********************************************************/
+	void DeleteMeshArena(void* pObject)
+	{
+		delete (MeshArena*)pObject;
+	}
+
+	/***********************************************************
+	 *  GenerateBasicMeshes()
+	 *
+	 *  This function is used for generating the geometry of the
+	 *  basic shapes, in the order of the MESH_TYPE values so the
+	 *  index of each mesh is its type.
+	 ***********************************************************/
+	void GenerateBasicMeshes(MESH_DATA& data)
+	{
+		for (int mesh = 0; mesh < SceneManager::MESH_TYPE_COUNT; mesh++)
+		{
+			std::vector<MESH_VERTEX> vertices;
+			std::vector<GLuint> indices;
+			switch (mesh)
+			{
+			case SceneManager::BOX_MESH:
+				BuildBoxMesh(vertices, indices);
+				break;
+			case SceneManager::CYLINDER_MESH:
+				BuildCylinderMesh(vertices, indices, 1.0f, 1.0f);
+				break;
+			case SceneManager::PLANE_MESH:
+				BuildPlaneMesh(vertices, indices);
+				break;
+			case SceneManager::TAPERED_CYLINDER_MESH:
+				BuildCylinderMesh(vertices, indices, 1.0f, TAPERED_CYLINDER_TOP_RADIUS);
+				break;
+			case SceneManager::CONE_MESH:
+				BuildCylinderMesh(vertices, indices, 1.0f, 0.0f);
+				break;
+			}
+			AppendMesh(data, vertices, indices);
+		}
+	}
 }
 
 /***********************************************************
@@ -31,18 +122,41 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
+SceneManager::SceneManager(ShaderManager* pShaderManager, ResourceCache* pResourceCache)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pResourceCache = pResourceCache;
+	m_bOwnsResourceCache = false;
+	if (NULL == m_pResourceCache)
+	{
+		m_pResourceCache = new ResourceCache();
+		m_bOwnsResourceCache = true;
+	}
+	m_pMeshArena = NULL;
+	m_pPlaceholderMeshes = NULL;
 
 	// initialize the texture collection
 	for (int i = 0; i < 16; i++)
 	{
 		m_textureIDs[i].tag = "/0";
 		m_textureIDs[i].ID = -1;
+		m_textureIDs[i].bPlaceholder = false;
 	}
 	m_loadedTextures = 0;
+
+	m_lastRecordedDraws = 0;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pTransparencyRenderer = NULL;
+	m_pDepthPrepassRenderer = NULL;
+	m_pDeferredRenderer = NULL;
+	m_pImpostorRenderer = NULL;
+	m_pMultiViewRenderer = NULL;
+	m_frameStats = FRAME_STATS();
+	m_pLastSubmitShader = NULL;
+	m_lastSubmitTexture = -1;
+	m_lastSubmitMaterial = -1;
 }
 
 /***********************************************************
@@ -53,10 +167,44 @@ SceneManager::SceneManager(ShaderManager* pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
+	if (NULL != m_pTransparencyRenderer)
+	{
+		delete m_pTransparencyRenderer;
+		m_pTransparencyRenderer = NULL;
+	}
+	if (NULL != m_pDepthPrepassRenderer)
+	{
+		delete m_pDepthPrepassRenderer;
+		m_pDepthPrepassRenderer = NULL;
+	}
+	if (NULL != m_pDeferredRenderer)
+	{
+		delete m_pDeferredRenderer;
+		m_pDeferredRenderer = NULL;
+	}
+	if (NULL != m_pImpostorRenderer)
+	{
+		delete m_pImpostorRenderer;
+		m_pImpostorRenderer = NULL;
+	}
+	if (NULL != m_pMultiViewRenderer)
+	{
+		delete m_pMultiViewRenderer;
+		m_pMultiViewRenderer = NULL;
+	}
 
+	// the renderers release their programs above, so once the
+	// meshes and textures are released nothing is referenced
+	m_meshesHandle.Release();
+	m_pMeshArena = NULL;
+	DestroyPlaceholderMeshes();
 	DestroyGLTextures();
+
+	if (m_bOwnsResourceCache)
+	{
+		delete m_pResourceCache;
+	}
+	m_pResourceCache = NULL;
 }
 
 /***********************************************************
@@ -65,72 +213,514 @@ SceneManager::~SceneManager()
  *  This method is used for loading textures from image files,
  *  configuring the texture mapping parameters in OpenGL,
  *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  the next available texture slot in memory.  A texture that
+ *  is still in the resource cache is used without loading it
+ *  again.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
+	if (AcquireCachedTexture(filename, tag))
+	{
+		return true;
+	}
 
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3 && filename)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
+	DECODED_TEXTURE decoded;
+	if (!DecodeTexture(filename, decoded))
+	{
+		return false;
+	}
+	return(UploadTexture(decoded, tag));
+}
+
+/***********************************************************
+ *  BakeProceduralTextures()
+ *
+ *  This method is used for generating the procedural textures
+ *  of the scene into the next available texture slots.  A
+ *  texture still in the resource cache is used as it is, and
+ *  the image file of a texture is loaded in its place when it
+ *  cannot be generated.
+ ***********************************************************/
+void SceneManager::BakeProceduralTextures()
+{
+	for (size_t i = 0; i < m_proceduralTextures.size(); i++)
+	{
+		const PROCEDURAL_TEXTURE& texture = m_proceduralTextures[i];
+		std::string key = GetProceduralTextureKey(texture);
+		if (AcquireCachedTexture(key.c_str(), texture.tag))
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		long long textureBytes = 0;
+		GLuint textureID = BakeProceduralTexture(m_pResourceCache, texture, textureBytes);
+		if (0 == textureID)
+		{
+			std::cout << "Could not generate procedural texture, loading image:" << texture.fallbackFilename << std::endl;
+			CreateGLTexture(texture.fallbackFilename.c_str(), texture.tag);
+			continue;
+		}
+		InstallTexture(textureID, textureBytes, key,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(), texture.tag);
+	}
+}
+
+/***********************************************************
+ *  AcquireCachedTexture()
+ *
+ *  This method is used for putting a texture that is still in
+ *  the resource cache into the next available texture slot.
+ *  False is returned when the texture has to be loaded.
+ ***********************************************************/
+bool SceneManager::AcquireCachedTexture(const char* filename, std::string tag)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	ResourceHandle handle = m_pResourceCache->Acquire(RESOURCE_TEXTURE, filename);
+	if (!handle.IsValid())
+	{
+		return false;
+	}
+
+	int slot = ClaimTextureSlot(tag);
+	if (slot < 0)
+	{
+		return false;
+	}
+	m_textureIDs[slot].ID = handle.GetID();
+	m_textureIDs[slot].tag = tag;
+	m_textureIDs[slot].handle = handle;
+
+	LOAD_TIME loadTime;
+	loadTime.name = filename;
+	loadTime.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	m_loadTimes.push_back(loadTime);
+
+	return true;
+}
+
+/***********************************************************
+ *  DecodeTexture()
+ *
+ *  This method is used for reading a texture image file and
+ *  preparing its mipmaps, block compressing them when that is
+ *  enabled.  No OpenGL calls are made, so the textures of a
+ *  scene can be decoded on a worker thread while another
+ *  scene is rendering.  When the file has been read ahead its
+ *  contents are passed in and only decoded.
+ ***********************************************************/
+bool SceneManager::DecodeTexture(
+	const char* filename,
+	DECODED_TEXTURE& decoded,
+	const unsigned char* pFileData,
+	size_t fileSize)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	decoded.filename = filename;
+	decoded.bDecoded = false;
+	decoded.width = 0;
+	decoded.height = 0;
+	decoded.colorChannels = 0;
+	decoded.levels.clear();
+	decoded.bCompressed = false;
+	decoded.decodeMilliseconds = 0.0;
+
+	// an image in the asset pack is decoded straight from the
+	// mapped file, and a loose one is read whole first
+	ASSET_DATA asset;
+	std::vector<unsigned char> fileContents;
+	if ((NULL == pFileData) && LoadPackedAsset(filename, asset))
+	{
+		pFileData = asset.pData;
+		fileSize = asset.size;
+	}
+	if (NULL == pFileData)
+	{
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		if (file.is_open())
+		{
+			fileContents.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read((char*)fileContents.data(), fileContents.size());
+		}
+		if (!file.is_open() || !file)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
 			return false;
 		}
+		pFileData = fileContents.data();
+		fileSize = fileContents.size();
+	}
+
+	// the decoder is picked by the format of the contents - every
+	// one leaves the rows as they are in the file, they are
+	// flipped by PrepareImage() on worker threads
+	const ImageDecoder* pDecoder = GetImageDecoder(DetectImageFormat(pFileData, fileSize));
+	DECODED_IMAGE image;
+	if (!pDecoder->Decode(pFileData, fileSize, image))
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return false;
+	}
+	decoded.width = image.width;
+	decoded.height = image.height;
+	decoded.colorChannels = image.channels;
+
+	std::cout << "Successfully loaded image:" << filename << ", width:" << decoded.width << ", height:" << decoded.height << ", channels:" << decoded.colorChannels
+		<< ", decoder:" << pDecoder->GetName() << std::endl;
+
+	// only RGB and RGBA images are supported - RGBA supports transparency
+	if ((decoded.colorChannels != 3) && (decoded.colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << decoded.colorChannels << " channels" << std::endl;
+		return false;
+	}
+
+	// flip the image, expand it to RGBA and build the sRGB
+	// correct mipmaps, then free the decoded image data
+	IMAGE_PREP_OPTIONS prepOptions;
+	PrepareImage(image.pixels.data(), decoded.width, decoded.height, decoded.colorChannels, prepOptions, decoded.levels);
+	image.pixels = std::vector<unsigned char>();
+
+	// try the block compression first
+	decoded.blockFormat = g_bPreferBC7 ? BLOCK_FORMAT_BC7 : ((decoded.colorChannels == 4) ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_BC1);
+	if (g_bCompressTextures)
+	{
+		COMPRESSED_IMAGE& compressedImage = decoded.compressedImage;
+		if (!IsBlockFormatSupported(decoded.blockFormat))
+		{
+			std::cout << GetBlockFormatName(decoded.blockFormat) << " textures are not supported, uploading uncompressed" << std::endl;
+		}
+		else if (CompressImage(decoded.levels, decoded.colorChannels, decoded.blockFormat, compressedImage))
+		{
+			decoded.bCompressed = true;
+
+			std::cout << "Compressed image:" << filename << " to " << GetBlockFormatName(decoded.blockFormat)
+				<< ", " << compressedImage.uncompressedBytes / 1024 << " KB -> " << compressedImage.compressedBytes / 1024 << " KB"
+				<< " (" << 100.0 * (1.0 - (double)compressedImage.compressedBytes / compressedImage.uncompressedBytes) << "% saved)"
+				<< ", PSNR:" << compressedImage.psnr << " dB"
+				<< ", encode:" << compressedImage.encodeMilliseconds << " ms" << std::endl;
+		}
+	}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	decoded.bDecoded = true;
+	decoded.decodeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	return true;
+}
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+/***********************************************************
+ *  UploadTexture()
+ *
+ *  This method is used for creating the OpenGL texture of a
+ *  decoded image and loading it into the next available
+ *  texture slot.  The texture binding of the active unit is
+ *  kept, since a scene that is rendering relies on it while
+ *  the next scene is loaded.
+ ***********************************************************/
+bool SceneManager::UploadTexture(const DECODED_TEXTURE& decoded, std::string tag)
+{
+	GLuint textureID = 0;
+	GLint previousTexture = 0;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	if (!decoded.bDecoded)
+	{
+		return false;
+	}
+	int slot = ClaimTextureSlot(tag);
+	if (slot < 0)
+	{
+		std::cout << "No texture slot left for image:" << decoded.filename << std::endl;
+		return false;
+	}
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	long long textureBytes = 0;
+	if (decoded.bCompressed)
+	{
+		const COMPRESSED_IMAGE& compressedImage = decoded.compressedImage;
+		for (size_t level = 0; level < compressedImage.levels.size(); level++)
+		{
+			const COMPRESSED_LEVEL& compressedLevel = compressedImage.levels[level];
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, GetBlockInternalFormat(decoded.blockFormat),
+				compressedLevel.width, compressedLevel.height, 0,
+				(GLsizei)compressedLevel.data.size(), compressedLevel.data.data());
+		}
+		textureBytes = (long long)compressedImage.compressedBytes;
+	}
+	else
+	{
+		// the prepared levels are RGBA, so every row is 4 byte
+		// aligned whatever the width of the image
+		GLenum internalFormat = (decoded.colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+		for (size_t level = 0; level < decoded.levels.size(); level++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, decoded.levels[level].width, decoded.levels[level].height,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.levels[level].pixels.data());
+			textureBytes += (long long)decoded.levels[level].pixels.size();
+		}
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, textureBytes);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)decoded.levels.size() - 1);
+
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	// register the loaded texture and associate it with the special tag
+	// string, the cache owns the texture from here on and hands back
+	// the copy it already had when the image was loaded twice
+	ResourceHandle handle = m_pResourceCache->Add(RESOURCE_TEXTURE, decoded.filename, textureID, textureBytes);
+	m_textureIDs[slot].ID = handle.GetID();
+	m_textureIDs[slot].tag = tag;
+	m_textureIDs[slot].handle = handle;
+
+	LOAD_TIME loadTime;
+	loadTime.name = decoded.filename;
+	loadTime.milliseconds = decoded.decodeMilliseconds +
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	m_loadTimes.push_back(loadTime);
+
+	return true;
+}
+
+/***********************************************************
+ *  InstallTexture()
+ *
+ *  This method is used for putting a texture that was created
+ *  and filled on the resource upload thread into the scene.
+ *  The upload has finished, so only the slot and the cache
+ *  entry are set here.  The texture is deleted when no slot
+ *  is left for it.
+ ***********************************************************/
+bool SceneManager::InstallTexture(
+	GLuint textureID,
+	long long textureBytes,
+	const std::string& filename,
+	double loadMilliseconds,
+	std::string tag)
+{
+	int slot = ClaimTextureSlot(tag);
+	if (slot < 0)
+	{
+		std::cout << "No texture slot left for image:" << filename << std::endl;
+		glDeleteTextures(1, &textureID);
+		TrackGpuMemory(GPU_MEMORY_TEXTURE, -textureBytes);
+		return false;
+	}
 
+	// the texture is freed in favour of the cached copy when the
+	// image was loaded twice
+	ResourceHandle handle = m_pResourceCache->Add(RESOURCE_TEXTURE, filename, textureID, textureBytes);
+	m_textureIDs[slot].ID = handle.GetID();
+	m_textureIDs[slot].tag = tag;
+	m_textureIDs[slot].handle = handle;
+
+	LOAD_TIME loadTime;
+	loadTime.name = filename;
+	loadTime.milliseconds = loadMilliseconds;
+	m_loadTimes.push_back(loadTime);
+
+	return true;
+}
+
+/***********************************************************
+ *  AcquireCachedMeshes()
+ *
+ *  This method is used for using the basic meshes while they
+ *  are still in the resource cache.  False is returned when
+ *  they have to be loaded.
+ ***********************************************************/
+bool SceneManager::AcquireCachedMeshes()
+{
+	m_meshesHandle = m_pResourceCache->Acquire(RESOURCE_MESH, g_BasicMeshesKey);
+	if (!m_meshesHandle.IsValid())
+	{
+		return(false);
+	}
+
+	m_pMeshArena = (MeshArena*)m_meshesHandle.GetObject();
+	DestroyPlaceholderMeshes();
+	return(true);
+}
+
+/***********************************************************
+ *  LoadMeshData()
+ *
+ *  This method is used for getting the geometry of the basic
+ *  meshes.  It is read from the mesh cache file, and is
+ *  generated and written to the cache when the file is
+ *  missing or out of date.  The contents of the cache file
+ *  are passed in when it has been read ahead.  No OpenGL
+ *  calls are made, so it can run on a worker thread.
+ ***********************************************************/
+bool SceneManager::LoadMeshData(MESH_DATA& data, const unsigned char* pCacheData, size_t cacheSize)
+{
+	bool bRead = (NULL != pCacheData) ?
+		ReadMeshCacheData(pCacheData, cacheSize, BASIC_MESHES_VERSION, data, g_BasicMeshesCacheFile) :
+		ReadMeshCache(g_BasicMeshesCacheFile, BASIC_MESHES_VERSION, data);
+	if (bRead && (data.ranges.size() == MESH_TYPE_COUNT))
+	{
+		return(true);
+	}
+
+	data = MESH_DATA();
+	GenerateBasicMeshes(data);
+	WriteMeshCache(g_BasicMeshesCacheFile, BASIC_MESHES_VERSION, data);
+	return(true);
+}
+
+/***********************************************************
+ *  GetMeshCacheFile()
+ *
+ *  This method is used for getting the name of the file the
+ *  basic meshes are cached in.
+ ***********************************************************/
+const char* SceneManager::GetMeshCacheFile()
+{
+	return(g_BasicMeshesCacheFile);
+}
+
+/***********************************************************
+ *  UploadMeshes()
+ *
+ *  This method is used for uploading the geometry of the basic
+ *  meshes into a new mesh arena, which the resource cache
+ *  owns from then on.  The meshes in the cache are used
+ *  instead when another scene has loaded them meanwhile.
+ ***********************************************************/
+bool SceneManager::UploadMeshes(const MESH_DATA& data)
+{
+	if (AcquireCachedMeshes())
+	{
+		return(true);
+	}
+
+	MeshArena* pArena = new MeshArena();
+	if (!pArena->Initialize() || (pArena->AddMeshes(data) < 0))
+	{
+		std::cout << "Could not upload the basic meshes" << std::endl;
+		delete pArena;
+		return(false);
+	}
+
+	m_meshesHandle = m_pResourceCache->AddObject(g_BasicMeshesKey, pArena, DeleteMeshArena, pArena->GetBytes());
+	m_pMeshArena = (MeshArena*)m_meshesHandle.GetObject();
+	DestroyPlaceholderMeshes();
+	return(true);
+}
+
+/***********************************************************
+ *  CreatePlaceholderTexture()
+ *
+ *  This method is used for putting a 1x1 grey texture in the
+ *  next texture slot under the passed in tag, so the scene
+ *  can be drawn before the texture is loaded.  Uploading the
+ *  texture later puts it in the same slot.
+ ***********************************************************/
+bool SceneManager::CreatePlaceholderTexture(std::string tag)
+{
+	if (m_loadedTextures >= 16)
+	{
+		return false;
+	}
+
+	const unsigned char grey[4] = { 128, 128, 128, 255 };
+	GLuint textureID = 0;
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, g_PlaceholderTextureBytes);
+
+	m_textureIDs[m_loadedTextures].ID = textureID;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].bPlaceholder = true;
+	m_loadedTextures++;
+	return true;
+}
+
+/***********************************************************
+ *  CreatePlaceholderMeshes()
+ *
+ *  This method is used for drawing every basic mesh as a box
+ *  of its bounds until the real meshes are uploaded, which
+ *  replace the boxes at the next frame.
+ ***********************************************************/
+bool SceneManager::CreatePlaceholderMeshes()
+{
+	if ((NULL != m_pMeshArena) || (NULL != m_pPlaceholderMeshes))
+	{
 		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	std::vector<MESH_VERTEX> box;
+	std::vector<GLuint> indices;
+	BuildBoxMesh(box, indices);
+
+	MESH_DATA data;
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		GetMeshBounds((MESH_TYPE)mesh, boundsMin, boundsMax);
+
+		// the unit box spans -0.5 to 0.5
+		std::vector<MESH_VERTEX> vertices = box;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			vertices[i].position = boundsMin + (vertices[i].position + glm::vec3(0.5f)) * (boundsMax - boundsMin);
+		}
+		AppendMesh(data, vertices, indices);
+	}
 
-	// Error loading the image
-	return false;
+	MeshArena* pArena = new MeshArena();
+	if (!pArena->Initialize((unsigned int)data.vertices.size(), (unsigned int)data.indices.size()) ||
+		(pArena->AddMeshes(data) < 0))
+	{
+		delete pArena;
+		return false;
+	}
+
+	m_pPlaceholderMeshes = pArena;
+	m_pMeshArena = pArena;
+	return true;
+}
+
+/***********************************************************
+ *  DestroyPlaceholderMeshes()
+ *
+ *  This method is used for freeing the placeholder boxes once
+ *  the real meshes are in use.
+ ***********************************************************/
+void SceneManager::DestroyPlaceholderMeshes()
+{
+	if (NULL == m_pPlaceholderMeshes)
+	{
+		return;
+	}
+
+	if (m_pMeshArena == m_pPlaceholderMeshes)
+	{
+		m_pMeshArena = NULL;
+	}
+	delete m_pPlaceholderMeshes;
+	m_pPlaceholderMeshes = NULL;
 }
 
 /***********************************************************
@@ -152,15 +742,56 @@ void SceneManager::BindGLTextures()
 /***********************************************************
  *  DestroyGLTextures()
  *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  This method is used for releasing all the used texture
+ *  memory slots.  The textures are deleted by the resource
+ *  cache once they are evicted or the cache is cleared.
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		if (m_textureIDs[i].bPlaceholder)
+		{
+			GLuint textureID = m_textureIDs[i].ID;
+			glDeleteTextures(1, &textureID);
+			TrackGpuMemory(GPU_MEMORY_TEXTURE, -g_PlaceholderTextureBytes);
+			m_textureIDs[i].bPlaceholder = false;
+		}
+		m_textureIDs[i].handle.Release();
+		m_textureIDs[i].tag = "/0";
+		m_textureIDs[i].ID = -1;
+	}
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  ClaimTextureSlot()
+ *
+ *  This method is used for getting the slot a texture with
+ *  the passed in tag goes into.  The placeholder of the tag is
+ *  deleted and its slot reused, so the texture unit the scene
+ *  samples the tag from does not change, otherwise the next
+ *  free slot is taken.  -1 is returned when none is left.
+ ***********************************************************/
+int SceneManager::ClaimTextureSlot(const std::string& tag)
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		if (m_textureIDs[i].bPlaceholder && (m_textureIDs[i].tag == tag))
+		{
+			GLuint textureID = m_textureIDs[i].ID;
+			glDeleteTextures(1, &textureID);
+			TrackGpuMemory(GPU_MEMORY_TEXTURE, -g_PlaceholderTextureBytes);
+			m_textureIDs[i].bPlaceholder = false;
+			return(i);
+		}
+	}
+
+	if (m_loadedTextures >= 16)
+	{
+		return(-1);
 	}
+	return(m_loadedTextures++);
 }
 
 /***********************************************************
@@ -250,6 +881,25 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 	return(true);
 }
 
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a previously
+ *  defined material that is associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
 /***********************************************************
  *  SetTransformations()
  *
@@ -265,22 +915,21 @@ void SceneManager::SetTransformations(
 {
 	// variables for this method
 	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	AFFINE_3X4 affine;
+
+	// compose the scale, the X, Y and Z rotations as one
+	// quaternion and the translation into an affine matrix,
+	// skipping the rotation or scale when it has no effect
+	ComposeAffine(MakeTRS(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ), affine);
+
+	// the shaders take the model as a mat4 uniform
+	modelView = AffineToMat4(affine);
+
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->SetTransform(modelView);
+		return;
+	}
 
 	if (NULL != m_pShaderManager)
 	{
@@ -308,6 +957,12 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->SetColor(currentColor);
+		return;
+	}
+
 	if (NULL != m_pShaderManager)
 	{
 		m_pShaderManager->setIntValue(g_UseTextureName, false);
@@ -324,6 +979,12 @@ void SceneManager::SetShaderColor(
 void SceneManager::SetShaderTexture(
 	std::string textureTag)
 {
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->SetTexture(FindTextureSlot(textureTag));
+		return;
+	}
+
 	if (NULL != m_pShaderManager)
 	{
 		m_pShaderManager->setIntValue(g_UseTextureName, true);
@@ -342,6 +1003,12 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->SetUVScale(glm::vec2(u, v));
+		return;
+	}
+
 	if (NULL != m_pShaderManager)
 	{
 		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
@@ -357,7 +1024,13 @@ void SceneManager::SetTextureUVScale(float u, float v)
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->SetMaterial(FindMaterialIndex(materialTag));
+		return;
+	}
+
+	if ((NULL != m_pShaderManager) && (m_objectMaterials.size() > 0))
 	{
 		OBJECT_MATERIAL material;
 		bool bReturn = false;
@@ -374,6 +1047,328 @@ void SceneManager::SetShaderMaterial(
 	}
 }
 
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing the passed in basic mesh
+ *  with the current shader state.  While the scene is being
+ *  recorded, the draw is captured into the command list of
+ *  the recording thread instead.
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_TYPE mesh)
+{
+	if (NULL != g_pRecordingList)
+	{
+		g_pRecordingList->DrawMesh((int)mesh);
+		return;
+	}
+
+	// nothing is drawn when the meshes failed to load, or in the
+	// moment between the placeholders and the real meshes
+	if (NULL == m_pMeshArena)
+	{
+		return;
+	}
+
+	m_frameStats.drawCalls++;
+
+	// the index of each mesh in the arena is its type, and the
+	// draw goes through GLEW so a frame capture hooks it
+	m_pMeshArena->Draw((int)mesh);
+}
+
+/***********************************************************
+ *  BindMeshes()
+ *
+ *  This method is used for binding the vertex array that all
+ *  the basic meshes are drawn from.  It stays bound through
+ *  the frame, as the passes that bind another vertex array
+ *  put the previous one back.
+ ***********************************************************/
+void SceneManager::BindMeshes()
+{
+	if (NULL != m_pMeshArena)
+	{
+		m_pMeshArena->Bind();
+	}
+}
+
+/***********************************************************
+ *  RecordScene()
+ *
+ *  This method is used for capturing the draws issued by the
+ *  Make* methods into the draw list without touching OpenGL.
+ *  Each prop group is recorded into its own command list and
+ *  the lists are merged in group order, so the draw list is
+ *  the same whichever thread recorded each group.
+ ***********************************************************/
+const std::vector<SceneManager::DRAW_ITEM>& SceneManager::RecordScene()
+{
+	RecordCommandLists();
+	MergeCommandLists();
+
+	return(m_drawList);
+}
+
+/***********************************************************
+ *  RecordCommandLists()
+ *
+ *  This method is used for recording the prop groups into
+ *  their command lists.  Large scenes spread the groups over
+ *  the record workers, which take the next unrecorded group
+ *  until none are left, and the calling thread records
+ *  alongside them.  The Make* methods only read the texture and material
+ *  tables, so the groups can be recorded at the same time.
+ ***********************************************************/
+void SceneManager::RecordCommandLists()
+{
+	std::vector<PROP_GROUP> groups;
+	GetPropGroups(groups);
+	const int groupCount = (int)groups.size();
+	if ((int)m_commandLists.size() != groupCount)
+	{
+		m_commandLists.resize(groupCount);
+	}
+
+	std::atomic<int> nextGroup(0);
+	std::function<void()> recordGroups = [this, &groups, &nextGroup, groupCount]()
+	{
+		int group = nextGroup.fetch_add(1);
+		while (group < groupCount)
+		{
+			CommandList& commandList = m_commandLists[group];
+			commandList.Reset();
+			g_pRecordingList = &commandList;
+			(this->*groups[group])();
+			g_pRecordingList = NULL;
+			group = nextGroup.fetch_add(1);
+		}
+	};
+
+	int threadCount = 1;
+	if (m_lastRecordedDraws >= g_ParallelRecordThreshold)
+	{
+		threadCount = std::min(groupCount, std::max(1, (int)std::thread::hardware_concurrency()));
+	}
+	m_recordWorkers.Run(recordGroups, threadCount);
+}
+
+/***********************************************************
+ *  MergeCommandLists()
+ *
+ *  This method is used for replaying the command lists in
+ *  group order into the draw list.  The shader state carries
+ *  over from one list to the next, as it did when the Make*
+ *  methods were called one after the other.
+ ***********************************************************/
+void SceneManager::MergeCommandLists()
+{
+	DRAW_ITEM state;
+	state.mesh = BOX_MESH;
+	state.model = glm::mat4(1.0f);
+	state.bUseTexture = false;
+	state.textureSlot = -1;
+	state.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	state.UVscale = glm::vec2(1.0f, 1.0f);
+	state.materialIndex = -1;
+
+	int drawCount = 0;
+	for (size_t i = 0; i < m_commandLists.size(); i++)
+	{
+		drawCount += m_commandLists[i].GetDrawCount();
+	}
+	m_drawList.clear();
+	m_drawList.reserve(drawCount);
+	m_groupStarts.clear();
+
+	for (size_t list = 0; list < m_commandLists.size(); list++)
+	{
+		const CommandList& commandList = m_commandLists[list];
+		m_groupStarts.push_back((int)m_drawList.size());
+		for (size_t i = 0; i < commandList.GetCommandCount(); i++)
+		{
+			const COMMAND& command = commandList.GetCommand(i);
+			switch (command.type)
+			{
+			case COMMAND_SET_TRANSFORM:
+				state.model = commandList.GetMatrix(command.value);
+				break;
+			case COMMAND_SET_COLOR:
+				state.bUseTexture = false;
+				state.color = commandList.GetVector(command.value);
+				break;
+			case COMMAND_SET_TEXTURE:
+				state.bUseTexture = true;
+				state.textureSlot = command.value;
+				break;
+			case COMMAND_SET_UV_SCALE:
+				state.UVscale = glm::vec2(commandList.GetVector(command.value).x, commandList.GetVector(command.value).y);
+				break;
+			case COMMAND_SET_MATERIAL:
+				state.materialIndex = command.value;
+				break;
+			case COMMAND_DRAW_MESH:
+				state.mesh = (MESH_TYPE)command.value;
+				m_drawList.push_back(state);
+				break;
+			}
+		}
+	}
+	m_groupStarts.push_back((int)m_drawList.size());
+
+	m_lastRecordedDraws = drawCount;
+}
+
+/***********************************************************
+ *  SubmitDrawItem()
+ *
+ *  This method is used for setting the captured shader state
+ *  of a recorded draw item into the shader and drawing it.
+ ***********************************************************/
+void SceneManager::SubmitDrawItem(const DRAW_ITEM& item)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	// a change of program, texture or material between
+	// consecutive items is what a state sort would save
+	int textureSlot = item.bUseTexture ? item.textureSlot : -1;
+	if ((m_pShaderManager != m_pLastSubmitShader) ||
+		(textureSlot != m_lastSubmitTexture) ||
+		(item.materialIndex != m_lastSubmitMaterial))
+	{
+		m_frameStats.stateChanges++;
+		m_pLastSubmitShader = m_pShaderManager;
+		m_lastSubmitTexture = textureSlot;
+		m_lastSubmitMaterial = item.materialIndex;
+	}
+
+	m_pShaderManager->setMat4Value(g_ModelName, item.model);
+	m_pShaderManager->setIntValue(g_UseTextureName, item.bUseTexture);
+	if (item.bUseTexture == true)
+	{
+		m_pShaderManager->setSampler2DValue(g_TextureValueName, item.textureSlot);
+	}
+	else
+	{
+		m_pShaderManager->setVec4Value(g_ColorValueName, item.color);
+	}
+	m_pShaderManager->setVec2Value("UVscale", item.UVscale);
+
+	if ((item.materialIndex >= 0) && (item.materialIndex < (int)m_objectMaterials.size()))
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[item.materialIndex];
+		m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
+		m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
+		m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
+		m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
+		m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+		m_pShaderManager->setFloatValue("material.alpha", material.alpha);
+	}
+
+	DrawMesh(item.mesh);
+}
+
+/***********************************************************
+ *  SubmitDrawItemGeometry()
+ *
+ *  This method is used for drawing a recorded draw item with
+ *  only its transform set, for passes that do not shade.
+ ***********************************************************/
+void SceneManager::SubmitDrawItemGeometry(const DRAW_ITEM& item)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(g_ModelName, item.model);
+		DrawMesh(item.mesh);
+	}
+}
+
+/***********************************************************
+ *  IsTransparent()
+ *
+ *  This method is used for checking whether a recorded draw
+ *  item is see-through, either from its material or from the
+ *  alpha of its flat color.
+ ***********************************************************/
+bool SceneManager::IsTransparent(const DRAW_ITEM& item) const
+{
+	if ((item.bUseTexture == false) && (item.color.a < 1.0f))
+	{
+		return(true);
+	}
+	if ((item.materialIndex >= 0) &&
+		(item.materialIndex < (int)m_objectMaterials.size()) &&
+		(m_objectMaterials[item.materialIndex].alpha < 1.0f))
+	{
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for keeping the view transform of the
+ *  current frame, for the shader programs other than the one
+ *  the view manager sets it into.
+ ***********************************************************/
+void SceneManager::SetViewTransform(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  ApplyViewTransform()
+ *
+ *  This method is used for setting the view transform of the
+ *  current frame into the current shader manager.
+ ***********************************************************/
+void SceneManager::ApplyViewTransform()
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value("view", m_viewMatrix);
+		m_pShaderManager->setMat4Value("projection", m_projectionMatrix);
+		m_pShaderManager->setVec3Value("viewPosition", m_viewPosition);
+	}
+}
+
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the object space bounding
+ *  box of a basic mesh, before any transformations.
+ ***********************************************************/
+void SceneManager::GetMeshBounds(MESH_TYPE mesh, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	switch (mesh)
+	{
+	case BOX_MESH:
+		boundsMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+		boundsMax = glm::vec3(0.5f, 0.5f, 0.5f);
+		break;
+	case PLANE_MESH:
+		boundsMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+		boundsMax = glm::vec3(1.0f, 0.0f, 1.0f);
+		break;
+	default:
+		// the cylinder, tapered cylinder and cone are all built
+		// with a unit radius from a base at y = 0 up to y = 1
+		boundsMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+		boundsMax = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	}
+}
+
 /**************************************************************/
 /*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
 /*** preparing and rendering their own 3D replicated scenes.***/
@@ -391,47 +1386,348 @@ void SceneManager::SetShaderMaterial(
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
 	//load images from a file into openGL
 	LoadScenetexture();
-	
-	DefineObjectMaterials();
-
-	SetupSceneLights();
-
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadConeMesh();
+
+	for (int step = 0; step < PREPARE_STEP_COUNT; step++)
+	{
+		RunPrepareStep((PREPARE_STEP)step);
+	}
+
+	LOAD_TIME sceneLoadTime;
+	sceneLoadTime.name = "scene";
+	sceneLoadTime.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	m_loadTimes.push_back(sceneLoadTime);
+}
+
+/***********************************************************
+ *  RunPrepareStep()
+ *
+ *  This method is used for running one step of preparing the
+ *  scene after the textures are loaded.  The steps are run
+ *  in order, all at once by PrepareScene() or one at a time
+ *  between frames when the scene is loaded in the background.
+ ***********************************************************/
+void SceneManager::RunPrepareStep(PREPARE_STEP step)
+{
+	switch (step)
+	{
+	case PREPARE_MATERIALS:
+		DefineObjectMaterials();
+		SetupSceneLights();
+		break;
+	case PREPARE_PROCEDURAL_TEXTURES:
+		DefineProceduralTextures();
+		BakeProceduralTextures();
+		BindGLTextures();
+		break;
+	case PREPARE_MESHES:
+		// only one instance of a particular mesh needs to be
+		// loaded in memory no matter how many times it is drawn
+		// in the rendered 3D scene, or by how many scenes
+		if (!AcquireCachedMeshes())
+		{
+			MESH_DATA meshData;
+			LoadMeshData(meshData);
+			UploadMeshes(meshData);
+		}
+		break;
+	case PREPARE_TRANSPARENCY:
+		// the transparent pass falls back to the main shader when
+		// its programs cannot be loaded
+		m_pTransparencyRenderer = new TransparencyRenderer();
+		if (!m_pTransparencyRenderer->Initialize(this))
+		{
+			std::cout << "Transparent pass shaders not loaded, blended draws use the main shader" << std::endl;
+			delete m_pTransparencyRenderer;
+			m_pTransparencyRenderer = NULL;
+		}
+		break;
+	case PREPARE_DEPTH_PREPASS:
+		m_pDepthPrepassRenderer = new DepthPrepassRenderer();
+		if (!m_pDepthPrepassRenderer->Initialize(this))
+		{
+			std::cout << "Depth pre-pass shaders not loaded, the pre-pass is unavailable" << std::endl;
+			delete m_pDepthPrepassRenderer;
+			m_pDepthPrepassRenderer = NULL;
+		}
+		break;
+	case PREPARE_DEFERRED:
+		m_pDeferredRenderer = new DeferredRenderer();
+		if (!m_pDeferredRenderer->Initialize(this))
+		{
+			std::cout << "Deferred shaders not loaded, the opaque pass stays forward" << std::endl;
+			delete m_pDeferredRenderer;
+			m_pDeferredRenderer = NULL;
+		}
+		break;
+	case PREPARE_MULTIVIEW:
+		m_pMultiViewRenderer = new MultiViewRenderer();
+		if (!m_pMultiViewRenderer->Initialize(this))
+		{
+			std::cout << "Multi-view shaders not loaded, the multi-view pass is unavailable" << std::endl;
+			delete m_pMultiViewRenderer;
+			m_pMultiViewRenderer = NULL;
+		}
+		break;
+	case PREPARE_IMPOSTORS:
+		// the props are baked with the main shader, so this step
+		// needs the textures, materials and meshes loaded first
+		m_pImpostorRenderer = new ImpostorRenderer();
+		if (!m_pImpostorRenderer->Initialize(this))
+		{
+			std::cout << "Impostors not baked, distant props draw their full geometry" << std::endl;
+			delete m_pImpostorRenderer;
+			m_pImpostorRenderer = NULL;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  ActivateScene()
+ *
+ *  This method is used for making a scene that was loaded in
+ *  the background the one being rendered.  The texture units
+ *  and the lights of the main program are shared by every
+ *  scene, so they are set again for this scene.
+ ***********************************************************/
+void SceneManager::ActivateScene()
+{
+	BindGLTextures();
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->use();
+		SetupSceneLights();
+	}
 }
 
 /***********************************************************
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  transforming and drawing the basic 3D shapes.  The draws
+ *  are recorded first and the ones outside the view frustum
+ *  are dropped, then the rest are drawn in an opaque pass
+ *  without blending followed by a blended transparent pass.
+ *  The opaque draws of the deferred path are culled on the
+ *  GPU instead when it can, so only the transparent ones,
+ *  which are sorted here, are tested on the CPU.
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	MakeDesk();
-	MakeBackWall();
-	MakeDeskStand();
-	MakeMug();
-	MakeBooks();
-	MakeLamp();
-	MakePenHolder();
+	const std::vector<DRAW_ITEM>& drawList = RecordScene();
+
+	// every pass draws the basic meshes from the one arena, so it
+	// is bound once for the frame rather than once per draw
+	BindMeshes();
+
+	m_frameStats.drawCalls = 0;
+	m_frameStats.stateChanges = 0;
+	m_frameStats.visibleObjects = 0;
+	m_frameStats.culledObjects = 0;
+	m_frameStats.gpuCulledObjects = 0;
+	m_pLastSubmitShader = NULL;
+	m_lastSubmitTexture = -1;
+	m_lastSubmitMaterial = -1;
+
+	FRUSTUM frustum = ExtractFrustum(m_projectionMatrix * m_viewMatrix);
+	m_opaqueItems.clear();
+	m_transparentItems.clear();
+
+	bool bDeferred = (m_renderOptions.shadingPath == SHADING_DEFERRED) && (NULL != m_pDeferredRenderer);
+	bool bGpuCulling = bDeferred && m_renderOptions.bGpuCulling && m_pDeferredRenderer->HasGpuCulling();
+
+	// prop groups far from the camera are drawn as impostors, and
+	// the items of a group are skipped once it is fully replaced
+	bool bImpostors = m_renderOptions.bImpostors && (NULL != m_pImpostorRenderer);
+	if (bImpostors)
+	{
+		m_pImpostorRenderer->SelectImpostors(m_viewPosition, frustum);
+	}
+	for (int group = 0; group + 1 < (int)m_groupStarts.size(); group++)
+	{
+		if (bImpostors && m_pImpostorRenderer->IsReplaced(group))
+		{
+			continue;
+		}
+		for (int i = m_groupStarts[group]; i < m_groupStarts[group + 1]; i++)
+		{
+			bool bTransparent = IsTransparent(drawList[i]) && (NULL != m_pTransparencyRenderer);
+			if (bGpuCulling && !bTransparent)
+			{
+				m_frameStats.gpuCulledObjects++;
+				m_opaqueItems.push_back(i);
+				continue;
+			}
+
+			BOUNDING_BOX localBounds;
+			GetMeshBounds(drawList[i].mesh, localBounds.min, localBounds.max);
+			if (!IsBoxInFrustum(frustum, TransformBoundingBox(localBounds, drawList[i].model)))
+			{
+				m_frameStats.culledObjects++;
+				continue;
+			}
+			m_frameStats.visibleObjects++;
+
+			if (bTransparent)
+			{
+				m_transparentItems.push_back(i);
+			}
+			else
+			{
+				m_opaqueItems.push_back(i);
+			}
+		}
+	}
+
+	// opaque pass, either deferred or forward shaded, with the
+	// forward path optionally preceded by a depth-only pass so
+	// that hidden fragments are rejected before shading - should
+	// the G-buffer fail, the forward path draws the opaque items
+	// that were meant for the GPU culling pass unculled
+	bool bDepthPrepass = m_renderOptions.bDepthPrepass && (NULL != m_pDepthPrepassRenderer);
+	glDisable(GL_BLEND);
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_pDeferredRenderer->BeginMeasurement(bDeferred);
+	}
+	if (bDeferred)
+	{
+		bDeferred = m_pDeferredRenderer->Render(this, drawList, m_opaqueItems, bGpuCulling, m_renderOptions.bOcclusionCulling);
+		if (bDeferred && m_pDeferredRenderer->WasGpuCulled())
+		{
+			// the culled items are one indirect multi-draw
+			m_frameStats.drawCalls++;
+		}
+	}
+	if (!bDeferred)
+	{
+		if (NULL != m_pDepthPrepassRenderer)
+		{
+			m_pDepthPrepassRenderer->BeginMeasurement(bDepthPrepass);
+			if (bDepthPrepass)
+			{
+				m_pDepthPrepassRenderer->RenderDepth(this, drawList, m_opaqueItems);
+			}
+			m_pDepthPrepassRenderer->BeginShadingPass();
+		}
+		for (size_t i = 0; i < m_opaqueItems.size(); i++)
+		{
+			SubmitDrawItem(drawList[m_opaqueItems[i]]);
+		}
+		if (NULL != m_pDepthPrepassRenderer)
+		{
+			m_pDepthPrepassRenderer->EndMeasurement(this);
+		}
+	}
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_pDeferredRenderer->EndMeasurement();
+	}
+
+	// the impostors go after the opaque pass of either path, so
+	// they are depth tested against the finished depth buffer
+	if (bImpostors)
+	{
+		m_pImpostorRenderer->Render(this);
+	}
+
+	// transparent pass
+	if (NULL != m_pTransparencyRenderer)
+	{
+		m_pTransparencyRenderer->Render(this, drawList, m_transparentItems, m_renderOptions.transparencyMode);
+	}
+
+	// the multi-view pass records the scene again, so it goes
+	// after every pass that uses this frame's draw list
+	if (m_renderOptions.bMultiView && (NULL != m_pMultiViewRenderer))
+	{
+		RenderMultiView();
+	}
+
+	// the deferred renderer times the opaque pass of both paths,
+	// the pre-pass timer covers the forward path without it
+	m_frameStats.opaqueGpuMilliseconds = 0.0;
+	m_frameStats.transparentGpuMilliseconds = 0.0;
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_frameStats.opaqueGpuMilliseconds = m_pDeferredRenderer->GetStats(bDeferred).lastGpuMilliseconds;
+	}
+	else if (NULL != m_pDepthPrepassRenderer)
+	{
+		m_frameStats.opaqueGpuMilliseconds = m_pDepthPrepassRenderer->GetStats(bDepthPrepass).lastGpuMilliseconds;
+	}
+	if (NULL != m_pTransparencyRenderer)
+	{
+		m_frameStats.transparentGpuMilliseconds =
+			m_pTransparencyRenderer->GetStats(m_renderOptions.transparencyMode).lastGpuMilliseconds;
+	}
+}
+
+/***********************************************************
+ *  RenderMultiView()
+ *
+ *  This method is used for rendering the scene offscreen from
+ *  a ring of views at the camera position, one per layer of
+ *  the multi-view target, to measure how many views per
+ *  second the layered pass reaches.
+ ***********************************************************/
+void SceneManager::RenderMultiView()
+{
+	std::vector<glm::mat4> views(g_MultiViewCount);
+	std::vector<glm::mat4> projections(g_MultiViewCount,
+		glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f));
+	for (int i = 0; i < g_MultiViewCount; i++)
+	{
+		float angle = glm::radians(360.0f * i / g_MultiViewCount);
+		glm::vec3 direction(std::sin(angle), 0.0f, -std::cos(angle));
+		views[i] = glm::lookAt(m_viewPosition, m_viewPosition + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	m_pMultiViewRenderer->RenderViews(this, views, projections, g_MultiViewSize, g_MultiViewSize);
+}
+
+/***********************************************************
+ *  GetPropGroups()
+ *
+ *  This method is used for listing the Make* methods that
+ *  transform and draw the objects in the 3D scene, in the
+ *  order they are drawn.  Each group may be recorded on its
+ *  own thread, so a Make* method must only change the draw
+ *  state through the Set* methods.
+ ***********************************************************/
+void SceneManager::GetPropGroups(std::vector<PROP_GROUP>& groups)
+{
+	groups.push_back(&SceneManager::MakeDesk);
+	groups.push_back(&SceneManager::MakeBackWall);
+	groups.push_back(&SceneManager::MakeDeskStand);
+	groups.push_back(&SceneManager::MakeMug);
+	groups.push_back(&SceneManager::MakeBooks);
+	groups.push_back(&SceneManager::MakeLamp);
+	groups.push_back(&SceneManager::MakePenHolder);
+}
+
+//list the .jpg files of the scene textures and their tags - the
+//brick, desk, wood and plastic are generated instead, see
+//DefineProceduralTextures()
+void SceneManager::GetSceneTextures(std::vector<TEXTURE_FILE>& textures) {
+
+	textures.clear();
 }
 
 //load textures from a .jpg into openGL
 void SceneManager::LoadScenetexture() {
-	
-	CreateGLTexture("./Source/brick.jpg", "brick");
-	CreateGLTexture("./Source/desk.jpg", "desk");
-	CreateGLTexture("./Source/wood.jpg", "wood");
-	CreateGLTexture("./Source/plastic.jpg", "plastic");
+
+	std::vector<TEXTURE_FILE> textures;
+	GetSceneTextures(textures);
+	for (size_t i = 0; i < textures.size(); i++) {
+		CreateGLTexture(textures[i].filename.c_str(), textures[i].tag);
+	}
 
 
 	// after the texture image data is loaded into memory, the
@@ -449,6 +1745,7 @@ void SceneManager::DefineObjectMaterials() {
 	woodMat.diffuseColor = glm::vec3(0.36, 0.24, 0.12);
 	woodMat.specularColor = glm::vec3(0.12, 0.14, 0.08);
 	woodMat.shininess = 0.3;
+	woodMat.alpha = 1.0f;
 	woodMat.tag = "wood";
 	m_objectMaterials.push_back(woodMat);
 
@@ -458,6 +1755,7 @@ void SceneManager::DefineObjectMaterials() {
 	plasticMat.diffuseColor = glm::vec3(0.05, 0.05, 0.06);
 	plasticMat.specularColor = glm::vec3(0.06, 0.05, 0.05);
 	plasticMat.shininess = 0.2;
+	plasticMat.alpha = 1.0f;
 	plasticMat.tag = "plastic";
 	m_objectMaterials.push_back(plasticMat);
 
@@ -467,6 +1765,7 @@ void SceneManager::DefineObjectMaterials() {
 	rubberMat.diffuseColor = glm::vec3(0.93, 0.28, 0.92);
 	rubberMat.specularColor = glm::vec3(0.94, 0.30, 0.93);
 	rubberMat.shininess = 0;
+	rubberMat.alpha = 1.0f;
 	rubberMat.tag = "rubber";
 	m_objectMaterials.push_back(rubberMat);
 
@@ -476,6 +1775,7 @@ void SceneManager::DefineObjectMaterials() {
 	glassMat.diffuseColor = glm::vec3(0.84, 0.84, 0.84);
 	glassMat.specularColor = glm::vec3(0.92, 0.92, 0.92);
 	glassMat.shininess = 32;
+	glassMat.alpha = 0.35f;
 	glassMat.tag = "glass";
 	m_objectMaterials.push_back(glassMat);
 
@@ -485,6 +1785,7 @@ void SceneManager::DefineObjectMaterials() {
 	brickMat.diffuseColor = glm::vec3(0.84, 0.84, 0.84);
 	brickMat.specularColor = glm::vec3(0.92, 0.92, 0.92);
 	brickMat.shininess = 0.1f;
+	brickMat.alpha = 1.0f;
 	brickMat.tag = "brick";
 	m_objectMaterials.push_back(brickMat);
 
@@ -494,6 +1795,7 @@ void SceneManager::DefineObjectMaterials() {
 	paperMat.diffuseColor = glm::vec3(0.84, 0.84, 0.84);
 	paperMat.specularColor = glm::vec3(0.92, 0.92, 0.92);
 	paperMat.shininess = 0.1f;
+	paperMat.alpha = 1.0f;
 	paperMat.tag = "paper";
 	m_objectMaterials.push_back(paperMat);
 
@@ -503,6 +1805,7 @@ void SceneManager::DefineObjectMaterials() {
 	topBookCoverMat.diffuseColor = glm::vec3(0, 0.3, 0.3);
 	topBookCoverMat.specularColor = glm::vec3(0.3, 0.3, 0.3);
 	topBookCoverMat.shininess = 0.4f;
+	topBookCoverMat.alpha = 1.0f;
 	topBookCoverMat.tag = "top_cover";
 	m_objectMaterials.push_back(topBookCoverMat);
 
@@ -512,10 +1815,68 @@ void SceneManager::DefineObjectMaterials() {
 	bottomBookCoverMat.diffuseColor = glm::vec3(0.89, 0.73, 0.02);
 	bottomBookCoverMat.specularColor = glm::vec3(0.895, 0.73, 0.03);
 	bottomBookCoverMat.shininess = 0.4f;
+	bottomBookCoverMat.alpha = 1.0f;
 	bottomBookCoverMat.tag = "bottom_cover";
 	m_objectMaterials.push_back(bottomBookCoverMat);
 }
 
+//define the textures generated for the scene, with the .jpg each one replaces to load if it cannot be generated
+void SceneManager::DefineProceduralTextures() {
+	m_proceduralTextures.clear();
+
+	PROCEDURAL_TEXTURE brickTex;
+	brickTex.pattern = PROCEDURAL_BRICK;
+	brickTex.size = 1024;
+	brickTex.baseColor = glm::vec3(0.55, 0.22, 0.14);
+	brickTex.detailColor = glm::vec3(0.72, 0.70, 0.66);
+	brickTex.frequency = 4.0f;
+	brickTex.variation = 0.15f;
+	brickTex.detail = 0.08f;
+	brickTex.seed = 1;
+	brickTex.tag = "brick";
+	brickTex.fallbackFilename = "./Source/brick.jpg";
+	m_proceduralTextures.push_back(brickTex);
+
+	PROCEDURAL_TEXTURE deskTex;
+	deskTex.pattern = PROCEDURAL_WOOD;
+	deskTex.size = 1024;
+	deskTex.baseColor = glm::vec3(0.36, 0.22, 0.12);
+	deskTex.detailColor = glm::vec3(0.22, 0.12, 0.06);
+	deskTex.frequency = 12.0f;
+	deskTex.variation = 1.5f;
+	deskTex.detail = 0.3f;
+	deskTex.seed = 2;
+	deskTex.tag = "desk";
+	deskTex.fallbackFilename = "./Source/desk.jpg";
+	m_proceduralTextures.push_back(deskTex);
+
+	PROCEDURAL_TEXTURE woodTex;
+	woodTex.pattern = PROCEDURAL_WOOD;
+	woodTex.size = 1024;
+	woodTex.baseColor = glm::vec3(0.62, 0.45, 0.28);
+	woodTex.detailColor = glm::vec3(0.45, 0.30, 0.16);
+	woodTex.frequency = 8.0f;
+	woodTex.variation = 1.0f;
+	woodTex.detail = 0.25f;
+	woodTex.seed = 3;
+	woodTex.tag = "wood";
+	woodTex.fallbackFilename = "./Source/wood.jpg";
+	m_proceduralTextures.push_back(woodTex);
+
+	PROCEDURAL_TEXTURE plasticTex;
+	plasticTex.pattern = PROCEDURAL_PLASTIC;
+	plasticTex.size = 1024;
+	plasticTex.baseColor = glm::vec3(0.10, 0.10, 0.11);
+	plasticTex.detailColor = glm::vec3(0.30, 0.30, 0.32);
+	plasticTex.frequency = 96.0f;
+	plasticTex.variation = 0.1f;
+	plasticTex.detail = 0.2f;
+	plasticTex.seed = 4;
+	plasticTex.tag = "plastic";
+	plasticTex.fallbackFilename = "./Source/plastic.jpg";
+	m_proceduralTextures.push_back(plasticTex);
+}
+
 //generates point(s) of light in the scene with a specific vertex, color, and intensity
 void SceneManager::SetupSceneLights() {
 	//create a white light in the middle of the objects in the scene
@@ -577,7 +1938,7 @@ void SceneManager::MakeDesk() {
 	SetShaderMaterial("wood");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 }
 
 void SceneManager::MakeBackWall() {
@@ -620,7 +1981,7 @@ void SceneManager::MakeBackWall() {
 	SetShaderMaterial("brick");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 }
 
 void SceneManager::MakeDeskStand() {
@@ -661,7 +2022,7 @@ void SceneManager::MakeDeskStand() {
 	SetShaderMaterial("wood");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 	/****************************************************************/
 
 	/*** Set needed transformations before drawing the basic mesh.  ***/
@@ -694,7 +2055,7 @@ void SceneManager::MakeDeskStand() {
 	SetShaderMaterial("wood");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 	/****************************************************************/
 
 	/*** Set needed transformations before drawing the basic mesh.  ***/
@@ -727,7 +2088,7 @@ void SceneManager::MakeDeskStand() {
 	SetShaderMaterial("wood");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 }
 
 void SceneManager::MakeMug() {
@@ -770,7 +2131,7 @@ void SceneManager::MakeMug() {
 	SetShaderMaterial("glass");
 
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 	/****************************************************************/
 
 	/*** Set needed transformations before drawing the basic mesh.  ***/
@@ -800,7 +2161,7 @@ void SceneManager::MakeMug() {
 
 
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 	/****************************************************************/
 
 	/*** Set needed transformations before drawing the basic mesh.  ***/
@@ -830,7 +2191,7 @@ void SceneManager::MakeMug() {
 
 
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 
 	/****************************************************************/
 
@@ -861,7 +2222,7 @@ void SceneManager::MakeMug() {
 
 
 	// draw the mesh
-	m_basicMeshes->DrawTaperedCylinderMesh();
+	DrawMesh(TAPERED_CYLINDER_MESH);
 	/****************************************************************/
 }
 
@@ -901,7 +2262,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("paper");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 	
 	/***********************************************************************************************************
 	*************************************************************************************************************
@@ -930,7 +2291,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("bottom_cover");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 
 	/***********************************************************************************************************
 	*************************************************************************************************************
@@ -959,7 +2320,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("bottom_cover");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 
 	/***********************************************************************************************************
 *************************************************************************************************************
@@ -988,7 +2349,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("paper");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/***********************************************************************************************************
 	*************************************************************************************************************
@@ -1017,7 +2378,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("top_cover");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 
 	/***********************************************************************************************************
 	*************************************************************************************************************
@@ -1046,7 +2407,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("top_cover");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 	/***********************************************************************************************************
 *************************************************************************************************************
 ************************************************************************************************************/
@@ -1074,7 +2435,7 @@ void SceneManager::MakeBooks() {
 	SetShaderMaterial("top_cover");
 
 	// draw the mesh
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh(PLANE_MESH);
 }
 
 void SceneManager::MakeLamp() {
@@ -1115,7 +2476,7 @@ void SceneManager::MakeLamp() {
 	SetShaderMaterial("plastic");
 
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1145,7 +2506,7 @@ void SceneManager::MakeLamp() {
 	SetShaderMaterial("plastic");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1174,7 +2535,7 @@ void SceneManager::MakeLamp() {
 	SetShaderMaterial("plastic");
 
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1203,7 +2564,7 @@ void SceneManager::MakeLamp() {
 	SetShaderMaterial("plastic");
 
 	// draw the mesh
-	m_basicMeshes->DrawConeMesh();
+	DrawMesh(CONE_MESH);
 
 }
 
@@ -1245,7 +2606,7 @@ void SceneManager::MakePenHolder() {
 	SetTextureUVScale(0.25, 0.25);
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1275,7 +2636,7 @@ void SceneManager::MakePenHolder() {
 	SetTextureUVScale(0.25, 0.25);
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1305,7 +2666,7 @@ void SceneManager::MakePenHolder() {
 	SetTextureUVScale(0.25, 0.25);
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1335,7 +2696,7 @@ void SceneManager::MakePenHolder() {
 	SetTextureUVScale(0.25, 0.25);
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh(BOX_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1364,7 +2725,7 @@ void SceneManager::MakePenHolder() {
 	SetShaderTexture("plastic");
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1393,7 +2754,7 @@ void SceneManager::MakePenHolder() {
 
 	SetShaderMaterial("wood");
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1421,7 +2782,7 @@ void SceneManager::MakePenHolder() {
 
 	SetShaderMaterial("rubber");
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 
 	/********************************************************************************************************
 	********************************************************************************************************
@@ -1449,5 +2810,5 @@ void SceneManager::MakePenHolder() {
 
 	SetShaderMaterial("rubber");
 	// draw the mesh
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh(CYLINDER_MESH);
 }
\ No newline at end of file
@@ -10,11 +10,23 @@
 #pragma once
 
 #include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "MeshArena.h"
+#include "RenderOptions.h"
+#include "CommandList.h"
+#include "WorkerPool.h"
+#include "ResourceCache.h"
+#include "ImageProcessing.h"
+#include "TextureCompressor.h"
 
 #include <string>
 #include <vector>
 
+class TransparencyRenderer;
+class DepthPrepassRenderer;
+class DeferredRenderer;
+class ImpostorRenderer;
+class MultiViewRenderer;
+
 /***********************************************************
  *  SceneManager
  *
@@ -24,8 +36,9 @@
 class SceneManager
 {
 public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	// constructor, a cache of its own is created when no
+	// resource cache is passed in
+	SceneManager(ShaderManager *pShaderManager, ResourceCache* pResourceCache = NULL);
 	// destructor
 	~SceneManager();
 
@@ -33,6 +46,11 @@ public:
 	{
 		std::string tag;
 		uint32_t ID;
+		// reference to the texture in the resource cache
+		ResourceHandle handle;
+		// a 1x1 stand-in owned by the scene, until the texture
+		// with the same tag is uploaded over it
+		bool bPlaceholder;
 	};
 
 	struct OBJECT_MATERIAL
@@ -42,32 +60,208 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
+		// opacity used by the transparent pass, 1.0 is opaque
+		float alpha;
+		std::string tag;
+	};
+
+	// patterns a texture can be generated with
+	enum PROCEDURAL_PATTERN
+	{
+		PROCEDURAL_WOOD,
+		PROCEDURAL_BRICK,
+		PROCEDURAL_PLASTIC
+	};
+
+	// a texture generated on the GPU instead of read from an
+	// image, found by its tag like a loaded one
+	struct PROCEDURAL_TEXTURE
+	{
+		PROCEDURAL_PATTERN pattern;
+		// width and height in texels, a power of two
+		int size;
+		// sRGB colors of the wood and its rings, the bricks and
+		// the mortar, or the plastic and its speckles
+		glm::vec3 baseColor;
+		glm::vec3 detailColor;
+		// rings, bricks or speckle cells across the texture,
+		// rounded so the pattern tiles
+		float frequency;
+		// how far the rings wander, how much the bricks differ
+		// in shade, or how mottled the plastic is
+		float variation;
+		// contrast of the grain, width of the mortar as a part of
+		// a brick's height, or the share of cells with a speckle
+		float detail;
+		unsigned int seed;
+		std::string tag;
+		// loaded in its place where it cannot be generated
+		std::string fallbackFilename;
+	};
+
+	// identifiers for the basic meshes that can be drawn
+	enum MESH_TYPE
+	{
+		BOX_MESH,
+		CYLINDER_MESH,
+		PLANE_MESH,
+		TAPERED_CYLINDER_MESH,
+		CONE_MESH,
+		MESH_TYPE_COUNT
+	};
+
+	// snapshot of the shader state for one mesh draw, captured
+	// while recording the scene instead of drawing it
+	struct DRAW_ITEM
+	{
+		MESH_TYPE mesh;
+		glm::mat4 model;
+		bool bUseTexture;
+		int textureSlot;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		int materialIndex;
+	};
+
+	// image file of a scene texture and the tag it is found by
+	struct TEXTURE_FILE
+	{
+		std::string filename;
 		std::string tag;
 	};
 
+	// a texture image read and prepared for upload, which is
+	// done away from the thread that owns the GL context
+	struct DECODED_TEXTURE
+	{
+		std::string filename;
+		bool bDecoded;
+		int width;
+		int height;
+		int colorChannels;
+		// sRGB correct RGBA mipmaps
+		std::vector<IMAGE_LEVEL> levels;
+		// the mipmaps block compressed, used when bCompressed
+		bool bCompressed;
+		BLOCK_FORMAT blockFormat;
+		COMPRESSED_IMAGE compressedImage;
+		double decodeMilliseconds;
+	};
+
+	// steps of preparing the scene after its textures are
+	// loaded, each one short enough to run between frames
+	enum PREPARE_STEP
+	{
+		PREPARE_MATERIALS,
+		PREPARE_PROCEDURAL_TEXTURES,
+		PREPARE_MESHES,
+		PREPARE_TRANSPARENCY,
+		PREPARE_DEPTH_PREPASS,
+		PREPARE_DEFERRED,
+		PREPARE_MULTIVIEW,
+		PREPARE_IMPOSTORS,
+		PREPARE_STEP_COUNT
+	};
+
+	// time taken to load one asset, for reporting
+	struct LOAD_TIME
+	{
+		std::string name;
+		double milliseconds;
+	};
+
+	// counters and pass timings of the last rendered frame, the
+	// GPU timings are read back a frame or two late
+	struct FRAME_STATS
+	{
+		int drawCalls;
+		int stateChanges;
+		// objects tested on the CPU
+		int visibleObjects;
+		int culledObjects;
+		// objects handed to the GPU culling pass, whose result
+		// is not read back
+		int gpuCulledObjects;
+		double opaqueGpuMilliseconds;
+		double transparentGpuMilliseconds;
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
+	// cache that owns the textures, meshes and programs
+	ResourceCache* m_pResourceCache;
+	bool m_bOwnsResourceCache;
+	// arena holding the basic shapes, held through m_meshesHandle,
+	// or the placeholder boxes until the shapes are uploaded
+	MeshArena* m_pMeshArena;
+	ResourceHandle m_meshesHandle;
+	MeshArena* m_pPlaceholderMeshes;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// textures generated with the materials
+	std::vector<PROCEDURAL_TEXTURE> m_proceduralTextures;
+	// one command list per prop group, recorded in parallel
+	std::vector<CommandList> m_commandLists;
+	// threads the command lists are recorded on, kept between
+	// frames
+	WorkerPool m_recordWorkers;
+	// draws recorded in the last frame, to decide whether the
+	// next frame is worth recording on worker threads
+	int m_lastRecordedDraws;
+	// draw items captured by the last call to RecordScene()
+	std::vector<DRAW_ITEM> m_drawList;
+	// first draw item of each prop group, and one past the last
+	std::vector<int> m_groupStarts;
+	// indices of the opaque and transparent recorded draw items
+	std::vector<int> m_opaqueItems;
+	std::vector<int> m_transparentItems;
+	// view transform of the current frame for the alternate programs
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+	// rendering options of the current frame
+	RENDER_OPTIONS m_renderOptions;
+	// renderer for the blended draws after the opaque pass
+	TransparencyRenderer* m_pTransparencyRenderer;
+	// renderer for the optional opaque depth pre-pass
+	DepthPrepassRenderer* m_pDepthPrepassRenderer;
+	// renderer for the deferred opaque shading path
+	DeferredRenderer* m_pDeferredRenderer;
+	// renderer for the distant props drawn as impostors
+	ImpostorRenderer* m_pImpostorRenderer;
+	// renderer for the scene seen from many views at once
+	MultiViewRenderer* m_pMultiViewRenderer;
+	// counters of the frame being rendered
+	FRAME_STATS m_frameStats;
+	// load times of the textures and the whole scene
+	std::vector<LOAD_TIME> m_loadTimes;
+	// shader state of the last submitted item, for counting
+	// the state changes between consecutive draws
+	const ShaderManager* m_pLastSubmitShader;
+	int m_lastSubmitTexture;
+	int m_lastSubmitMaterial;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
+	// generate the procedural textures on the GPU
+	void BakeProceduralTextures();
+	// release the loaded OpenGL textures to the resource cache
 	void DestroyGLTextures();
+	// get the slot a texture is loaded into - the slot of its
+	// placeholder, freed for it, or the next free one
+	int ClaimTextureSlot(const std::string& tag);
+	void DestroyPlaceholderMeshes();
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
 	int FindTextureSlot(std::string tag);
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(std::string tag);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -97,15 +291,106 @@ private:
 	void SetShaderMaterial(
 		std::string materialTag);
 
+	// true when the recorded draw needs blending
+	bool IsTransparent(const DRAW_ITEM& item) const;
+	// record every prop group into its own command list
+	void RecordCommandLists();
+	// replay the command lists in order into the draw list
+	void MergeCommandLists();
+	// render the scene from a ring of views around the camera
+	void RenderMultiView();
+
 public:
 
+	// a Make* method that records one group of props
+	typedef void (SceneManager::*PROP_GROUP)();
+
+	// run the Make* methods without drawing and return the
+	// captured draw items for multi-pass and multi-view rendering
+	const std::vector<DRAW_ITEM>& RecordScene();
+	// get the first draw item of each prop group in the list
+	// returned by RecordScene(), followed by the item count
+	const std::vector<int>& GetPropGroupStarts() const { return m_groupStarts; }
+	// set the shader state of a recorded draw item and draw it
+	void SubmitDrawItem(const DRAW_ITEM& item);
+	// set only the transform of a recorded draw item and draw it
+	void SubmitDrawItemGeometry(const DRAW_ITEM& item);
+	// draw the passed in mesh, or record it when the
+	// scene is being captured into the draw list
+	void DrawMesh(MESH_TYPE mesh);
+	// bind the vertex array the basic meshes are drawn from
+	void BindMeshes();
+	// get the arena the basic meshes are drawn from, NULL while
+	// no meshes are loaded
+	const MeshArena* GetMeshArena() const { return m_pMeshArena; }
+	// set the view transform of the current frame
+	void SetViewTransform(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	// set the view transform into the current shader manager
+	void ApplyViewTransform();
+	const glm::mat4& GetViewMatrix() const { return m_viewMatrix; }
+	const glm::mat4& GetProjectionMatrix() const { return m_projectionMatrix; }
+	const glm::vec3& GetViewPosition() const { return m_viewPosition; }
+	// get the defined object materials, indexed by DRAW_ITEM::materialIndex
+	const std::vector<OBJECT_MATERIAL>& GetObjectMaterials() const { return m_objectMaterials; }
+	// set the rendering options of the current frame
+	void SetRenderOptions(const RENDER_OPTIONS& options) { m_renderOptions = options; }
+	// get the counters and pass timings of the last frame
+	const FRAME_STATS& GetFrameStats() const { return m_frameStats; }
+	// get the load times recorded by PrepareScene()
+	const std::vector<LOAD_TIME>& GetLoadTimes() const { return m_loadTimes; }
+	// get the object space bounds of a basic mesh
+	static void GetMeshBounds(MESH_TYPE mesh, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+	// get or replace the shader manager used for drawing, so
+	// that alternate shader programs can render the same scene
+	ShaderManager* GetShaderManager() { return m_pShaderManager; }
+	// get the cache the scene loads its resources through
+	ResourceCache* GetResourceCache() { return m_pResourceCache; }
+
+	// the parts of PrepareScene() for loading the scene in the
+	// background - the textures are decoded on any thread, then
+	// uploaded and the prepare steps run on the GL thread, and
+	// the scene is activated when it replaces the current one
+	// - the file contents are decoded when they have already been
+	// read, and the file is read otherwise
+	static bool DecodeTexture(
+		const char* filename,
+		DECODED_TEXTURE& decoded,
+		const unsigned char* pFileData = NULL,
+		size_t fileSize = 0);
+	bool UploadTexture(const DECODED_TEXTURE& decoded, std::string tag);
+	// put a texture uploaded by another context into the slot of
+	// the tag, the scene owns it from here on
+	bool InstallTexture(GLuint textureID, long long textureBytes, const std::string& filename, double loadMilliseconds, std::string tag);
+	bool AcquireCachedTexture(const char* filename, std::string tag);
+	// the same for the basic meshes, read or generated on any
+	// thread and uploaded on the GL thread
+	static bool LoadMeshData(MESH_DATA& data, const unsigned char* pCacheData = NULL, size_t cacheSize = 0);
+	// the file the mesh data is cached in, for reading it ahead
+	static const char* GetMeshCacheFile();
+	bool UploadMeshes(const MESH_DATA& data);
+	bool AcquireCachedMeshes();
+	// stand-ins drawn until the real texture or meshes are
+	// uploaded - a 1x1 texture in the slot of the tag, and a box
+	// of the bounds of each basic mesh
+	bool CreatePlaceholderTexture(std::string tag);
+	bool CreatePlaceholderMeshes();
+	void RunPrepareStep(PREPARE_STEP step);
+	void ActivateScene();
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	void SetShaderManager(ShaderManager* pShaderManager) { m_pShaderManager = pShaderManager; }
+
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
 	void RenderScene();
+	void GetSceneTextures(std::vector<TEXTURE_FILE>& textures);
 	void LoadScenetexture();
 	void DefineObjectMaterials();
+	void DefineProceduralTextures();
 	void SetupSceneLights();
+	void GetPropGroups(std::vector<PROP_GROUP>& groups);
 	
 	void MakeDesk();
 	void MakeBackWall();
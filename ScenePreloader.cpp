@@ -0,0 +1,371 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenepreloader.cpp
+// ============
+// load the next scene in the background while the current one renders,
+// so the switch between them happens at a frame boundary without a hitch
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ScenePreloader.h"
+#include "AssetPack.h"
+#include "AsyncFileReader.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// reads the worker keeps in flight at once
+	const int READ_QUEUE_DEPTH = 16;
+}
+
+/***********************************************************
+ *  ScenePreloader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ScenePreloader::ScenePreloader()
+{
+	m_state = PRELOAD_IDLE;
+	m_pSceneManager = NULL;
+	m_decodedCount = 0;
+	m_pUploader = NULL;
+	m_bCancel = false;
+	m_nextUpload = 0;
+	m_nextStep = 0;
+	m_startTime = std::chrono::steady_clock::now();
+	m_lastUpdateTime = m_startTime;
+	m_stats = SWITCH_STATS();
+	m_lastStats = SWITCH_STATS();
+	m_bNewStats = false;
+}
+
+/***********************************************************
+ *  ~ScenePreloader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ScenePreloader::~ScenePreloader()
+{
+	Cancel();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting to load the passed in
+ *  scene.  The textures still in the resource cache are put
+ *  into the scene straight away and the rest are handed to
+ *  the worker thread to decode.
+ ***********************************************************/
+bool ScenePreloader::Start(SceneManager* pSceneManager)
+{
+	if ((NULL == pSceneManager) || IsBusy())
+	{
+		return(false);
+	}
+
+	m_pSceneManager = pSceneManager;
+	m_startTime = std::chrono::steady_clock::now();
+	m_stats = SWITCH_STATS();
+	m_nextUpload = 0;
+	m_nextStep = 0;
+
+	std::vector<SceneManager::TEXTURE_FILE> textures;
+	m_pSceneManager->GetSceneTextures(textures);
+	m_textureFiles.clear();
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		if (m_pSceneManager->AcquireCachedTexture(textures[i].filename.c_str(), textures[i].tag))
+		{
+			m_stats.cachedTextures++;
+		}
+		else
+		{
+			m_textureFiles.push_back(textures[i]);
+		}
+	}
+
+	m_decodedTextures.clear();
+	m_decodedTextures.resize(m_textureFiles.size());
+	m_uploadRequests.assign(m_textureFiles.size(), NULL);
+	m_decodedCount = 0;
+	m_bCancel = false;
+	if (!m_textureFiles.empty())
+	{
+		m_worker = std::thread(&ScenePreloader::DecodeTextures, this);
+	}
+
+	m_state = PRELOAD_LOADING;
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for timing the frames of a switch and
+ *  doing the GL work of the scene being loaded.  Decoded
+ *  textures are uploaded and then the prepare steps are run,
+ *  one at a time until the time budget is spent.  A texture
+ *  upload or a step is never split, so one that is larger
+ *  than the budget runs over it.
+ ***********************************************************/
+bool ScenePreloader::Update(double budgetMilliseconds)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double frameMilliseconds = std::chrono::duration<double, std::milli>(now - m_lastUpdateTime).count();
+	m_lastUpdateTime = now;
+
+	if (m_state == PRELOAD_IDLE)
+	{
+		return(false);
+	}
+
+	m_stats.frames++;
+	m_stats.maxFrameMilliseconds = std::max(m_stats.maxFrameMilliseconds, frameMilliseconds);
+
+	if (m_state == PRELOAD_SWITCHED)
+	{
+		// the frame that was just timed is the first one of the
+		// new scene, so the switch is over
+		std::cout << "Scene switch: " << m_stats.switchMilliseconds << " ms over " << m_stats.frames << " frames"
+			<< ", longest frame:" << m_stats.maxFrameMilliseconds << " ms"
+			<< ", textures decoded:" << m_stats.decodedTextures << " (" << m_stats.decodeMilliseconds << " ms on the worker)"
+			<< ", cached:" << m_stats.cachedTextures
+			<< ", GL work:" << m_stats.uploadMilliseconds << " ms" << std::endl;
+		m_lastStats = m_stats;
+		m_bNewStats = true;
+		m_state = PRELOAD_IDLE;
+		return(false);
+	}
+
+	if (m_state == PRELOAD_LOADING)
+	{
+		double elapsedMilliseconds = 0.0;
+		while (elapsedMilliseconds < budgetMilliseconds)
+		{
+			if (m_nextUpload < (int)m_textureFiles.size())
+			{
+				// wait for the worker in the next frame
+				if (m_nextUpload >= m_decodedCount.load())
+				{
+					break;
+				}
+
+				ResourceUploader::UPLOAD_REQUEST* pRequest = m_uploadRequests[m_nextUpload];
+				if (NULL != pRequest)
+				{
+					// the texture is put in once its upload is done,
+					// and is looked at again in the next frame until then
+					ResourceUploader::UPLOADED_TEXTURE uploaded;
+					ResourceUploader::UPLOAD_STATUS status = m_pUploader.load()->TakeUploadedTexture(pRequest, uploaded);
+					if (status == ResourceUploader::UPLOAD_PENDING)
+					{
+						break;
+					}
+					m_uploadRequests[m_nextUpload] = NULL;
+					if ((status == ResourceUploader::UPLOAD_READY) &&
+						m_pSceneManager->InstallTexture(uploaded.textureID, uploaded.bytes, uploaded.filename,
+							uploaded.decodeMilliseconds + uploaded.uploadMilliseconds, m_textureFiles[m_nextUpload].tag))
+					{
+						m_stats.decodedTextures++;
+						m_stats.decodeMilliseconds += uploaded.decodeMilliseconds;
+					}
+				}
+				else
+				{
+					SceneManager::DECODED_TEXTURE& decoded = m_decodedTextures[m_nextUpload];
+					if (m_pSceneManager->UploadTexture(decoded, m_textureFiles[m_nextUpload].tag))
+					{
+						m_stats.decodedTextures++;
+					}
+					m_stats.decodeMilliseconds += decoded.decodeMilliseconds;
+					// the decoded levels are not needed after the upload
+					decoded = SceneManager::DECODED_TEXTURE();
+				}
+				m_nextUpload++;
+			}
+			else if (m_nextStep < SceneManager::PREPARE_STEP_COUNT)
+			{
+				m_pSceneManager->RunPrepareStep((SceneManager::PREPARE_STEP)m_nextStep);
+				m_nextStep++;
+			}
+			else
+			{
+				StopWorker();
+				m_state = PRELOAD_READY;
+				break;
+			}
+			elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+		}
+		m_stats.uploadMilliseconds += elapsedMilliseconds;
+	}
+
+	return(m_state == PRELOAD_READY);
+}
+
+/***********************************************************
+ *  TakeScene()
+ *
+ *  This method is used for handing over the loaded scene once
+ *  Update() has returned true.  The scene is activated, so it
+ *  replaces the current scene at the frame boundary, and the
+ *  frame it is first rendered in is timed by the next call
+ *  to Update().
+ ***********************************************************/
+SceneManager* ScenePreloader::TakeScene()
+{
+	if (m_state != PRELOAD_READY)
+	{
+		return(NULL);
+	}
+
+	SceneManager* pSceneManager = m_pSceneManager;
+	m_pSceneManager = NULL;
+	pSceneManager->ActivateScene();
+
+	m_stats.switchMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+	m_state = PRELOAD_SWITCHED;
+	return(pSceneManager);
+}
+
+/***********************************************************
+ *  Cancel()
+ *
+ *  This method is used for stopping the loading and freeing
+ *  the scene that was being loaded.
+ ***********************************************************/
+void ScenePreloader::Cancel()
+{
+	StopWorker();
+	AbandonUploads();
+	if (NULL != m_pSceneManager)
+	{
+		delete m_pSceneManager;
+		m_pSceneManager = NULL;
+	}
+	m_textureFiles.clear();
+	m_decodedTextures.clear();
+	m_state = PRELOAD_IDLE;
+}
+
+/***********************************************************
+ *  HasNewStats()
+ *
+ *  This method is used for checking once whether a switch has
+ *  finished since the last call.
+ ***********************************************************/
+bool ScenePreloader::HasNewStats()
+{
+	bool bNewStats = m_bNewStats;
+	m_bNewStats = false;
+	return(bNewStats);
+}
+
+/***********************************************************
+ *  DecodeTextures()
+ *
+ *  This method is used for reading and decoding the textures
+ *  of the scene on the worker thread.  The files not in the
+ *  asset pack are all submitted to the reader at once and
+ *  decoded as they come in, and are handed to Update() in
+ *  order.
+ ***********************************************************/
+void ScenePreloader::DecodeTextures()
+{
+	AsyncFileReader reader;
+	reader.Initialize(READ_QUEUE_DEPTH);
+
+	std::vector<ASSET_DATA> packed(m_textureFiles.size());
+	std::vector<bool> bPacked(m_textureFiles.size(), false);
+	for (size_t i = 0; i < m_textureFiles.size(); i++)
+	{
+		bPacked[i] = LoadPackedAsset(m_textureFiles[i].filename.c_str(), packed[i]);
+		if (!bPacked[i])
+		{
+			reader.Submit(m_textureFiles[i].filename.c_str(), (int)i);
+		}
+	}
+
+	std::vector<bool> bDecoded(m_textureFiles.size(), false);
+	auto markDecoded = [this, &bDecoded](int texture)
+	{
+		// the upload thread takes the texture straight away, and
+		// its ticket is set before Update() can look for it
+		ResourceUploader* pUploader = m_pUploader.load();
+		if ((NULL != pUploader) && m_decodedTextures[texture].bDecoded)
+		{
+			m_uploadRequests[texture] = pUploader->Submit(m_decodedTextures[texture]);
+		}
+		bDecoded[texture] = true;
+		int decodedCount = m_decodedCount.load();
+		while ((decodedCount < (int)bDecoded.size()) && bDecoded[decodedCount])
+		{
+			decodedCount++;
+		}
+		m_decodedCount = decodedCount;
+	};
+
+	for (size_t i = 0; (i < m_textureFiles.size()) && !m_bCancel; i++)
+	{
+		if (bPacked[i])
+		{
+			SceneManager::DecodeTexture(m_textureFiles[i].filename.c_str(), m_decodedTextures[i], packed[i].pData, packed[i].size);
+			markDecoded((int)i);
+		}
+	}
+
+	AsyncFileReader::READ_COMPLETION completion;
+	while (!m_bCancel && reader.WaitCompletion(completion))
+	{
+		// a texture that could not be read is left undecoded and
+		// is not uploaded
+		if (completion.bSucceeded)
+		{
+			SceneManager::DecodeTexture(completion.filename.c_str(), m_decodedTextures[completion.userData],
+				completion.data.data(), completion.data.size());
+		}
+		markDecoded(completion.userData);
+		completion.data.clear();
+	}
+
+	if (!m_bCancel)
+	{
+		reader.PrintStats("Next scene textures");
+	}
+}
+
+/***********************************************************
+ *  StopWorker()
+ *
+ *  This method is used for stopping the worker thread and
+ *  waiting for it to finish.
+ ***********************************************************/
+void ScenePreloader::StopWorker()
+{
+	m_bCancel = true;
+	if (m_worker.joinable())
+	{
+		m_worker.join();
+	}
+}
+
+/***********************************************************
+ *  AbandonUploads()
+ *
+ *  This method is used for giving up the uploads that were
+ *  handed to the uploader and not yet taken, once the worker
+ *  has stopped.
+ ***********************************************************/
+void ScenePreloader::AbandonUploads()
+{
+	for (size_t i = 0; i < m_uploadRequests.size(); i++)
+	{
+		if (NULL != m_uploadRequests[i])
+		{
+			m_pUploader.load()->Abandon(m_uploadRequests[i]);
+		}
+	}
+	m_uploadRequests.clear();
+}
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenepreloader.h
+// ============
+// load the next scene in the background while the current one renders,
+// so the switch between them happens at a frame boundary without a hitch
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ResourceUploader.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  ScenePreloader
+ *
+ *  This class prepares a scene manager a little at a time.
+ *  The texture files are read, mipmapped and compressed on a
+ *  worker thread.  The GL work - the texture uploads and the
+ *  prepare steps that load the meshes and programs - is done
+ *  from Update(), called once per frame, within a time budget
+ *  so the frame rate of the current scene holds.  With a
+ *  resource uploader set, the textures are uploaded on its
+ *  thread instead and Update() only puts them in once they
+ *  are done.  Resources still in the resource cache are used
+ *  without loading.
+ ***********************************************************/
+class ScenePreloader
+{
+public:
+	// constructor
+	ScenePreloader();
+	// destructor
+	~ScenePreloader();
+
+	// timings of the last scene switch
+	struct SWITCH_STATS
+	{
+		// from Start() to the first frame of the new scene
+		double switchMilliseconds;
+		// longest frame from Start() up to and including the
+		// frame the switch happened in
+		double maxFrameMilliseconds;
+		int frames;
+		// decoding on the worker and GL work in Update()
+		double decodeMilliseconds;
+		double uploadMilliseconds;
+		int cachedTextures;
+		int decodedTextures;
+	};
+
+	// start loading the passed in scene, which has not been
+	// prepared - the preloader owns it until TakeScene()
+	bool Start(SceneManager* pSceneManager);
+	// called at the start of every frame on the GL thread, does
+	// GL work for up to the passed in time while loading and
+	// returns true once the scene is ready to be taken
+	bool Update(double budgetMilliseconds);
+	// hand over the loaded scene, activated and ready to render
+	SceneManager* TakeScene();
+	// stop loading and free the scene that was being loaded
+	void Cancel();
+	// upload the textures decoded from here on with the passed
+	// in uploader, which outlives the loading
+	void SetUploader(ResourceUploader* pUploader) { m_pUploader = pUploader; }
+
+	bool IsBusy() const { return m_state != PRELOAD_IDLE; }
+	// true once the stats of a finished switch can be read
+	bool HasNewStats();
+	const SWITCH_STATS& GetLastStats() const { return m_lastStats; }
+
+private:
+	enum PRELOAD_STATE
+	{
+		PRELOAD_IDLE,
+		PRELOAD_LOADING,
+		PRELOAD_READY,
+		// switched, the frame of the switch is still being timed
+		PRELOAD_SWITCHED
+	};
+
+	PRELOAD_STATE m_state;
+	SceneManager* m_pSceneManager;
+	// textures not in the cache, decoded by the worker in the
+	// order their files are read and handed over in this order
+	std::vector<SceneManager::TEXTURE_FILE> m_textureFiles;
+	std::vector<SceneManager::DECODED_TEXTURE> m_decodedTextures;
+	// number of textures from the first that the worker has
+	// finished
+	std::atomic<int> m_decodedCount;
+	// the tickets of the textures handed to the uploader, NULL
+	// for the ones uploaded by Update()
+	std::atomic<ResourceUploader*> m_pUploader;
+	std::vector<ResourceUploader::UPLOAD_REQUEST*> m_uploadRequests;
+	std::atomic<bool> m_bCancel;
+	std::thread m_worker;
+	// next texture to upload and next prepare step to run
+	int m_nextUpload;
+	int m_nextStep;
+	std::chrono::steady_clock::time_point m_startTime;
+	std::chrono::steady_clock::time_point m_lastUpdateTime;
+	SWITCH_STATS m_stats;
+	SWITCH_STATS m_lastStats;
+	bool m_bNewStats;
+
+	void DecodeTextures();
+	void StopWorker();
+	void AbandonUploads();
+};
@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderloader.cpp
+// ============
+// compile shader programs that need more than a vertex and fragment
+// stage, with support for #include between GLSL files
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderLoader.h"
+#include "AssetPack.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// guard against files that include each other
+	const int MAX_INCLUDE_DEPTH = 8;
+
+	// sources read by PreloadShaderSources(), by file name
+	std::mutex g_PreloadedMutex;
+	std::map<std::string, std::string> g_PreloadedSources;
+
+	/***********************************************************
+	 *  ReadShaderFile()
+	 *
+	 *  This function is used for reading a GLSL file and
+	 *  expanding its #include lines recursively.
+	 ***********************************************************/
+	bool ReadShaderFile(const std::string& filename, std::string& source, int depth)
+	{
+		if (depth > MAX_INCLUDE_DEPTH)
+		{
+			std::cout << "Shader includes nested too deeply:" << filename << std::endl;
+			return(false);
+		}
+
+		// the asset pack is looked in first, so a program and the
+		// files it includes are read without opening any of them
+		std::string contents;
+		ASSET_DATA asset;
+		if (LoadPackedAsset(filename.c_str(), asset))
+		{
+			contents.assign((const char*)asset.pData, asset.size);
+		}
+		else
+		{
+			std::ifstream file(filename.c_str());
+			if (!file.is_open())
+			{
+				std::cout << "Could not open shader file:" << filename << std::endl;
+				return(false);
+			}
+			std::stringstream buffer;
+			buffer << file.rdbuf();
+			contents = buffer.str();
+		}
+		std::istringstream file(contents);
+
+		// included files are resolved relative to the including file
+		std::string directory;
+		size_t slash = filename.find_last_of("/\\");
+		if (slash != std::string::npos)
+		{
+			directory = filename.substr(0, slash + 1);
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			size_t start = line.find_first_not_of(" \t");
+			if ((start != std::string::npos) && (line.compare(start, 8, "#include") == 0))
+			{
+				size_t open = line.find('"', start);
+				size_t close = line.find('"', open + 1);
+				if ((open == std::string::npos) || (close == std::string::npos))
+				{
+					std::cout << "Malformed #include in shader file:" << filename << std::endl;
+					return(false);
+				}
+
+				std::string included;
+				if (!ReadShaderFile(directory + line.substr(open + 1, close - open - 1), included, depth + 1))
+				{
+					return(false);
+				}
+				source += included;
+			}
+			else
+			{
+				source += line;
+				source += "\n";
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  LinkProgram()
+	 *
+	 *  This function is used for linking the compiled stages into
+	 *  a program.  The stages are released after linking.
+	 ***********************************************************/
+	GLuint LinkProgram(const std::vector<GLuint>& stages)
+	{
+		GLuint programID = glCreateProgram();
+		GLint success = 0;
+
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			glAttachShader(programID, stages[i]);
+		}
+		glLinkProgram(programID);
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			glDetachShader(programID, stages[i]);
+			glDeleteShader(stages[i]);
+		}
+
+		glGetProgramiv(programID, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[1024];
+			glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+			std::cout << "Failed to link shader program\n" << infoLog << std::endl;
+			glDeleteProgram(programID);
+			return(0);
+		}
+
+		return(programID);
+	}
+}
+
+/***********************************************************
+ *  ReadShaderSource()
+ *
+ *  This function is used for reading the GLSL source code
+ *  from a shader file, with any #include lines expanded.
+ ***********************************************************/
+bool ReadShaderSource(const char* filename, std::string& source)
+{
+	source.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(g_PreloadedMutex);
+		std::map<std::string, std::string>::iterator preloaded = g_PreloadedSources.find(filename);
+		if (preloaded != g_PreloadedSources.end())
+		{
+			source = preloaded->second;
+			return(true);
+		}
+	}
+
+	return(ReadShaderFile(filename, source, 0));
+}
+
+/***********************************************************
+ *  PreloadShaderSources()
+ *
+ *  This function is used for reading the shader files of a
+ *  directory before the programs are compiled, so the file
+ *  reads and #include expansion can run on a worker thread
+ *  while the GL context is still being created.
+ ***********************************************************/
+int PreloadShaderSources(const char* directory)
+{
+	// with an asset pack mounted the directory is listed from
+	// its index instead of the disk
+	std::vector<std::string> names;
+	if (!ListPackedAssets(directory, names) || names.empty())
+	{
+		std::error_code error;
+		std::filesystem::directory_iterator entries(directory, error);
+		if (error)
+		{
+			std::cout << "Could not open shader directory:" << directory << std::endl;
+			return(0);
+		}
+		for (const std::filesystem::directory_entry& entry : entries)
+		{
+			if (entry.is_regular_file(error))
+			{
+				names.push_back(entry.path().filename().string());
+			}
+		}
+	}
+
+	int count = 0;
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (std::filesystem::path(names[i]).extension() != ".glsl")
+		{
+			continue;
+		}
+
+		// keyed the way the programs name their files, with a
+		// forward slash after the directory on every platform
+		std::string filename = std::string(directory) + "/" + names[i];
+		std::string source;
+		if (ReadShaderFile(filename, source, 0))
+		{
+			std::lock_guard<std::mutex> lock(g_PreloadedMutex);
+			g_PreloadedSources[filename].swap(source);
+			count++;
+		}
+	}
+
+	return(count);
+}
+
+/***********************************************************
+ *  ClearPreloadedShaderSources()
+ *
+ *  This function is used for dropping the preloaded sources
+ *  once startup is done, so programs loaded later read their
+ *  files as they are then.
+ ***********************************************************/
+void ClearPreloadedShaderSources()
+{
+	std::lock_guard<std::mutex> lock(g_PreloadedMutex);
+	g_PreloadedSources.clear();
+}
+
+/***********************************************************
+ *  CompileShaderStage()
+ *
+ *  This function is used for compiling one shader stage and
+ *  reporting any compile errors.
+ ***********************************************************/
+GLuint CompileShaderStage(GLenum stageType, const std::string& source, const char* name)
+{
+	GLuint shaderID = glCreateShader(stageType);
+	const char* sourceText = source.c_str();
+	GLint success = 0;
+
+	glShaderSource(shaderID, 1, &sourceText, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[1024];
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Failed to compile shader:" << name << "\n" << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  LoadShaderProgram()
+ *
+ *  This function is used for loading, compiling and linking
+ *  a program from vertex, geometry and fragment shader files.
+ *  The geometry shader file may be NULL.
+ ***********************************************************/
+GLuint LoadShaderProgram(
+	const char* vertexFile,
+	const char* geometryFile,
+	const char* fragmentFile)
+{
+	const char* files[3] = { vertexFile, geometryFile, fragmentFile };
+	const GLenum types[3] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER };
+	std::vector<GLuint> stages;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (NULL == files[i])
+		{
+			continue;
+		}
+
+		std::string source;
+		GLuint shaderID = 0;
+		if (ReadShaderSource(files[i], source))
+		{
+			shaderID = CompileShaderStage(types[i], source, files[i]);
+		}
+		if (0 == shaderID)
+		{
+			for (size_t j = 0; j < stages.size(); j++)
+			{
+				glDeleteShader(stages[j]);
+			}
+			return(0);
+		}
+		stages.push_back(shaderID);
+	}
+
+	return(LinkProgram(stages));
+}
+
+/***********************************************************
+ *  LoadComputeProgram()
+ *
+ *  This function is used for loading, compiling and linking
+ *  a compute program from a shader file.
+ ***********************************************************/
+GLuint LoadComputeProgram(const char* computeFile)
+{
+	std::string source;
+	std::vector<GLuint> stages;
+
+	if (!ReadShaderSource(computeFile, source))
+	{
+		return(0);
+	}
+
+	GLuint shaderID = CompileShaderStage(GL_COMPUTE_SHADER, source, computeFile);
+	if (0 == shaderID)
+	{
+		return(0);
+	}
+	stages.push_back(shaderID);
+
+	return(LinkProgram(stages));
+}
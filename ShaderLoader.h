@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderloader.h
+// ============
+// compile shader programs that need more than a vertex and fragment
+// stage, with support for #include between GLSL files
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+// read a GLSL file, replacing each #include "file" line with the
+// contents of that file from the same directory
+bool ReadShaderSource(const char* filename, std::string& source);
+
+// read and expand every .glsl file in the passed in directory ahead of
+// use, on any thread, so ReadShaderSource() of each one skips the file
+// reads until the preloaded sources are cleared - returns the number of
+// files read
+int PreloadShaderSources(const char* directory);
+void ClearPreloadedShaderSources();
+
+// compile a single shader stage from source code
+GLuint CompileShaderStage(GLenum stageType, const std::string& source, const char* name);
+
+// compile and link a program from vertex, optional geometry and
+// fragment shader files - pass NULL to skip the geometry stage
+GLuint LoadShaderProgram(
+	const char* vertexFile,
+	const char* geometryFile,
+	const char* fragmentFile);
+
+// compile and link a compute program from a shader file
+GLuint LoadComputeProgram(const char* computeFile);
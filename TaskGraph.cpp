@@ -0,0 +1,341 @@
+///////////////////////////////////////////////////////////////////////////////
+// taskgraph.cpp
+// ============
+// run a set of tasks with dependencies between them on a pool of worker
+// threads and the GL context thread, and report their timeline
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TaskGraph.h"
+
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  EscapeJson()
+	 *
+	 *  This function is used for escaping a task name to be put
+	 *  in a JSON string.
+	 ***********************************************************/
+	std::string EscapeJson(const std::string& value)
+	{
+		std::string escaped;
+		escaped.reserve(value.size());
+		for (size_t i = 0; i < value.size(); i++)
+		{
+			char character = value[i];
+			if ((character == '\\') || (character == '"'))
+			{
+				escaped += '\\';
+				escaped += character;
+			}
+			else if ((unsigned char)character < 0x20)
+			{
+				escaped += ' ';
+			}
+			else
+			{
+				escaped += character;
+			}
+		}
+		return(escaped);
+	}
+}
+
+/***********************************************************
+ *  TaskGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TaskGraph::TaskGraph()
+{
+	m_workerCount = 0;
+	m_totalMilliseconds = 0.0;
+	m_finishedCount = 0;
+	m_startTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  AddTask()
+ *
+ *  This method is used for adding a task to the graph.  A
+ *  dependency must have been added before the task, so the
+ *  graph can never hold a cycle.
+ ***********************************************************/
+int TaskGraph::AddTask(
+	const std::string& name,
+	TASK_THREAD thread,
+	const std::function<void()>& function,
+	const std::vector<int>& dependencies)
+{
+	int id = (int)m_tasks.size();
+
+	TASK task;
+	task.name = name;
+	task.thread = thread;
+	task.function = function;
+	task.waitingFor = 0;
+	task.threadIndex = 0;
+	task.startMilliseconds = 0.0;
+	task.endMilliseconds = 0.0;
+	for (size_t i = 0; i < dependencies.size(); i++)
+	{
+		if ((dependencies[i] < 0) || (dependencies[i] >= id))
+		{
+			std::cout << "Task " << name << " depends on a task that was not added before it" << std::endl;
+			continue;
+		}
+		task.dependencies.push_back(dependencies[i]);
+	}
+	m_tasks.push_back(task);
+
+	for (size_t i = 0; i < m_tasks[id].dependencies.size(); i++)
+	{
+		m_tasks[m_tasks[id].dependencies[i]].dependents.push_back(id);
+	}
+	return(id);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running the graph.  The calling
+ *  thread only takes the context tasks while there are
+ *  workers, so a GL step that becomes ready never waits
+ *  behind a long decode.
+ ***********************************************************/
+void TaskGraph::Run(int workerCount)
+{
+	m_workerCount = workerCount;
+	m_finishedCount = 0;
+	m_readyAny.clear();
+	m_readyContext.clear();
+	m_startTime = std::chrono::steady_clock::now();
+
+	// the tasks are added after their dependencies, so adding
+	// the ready ones in reverse keeps them in the order they
+	// were added when taken from the back
+	for (int task = (int)m_tasks.size() - 1; task >= 0; task--)
+	{
+		m_tasks[task].waitingFor = (int)m_tasks[task].dependencies.size();
+		if (0 == m_tasks[task].waitingFor)
+		{
+			if (m_tasks[task].thread == TASK_CONTEXT_THREAD)
+			{
+				m_readyContext.push_back(task);
+			}
+			else
+			{
+				m_readyAny.push_back(task);
+			}
+		}
+	}
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < workerCount; i++)
+	{
+		workers.push_back(std::thread(&TaskGraph::WorkerLoop, this, i + 1));
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_finishedCount < (int)m_tasks.size())
+	{
+		int task = -1;
+		if (!m_readyContext.empty())
+		{
+			task = m_readyContext.back();
+			m_readyContext.pop_back();
+		}
+		else if ((0 == workerCount) && !m_readyAny.empty())
+		{
+			task = m_readyAny.back();
+			m_readyAny.pop_back();
+		}
+
+		if (task < 0)
+		{
+			m_ready.wait(lock);
+			continue;
+		}
+
+		lock.unlock();
+		RunTask(task, 0);
+		lock.lock();
+	}
+	lock.unlock();
+
+	m_ready.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	m_totalMilliseconds = 0.0;
+	for (size_t task = 0; task < m_tasks.size(); task++)
+	{
+		m_totalMilliseconds = std::max(m_totalMilliseconds, m_tasks[task].endMilliseconds);
+	}
+}
+
+/***********************************************************
+ *  RunTask()
+ *
+ *  This method is used for running one task, without the lock
+ *  held, and then releasing the tasks that were waiting only
+ *  on it.
+ ***********************************************************/
+void TaskGraph::RunTask(int task, int threadIndex)
+{
+	TASK& current = m_tasks[task];
+	current.threadIndex = threadIndex;
+	current.startMilliseconds = GetElapsedMilliseconds();
+	if (current.function)
+	{
+		current.function();
+	}
+	current.endMilliseconds = GetElapsedMilliseconds();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < current.dependents.size(); i++)
+		{
+			TASK& dependent = m_tasks[current.dependents[i]];
+			dependent.waitingFor--;
+			if (0 == dependent.waitingFor)
+			{
+				if (dependent.thread == TASK_CONTEXT_THREAD)
+				{
+					m_readyContext.push_back(current.dependents[i]);
+				}
+				else
+				{
+					m_readyAny.push_back(current.dependents[i]);
+				}
+			}
+		}
+		m_finishedCount++;
+	}
+	m_ready.notify_all();
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for taking ready tasks that may run on
+ *  any thread until every task has finished.
+ ***********************************************************/
+void TaskGraph::WorkerLoop(int threadIndex)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_finishedCount < (int)m_tasks.size())
+	{
+		if (m_readyAny.empty())
+		{
+			m_ready.wait(lock);
+			continue;
+		}
+
+		int task = m_readyAny.back();
+		m_readyAny.pop_back();
+		lock.unlock();
+		RunTask(task, threadIndex);
+		lock.lock();
+	}
+}
+
+/***********************************************************
+ *  GetCriticalPath()
+ *
+ *  This method is used for finding the chain of tasks that
+ *  decided when the graph finished.  Starting from the task
+ *  that ended last, each step goes back to the dependency
+ *  that ended last, as that is the one the task waited for.
+ ***********************************************************/
+void TaskGraph::GetCriticalPath(std::vector<int>& path) const
+{
+	path.clear();
+
+	int task = -1;
+	for (int i = 0; i < (int)m_tasks.size(); i++)
+	{
+		if ((task < 0) || (m_tasks[i].endMilliseconds > m_tasks[task].endMilliseconds))
+		{
+			task = i;
+		}
+	}
+
+	while (task >= 0)
+	{
+		path.insert(path.begin(), task);
+
+		int latest = -1;
+		const std::vector<int>& dependencies = m_tasks[task].dependencies;
+		for (size_t i = 0; i < dependencies.size(); i++)
+		{
+			if ((latest < 0) || (m_tasks[dependencies[i]].endMilliseconds > m_tasks[latest].endMilliseconds))
+			{
+				latest = dependencies[i];
+			}
+		}
+		task = latest;
+	}
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for writing the timeline of the last
+ *  run as one complete event per task, on a track per thread.
+ *  The tasks on the critical path are marked in their args.
+ ***********************************************************/
+bool TaskGraph::WriteTrace(const char* filename) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write task trace:" << filename << std::endl;
+		return(false);
+	}
+
+	std::vector<int> path;
+	GetCriticalPath(path);
+	std::vector<bool> bCritical(m_tasks.size(), false);
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		bCritical[path[i]] = true;
+	}
+
+	file << "{\"traceEvents\":[\n";
+	for (int thread = 0; thread <= m_workerCount; thread++)
+	{
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+			<< ",\"args\":{\"name\":\"" << ((0 == thread) ? "context" : "worker " + std::to_string(thread)) << "\"}},\n";
+	}
+	for (size_t task = 0; task < m_tasks.size(); task++)
+	{
+		const TASK& current = m_tasks[task];
+		file << "{\"name\":\"" << EscapeJson(current.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << current.threadIndex
+			<< ",\"ts\":" << (long long)(current.startMilliseconds * 1000.0)
+			<< ",\"dur\":" << (long long)((current.endMilliseconds - current.startMilliseconds) * 1000.0)
+			<< ",\"args\":{\"critical\":" << (bCritical[task] ? "true" : "false") << "}}"
+			<< ((task + 1 < m_tasks.size()) ? ",\n" : "\n");
+	}
+	file << "]}\n";
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  GetElapsedMilliseconds()
+ *
+ *  This method is used for getting the time since the start
+ *  of the run.
+ ***********************************************************/
+double TaskGraph::GetElapsedMilliseconds() const
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count());
+}
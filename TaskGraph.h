@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// taskgraph.h
+// ============
+// run a set of tasks with dependencies between them on a pool of worker
+// threads and the GL context thread, and report their timeline
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TaskGraph
+ *
+ *  This class runs tasks once all the tasks they depend on
+ *  have finished.  Tasks that make GL calls are marked to run
+ *  on the context thread, which is the thread that calls
+ *  Run(), and the rest run on the worker threads as soon as
+ *  they are ready.  The start and end of every task are kept,
+ *  so the timeline can be written as a trace file and the
+ *  critical path - the chain of tasks that each waited on the
+ *  one before it - can be found.
+ ***********************************************************/
+class TaskGraph
+{
+public:
+	// constructor
+	TaskGraph();
+
+	// where a task may run
+	enum TASK_THREAD
+	{
+		TASK_ANY_THREAD,
+		TASK_CONTEXT_THREAD
+	};
+
+	// add a task, run after the tasks whose ids are passed in,
+	// returning the id of the new task
+	int AddTask(
+		const std::string& name,
+		TASK_THREAD thread,
+		const std::function<void()>& function,
+		const std::vector<int>& dependencies = std::vector<int>());
+
+	// run every task, the context tasks on the calling thread,
+	// and return once they have all finished - with no workers
+	// the calling thread runs all of them
+	void Run(int workerCount);
+
+	// write the timeline in the Chrome trace event format, which
+	// chrome://tracing and Perfetto open
+	bool WriteTrace(const char* filename) const;
+	// ids of the tasks on the critical path, first to last
+	void GetCriticalPath(std::vector<int>& path) const;
+
+	const std::string& GetTaskName(int task) const { return m_tasks[task].name; }
+	double GetTaskMilliseconds(int task) const { return m_tasks[task].endMilliseconds - m_tasks[task].startMilliseconds; }
+	// from the start of Run() to the end of the last task
+	double GetTotalMilliseconds() const { return m_totalMilliseconds; }
+
+private:
+	struct TASK
+	{
+		std::string name;
+		TASK_THREAD thread;
+		std::function<void()> function;
+		std::vector<int> dependencies;
+		std::vector<int> dependents;
+		// dependencies still running, while the graph runs
+		int waitingFor;
+		// thread it ran on, 0 for the context thread
+		int threadIndex;
+		double startMilliseconds;
+		double endMilliseconds;
+	};
+
+	std::vector<TASK> m_tasks;
+	int m_workerCount;
+	double m_totalMilliseconds;
+
+	// shared by the threads while the graph runs
+	std::mutex m_mutex;
+	std::condition_variable m_ready;
+	std::vector<int> m_readyAny;
+	std::vector<int> m_readyContext;
+	int m_finishedCount;
+	std::chrono::steady_clock::time_point m_startTime;
+
+	void RunTask(int task, int threadIndex);
+	void WorkerLoop(int threadIndex);
+	double GetElapsedMilliseconds() const;
+};
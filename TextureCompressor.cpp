@@ -0,0 +1,825 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.cpp
+// ============
+// encode texture images into BC1, BC3 or BC7 blocks on the CPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSOR_SSE2
+#endif
+
+// declaration of global variables
+namespace
+{
+	// BC7 interpolation weights for 4 bit indices
+	const int g_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// the 16 texels of a 4x4 block, one row of floats per channel
+	// so that four texels can be processed with one SSE register
+	struct BLOCK_PIXELS
+	{
+		alignas(16) float channel[4][16];
+	};
+
+	/***********************************************************
+	 *  BIT_WRITER
+	 *
+	 *  Writes values into a block least significant bit first,
+	 *  which is the bit order of the BC7 format.
+	 ***********************************************************/
+	struct BIT_WRITER
+	{
+		unsigned char* data;
+		int position;
+
+		BIT_WRITER(unsigned char* block, int blockBytes)
+		{
+			data = block;
+			position = 0;
+			memset(data, 0, blockBytes);
+		}
+
+		void Write(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; i++, position++)
+			{
+				data[position >> 3] |= ((value >> i) & 1) << (position & 7);
+			}
+		}
+	};
+
+	// reads values back in the order BIT_WRITER wrote them
+	struct BIT_READER
+	{
+		const unsigned char* data;
+		int position;
+
+		BIT_READER(const unsigned char* block)
+		{
+			data = block;
+			position = 0;
+		}
+
+		uint32_t Read(int bits)
+		{
+			uint32_t value = 0;
+			for (int i = 0; i < bits; i++, position++)
+			{
+				value |= ((data[position >> 3] >> (position & 7)) & 1u) << i;
+			}
+			return(value);
+		}
+	};
+
+	/***********************************************************
+	 *  GatherBlock()
+	 *
+	 *  This function is used for reading the 4x4 block at the
+	 *  passed in block coordinates, repeating the edge texels
+	 *  for blocks that hang over the image border.
+	 ***********************************************************/
+	void GatherBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, BLOCK_PIXELS& pixels)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int sourceY = std::min(blockY * 4 + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				int sourceX = std::min(blockX * 4 + x, width - 1);
+				const unsigned char* texel = rgba + ((size_t)sourceY * width + sourceX) * 4;
+				for (int c = 0; c < 4; c++)
+				{
+					pixels.channel[c][y * 4 + x] = texel[c];
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  FindEndpoints()
+	 *
+	 *  This function is used for fitting a line through the
+	 *  block colors along their principal axis, found with a
+	 *  few power iterations on the covariance matrix, and
+	 *  returning the extent of the texels along that line.
+	 ***********************************************************/
+	void FindEndpoints(const BLOCK_PIXELS& pixels, int channelCount, float low[4], float high[4])
+	{
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float minimum[4];
+		float maximum[4];
+		for (int c = 0; c < channelCount; c++)
+		{
+			minimum[c] = 255.0f;
+			maximum[c] = 0.0f;
+			for (int i = 0; i < 16; i++)
+			{
+				mean[c] += pixels.channel[c][i];
+				minimum[c] = std::min(minimum[c], pixels.channel[c][i]);
+				maximum[c] = std::max(maximum[c], pixels.channel[c][i]);
+			}
+			mean[c] /= 16.0f;
+		}
+
+		float covariance[4][4];
+		for (int a = 0; a < channelCount; a++)
+		{
+			for (int b = a; b < channelCount; b++)
+			{
+				float sum = 0.0f;
+				for (int i = 0; i < 16; i++)
+				{
+					sum += (pixels.channel[a][i] - mean[a]) * (pixels.channel[b][i] - mean[b]);
+				}
+				covariance[a][b] = sum;
+				covariance[b][a] = sum;
+			}
+		}
+
+		// start from the bounding box diagonal, which is already
+		// close to the principal axis for most blocks
+		float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] = maximum[c] - minimum[c];
+		}
+		for (int iteration = 0; iteration < 4; iteration++)
+		{
+			float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float length = 0.0f;
+			for (int a = 0; a < channelCount; a++)
+			{
+				for (int b = 0; b < channelCount; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, std::fabs(next[a]));
+			}
+			if (length < FLT_EPSILON)
+			{
+				break;
+			}
+			for (int c = 0; c < channelCount; c++)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float axisLength = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			axisLength += axis[c] * axis[c];
+		}
+
+		// a flat block has no axis, so both endpoints are the mean
+		float minimumT = 0.0f;
+		float maximumT = 0.0f;
+		if (axisLength > FLT_EPSILON)
+		{
+			minimumT = FLT_MAX;
+			maximumT = -FLT_MAX;
+			for (int i = 0; i < 16; i++)
+			{
+				float t = 0.0f;
+				for (int c = 0; c < channelCount; c++)
+				{
+					t += (pixels.channel[c][i] - mean[c]) * axis[c];
+				}
+				minimumT = std::min(minimumT, t);
+				maximumT = std::max(maximumT, t);
+			}
+			minimumT /= axisLength;
+			maximumT /= axisLength;
+		}
+
+		for (int c = 0; c < channelCount; c++)
+		{
+			low[c] = std::min(std::max(mean[c] + axis[c] * minimumT, 0.0f), 255.0f);
+			high[c] = std::min(std::max(mean[c] + axis[c] * maximumT, 0.0f), 255.0f);
+		}
+	}
+
+	/***********************************************************
+	 *  FitIndices()
+	 *
+	 *  This function is used for choosing the closest palette
+	 *  entry for every texel over the passed in channels, and
+	 *  returning the summed squared error.  With SSE2 four
+	 *  texels are tested against each palette entry at once.
+	 ***********************************************************/
+	float FitIndices(
+		const BLOCK_PIXELS& pixels,
+		const float palette[][4],
+		int paletteSize,
+		int firstChannel,
+		int channelCount,
+		unsigned char indices[16])
+	{
+		float totalError = 0.0f;
+
+#ifdef TEXTURE_COMPRESSOR_SSE2
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 bestError = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+			for (int entry = 0; entry < paletteSize; entry++)
+			{
+				__m128 error = _mm_setzero_ps();
+				for (int c = firstChannel; c < firstChannel + channelCount; c++)
+				{
+					__m128 difference = _mm_sub_ps(_mm_load_ps(&pixels.channel[c][i]), _mm_set1_ps(palette[entry][c]));
+					error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+				}
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+				bestError = _mm_min_ps(error, bestError);
+				bestIndex = _mm_or_si128(
+					_mm_andnot_si128(closer, bestIndex),
+					_mm_and_si128(closer, _mm_set1_epi32(entry)));
+			}
+
+			alignas(16) int32_t chosen[4];
+			alignas(16) float errors[4];
+			_mm_store_si128((__m128i*)chosen, bestIndex);
+			_mm_store_ps(errors, bestError);
+			for (int j = 0; j < 4; j++)
+			{
+				indices[i + j] = (unsigned char)chosen[j];
+				totalError += errors[j];
+			}
+		}
+#else
+		for (int i = 0; i < 16; i++)
+		{
+			float bestError = FLT_MAX;
+			int bestIndex = 0;
+			for (int entry = 0; entry < paletteSize; entry++)
+			{
+				float error = 0.0f;
+				for (int c = firstChannel; c < firstChannel + channelCount; c++)
+				{
+					float difference = pixels.channel[c][i] - palette[entry][c];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = entry;
+				}
+			}
+			indices[i] = (unsigned char)bestIndex;
+			totalError += bestError;
+		}
+#endif
+
+		return(totalError);
+	}
+
+	uint16_t PackRGB565(const float color[4])
+	{
+		int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+		int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+		int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+		return((uint16_t)((r << 11) | (g << 5) | b));
+	}
+
+	void UnpackRGB565(uint16_t packed, float color[4])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (float)((r << 3) | (r >> 2));
+		color[1] = (float)((g << 2) | (g >> 4));
+		color[2] = (float)((b << 3) | (b >> 2));
+		color[3] = 255.0f;
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  This function is used for writing the 8 byte BC1 color
+	 *  block.  The endpoints are always ordered for the four
+	 *  color mode, which BC3 requires for its color block.
+	 ***********************************************************/
+	void EncodeColorBlock(const BLOCK_PIXELS& pixels, unsigned char* output)
+	{
+		float low[4];
+		float high[4];
+		FindEndpoints(pixels, 3, low, high);
+
+		uint16_t color0 = PackRGB565(high);
+		uint16_t color1 = PackRGB565(low);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		uint32_t indexBits = 0;
+		if (color0 != color1)
+		{
+			float palette[4][4];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (int c = 0; c < 4; c++)
+			{
+				palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+			}
+
+			unsigned char indices[16];
+			FitIndices(pixels, palette, 4, 0, 3, indices);
+			for (int i = 0; i < 16; i++)
+			{
+				indexBits |= (uint32_t)indices[i] << (2 * i);
+			}
+		}
+
+		output[0] = (unsigned char)(color0 & 0xFF);
+		output[1] = (unsigned char)(color0 >> 8);
+		output[2] = (unsigned char)(color1 & 0xFF);
+		output[3] = (unsigned char)(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+		{
+			output[4 + i] = (unsigned char)(indexBits >> (8 * i));
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  This function is used for writing the 8 byte BC3 alpha
+	 *  block in its eight value interpolated mode.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const BLOCK_PIXELS& pixels, unsigned char* output)
+	{
+		float minimum = 255.0f;
+		float maximum = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			minimum = std::min(minimum, pixels.channel[3][i]);
+			maximum = std::max(maximum, pixels.channel[3][i]);
+		}
+
+		int alpha0 = (int)(maximum + 0.5f);
+		int alpha1 = (int)(minimum + 0.5f);
+		uint64_t indexBits = 0;
+		if (alpha0 > alpha1)
+		{
+			float palette[8][4];
+			palette[0][3] = (float)alpha0;
+			palette[1][3] = (float)alpha1;
+			for (int i = 2; i < 8; i++)
+			{
+				palette[i][3] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7.0f;
+			}
+
+			unsigned char indices[16];
+			FitIndices(pixels, palette, 8, 3, 1, indices);
+			for (int i = 0; i < 16; i++)
+			{
+				indexBits |= (uint64_t)indices[i] << (3 * i);
+			}
+		}
+
+		output[0] = (unsigned char)alpha0;
+		output[1] = (unsigned char)alpha1;
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = (unsigned char)(indexBits >> (8 * i));
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeBC7Block()
+	 *
+	 *  This function is used for writing a BC7 block in mode 6,
+	 *  a single RGBA line with 7 bit endpoints, a shared low
+	 *  bit per endpoint and 4 bit indices.  All four low bit
+	 *  combinations are tried and the closest fit is kept.
+	 ***********************************************************/
+	void EncodeBC7Block(const BLOCK_PIXELS& pixels, unsigned char* output)
+	{
+		float low[4];
+		float high[4];
+		FindEndpoints(pixels, 4, low, high);
+
+		float bestError = FLT_MAX;
+		int bestEndpoints[2][4] = { { 0 } };
+		int bestPBits[2] = { 0, 0 };
+		unsigned char bestIndices[16] = { 0 };
+
+		for (int pBits = 0; pBits < 4; pBits++)
+		{
+			int pBit[2] = { pBits & 1, pBits >> 1 };
+			int endpoints[2][4];
+			float palette[16][4];
+			for (int c = 0; c < 4; c++)
+			{
+				endpoints[0][c] = std::min(std::max((int)((low[c] - pBit[0]) * 0.5f + 0.5f), 0), 127);
+				endpoints[1][c] = std::min(std::max((int)((high[c] - pBit[1]) * 0.5f + 0.5f), 0), 127);
+				int value0 = (endpoints[0][c] << 1) | pBit[0];
+				int value1 = (endpoints[1][c] << 1) | pBit[1];
+				for (int i = 0; i < 16; i++)
+				{
+					palette[i][c] = (float)(((64 - g_BC7Weights[i]) * value0 + g_BC7Weights[i] * value1 + 32) >> 6);
+				}
+			}
+
+			unsigned char indices[16];
+			float error = FitIndices(pixels, palette, 16, 0, 4, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+				bestPBits[0] = pBit[0];
+				bestPBits[1] = pBit[1];
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+		}
+
+		// the first index is stored without its high bit, so the
+		// endpoints are swapped when it would need it
+		if (bestIndices[0] & 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+			}
+			std::swap(bestPBits[0], bestPBits[1]);
+			for (int i = 0; i < 16; i++)
+			{
+				bestIndices[i] = (unsigned char)(15 - bestIndices[i]);
+			}
+		}
+
+		BIT_WRITER writer(output, 16);
+		writer.Write(1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write(bestEndpoints[0][c], 7);
+			writer.Write(bestEndpoints[1][c], 7);
+		}
+		writer.Write(bestPBits[0], 1);
+		writer.Write(bestPBits[1], 1);
+		writer.Write(bestIndices[0], 3);
+		for (int i = 1; i < 16; i++)
+		{
+			writer.Write(bestIndices[i], 4);
+		}
+	}
+
+	/***********************************************************
+	 *  Block decoders
+	 *
+	 *  Used for measuring the quality of the encoded image, so
+	 *  the BC7 decoder only handles mode 6, which is the only
+	 *  mode the encoder writes.
+	 ***********************************************************/
+	void DecodeColorBlock(const unsigned char* block, bool bForceFourColor, unsigned char texels[16][4])
+	{
+		uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+		uint32_t indexBits = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+
+		float palette[4][4];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			if ((color0 > color1) || bForceFourColor)
+			{
+				palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f;
+				palette[3][c] = 0.0f;
+			}
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (indexBits >> (2 * i)) & 3;
+			for (int c = 0; c < 3; c++)
+			{
+				texels[i][c] = (unsigned char)(palette[index][c] + 0.5f);
+			}
+			texels[i][3] = 255;
+		}
+	}
+
+	void DecodeAlphaBlock(const unsigned char* block, unsigned char texels[16][4])
+	{
+		int alpha0 = block[0];
+		int alpha1 = block[1];
+		uint64_t indexBits = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			indexBits |= (uint64_t)block[2 + i] << (8 * i);
+		}
+
+		float palette[8];
+		palette[0] = (float)alpha0;
+		palette[1] = (float)alpha1;
+		for (int i = 2; i < 8; i++)
+		{
+			if (alpha0 > alpha1)
+			{
+				palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7.0f;
+			}
+			else
+			{
+				palette[i] = (i < 6) ? ((6 - i) * alpha0 + (i - 1) * alpha1) / 5.0f : ((i == 6) ? 0.0f : 255.0f);
+			}
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			texels[i][3] = (unsigned char)(palette[(indexBits >> (3 * i)) & 7] + 0.5f);
+		}
+	}
+
+	void DecodeBC7Block(const unsigned char* block, unsigned char texels[16][4])
+	{
+		BIT_READER reader(block);
+		if (reader.Read(7) != (1u << 6))
+		{
+			memset(texels, 0, 16 * 4);
+			return;
+		}
+
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = reader.Read(7) << 1;
+			endpoints[1][c] = reader.Read(7) << 1;
+		}
+		int pBit0 = reader.Read(1);
+		int pBit1 = reader.Read(1);
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] |= pBit0;
+			endpoints[1][c] |= pBit1;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int weight = g_BC7Weights[reader.Read((i == 0) ? 3 : 4)];
+			for (int c = 0; c < 4; c++)
+			{
+				texels[i][c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  CompressLevel()
+	 *
+	 *  This function is used for encoding one RGBA image level.
+	 *  Rows of blocks are split evenly over worker threads, and
+	 *  each block is written to its own place in the output.
+	 ***********************************************************/
+	void CompressLevel(const unsigned char* rgba, int width, int height, BLOCK_FORMAT format, unsigned char* output)
+	{
+		const int blocksX = (width + 3) / 4;
+		const int blocksY = (height + 3) / 4;
+		const int blockBytes = GetBlockBytes(format);
+
+		auto encodeRows = [=](int firstRow, int lastRow)
+		{
+			BLOCK_PIXELS pixels;
+			for (int blockY = firstRow; blockY < lastRow; blockY++)
+			{
+				for (int blockX = 0; blockX < blocksX; blockX++)
+				{
+					unsigned char* block = output + ((size_t)blockY * blocksX + blockX) * blockBytes;
+					GatherBlock(rgba, width, height, blockX, blockY, pixels);
+					if (format == BLOCK_FORMAT_BC1)
+					{
+						EncodeColorBlock(pixels, block);
+					}
+					else if (format == BLOCK_FORMAT_BC3)
+					{
+						EncodeAlphaBlock(pixels, block);
+						EncodeColorBlock(pixels, block + 8);
+					}
+					else
+					{
+						EncodeBC7Block(pixels, block);
+					}
+				}
+			}
+		};
+
+		int threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		threadCount = std::min(threadCount, blocksY);
+		if (threadCount <= 1)
+		{
+			encodeRows(0, blocksY);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threadCount; i++)
+		{
+			int firstRow = blocksY * i / threadCount;
+			int lastRow = blocksY * (i + 1) / threadCount;
+			workers.push_back(std::thread(encodeRows, firstRow, lastRow));
+		}
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+
+	/***********************************************************
+	 *  MeasurePSNR()
+	 *
+	 *  This function is used for decoding an encoded level and
+	 *  comparing it with the source over the source channels.
+	 ***********************************************************/
+	double MeasurePSNR(const unsigned char* rgba, int width, int height, int channels, BLOCK_FORMAT format, const unsigned char* blocks)
+	{
+		const int blocksX = (width + 3) / 4;
+		const int blocksY = (height + 3) / 4;
+		const int blockBytes = GetBlockBytes(format);
+		double squaredError = 0.0;
+
+		for (int blockY = 0; blockY < blocksY; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksX; blockX++)
+			{
+				const unsigned char* block = blocks + ((size_t)blockY * blocksX + blockX) * blockBytes;
+				unsigned char texels[16][4];
+				if (format == BLOCK_FORMAT_BC1)
+				{
+					DecodeColorBlock(block, false, texels);
+				}
+				else if (format == BLOCK_FORMAT_BC3)
+				{
+					DecodeColorBlock(block + 8, true, texels);
+					DecodeAlphaBlock(block, texels);
+				}
+				else
+				{
+					DecodeBC7Block(block, texels);
+				}
+
+				for (int y = 0; y < 4; y++)
+				{
+					int sourceY = blockY * 4 + y;
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = blockX * 4 + x;
+						if ((sourceX >= width) || (sourceY >= height))
+						{
+							continue;
+						}
+						const unsigned char* source = rgba + ((size_t)sourceY * width + sourceX) * 4;
+						for (int c = 0; c < channels; c++)
+						{
+							double difference = (double)source[c] - texels[y * 4 + x][c];
+							squaredError += difference * difference;
+						}
+					}
+				}
+			}
+		}
+
+		double meanSquaredError = squaredError / ((double)width * height * channels);
+		if (meanSquaredError <= 0.0)
+		{
+			return(99.0);
+		}
+
+		return(10.0 * log10(255.0 * 255.0 / meanSquaredError));
+	}
+}
+
+/***********************************************************
+ *  GetBlockBytes()
+ *
+ *  This function is used for getting the size of one 4x4
+ *  block of the passed in format.
+ ***********************************************************/
+int GetBlockBytes(BLOCK_FORMAT format)
+{
+	return((format == BLOCK_FORMAT_BC1) ? 8 : 16);
+}
+
+/***********************************************************
+ *  GetBlockInternalFormat()
+ *
+ *  This function is used for getting the GL internal format
+ *  of the passed in block format.
+ ***********************************************************/
+GLenum GetBlockInternalFormat(BLOCK_FORMAT format)
+{
+	switch (format)
+	{
+	case BLOCK_FORMAT_BC1:
+		return(GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+	case BLOCK_FORMAT_BC3:
+		return(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+	default:
+		return(GL_COMPRESSED_RGBA_BPTC_UNORM);
+	}
+}
+
+/***********************************************************
+ *  GetBlockFormatName()
+ *
+ *  This function is used for getting a readable name of the
+ *  passed in block format.
+ ***********************************************************/
+const char* GetBlockFormatName(BLOCK_FORMAT format)
+{
+	switch (format)
+	{
+	case BLOCK_FORMAT_BC1:
+		return("BC1");
+	case BLOCK_FORMAT_BC3:
+		return("BC3");
+	default:
+		return("BC7");
+	}
+}
+
+/***********************************************************
+ *  IsBlockFormatSupported()
+ *
+ *  This function is used for checking whether the driver can
+ *  sample the passed in format.  S3TC is an extension even in
+ *  recent GL versions, BPTC is core since GL 4.2.
+ ***********************************************************/
+bool IsBlockFormatSupported(BLOCK_FORMAT format)
+{
+	if (format == BLOCK_FORMAT_BC7)
+	{
+		return(GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc);
+	}
+
+	return(GLEW_EXT_texture_compression_s3tc);
+}
+
+/***********************************************************
+ *  CompressImage()
+ *
+ *  This function is used for encoding every prepared level
+ *  into the passed in format and measuring the quality of
+ *  the top level.
+ ***********************************************************/
+bool CompressImage(
+	const std::vector<IMAGE_LEVEL>& levels,
+	int channels,
+	BLOCK_FORMAT format,
+	COMPRESSED_IMAGE& image)
+{
+	if ((levels.size() == 0) || ((channels != 3) && (channels != 4)))
+	{
+		return(false);
+	}
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	image.format = format;
+	image.levels.resize(levels.size());
+	image.uncompressedBytes = 0;
+	image.compressedBytes = 0;
+	image.psnr = 0.0;
+
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		const IMAGE_LEVEL& level = levels[i];
+		COMPRESSED_LEVEL& compressed = image.levels[i];
+		compressed.width = level.width;
+		compressed.height = level.height;
+		compressed.data.resize((size_t)((level.width + 3) / 4) * ((level.height + 3) / 4) * GetBlockBytes(format));
+		CompressLevel(level.pixels.data(), level.width, level.height, format, compressed.data.data());
+
+		if (i == 0)
+		{
+			image.psnr = MeasurePSNR(level.pixels.data(), level.width, level.height, channels, format, compressed.data.data());
+		}
+
+		image.uncompressedBytes += (size_t)level.width * level.height * channels;
+		image.compressedBytes += compressed.data.size();
+	}
+
+	std::chrono::duration<double, std::milli> encodeTime = std::chrono::high_resolution_clock::now() - startTime;
+	image.encodeMilliseconds = encodeTime.count();
+
+	return(true);
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.h
+// ============
+// encode texture images into BC1, BC3 or BC7 blocks on the CPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ImageProcessing.h"
+
+#include <cstddef>
+#include <vector>
+
+// block compressed formats the encoder can produce
+enum BLOCK_FORMAT
+{
+	BLOCK_FORMAT_BC1,
+	BLOCK_FORMAT_BC3,
+	BLOCK_FORMAT_BC7
+};
+
+// one encoded mipmap level
+struct COMPRESSED_LEVEL
+{
+	int width;
+	int height;
+	std::vector<unsigned char> data;
+};
+
+/***********************************************************
+ *  COMPRESSED_IMAGE
+ *
+ *  The encoded mipmap chain of an image along with the size
+ *  and quality figures used for reporting.
+ ***********************************************************/
+struct COMPRESSED_IMAGE
+{
+	BLOCK_FORMAT format;
+	std::vector<COMPRESSED_LEVEL> levels;
+	// size of the mipmap chain before and after compression
+	size_t uncompressedBytes;
+	size_t compressedBytes;
+	// peak signal to noise ratio of the top level in dB
+	double psnr;
+	double encodeMilliseconds;
+};
+
+// bytes in one 4x4 block of the passed in format
+int GetBlockBytes(BLOCK_FORMAT format);
+// GL internal format for uploading the passed in format
+GLenum GetBlockInternalFormat(BLOCK_FORMAT format);
+// readable name of the passed in format
+const char* GetBlockFormatName(BLOCK_FORMAT format);
+// true when the current context can sample the passed in format
+bool IsBlockFormatSupported(BLOCK_FORMAT format);
+
+// encode the RGBA8 levels prepared by PrepareImage(), spreading
+// the blocks over the CPU cores - the channel count of the source
+// image selects which channels the quality is measured over
+bool CompressImage(
+	const std::vector<IMAGE_LEVEL>& levels,
+	int channels,
+	BLOCK_FORMAT format,
+	COMPRESSED_IMAGE& image);
@@ -0,0 +1,558 @@
+///////////////////////////////////////////////////////////////////////////////
+// transparencyrenderer.cpp
+// ============
+// render the blended draws of the scene after the opaque pass
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransparencyRenderer.h"
+#include "FrameCapture.h"
+#include "GpuMemoryTracker.h"
+
+#include <chrono>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const char* g_SceneVertexShader = "./Source/shaders/sceneVertexShader.glsl";
+	const char* g_TransparentFragmentShader = "./Source/shaders/transparentFragmentShader.glsl";
+	const char* g_AccumulateFragmentShader = "./Source/shaders/oitAccumulateFragmentShader.glsl";
+	const char* g_FullscreenVertexShader = "./Source/shaders/fullscreenVertexShader.glsl";
+	const char* g_CompositeFragmentShader = "./Source/shaders/oitCompositeFragmentShader.glsl";
+
+	// the scene textures are bound once to the low texture units,
+	// so the OIT targets are sampled from the top two units
+	const int ACCUMULATION_TEXTURE_UNIT = 14;
+	const int REVEALAGE_TEXTURE_UNIT = 15;
+
+	// bytes per pixel of the accumulation, revealage and depth targets
+	const int OIT_BYTES_PER_PIXEL = 8 + 1 + 4;
+
+	/***********************************************************
+	 *  FloatToSortKey()
+	 *
+	 *  This function is used for converting a float into an
+	 *  unsigned key that sorts in the same order as the float.
+	 ***********************************************************/
+	unsigned int FloatToSortKey(float value)
+	{
+		unsigned int bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		// flip all bits of negatives and only the sign of positives
+		return(bits ^ ((bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u));
+	}
+
+	/***********************************************************
+	 *  RadixSort()
+	 *
+	 *  This function is used for sorting the items by their keys
+	 *  with a stable least significant digit radix sort, one byte
+	 *  per pass.  Passes where every key has the same byte are
+	 *  skipped, which is common for depths within a small scene.
+	 ***********************************************************/
+	void RadixSort(
+		std::vector<unsigned int>& keys,
+		std::vector<int>& items,
+		std::vector<unsigned int>& keyScratch,
+		std::vector<int>& itemScratch)
+	{
+		const size_t count = keys.size();
+		keyScratch.resize(count);
+		itemScratch.resize(count);
+
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			size_t histogram[256] = { 0 };
+			for (size_t i = 0; i < count; i++)
+			{
+				histogram[(keys[i] >> shift) & 0xFF]++;
+			}
+			if (histogram[(keys[0] >> shift) & 0xFF] == count)
+			{
+				continue;
+			}
+
+			size_t offset = 0;
+			for (int digit = 0; digit < 256; digit++)
+			{
+				size_t digitCount = histogram[digit];
+				histogram[digit] = offset;
+				offset += digitCount;
+			}
+			for (size_t i = 0; i < count; i++)
+			{
+				size_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+				keyScratch[destination] = keys[i];
+				itemScratch[destination] = items[i];
+			}
+
+			keys.swap(keyScratch);
+			items.swap(itemScratch);
+		}
+	}
+}
+
+/***********************************************************
+ *  TransparencyRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransparencyRenderer::TransparencyRenderer()
+{
+	m_pSortedShader = NULL;
+	m_pAccumulateShader = NULL;
+	m_pCompositeShader = NULL;
+	m_oitFramebuffer = 0;
+	m_accumulationTexture = 0;
+	m_revealageTexture = 0;
+	m_depthRenderbuffer = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_fullscreenVAO = 0;
+	m_timerQueries[0] = 0;
+	m_timerQueries[1] = 0;
+	m_queryModes[0] = TRANSPARENCY_SORTED;
+	m_queryModes[1] = TRANSPARENCY_SORTED;
+	m_bQueryPending[0] = false;
+	m_bQueryPending[1] = false;
+	m_queryIndex = 0;
+	m_stats[TRANSPARENCY_SORTED] = TRANSPARENCY_STATS();
+	m_stats[TRANSPARENCY_WEIGHTED_OIT] = TRANSPARENCY_STATS();
+	m_lastMode = TRANSPARENCY_SORTED;
+}
+
+/***********************************************************
+ *  ~TransparencyRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransparencyRenderer::~TransparencyRenderer()
+{
+	ShaderManager** shaders[3] = { &m_pSortedShader, &m_pAccumulateShader, &m_pCompositeShader };
+
+	DestroyRenderTarget();
+
+	// the programs stay in the resource cache for the next scene
+	for (int i = 0; i < 3; i++)
+	{
+		if (NULL != *shaders[i])
+		{
+			delete *shaders[i];
+			*shaders[i] = NULL;
+		}
+		m_programs[i].Release();
+	}
+	if (0 != m_fullscreenVAO)
+	{
+		glDeleteVertexArrays(1, &m_fullscreenVAO);
+		m_fullscreenVAO = 0;
+	}
+	if (0 != m_timerQueries[0])
+	{
+		glDeleteQueries(2, m_timerQueries);
+		m_timerQueries[0] = 0;
+		m_timerQueries[1] = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the shader programs and
+ *  setting the scene lights into the programs that shade.
+ ***********************************************************/
+bool TransparencyRenderer::Initialize(SceneManager* pSceneManager)
+{
+	ResourceCache* pResourceCache = pSceneManager->GetResourceCache();
+	m_programs[0] = pResourceCache->AcquireProgram(g_SceneVertexShader, NULL, g_TransparentFragmentShader);
+	m_programs[1] = pResourceCache->AcquireProgram(g_SceneVertexShader, NULL, g_AccumulateFragmentShader);
+	m_programs[2] = pResourceCache->AcquireProgram(g_FullscreenVertexShader, NULL, g_CompositeFragmentShader);
+	if (!m_programs[0].IsValid() || !m_programs[1].IsValid() || !m_programs[2].IsValid())
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			m_programs[i].Release();
+		}
+		return(false);
+	}
+
+	m_pSortedShader = new ShaderManager();
+	m_pSortedShader->m_programID = m_programs[0].GetID();
+	m_pAccumulateShader = new ShaderManager();
+	m_pAccumulateShader->m_programID = m_programs[1].GetID();
+	m_pCompositeShader = new ShaderManager();
+	m_pCompositeShader->m_programID = m_programs[2].GetID();
+
+	m_pCompositeShader->use();
+	m_pCompositeShader->setSampler2DValue("accumulationTexture", ACCUMULATION_TEXTURE_UNIT);
+	m_pCompositeShader->setSampler2DValue("revealageTexture", REVEALAGE_TEXTURE_UNIT);
+
+	// uniforms belong to a program, so the lights are set into
+	// both shading programs through the scene manager
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+	ShaderManager* lightingShaders[2] = { m_pSortedShader, m_pAccumulateShader };
+	for (int i = 0; i < 2; i++)
+	{
+		lightingShaders[i]->use();
+		pSceneManager->SetShaderManager(lightingShaders[i]);
+		pSceneManager->SetupSceneLights();
+	}
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	glGenVertexArrays(1, &m_fullscreenVAO);
+	glGenQueries(2, m_timerQueries);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating the accumulation and
+ *  revealage targets for weighted blended OIT, along with a
+ *  depth buffer that receives a copy of the opaque depth.
+ ***********************************************************/
+bool TransparencyRenderer::CreateRenderTarget(int width, int height)
+{
+	if ((0 != m_oitFramebuffer) && (width == m_targetWidth) && (height == m_targetHeight))
+	{
+		return(true);
+	}
+
+	DestroyRenderTarget();
+
+	glGenTextures(1, &m_accumulationTexture);
+	glBindTexture(GL_TEXTURE_2D, m_accumulationTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+
+	glGenTextures(1, &m_revealageTexture);
+	glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// the format matches the default framebuffer so that the
+	// opaque depth can be copied in with a blit
+	glGenRenderbuffers(1, &m_depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_oitFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_oitFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumulationTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "OIT framebuffer is incomplete, status:" << status << std::endl;
+		DestroyRenderTarget();
+		return(false);
+	}
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)width * height * OIT_BYTES_PER_PIXEL);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing the OIT render target.
+ ***********************************************************/
+void TransparencyRenderer::DestroyRenderTarget()
+{
+	if (0 != m_oitFramebuffer)
+	{
+		glDeleteFramebuffers(1, &m_oitFramebuffer);
+		m_oitFramebuffer = 0;
+	}
+	if (0 != m_accumulationTexture)
+	{
+		glDeleteTextures(1, &m_accumulationTexture);
+		m_accumulationTexture = 0;
+	}
+	if (0 != m_revealageTexture)
+	{
+		glDeleteTextures(1, &m_revealageTexture);
+		m_revealageTexture = 0;
+	}
+	if (0 != m_depthRenderbuffer)
+	{
+		glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+		m_depthRenderbuffer = 0;
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)m_targetWidth * m_targetHeight * OIT_BYTES_PER_PIXEL);
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing the transparent items
+ *  with the passed in mode.  Only this pass enables blending,
+ *  and depth writes are off so transparent surfaces do not
+ *  hide each other.
+ ***********************************************************/
+void TransparencyRenderer::Render(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& transparentItems,
+	TRANSPARENCY_MODE mode)
+{
+	if ((NULL == pSceneManager) || (NULL == m_pSortedShader) || (transparentItems.size() == 0))
+	{
+		return;
+	}
+
+	CollectTimings(mode);
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	ShaderManager* pPreviousShader = pSceneManager->GetShaderManager();
+
+	// the query slot is only reused after its result was read
+	bool bTiming = !m_bQueryPending[m_queryIndex];
+	if (bTiming)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_queryIndex]);
+	}
+
+	glEnable(GL_BLEND);
+	glDepthMask(GL_FALSE);
+
+	if (mode == TRANSPARENCY_WEIGHTED_OIT)
+	{
+		RenderWeightedOIT(pSceneManager, drawList, transparentItems);
+	}
+	else
+	{
+		SortBackToFront(drawList, transparentItems, pSceneManager->GetViewMatrix());
+		RenderSorted(pSceneManager, drawList);
+	}
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	if (bTiming)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_queryModes[m_queryIndex] = mode;
+		m_bQueryPending[m_queryIndex] = true;
+		m_queryIndex = 1 - m_queryIndex;
+	}
+
+	pSceneManager->SetShaderManager(pPreviousShader);
+	if (NULL != pPreviousShader)
+	{
+		pPreviousShader->use();
+	}
+
+	std::chrono::duration<double, std::milli> cpuTime = std::chrono::high_resolution_clock::now() - startTime;
+	m_stats[mode].frames++;
+	m_stats[mode].cpuMilliseconds += cpuTime.count();
+}
+
+/***********************************************************
+ *  SortBackToFront()
+ *
+ *  This method is used for ordering the transparent items
+ *  from the farthest to the nearest view depth.  The order
+ *  from the last frame is kept, so when the camera has not
+ *  moved enough to change it the radix sort is skipped.
+ ***********************************************************/
+void TransparencyRenderer::SortBackToFront(
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& transparentItems,
+	const glm::mat4& view)
+{
+	const size_t count = transparentItems.size();
+
+	// start over when the set of transparent items changed
+	if (m_sortedSource != transparentItems)
+	{
+		m_sortedSource = transparentItems;
+		m_sortedItems = transparentItems;
+	}
+
+	// view space z is negative in front of the camera, so the
+	// ascending order of z is the back-to-front order
+	m_sortKeys.resize(count);
+	bool bSorted = true;
+	for (size_t i = 0; i < count; i++)
+	{
+		const SceneManager::DRAW_ITEM& item = drawList[m_sortedItems[i]];
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		SceneManager::GetMeshBounds(item.mesh, boundsMin, boundsMax);
+		glm::vec4 center = item.model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f);
+
+		m_sortKeys[i] = FloatToSortKey((view * center).z);
+		if ((i > 0) && (m_sortKeys[i] < m_sortKeys[i - 1]))
+		{
+			bSorted = false;
+		}
+	}
+
+	if (!bSorted)
+	{
+		RadixSort(m_sortKeys, m_sortedItems, m_keyScratch, m_sortScratch);
+	}
+}
+
+/***********************************************************
+ *  RenderSorted()
+ *
+ *  This method is used for drawing the sorted items with
+ *  conventional over blending.
+ ***********************************************************/
+void TransparencyRenderer::RenderSorted(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList)
+{
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pSortedShader->use();
+	pSceneManager->SetShaderManager(m_pSortedShader);
+	pSceneManager->ApplyViewTransform();
+
+	for (size_t i = 0; i < m_sortedItems.size(); i++)
+	{
+		pSceneManager->SubmitDrawItem(drawList[m_sortedItems[i]]);
+	}
+}
+
+/***********************************************************
+ *  RenderWeightedOIT()
+ *
+ *  This method is used for accumulating the transparent items
+ *  into the OIT targets in any order and then compositing the
+ *  weighted average over the opaque scene.
+ ***********************************************************/
+void TransparencyRenderer::RenderWeightedOIT(
+	SceneManager* pSceneManager,
+	const std::vector<SceneManager::DRAW_ITEM>& drawList,
+	const std::vector<int>& transparentItems)
+{
+	GLint viewport[4];
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	if (!CreateRenderTarget(viewport[2], viewport[3]))
+	{
+		return;
+	}
+
+	// the transparent surfaces are depth tested against the
+	// opaque pass, so copy its depth into the OIT target
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_oitFramebuffer);
+	glBlitFramebuffer(
+		viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3],
+		0, 0, viewport[2], viewport[3],
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_oitFramebuffer);
+	glViewport(0, 0, viewport[2], viewport[3]);
+
+	const GLfloat clearAccumulation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearRevealage[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+	glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+	// sum the weighted colors and multiply the revealage
+	glBlendFunci(0, GL_ONE, GL_ONE);
+	glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+
+	m_pAccumulateShader->use();
+	pSceneManager->SetShaderManager(m_pAccumulateShader);
+	pSceneManager->ApplyViewTransform();
+	for (size_t i = 0; i < transparentItems.size(); i++)
+	{
+		pSceneManager->SubmitDrawItem(drawList[transparentItems[i]]);
+	}
+
+	// composite the average color over the opaque scene
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthFunc(GL_ALWAYS);
+
+	glActiveTexture(GL_TEXTURE0 + ACCUMULATION_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_accumulationTexture);
+	glActiveTexture(GL_TEXTURE0 + REVEALAGE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	m_pCompositeShader->use();
+	m_pCompositeShader->setVec2Value("viewportOrigin", (float)viewport[0], (float)viewport[1]);
+	GLint previousVertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glBindVertexArray(m_fullscreenVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(previousVertexArray);
+
+	glDepthFunc(GL_LESS);
+}
+
+/***********************************************************
+ *  CollectTimings()
+ *
+ *  This method is used for reading the GPU timings that have
+ *  finished without waiting on the GPU, and for printing the
+ *  cost of both modes whenever the mode is switched.
+ ***********************************************************/
+void TransparencyRenderer::CollectTimings(TRANSPARENCY_MODE mode)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (!m_bQueryPending[i])
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &nanoseconds);
+			m_stats[m_queryModes[i]].lastGpuMilliseconds = nanoseconds / 1000000.0;
+			m_stats[m_queryModes[i]].gpuMilliseconds += nanoseconds / 1000000.0;
+			m_stats[m_queryModes[i]].gpuFrames++;
+			m_bQueryPending[i] = false;
+		}
+	}
+
+	if (mode != m_lastMode)
+	{
+		const char* names[2] = { "sorted", "weighted OIT" };
+		std::cout << "INFO: Transparency cost per frame:";
+		for (int i = 0; i < 2; i++)
+		{
+			const TRANSPARENCY_STATS& stats = m_stats[i];
+			if (stats.frames > 0)
+			{
+				std::cout << " " << names[i]
+					<< " cpu " << stats.cpuMilliseconds / stats.frames << " ms"
+					<< " gpu " << ((stats.gpuFrames > 0) ? stats.gpuMilliseconds / stats.gpuFrames : 0.0) << " ms"
+					<< " (" << stats.frames << " frames)";
+			}
+		}
+		std::cout << std::endl;
+		m_lastMode = mode;
+	}
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// transparencyrenderer.h
+// ============
+// render the blended draws of the scene after the opaque pass
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "RenderOptions.h"
+
+#include <vector>
+
+/***********************************************************
+ *  TransparencyRenderer
+ *
+ *  This class draws the transparent items of the recorded
+ *  scene over the opaque pass, either sorted back-to-front
+ *  by view depth or with weighted blended order independent
+ *  transparency.  The cost of each mode is measured so the
+ *  two can be compared at runtime.
+ ***********************************************************/
+class TransparencyRenderer
+{
+public:
+	// constructor
+	TransparencyRenderer();
+	// destructor
+	~TransparencyRenderer();
+
+	// running cost of one transparency mode
+	struct TRANSPARENCY_STATS
+	{
+		int frames;
+		int gpuFrames;
+		double cpuMilliseconds;
+		double gpuMilliseconds;
+		// GPU cost of the most recently finished frame
+		double lastGpuMilliseconds;
+	};
+
+	// load the shader programs for both transparency modes
+	bool Initialize(SceneManager* pSceneManager);
+
+	// draw the transparent items of the draw list with the
+	// passed in mode, over the current framebuffer contents
+	void Render(
+		SceneManager* pSceneManager,
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& transparentItems,
+		TRANSPARENCY_MODE mode);
+
+	// accumulated cost of a transparency mode
+	const TRANSPARENCY_STATS& GetStats(TRANSPARENCY_MODE mode) const { return m_stats[mode]; }
+
+private:
+	// shader managers for the sorted, accumulate and composite programs
+	ShaderManager* m_pSortedShader;
+	ShaderManager* m_pAccumulateShader;
+	ShaderManager* m_pCompositeShader;
+	// references to the programs in the resource cache
+	ResourceHandle m_programs[3];
+	// weighted blended OIT render target
+	GLuint m_oitFramebuffer;
+	GLuint m_accumulationTexture;
+	GLuint m_revealageTexture;
+	GLuint m_depthRenderbuffer;
+	int m_targetWidth;
+	int m_targetHeight;
+	// empty vertex array for the full screen triangle
+	GLuint m_fullscreenVAO;
+	// GPU timers, alternated so results are read a frame late
+	GLuint m_timerQueries[2];
+	TRANSPARENCY_MODE m_queryModes[2];
+	bool m_bQueryPending[2];
+	int m_queryIndex;
+	// sorting buffers, kept between frames so that the order
+	// from the previous frame is the starting point
+	std::vector<int> m_sortedSource;
+	std::vector<unsigned int> m_sortKeys;
+	std::vector<int> m_sortedItems;
+	std::vector<int> m_sortScratch;
+	std::vector<unsigned int> m_keyScratch;
+	// measured cost of each mode
+	TRANSPARENCY_STATS m_stats[2];
+	TRANSPARENCY_MODE m_lastMode;
+
+	// sort the transparent items back-to-front by view depth
+	void SortBackToFront(
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& transparentItems,
+		const glm::mat4& view);
+	// draw the sorted items with conventional alpha blending
+	void RenderSorted(SceneManager* pSceneManager, const std::vector<SceneManager::DRAW_ITEM>& drawList);
+	// accumulate and composite the items in submission order
+	void RenderWeightedOIT(
+		SceneManager* pSceneManager,
+		const std::vector<SceneManager::DRAW_ITEM>& drawList,
+		const std::vector<int>& transparentItems);
+	// create or resize the OIT render target
+	bool CreateRenderTarget(int width, int height);
+	void DestroyRenderTarget();
+	// collect finished GPU timings and report the mode comparison
+	void CollectTimings(TRANSPARENCY_MODE mode);
+};
@@ -113,8 +113,9 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	//is not interrupted by the cursor exiting the screen
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
+	// blending is only enabled by the scene manager for the
+	// transparent pass, so opaque draws skip the blend stage
+	glDisable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
@@ -224,6 +225,91 @@ void ViewManager::ProcessKeyboardEvents()
 		//define the orthographic projection matrix
 		projection = glm::ortho(-(GLfloat)WINDOW_WIDTH / 2 * aspect, (GLfloat)WINDOW_WIDTH / 2 * aspect, -(GLfloat)WINDOW_HEIGHT / 2 * aspect, (GLfloat)WINDOW_HEIGHT / 2 * aspect, 0.1f, 100.0f);
 	}
+
+	//switch between sorted and order independent transparency
+	if (IsKeyToggled(GLFW_KEY_T)) {
+		if (m_renderOptions.transparencyMode == TRANSPARENCY_SORTED) {
+			m_renderOptions.transparencyMode = TRANSPARENCY_WEIGHTED_OIT;
+			std::cout << "INFO: Transparency mode: weighted blended OIT" << std::endl;
+		}
+		else {
+			m_renderOptions.transparencyMode = TRANSPARENCY_SORTED;
+			std::cout << "INFO: Transparency mode: sorted back-to-front" << std::endl;
+		}
+	}
+
+	//toggle the depth pre-pass for the opaque geometry
+	if (IsKeyToggled(GLFW_KEY_Z)) {
+		m_renderOptions.bDepthPrepass = !m_renderOptions.bDepthPrepass;
+		std::cout << "INFO: Depth pre-pass " << (m_renderOptions.bDepthPrepass ? "on" : "off") << std::endl;
+	}
+
+	//switch the opaque pass between forward and deferred shading
+	if (IsKeyToggled(GLFW_KEY_G)) {
+		if (m_renderOptions.shadingPath == SHADING_FORWARD) {
+			m_renderOptions.shadingPath = SHADING_DEFERRED;
+			std::cout << "INFO: Shading path: deferred" << std::endl;
+		}
+		else {
+			m_renderOptions.shadingPath = SHADING_FORWARD;
+			std::cout << "INFO: Shading path: forward" << std::endl;
+		}
+	}
+
+	//show or hide the performance overlay
+	if (IsKeyToggled(GLFW_KEY_H)) {
+		m_renderOptions.bShowHUD = !m_renderOptions.bShowHUD;
+		std::cout << "INFO: Performance HUD " << (m_renderOptions.bShowHUD ? "on" : "off") << std::endl;
+	}
+
+	//draw the distant props as impostors or with their full geometry
+	if (IsKeyToggled(GLFW_KEY_I)) {
+		m_renderOptions.bImpostors = !m_renderOptions.bImpostors;
+		std::cout << "INFO: Impostors " << (m_renderOptions.bImpostors ? "on" : "off") << std::endl;
+	}
+
+	//cull the opaque draws of the deferred path on the GPU or the CPU
+	if (IsKeyToggled(GLFW_KEY_C)) {
+		m_renderOptions.bGpuCulling = !m_renderOptions.bGpuCulling;
+		std::cout << "INFO: GPU culling " << (m_renderOptions.bGpuCulling ? "on" : "off") << std::endl;
+	}
+
+	//test the GPU culled draws against the depth of the last frame
+	if (IsKeyToggled(GLFW_KEY_X)) {
+		m_renderOptions.bOcclusionCulling = !m_renderOptions.bOcclusionCulling;
+		std::cout << "INFO: Occlusion culling " << (m_renderOptions.bOcclusionCulling ? "on" : "off") << std::endl;
+	}
+
+	//render the scene from many views at once for measuring
+	//the multi-view throughput
+	if (IsKeyToggled(GLFW_KEY_V)) {
+		m_renderOptions.bMultiView = !m_renderOptions.bMultiView;
+		std::cout << "INFO: Multi-view pass " << (m_renderOptions.bMultiView ? "on" : "off") << std::endl;
+	}
+
+	//capture the GL calls of the next frame for offline replay,
+	//the request only lasts for a single frame
+	m_renderOptions.bCaptureFrame = IsKeyToggled(GLFW_KEY_F9);
+
+	//switch to the next scene once it has loaded in the background,
+	//the request only lasts for a single frame as well
+	m_renderOptions.bNextScene = IsKeyToggled(GLFW_KEY_N);
+}
+
+/***********************************************************
+ *  IsKeyToggled()
+ *
+ *  This method is used for detecting a single key press, so
+ *  that holding a toggle key down only switches it once.
+ ***********************************************************/
+bool ViewManager::IsKeyToggled(int key)
+{
+	bool bPressed = (glfwGetKey(m_pWindow, key) == GLFW_PRESS);
+	bool bWasPressed = m_keyPressed[key];
+
+	m_keyPressed[key] = bPressed;
+
+	return(bPressed && !bWasPressed);
 }
 
 /***********************************************************
@@ -265,6 +351,22 @@ void ViewManager::PrepareSceneView()
 	}
 }
 
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method is used for getting the position of the
+ *  camera in world space.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	if (NULL == g_pCamera)
+	{
+		return(glm::vec3(0.0f, 0.0f, 0.0f));
+	}
+
+	return(g_pCamera->Position);
+}
+
 void ViewManager::ScrollWheelCallback(GLFWwindow* window, double xOffset, double yOffset) {
 	g_pCamera->ProcessMouseScroll(-yOffset);
 }
\ No newline at end of file
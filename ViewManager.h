@@ -10,8 +10,11 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "RenderOptions.h"
 #include "camera.h"
 
+#include <map>
+
 // GLFW library
 #include "GLFW/glfw3.h" 
 
@@ -38,6 +41,13 @@ private:
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// true only on the frame the key goes from released to pressed
+	bool IsKeyToggled(int key);
+
+	// last known pressed state of the toggle keys
+	std::map<int, bool> m_keyPressed;
+	// rendering options changed from the keyboard
+	RENDER_OPTIONS m_renderOptions;
 
 	//matrices for projection and orthographic views
 	glm::mat4 projection;
@@ -49,4 +59,12 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// get the matrices and camera position of the current frame
+	glm::mat4 GetViewMatrix() const { return view; }
+	glm::mat4 GetProjectionMatrix() const { return projection; }
+	glm::vec3 GetCameraPosition() const;
+
+	// get the rendering options set from the keyboard
+	const RENDER_OPTIONS& GetRenderOptions() const { return m_renderOptions; }
 };
\ No newline at end of file
@@ -0,0 +1,1710 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.cpp
+// ============
+// Vulkan implementation of the render hardware interface, compiled
+// when RHI_VULKAN is defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VulkanRenderDevice.h"
+
+#ifdef RHI_VULKAN
+
+#include "GpuMemoryTracker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// size of the memory blocks resources are placed in
+	const VkDeviceSize MEMORY_BLOCK_BYTES = 64 * 1024 * 1024;
+	// size of each uniform buffer and the descriptor sets of one
+	// recording
+	const VkDeviceSize UNIFORM_BUFFER_BYTES = 4 * 1024 * 1024;
+	const uint32_t MAX_DESCRIPTOR_SETS = 4096;
+	// formats of the render target attachments
+	const VkFormat COLOR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+	const VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+
+	// round an offset up to a power of two alignment
+	VkDeviceSize AlignUp(VkDeviceSize offset, VkDeviceSize alignment)
+	{
+		return((offset + alignment - 1) & ~(alignment - 1));
+	}
+
+	// the Vulkan format of a vertex attribute
+	VkFormat VertexFormat(VERTEX_FORMAT format)
+	{
+		switch (format)
+		{
+		case VERTEX_FORMAT_FLOAT2:
+			return(VK_FORMAT_R32G32_SFLOAT);
+		case VERTEX_FORMAT_FLOAT3:
+			return(VK_FORMAT_R32G32B32_SFLOAT);
+		case VERTEX_FORMAT_FLOAT4:
+			return(VK_FORMAT_R32G32B32A32_SFLOAT);
+		case VERTEX_FORMAT_UNORM8X4:
+			return(VK_FORMAT_R8G8B8A8_UNORM);
+		}
+		return(VK_FORMAT_UNDEFINED);
+	}
+}
+
+/***********************************************************
+ *  VulkanCommandBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VulkanCommandBuffer::VulkanCommandBuffer(VulkanRenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+	m_commandPool = VK_NULL_HANDLE;
+	m_commandBuffer = VK_NULL_HANDLE;
+	m_fence = VK_NULL_HANDLE;
+	m_bSubmitted = false;
+	m_descriptorPool = VK_NULL_HANDLE;
+	m_descriptorSet = VK_NULL_HANDLE;
+	m_uniformBlock = 0;
+	m_uniformUsed = 0;
+	m_uniformOffset = 0;
+	m_texture = 0;
+	m_bDescriptorsDirty = true;
+	m_bOffsetDirty = true;
+	m_bOutOfSpace = false;
+}
+
+/***********************************************************
+ *  ~VulkanCommandBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VulkanCommandBuffer::~VulkanCommandBuffer()
+{
+	VkDevice device = m_pDevice->m_device;
+	WaitForSubmit();
+
+	for (size_t i = 0; i < m_uniformBlocks.size(); ++i)
+	{
+		vkDestroyBuffer(device, m_uniformBlocks[i].buffer, NULL);
+		vkFreeMemory(device, m_uniformBlocks[i].memory, NULL);
+		TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)UNIFORM_BUFFER_BYTES);
+	}
+	if (VK_NULL_HANDLE != m_descriptorPool)
+	{
+		vkDestroyDescriptorPool(device, m_descriptorPool, NULL);
+	}
+	if (VK_NULL_HANDLE != m_fence)
+	{
+		vkDestroyFence(device, m_fence, NULL);
+	}
+	if (VK_NULL_HANDLE != m_commandPool)
+	{
+		vkDestroyCommandPool(device, m_commandPool, NULL);
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the pools, the fence and
+ *  the first uniform buffer owned by the command buffer.
+ ***********************************************************/
+bool VulkanCommandBuffer::Initialize()
+{
+	VkDevice device = m_pDevice->m_device;
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_pDevice->m_queueFamily;
+	if (VK_SUCCESS != vkCreateCommandPool(device, &poolInfo, NULL, &m_commandPool))
+	{
+		return(false);
+	}
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = m_commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	if (VK_SUCCESS != vkAllocateCommandBuffers(device, &allocateInfo, &m_commandBuffer))
+	{
+		return(false);
+	}
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	if (VK_SUCCESS != vkCreateFence(device, &fenceInfo, NULL, &m_fence))
+	{
+		return(false);
+	}
+
+	VkDescriptorPoolSize poolSizes[2] = {};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSizes[0].descriptorCount = MAX_DESCRIPTOR_SETS;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = MAX_DESCRIPTOR_SETS;
+
+	VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
+	descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolInfo.maxSets = MAX_DESCRIPTOR_SETS;
+	descriptorPoolInfo.poolSizeCount = 2;
+	descriptorPoolInfo.pPoolSizes = poolSizes;
+	if (VK_SUCCESS != vkCreateDescriptorPool(device, &descriptorPoolInfo, NULL, &m_descriptorPool))
+	{
+		return(false);
+	}
+
+	m_uniformBlock = 0;
+	m_uniformUsed = 0;
+	return(NextUniformBlock());
+}
+
+/***********************************************************
+ *  NextUniformBlock()
+ *
+ *  This method is used for continuing the uniforms at the
+ *  start of the next uniform buffer, which is created the
+ *  first time a recording fills the ones before it.
+ ***********************************************************/
+bool VulkanCommandBuffer::NextUniformBlock()
+{
+	size_t next = m_uniformBlocks.empty() ? 0 : m_uniformBlock + 1;
+	if (next == m_uniformBlocks.size())
+	{
+		UNIFORM_BLOCK block = {};
+		if (!m_pDevice->CreateHostBuffer(UNIFORM_BUFFER_BYTES, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			block.buffer, block.memory, block.pMapped))
+		{
+			return(false);
+		}
+		TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)UNIFORM_BUFFER_BYTES);
+		m_uniformBlocks.push_back(block);
+	}
+
+	m_uniformBlock = next;
+	m_uniformUsed = 0;
+	// the descriptor set points at one buffer
+	m_bDescriptorsDirty = true;
+	return(true);
+}
+
+/***********************************************************
+ *  WaitForSubmit()
+ *
+ *  This method is used for waiting for the last submit of
+ *  the command buffer before its memory is reused.
+ ***********************************************************/
+void VulkanCommandBuffer::WaitForSubmit()
+{
+	if (m_bSubmitted)
+	{
+		vkWaitForFences(m_pDevice->m_device, 1, &m_fence, VK_TRUE, UINT64_MAX);
+		vkResetFences(m_pDevice->m_device, 1, &m_fence);
+		m_bSubmitted = false;
+	}
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for resetting the pools and the
+ *  uniform storage and starting the recording.
+ ***********************************************************/
+void VulkanCommandBuffer::Begin()
+{
+	WaitForSubmit();
+
+	vkResetCommandPool(m_pDevice->m_device, m_commandPool, 0);
+	vkResetDescriptorPool(m_pDevice->m_device, m_descriptorPool, 0);
+	m_descriptorSet = VK_NULL_HANDLE;
+	m_uniformBlock = 0;
+	m_uniformUsed = 0;
+	m_uniformOffset = 0;
+	m_texture = m_pDevice->m_defaultTexture;
+	m_bDescriptorsDirty = true;
+	m_bOffsetDirty = true;
+	m_bOutOfSpace = false;
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method is used for finishing the recording.
+ ***********************************************************/
+void VulkanCommandBuffer::End()
+{
+	vkEndCommandBuffer(m_commandBuffer);
+}
+
+/***********************************************************
+ *  BeginRenderPass()
+ *
+ *  This method is used for starting the pass on a target.
+ *  The viewport has a negative height so clip space Y points
+ *  up like in OpenGL.
+ ***********************************************************/
+void VulkanCommandBuffer::BeginRenderPass(RENDER_TARGET_HANDLE target, const glm::vec4& clearColor)
+{
+	const VulkanRenderDevice::VK_RENDER_TARGET& renderTarget = m_pDevice->m_renderTargets[target - 1];
+
+	VkClearValue clearValues[2] = {};
+	clearValues[0].color.float32[0] = clearColor.x;
+	clearValues[0].color.float32[1] = clearColor.y;
+	clearValues[0].color.float32[2] = clearColor.z;
+	clearValues[0].color.float32[3] = clearColor.w;
+	clearValues[1].depthStencil.depth = 1.0f;
+	clearValues[1].depthStencil.stencil = 0;
+
+	VkRenderPassBeginInfo passInfo = {};
+	passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	passInfo.renderPass = m_pDevice->m_renderPass;
+	passInfo.framebuffer = renderTarget.framebuffer;
+	passInfo.renderArea.extent.width = (uint32_t)renderTarget.width;
+	passInfo.renderArea.extent.height = (uint32_t)renderTarget.height;
+	passInfo.clearValueCount = 2;
+	passInfo.pClearValues = clearValues;
+	vkCmdBeginRenderPass(m_commandBuffer, &passInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	VkViewport viewport = {};
+	viewport.x = 0.0f;
+	viewport.y = (float)renderTarget.height;
+	viewport.width = (float)renderTarget.width;
+	viewport.height = -(float)renderTarget.height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(m_commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor = {};
+	scissor.extent = passInfo.renderArea.extent;
+	vkCmdSetScissor(m_commandBuffer, 0, 1, &scissor);
+}
+
+/***********************************************************
+ *  EndRenderPass()
+ *
+ *  This method is used for ending the pass.
+ ***********************************************************/
+void VulkanCommandBuffer::EndRenderPass()
+{
+	vkCmdEndRenderPass(m_commandBuffer);
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for binding a pipeline.  Every
+ *  pipeline has the same layout, so the bound descriptor set
+ *  stays valid across pipeline changes.
+ ***********************************************************/
+void VulkanCommandBuffer::BindPipeline(PIPELINE_HANDLE pipeline)
+{
+	vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pDevice->m_pipelines[pipeline - 1]);
+}
+
+/***********************************************************
+ *  BindVertexBuffer()
+ *
+ *  This method is used for binding a vertex buffer.
+ ***********************************************************/
+void VulkanCommandBuffer::BindVertexBuffer(unsigned int binding, BUFFER_HANDLE buffer, size_t offset)
+{
+	VkBuffer vertexBuffer = m_pDevice->m_buffers[buffer - 1].buffer;
+	VkDeviceSize vertexOffset = (VkDeviceSize)offset;
+	vkCmdBindVertexBuffers(m_commandBuffer, binding, 1, &vertexBuffer, &vertexOffset);
+}
+
+/***********************************************************
+ *  BindIndexBuffer()
+ *
+ *  This method is used for binding the 32 bit index buffer.
+ ***********************************************************/
+void VulkanCommandBuffer::BindIndexBuffer(BUFFER_HANDLE buffer, size_t offset)
+{
+	vkCmdBindIndexBuffer(m_commandBuffer, m_pDevice->m_buffers[buffer - 1].buffer,
+		(VkDeviceSize)offset, VK_INDEX_TYPE_UINT32);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for changing the texture, which takes
+ *  a new descriptor set at the next draw.
+ ***********************************************************/
+void VulkanCommandBuffer::BindTexture(TEXTURE_HANDLE texture)
+{
+	if (texture != m_texture)
+	{
+		m_texture = texture;
+		m_bDescriptorsDirty = true;
+	}
+}
+
+/***********************************************************
+ *  SetUniforms()
+ *
+ *  This method is used for writing the uniforms into the
+ *  mapped uniform buffer at the next aligned offset, moving
+ *  on to the next buffer when the current one is full.
+ ***********************************************************/
+void VulkanCommandBuffer::SetUniforms(const void* data, size_t size)
+{
+	if (size > RHI_MAX_UNIFORM_BYTES)
+	{
+		std::cout << "Uniform data of " << size << " bytes is over the limit of "
+			<< RHI_MAX_UNIFORM_BYTES << std::endl;
+		size = RHI_MAX_UNIFORM_BYTES;
+	}
+
+	// the descriptor always covers the largest block
+	VkDeviceSize offset = AlignUp(m_uniformUsed, m_pDevice->m_uniformAlignment);
+	if (offset + RHI_MAX_UNIFORM_BYTES > UNIFORM_BUFFER_BYTES)
+	{
+		if (!NextUniformBlock())
+		{
+			if (!m_bOutOfSpace)
+			{
+				std::cout << "Command buffer is out of uniform space, draws are skipped" << std::endl;
+			}
+			m_bOutOfSpace = true;
+			return;
+		}
+		offset = 0;
+	}
+
+	memcpy(m_uniformBlocks[m_uniformBlock].pMapped + offset, data, size);
+	m_uniformOffset = (uint32_t)offset;
+	m_uniformUsed = offset + size;
+	m_bOffsetDirty = true;
+}
+
+/***********************************************************
+ *  PrepareDraw()
+ *
+ *  This method is used for allocating a descriptor set when
+ *  the texture changed and binding it with the offset of the
+ *  current uniforms.
+ ***********************************************************/
+bool VulkanCommandBuffer::PrepareDraw()
+{
+	if (m_bOutOfSpace)
+	{
+		return(false);
+	}
+
+	if (m_bDescriptorsDirty)
+	{
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.descriptorPool = m_descriptorPool;
+		allocateInfo.descriptorSetCount = 1;
+		allocateInfo.pSetLayouts = &m_pDevice->m_descriptorSetLayout;
+		if (VK_SUCCESS != vkAllocateDescriptorSets(m_pDevice->m_device, &allocateInfo, &m_descriptorSet))
+		{
+			std::cout << "Command buffer is out of descriptor sets" << std::endl;
+			m_bOutOfSpace = true;
+			return(false);
+		}
+
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = m_uniformBlocks[m_uniformBlock].buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = RHI_MAX_UNIFORM_BYTES;
+
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.sampler = m_pDevice->m_sampler;
+		imageInfo.imageView = m_pDevice->m_textures[m_texture - 1].view;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet writes[2] = {};
+		writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[0].dstSet = m_descriptorSet;
+		writes[0].dstBinding = RHI_UNIFORM_BINDING;
+		writes[0].descriptorCount = 1;
+		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		writes[0].pBufferInfo = &bufferInfo;
+		writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[1].dstSet = m_descriptorSet;
+		writes[1].dstBinding = RHI_TEXTURE_BINDING;
+		writes[1].descriptorCount = 1;
+		writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[1].pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(m_pDevice->m_device, 2, writes, 0, NULL);
+
+		m_bDescriptorsDirty = false;
+		m_bOffsetDirty = true;
+	}
+
+	if (m_bOffsetDirty)
+	{
+		vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pDevice->m_pipelineLayout, 0, 1, &m_descriptorSet, 1, &m_uniformOffset);
+		m_bOffsetDirty = false;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for recording a non-indexed draw.
+ ***********************************************************/
+void VulkanCommandBuffer::Draw(
+	unsigned int vertexCount,
+	unsigned int instanceCount,
+	unsigned int firstVertex,
+	unsigned int firstInstance)
+{
+	if (PrepareDraw())
+	{
+		vkCmdDraw(m_commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+	}
+}
+
+/***********************************************************
+ *  DrawIndexed()
+ *
+ *  This method is used for recording an indexed draw.
+ ***********************************************************/
+void VulkanCommandBuffer::DrawIndexed(
+	unsigned int indexCount,
+	unsigned int instanceCount,
+	unsigned int firstIndex,
+	int vertexOffset,
+	unsigned int firstInstance)
+{
+	if (PrepareDraw())
+	{
+		vkCmdDrawIndexed(m_commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	}
+}
+
+/***********************************************************
+ *  VulkanRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VulkanRenderDevice::VulkanRenderDevice(bool bPreferCPU)
+{
+	m_bPreferCPU = bPreferCPU;
+	m_instance = VK_NULL_HANDLE;
+	m_physicalDevice = VK_NULL_HANDLE;
+	m_device = VK_NULL_HANDLE;
+	m_queue = VK_NULL_HANDLE;
+	m_queueFamily = 0;
+	memset(&m_memoryProperties, 0, sizeof(m_memoryProperties));
+	m_uniformAlignment = 256;
+	m_bufferImageGranularity = 1;
+	m_uploadPool = VK_NULL_HANDLE;
+	m_renderPass = VK_NULL_HANDLE;
+	m_descriptorSetLayout = VK_NULL_HANDLE;
+	m_pipelineLayout = VK_NULL_HANDLE;
+	m_sampler = VK_NULL_HANDLE;
+	m_defaultTexture = 0;
+}
+
+/***********************************************************
+ *  ~VulkanRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VulkanRenderDevice::~VulkanRenderDevice()
+{
+	if (VK_NULL_HANDLE != m_device)
+	{
+		vkDeviceWaitIdle(m_device);
+
+		for (size_t i = 0; i < m_pipelines.size(); ++i)
+		{
+			DestroyPipeline((PIPELINE_HANDLE)(i + 1));
+		}
+		for (size_t i = 0; i < m_renderTargets.size(); ++i)
+		{
+			DestroyRenderTarget((RENDER_TARGET_HANDLE)(i + 1));
+		}
+		for (size_t i = 0; i < m_textures.size(); ++i)
+		{
+			DestroyTexture((TEXTURE_HANDLE)(i + 1));
+		}
+		for (size_t i = 0; i < m_buffers.size(); ++i)
+		{
+			DestroyBuffer((BUFFER_HANDLE)(i + 1));
+		}
+
+		if (VK_NULL_HANDLE != m_sampler)
+		{
+			vkDestroySampler(m_device, m_sampler, NULL);
+		}
+		if (VK_NULL_HANDLE != m_pipelineLayout)
+		{
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, NULL);
+		}
+		if (VK_NULL_HANDLE != m_descriptorSetLayout)
+		{
+			vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, NULL);
+		}
+		if (VK_NULL_HANDLE != m_renderPass)
+		{
+			vkDestroyRenderPass(m_device, m_renderPass, NULL);
+		}
+		if (VK_NULL_HANDLE != m_uploadPool)
+		{
+			vkDestroyCommandPool(m_device, m_uploadPool, NULL);
+		}
+		for (size_t i = 0; i < m_memoryBlocks.size(); ++i)
+		{
+			vkFreeMemory(m_device, m_memoryBlocks[i].memory, NULL);
+		}
+		m_memoryBlocks.clear();
+
+		vkDestroyDevice(m_device, NULL);
+		m_device = VK_NULL_HANDLE;
+	}
+	if (VK_NULL_HANDLE != m_instance)
+	{
+		vkDestroyInstance(m_instance, NULL);
+		m_instance = VK_NULL_HANDLE;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the instance and the
+ *  device with one graphics queue, then the objects shared
+ *  by every pipeline.  No window system extension is used,
+ *  so this works headless.
+ ***********************************************************/
+bool VulkanRenderDevice::Initialize()
+{
+	VkApplicationInfo applicationInfo = {};
+	applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	applicationInfo.pApplicationName = "CS330 Scene";
+	applicationInfo.applicationVersion = 1;
+	applicationInfo.pEngineName = "CS330 RHI";
+	applicationInfo.engineVersion = 1;
+	// 1.1 for the flipped viewport
+	applicationInfo.apiVersion = VK_API_VERSION_1_1;
+
+	VkInstanceCreateInfo instanceInfo = {};
+	instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pApplicationInfo = &applicationInfo;
+	if (VK_SUCCESS != vkCreateInstance(&instanceInfo, NULL, &m_instance))
+	{
+		std::cout << "Failed to create the Vulkan instance" << std::endl;
+		m_instance = VK_NULL_HANDLE;
+		return(false);
+	}
+
+	if (!SelectPhysicalDevice())
+	{
+		std::cout << "No Vulkan 1.1 device with a graphics queue was found" << std::endl;
+		return(false);
+	}
+
+	float queuePriority = 1.0f;
+	VkDeviceQueueCreateInfo queueInfo = {};
+	queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueInfo.queueFamilyIndex = m_queueFamily;
+	queueInfo.queueCount = 1;
+	queueInfo.pQueuePriorities = &queuePriority;
+
+	VkDeviceCreateInfo deviceInfo = {};
+	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.queueCreateInfoCount = 1;
+	deviceInfo.pQueueCreateInfos = &queueInfo;
+	if (VK_SUCCESS != vkCreateDevice(m_physicalDevice, &deviceInfo, NULL, &m_device))
+	{
+		std::cout << "Failed to create the Vulkan device" << std::endl;
+		m_device = VK_NULL_HANDLE;
+		return(false);
+	}
+	vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_queueFamily;
+	if (VK_SUCCESS != vkCreateCommandPool(m_device, &poolInfo, NULL, &m_uploadPool))
+	{
+		return(false);
+	}
+
+	if (!CreateRenderPass() || !CreateLayouts())
+	{
+		return(false);
+	}
+
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.maxLod = 0.0f;
+	if (VK_SUCCESS != vkCreateSampler(m_device, &samplerInfo, NULL, &m_sampler))
+	{
+		return(false);
+	}
+
+	const unsigned char white[4] = { 255, 255, 255, 255 };
+	m_defaultTexture = CreateTexture(1, 1, TEXTURE_FORMAT_RGBA8, white);
+	return(0 != m_defaultTexture);
+}
+
+/***********************************************************
+ *  SelectPhysicalDevice()
+ *
+ *  This method is used for picking the device to run on.  A
+ *  discrete GPU is preferred, unless a CPU device was asked
+ *  for, and the device needs Vulkan 1.1 and a graphics queue.
+ ***********************************************************/
+bool VulkanRenderDevice::SelectPhysicalDevice()
+{
+	uint32_t deviceCount = 0;
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, NULL);
+	std::vector<VkPhysicalDevice> devices(deviceCount);
+	if (deviceCount > 0)
+	{
+		vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+	}
+
+	int bestScore = -1;
+	for (uint32_t i = 0; i < deviceCount; ++i)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(devices[i], &properties);
+		if (properties.apiVersion < VK_API_VERSION_1_1)
+		{
+			continue;
+		}
+
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, NULL);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, families.data());
+
+		int family = -1;
+		for (uint32_t j = 0; j < familyCount; ++j)
+		{
+			if (0 != (families[j].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				family = (int)j;
+				break;
+			}
+		}
+		if (family < 0)
+		{
+			continue;
+		}
+
+		int score = 1;
+		switch (properties.deviceType)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			score = 4;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			score = 3;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			score = 2;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:
+			score = m_bPreferCPU ? 5 : 1;
+			break;
+		default:
+			break;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			m_physicalDevice = devices[i];
+			m_queueFamily = (uint32_t)family;
+			m_deviceName = properties.deviceName;
+			m_uniformAlignment = std::max(properties.limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+			m_bufferImageGranularity = std::max(properties.limits.bufferImageGranularity, (VkDeviceSize)1);
+		}
+	}
+
+	if (VK_NULL_HANDLE == m_physicalDevice)
+	{
+		return(false);
+	}
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+	return(true);
+}
+
+/***********************************************************
+ *  CreateRenderPass()
+ *
+ *  This method is used for creating the pass every target
+ *  and pipeline uses.  Both attachments are cleared, and the
+ *  color ends ready to be copied out by ReadRenderTarget().
+ ***********************************************************/
+bool VulkanRenderDevice::CreateRenderPass()
+{
+	VkAttachmentDescription attachments[2] = {};
+	attachments[0].format = COLOR_FORMAT;
+	attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	attachments[1].format = DEPTH_FORMAT;
+	attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference colorReference = {};
+	colorReference.attachment = 0;
+	colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	VkAttachmentReference depthReference = {};
+	depthReference.attachment = 1;
+	depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorReference;
+	subpass.pDepthStencilAttachment = &depthReference;
+
+	// wait for the copy out of the last pass before clearing, and
+	// finish the writes of this pass before the next copy out
+	VkSubpassDependency dependencies[2] = {};
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT
+		| VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		| VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+		| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+		| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	VkRenderPassCreateInfo passInfo = {};
+	passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	passInfo.attachmentCount = 2;
+	passInfo.pAttachments = attachments;
+	passInfo.subpassCount = 1;
+	passInfo.pSubpasses = &subpass;
+	passInfo.dependencyCount = 2;
+	passInfo.pDependencies = dependencies;
+	return(VK_SUCCESS == vkCreateRenderPass(m_device, &passInfo, NULL, &m_renderPass));
+}
+
+/***********************************************************
+ *  CreateLayouts()
+ *
+ *  This method is used for creating the descriptor set and
+ *  pipeline layouts of the fixed resource layout - a dynamic
+ *  uniform buffer and one texture.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateLayouts()
+{
+	VkDescriptorSetLayoutBinding bindings[2] = {};
+	bindings[0].binding = RHI_UNIFORM_BINDING;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[1].binding = RHI_TEXTURE_BINDING;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo = {};
+	setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.bindingCount = 2;
+	setLayoutInfo.pBindings = bindings;
+	if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device, &setLayoutInfo, NULL, &m_descriptorSetLayout))
+	{
+		return(false);
+	}
+
+	VkPipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = 1;
+	layoutInfo.pSetLayouts = &m_descriptorSetLayout;
+	return(VK_SUCCESS == vkCreatePipelineLayout(m_device, &layoutInfo, NULL, &m_pipelineLayout));
+}
+
+/***********************************************************
+ *  FindMemoryType()
+ *
+ *  This method is used for finding a memory type allowed by
+ *  the type bits that has all of the passed in properties.
+ ***********************************************************/
+bool VulkanRenderDevice::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& typeIndex) const
+{
+	for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+	{
+		if ((0 != (typeBits & (1u << i))) &&
+			(properties == (m_memoryProperties.memoryTypes[i].propertyFlags & properties)))
+		{
+			typeIndex = i;
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for placing a resource in a memory
+ *  block, with the preferred properties when a memory type
+ *  has them.  Offsets are aligned to the buffer and image
+ *  granularity as well so buffers and images can share a
+ *  block.  Host visible blocks stay mapped.
+ ***********************************************************/
+bool VulkanRenderDevice::Allocate(
+	const VkMemoryRequirements& requirements,
+	VkMemoryPropertyFlags required,
+	VkMemoryPropertyFlags preferred,
+	VK_ALLOCATION& allocation)
+{
+	uint32_t typeIndex = 0;
+	if (!FindMemoryType(requirements.memoryTypeBits, required | preferred, typeIndex) &&
+		!FindMemoryType(requirements.memoryTypeBits, required, typeIndex))
+	{
+		std::cout << "No Vulkan memory type fits the resource" << std::endl;
+		return(false);
+	}
+
+	VkDeviceSize alignment = std::max(requirements.alignment, m_bufferImageGranularity);
+	MEMORY_BLOCK* pBlock = NULL;
+	VkDeviceSize offset = 0;
+	for (size_t i = 0; i < m_memoryBlocks.size(); ++i)
+	{
+		MEMORY_BLOCK& block = m_memoryBlocks[i];
+		offset = AlignUp(block.used, alignment);
+		if ((block.typeIndex == typeIndex) && (offset + requirements.size <= block.size))
+		{
+			pBlock = &block;
+			break;
+		}
+	}
+
+	if (NULL == pBlock)
+	{
+		MEMORY_BLOCK block;
+		block.typeIndex = typeIndex;
+		block.size = std::max(MEMORY_BLOCK_BYTES, requirements.size);
+		block.used = 0;
+		block.pMapped = NULL;
+		block.memory = VK_NULL_HANDLE;
+
+		VkMemoryAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = block.size;
+		allocateInfo.memoryTypeIndex = typeIndex;
+		if (VK_SUCCESS != vkAllocateMemory(m_device, &allocateInfo, NULL, &block.memory))
+		{
+			std::cout << "Failed to allocate a Vulkan memory block of " << block.size << " bytes" << std::endl;
+			return(false);
+		}
+		if (0 != (m_memoryProperties.memoryTypes[typeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+		{
+			void* pMapped = NULL;
+			vkMapMemory(m_device, block.memory, 0, VK_WHOLE_SIZE, 0, &pMapped);
+			block.pMapped = (unsigned char*)pMapped;
+		}
+		m_memoryBlocks.push_back(block);
+		pBlock = &m_memoryBlocks.back();
+		offset = 0;
+	}
+
+	pBlock->used = offset + requirements.size;
+	allocation.memory = pBlock->memory;
+	allocation.offset = offset;
+	allocation.pMapped = (NULL != pBlock->pMapped) ? pBlock->pMapped + offset : NULL;
+	return(true);
+}
+
+/***********************************************************
+ *  CreateHostBuffer()
+ *
+ *  This method is used for creating a buffer with its own
+ *  mapped, host coherent memory.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateHostBuffer(
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+	VkBuffer& buffer,
+	VkDeviceMemory& memory,
+	unsigned char*& pMapped)
+{
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (VK_SUCCESS != vkCreateBuffer(m_device, &bufferInfo, NULL, &buffer))
+	{
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, buffer, &requirements);
+	uint32_t typeIndex = 0;
+	if (!FindMemoryType(requirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, typeIndex))
+	{
+		vkDestroyBuffer(m_device, buffer, NULL);
+		buffer = VK_NULL_HANDLE;
+		return(false);
+	}
+
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	allocateInfo.memoryTypeIndex = typeIndex;
+	if (VK_SUCCESS != vkAllocateMemory(m_device, &allocateInfo, NULL, &memory))
+	{
+		vkDestroyBuffer(m_device, buffer, NULL);
+		buffer = VK_NULL_HANDLE;
+		return(false);
+	}
+	vkBindBufferMemory(m_device, buffer, memory, 0);
+
+	void* pMemory = NULL;
+	vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &pMemory);
+	pMapped = (unsigned char*)pMemory;
+	return(true);
+}
+
+/***********************************************************
+ *  CreateImage()
+ *
+ *  This method is used for creating a 2D image in device
+ *  local memory with a view of the passed in aspect.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateImage(
+	int width,
+	int height,
+	VkFormat format,
+	VkImageUsageFlags usage,
+	VkImageAspectFlags aspect,
+	VkImage& image,
+	VkImageView& view)
+{
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent.width = (uint32_t)width;
+	imageInfo.extent.height = (uint32_t)height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = usage;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (VK_SUCCESS != vkCreateImage(m_device, &imageInfo, NULL, &image))
+	{
+		image = VK_NULL_HANDLE;
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_device, image, &requirements);
+	VK_ALLOCATION allocation;
+	if (!Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, allocation) &&
+		!Allocate(requirements, 0, 0, allocation))
+	{
+		vkDestroyImage(m_device, image, NULL);
+		image = VK_NULL_HANDLE;
+		return(false);
+	}
+	vkBindImageMemory(m_device, image, allocation.memory, allocation.offset);
+
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = aspect;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+	if (VK_SUCCESS != vkCreateImageView(m_device, &viewInfo, NULL, &view))
+	{
+		vkDestroyImage(m_device, image, NULL);
+		image = VK_NULL_HANDLE;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  LoadShaderModule()
+ *
+ *  This method is used for reading a SPIR-V file into a
+ *  shader module.
+ ***********************************************************/
+VkShaderModule VulkanRenderDevice::LoadShaderModule(const std::string& filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open SPIR-V file " << filename << std::endl;
+		return(VK_NULL_HANDLE);
+	}
+
+	size_t size = (size_t)file.tellg();
+	std::vector<uint32_t> code((size + 3) / 4);
+	file.seekg(0);
+	file.read((char*)code.data(), (std::streamsize)size);
+
+	VkShaderModuleCreateInfo moduleInfo = {};
+	moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = size;
+	moduleInfo.pCode = code.data();
+
+	VkShaderModule module = VK_NULL_HANDLE;
+	if (VK_SUCCESS != vkCreateShaderModule(m_device, &moduleInfo, NULL, &module))
+	{
+		std::cout << "Invalid SPIR-V in " << filename << std::endl;
+		return(VK_NULL_HANDLE);
+	}
+	return(module);
+}
+
+/***********************************************************
+ *  BeginImmediate()
+ *
+ *  This method is used for starting a one time command
+ *  buffer for uploads and readbacks.
+ ***********************************************************/
+VkCommandBuffer VulkanRenderDevice::BeginImmediate()
+{
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = m_uploadPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	return(commandBuffer);
+}
+
+/***********************************************************
+ *  EndImmediate()
+ *
+ *  This method is used for submitting a one time command
+ *  buffer and waiting for it to finish.
+ ***********************************************************/
+void VulkanRenderDevice::EndImmediate(VkCommandBuffer commandBuffer)
+{
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(m_queue);
+
+	vkFreeCommandBuffers(m_device, m_uploadPool, 1, &commandBuffer);
+}
+
+/***********************************************************
+ *  TransitionImage()
+ *
+ *  This method is used for recording a layout change of the
+ *  color aspect of an image.
+ ***********************************************************/
+void VulkanRenderDevice::TransitionImage(
+	VkCommandBuffer commandBuffer,
+	VkImage image,
+	VkImageLayout oldLayout,
+	VkImageLayout newLayout,
+	VkAccessFlags srcAccess,
+	VkAccessFlags dstAccess,
+	VkPipelineStageFlags srcStage,
+	VkPipelineStageFlags dstStage)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstAccessMask = dstAccess;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a vertex or index buffer
+ *  in memory the CPU can write, which is device local too on
+ *  unified memory, resizable BAR and CPU devices.
+ ***********************************************************/
+BUFFER_HANDLE VulkanRenderDevice::CreateBuffer(BUFFER_USAGE usage, size_t size, const void* data)
+{
+	VK_BUFFER entry;
+	entry.buffer = VK_NULL_HANDLE;
+	entry.size = (VkDeviceSize)size;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = entry.size;
+	bufferInfo.usage = (BUFFER_USAGE_INDEX == usage) ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (VK_SUCCESS != vkCreateBuffer(m_device, &bufferInfo, NULL, &entry.buffer))
+	{
+		return(0);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, entry.buffer, &requirements);
+	if (!Allocate(requirements,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, entry.allocation))
+	{
+		vkDestroyBuffer(m_device, entry.buffer, NULL);
+		return(0);
+	}
+	vkBindBufferMemory(m_device, entry.buffer, entry.allocation.memory, entry.allocation.offset);
+	if (NULL != data)
+	{
+		memcpy(entry.allocation.pMapped, data, size);
+	}
+	TrackGpuMemory(GPU_MEMORY_BUFFER, (long long)size);
+
+	m_buffers.push_back(entry);
+	return((BUFFER_HANDLE)m_buffers.size());
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for replacing part of a buffer.  The
+ *  buffer is written in place, so the queue is drained first
+ *  to keep submitted draws from reading the new data.
+ ***********************************************************/
+void VulkanRenderDevice::UpdateBuffer(BUFFER_HANDLE buffer, size_t offset, size_t size, const void* data)
+{
+	if ((0 == buffer) || (buffer > m_buffers.size()) || (offset + size > m_buffers[buffer - 1].size))
+	{
+		std::cout << "Buffer update out of range" << std::endl;
+		return;
+	}
+
+	vkQueueWaitIdle(m_queue);
+	memcpy(m_buffers[buffer - 1].allocation.pMapped + offset, data, size);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for destroying a buffer.  Its range
+ *  of the memory block is not reused.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyBuffer(BUFFER_HANDLE buffer)
+{
+	if ((0 == buffer) || (buffer > m_buffers.size()) || (VK_NULL_HANDLE == m_buffers[buffer - 1].buffer))
+	{
+		return;
+	}
+
+	VK_BUFFER& entry = m_buffers[buffer - 1];
+	vkDestroyBuffer(m_device, entry.buffer, NULL);
+	TrackGpuMemory(GPU_MEMORY_BUFFER, -(long long)entry.size);
+	entry.buffer = VK_NULL_HANDLE;
+	entry.size = 0;
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture in device
+ *  local memory and copying the pixels in through a staging
+ *  buffer.
+ ***********************************************************/
+TEXTURE_HANDLE VulkanRenderDevice::CreateTexture(int width, int height, TEXTURE_FORMAT format, const void* pixels)
+{
+	int texelBytes = (TEXTURE_FORMAT_R8 == format) ? 1 : 4;
+
+	VK_TEXTURE entry;
+	entry.bytes = width * height * texelBytes;
+	if (!CreateImage(width, height,
+		(TEXTURE_FORMAT_R8 == format) ? VK_FORMAT_R8_UNORM : VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		VK_IMAGE_ASPECT_COLOR_BIT, entry.image, entry.view))
+	{
+		return(0);
+	}
+
+	VkBuffer stagingBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+	unsigned char* pStaging = NULL;
+	bool bStaged = (NULL != pixels) &&
+		CreateHostBuffer((VkDeviceSize)entry.bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, stagingBuffer, stagingMemory, pStaging);
+
+	VkCommandBuffer commandBuffer = BeginImmediate();
+	if (bStaged)
+	{
+		memcpy(pStaging, pixels, (size_t)entry.bytes);
+		TransitionImage(commandBuffer, entry.image,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent.width = (uint32_t)width;
+		region.imageExtent.height = (uint32_t)height;
+		region.imageExtent.depth = 1;
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, entry.image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		TransitionImage(commandBuffer, entry.image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+	else
+	{
+		TransitionImage(commandBuffer, entry.image,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			0, VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+	EndImmediate(commandBuffer);
+
+	if (VK_NULL_HANDLE != stagingBuffer)
+	{
+		vkDestroyBuffer(m_device, stagingBuffer, NULL);
+		vkFreeMemory(m_device, stagingMemory, NULL);
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)entry.bytes);
+
+	m_textures.push_back(entry);
+	return((TEXTURE_HANDLE)m_textures.size());
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for destroying a texture.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyTexture(TEXTURE_HANDLE texture)
+{
+	if ((0 == texture) || (texture > m_textures.size()) || (VK_NULL_HANDLE == m_textures[texture - 1].image))
+	{
+		return;
+	}
+
+	VK_TEXTURE& entry = m_textures[texture - 1];
+	vkDestroyImageView(m_device, entry.view, NULL);
+	vkDestroyImage(m_device, entry.image, NULL);
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)entry.bytes);
+	entry.image = VK_NULL_HANDLE;
+	entry.view = VK_NULL_HANDLE;
+	entry.bytes = 0;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a graphics pipeline from
+ *  the SPIR-V of the shader files.  The viewport and scissor
+ *  are dynamic so one pipeline works with every target.
+ ***********************************************************/
+PIPELINE_HANDLE VulkanRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	VkShaderModule vertexModule = LoadShaderModule(desc.vertexShaderFile + ".spv");
+	VkShaderModule fragmentModule = LoadShaderModule(desc.fragmentShaderFile + ".spv");
+	if ((VK_NULL_HANDLE == vertexModule) || (VK_NULL_HANDLE == fragmentModule))
+	{
+		if (VK_NULL_HANDLE != vertexModule)
+		{
+			vkDestroyShaderModule(m_device, vertexModule, NULL);
+		}
+		if (VK_NULL_HANDLE != fragmentModule)
+		{
+			vkDestroyShaderModule(m_device, fragmentModule, NULL);
+		}
+		return(0);
+	}
+
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertexModule;
+	stages[0].pName = "main";
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragmentModule;
+	stages[1].pName = "main";
+
+	std::vector<VkVertexInputBindingDescription> bindings(desc.bindings.size());
+	for (size_t i = 0; i < desc.bindings.size(); ++i)
+	{
+		bindings[i].binding = desc.bindings[i].binding;
+		bindings[i].stride = desc.bindings[i].stride;
+		bindings[i].inputRate = desc.bindings[i].bPerInstance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX;
+	}
+	std::vector<VkVertexInputAttributeDescription> attributes(desc.attributes.size());
+	for (size_t i = 0; i < desc.attributes.size(); ++i)
+	{
+		attributes[i].location = desc.attributes[i].location;
+		attributes[i].binding = desc.attributes[i].binding;
+		attributes[i].format = VertexFormat(desc.attributes[i].format);
+		attributes[i].offset = desc.attributes[i].offset;
+	}
+
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = (uint32_t)bindings.size();
+	vertexInput.pVertexBindingDescriptions = bindings.data();
+	vertexInput.vertexAttributeDescriptionCount = (uint32_t)attributes.size();
+	vertexInput.pVertexAttributeDescriptions = attributes.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = (PRIMITIVE_TRIANGLE_STRIP == desc.topology) ?
+		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	// no culling, the same as the GL state of the scene
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = desc.bDepthTest ? VK_TRUE : VK_FALSE;
+	depthStencil.depthWriteEnable = (desc.bDepthTest && desc.bDepthWrite) ? VK_TRUE : VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+	VkPipelineColorBlendAttachmentState blendAttachment = {};
+	blendAttachment.blendEnable = desc.bBlend ? VK_TRUE : VK_FALSE;
+	blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = stages;
+	pipelineInfo.pVertexInputState = &vertexInput;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterization;
+	pipelineInfo.pMultisampleState = &multisample;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlend;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = m_pipelineLayout;
+	pipelineInfo.renderPass = m_renderPass;
+	pipelineInfo.subpass = 0;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline);
+	vkDestroyShaderModule(m_device, vertexModule, NULL);
+	vkDestroyShaderModule(m_device, fragmentModule, NULL);
+	if (VK_SUCCESS != result)
+	{
+		std::cout << "Failed to create the Vulkan pipeline for " << desc.vertexShaderFile << std::endl;
+		return(0);
+	}
+
+	m_pipelines.push_back(pipeline);
+	return((PIPELINE_HANDLE)m_pipelines.size());
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for destroying a pipeline.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyPipeline(PIPELINE_HANDLE pipeline)
+{
+	if ((0 == pipeline) || (pipeline > m_pipelines.size()) || (VK_NULL_HANDLE == m_pipelines[pipeline - 1]))
+	{
+		return;
+	}
+
+	vkDestroyPipeline(m_device, m_pipelines[pipeline - 1], NULL);
+	m_pipelines[pipeline - 1] = VK_NULL_HANDLE;
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating the color and depth
+ *  images of a target and its framebuffer.  The color image
+ *  is moved to the layout a finished pass leaves it in, so a
+ *  target can be read back before anything is drawn.
+ ***********************************************************/
+RENDER_TARGET_HANDLE VulkanRenderDevice::CreateRenderTarget(int width, int height)
+{
+	VK_RENDER_TARGET entry;
+	entry.colorImage = VK_NULL_HANDLE;
+	entry.colorView = VK_NULL_HANDLE;
+	entry.depthImage = VK_NULL_HANDLE;
+	entry.depthView = VK_NULL_HANDLE;
+	entry.framebuffer = VK_NULL_HANDLE;
+	entry.width = width;
+	entry.height = height;
+
+	bool bCreated = CreateImage(width, height, COLOR_FORMAT,
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		VK_IMAGE_ASPECT_COLOR_BIT, entry.colorImage, entry.colorView);
+	bCreated = bCreated && CreateImage(width, height, DEPTH_FORMAT,
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+		VK_IMAGE_ASPECT_DEPTH_BIT, entry.depthImage, entry.depthView);
+
+	if (bCreated)
+	{
+		VkImageView attachments[2] = { entry.colorView, entry.depthView };
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_renderPass;
+		framebufferInfo.attachmentCount = 2;
+		framebufferInfo.pAttachments = attachments;
+		framebufferInfo.width = (uint32_t)width;
+		framebufferInfo.height = (uint32_t)height;
+		framebufferInfo.layers = 1;
+		bCreated = (VK_SUCCESS == vkCreateFramebuffer(m_device, &framebufferInfo, NULL, &entry.framebuffer));
+	}
+
+	// RGBA8 color and 32 bit float depth
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, (long long)width * height * 8);
+	m_renderTargets.push_back(entry);
+	RENDER_TARGET_HANDLE target = (RENDER_TARGET_HANDLE)m_renderTargets.size();
+	if (!bCreated)
+	{
+		std::cout << "Failed to create a " << width << "x" << height << " render target" << std::endl;
+		DestroyRenderTarget(target);
+		return(0);
+	}
+
+	VkCommandBuffer commandBuffer = BeginImmediate();
+	TransitionImage(commandBuffer, entry.colorImage,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_READ_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	EndImmediate(commandBuffer);
+	return(target);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for destroying a render target.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyRenderTarget(RENDER_TARGET_HANDLE target)
+{
+	if ((0 == target) || (target > m_renderTargets.size()) || (0 == m_renderTargets[target - 1].width))
+	{
+		return;
+	}
+
+	VK_RENDER_TARGET& entry = m_renderTargets[target - 1];
+	if (VK_NULL_HANDLE != entry.framebuffer)
+	{
+		vkDestroyFramebuffer(m_device, entry.framebuffer, NULL);
+	}
+	if (VK_NULL_HANDLE != entry.depthImage)
+	{
+		vkDestroyImageView(m_device, entry.depthView, NULL);
+		vkDestroyImage(m_device, entry.depthImage, NULL);
+	}
+	if (VK_NULL_HANDLE != entry.colorImage)
+	{
+		vkDestroyImageView(m_device, entry.colorView, NULL);
+		vkDestroyImage(m_device, entry.colorImage, NULL);
+	}
+	TrackGpuMemory(GPU_MEMORY_TEXTURE, -(long long)entry.width * entry.height * 8);
+	entry.framebuffer = VK_NULL_HANDLE;
+	entry.colorImage = VK_NULL_HANDLE;
+	entry.colorView = VK_NULL_HANDLE;
+	entry.depthImage = VK_NULL_HANDLE;
+	entry.depthView = VK_NULL_HANDLE;
+	entry.width = 0;
+	entry.height = 0;
+}
+
+/***********************************************************
+ *  ReadRenderTarget()
+ *
+ *  This method is used for copying the color of a target
+ *  into a host buffer and reading it back.  Vulkan images
+ *  start at the top row, the order the interface uses.
+ ***********************************************************/
+bool VulkanRenderDevice::ReadRenderTarget(RENDER_TARGET_HANDLE target, std::vector<unsigned char>& pixels)
+{
+	if ((0 == target) || (target > m_renderTargets.size()) || (VK_NULL_HANDLE == m_renderTargets[target - 1].framebuffer))
+	{
+		return(false);
+	}
+	const VK_RENDER_TARGET& entry = m_renderTargets[target - 1];
+	VkDeviceSize size = (VkDeviceSize)entry.width * entry.height * 4;
+
+	VkBuffer readBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory readMemory = VK_NULL_HANDLE;
+	unsigned char* pRead = NULL;
+	if (!CreateHostBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, readBuffer, readMemory, pRead))
+	{
+		return(false);
+	}
+
+	// the submitted passes finish before the copy
+	vkQueueWaitIdle(m_queue);
+
+	VkCommandBuffer commandBuffer = BeginImmediate();
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent.width = (uint32_t)entry.width;
+	region.imageExtent.height = (uint32_t)entry.height;
+	region.imageExtent.depth = 1;
+	vkCmdCopyImageToBuffer(commandBuffer, entry.colorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		readBuffer, 1, &region);
+	EndImmediate(commandBuffer);
+
+	pixels.resize((size_t)size);
+	memcpy(pixels.data(), pRead, (size_t)size);
+
+	vkDestroyBuffer(m_device, readBuffer, NULL);
+	vkFreeMemory(m_device, readMemory, NULL);
+	return(true);
+}
+
+/***********************************************************
+ *  CreateCommandBuffer()
+ *
+ *  This method is used for creating a command buffer with
+ *  its own pools and uniform storage.
+ ***********************************************************/
+RenderCommandBuffer* VulkanRenderDevice::CreateCommandBuffer()
+{
+	VulkanCommandBuffer* pCommandBuffer = new VulkanCommandBuffer(this);
+	if (!pCommandBuffer->Initialize())
+	{
+		std::cout << "Failed to create a Vulkan command buffer" << std::endl;
+		delete pCommandBuffer;
+		return(NULL);
+	}
+	return(pCommandBuffer);
+}
+
+/***********************************************************
+ *  DestroyCommandBuffer()
+ *
+ *  This method is used for destroying a command buffer once
+ *  its last submit has finished.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyCommandBuffer(RenderCommandBuffer* pCommandBuffer)
+{
+	delete pCommandBuffer;
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a recorded command
+ *  buffer.  Its fence is signalled when it finishes, which
+ *  the next Begin() of the command buffer waits for.
+ ***********************************************************/
+void VulkanRenderDevice::Submit(RenderCommandBuffer* pCommandBuffer)
+{
+	if (NULL == pCommandBuffer)
+	{
+		return;
+	}
+
+	VulkanCommandBuffer* pVulkanCommandBuffer = static_cast<VulkanCommandBuffer*>(pCommandBuffer);
+	VkCommandBuffer commandBuffer = pVulkanCommandBuffer->GetCommandBuffer();
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	if (VK_SUCCESS == vkQueueSubmit(m_queue, 1, &submitInfo, pVulkanCommandBuffer->GetFence()))
+	{
+		pVulkanCommandBuffer->MarkSubmitted();
+	}
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used for waiting for the queue to drain.
+ ***********************************************************/
+void VulkanRenderDevice::WaitIdle()
+{
+	vkQueueWaitIdle(m_queue);
+}
+
+#endif // RHI_VULKAN
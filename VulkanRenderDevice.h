@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.h
+// ============
+// Vulkan implementation of the render hardware interface, compiled
+// when RHI_VULKAN is defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifdef RHI_VULKAN
+
+#include "RenderDevice.h"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+class VulkanRenderDevice;
+
+/***********************************************************
+ *  VulkanCommandBuffer
+ *
+ *  This class records straight into a Vulkan command buffer.
+ *  Each one owns its command pool, descriptor pool and mapped
+ *  uniform buffers, so separate command buffers can be
+ *  recorded on separate threads without any locking.  The
+ *  uniforms of every draw are written into the uniform buffer
+ *  and picked with a dynamic offset, so a new descriptor set
+ *  is only needed when the texture changes or a full uniform
+ *  buffer is followed by the next one.
+ ***********************************************************/
+class VulkanCommandBuffer : public RenderCommandBuffer
+{
+public:
+	// constructor
+	VulkanCommandBuffer(VulkanRenderDevice* pDevice);
+	// destructor
+	~VulkanCommandBuffer();
+
+	bool Initialize();
+
+	void Begin();
+	void End();
+	void BeginRenderPass(RENDER_TARGET_HANDLE target, const glm::vec4& clearColor);
+	void EndRenderPass();
+	void BindPipeline(PIPELINE_HANDLE pipeline);
+	void BindVertexBuffer(unsigned int binding, BUFFER_HANDLE buffer, size_t offset);
+	void BindIndexBuffer(BUFFER_HANDLE buffer, size_t offset);
+	void BindTexture(TEXTURE_HANDLE texture);
+	void SetUniforms(const void* data, size_t size);
+	void Draw(
+		unsigned int vertexCount,
+		unsigned int instanceCount,
+		unsigned int firstVertex,
+		unsigned int firstInstance);
+	void DrawIndexed(
+		unsigned int indexCount,
+		unsigned int instanceCount,
+		unsigned int firstIndex,
+		int vertexOffset,
+		unsigned int firstInstance);
+
+	// used by the device to submit the recorded commands
+	VkCommandBuffer GetCommandBuffer() const { return m_commandBuffer; }
+	VkFence GetFence() const { return m_fence; }
+	void MarkSubmitted() { m_bSubmitted = true; }
+
+private:
+	VulkanRenderDevice* m_pDevice;
+	VkCommandPool m_commandPool;
+	VkCommandBuffer m_commandBuffer;
+	// signalled when the last submit has finished
+	VkFence m_fence;
+	bool m_bSubmitted;
+	VkDescriptorPool m_descriptorPool;
+	VkDescriptorSet m_descriptorSet;
+	// host visible uniform storage, filled one buffer after the
+	// other and kept for the following recordings
+	struct UNIFORM_BLOCK
+	{
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		unsigned char* pMapped;
+	};
+	std::vector<UNIFORM_BLOCK> m_uniformBlocks;
+	size_t m_uniformBlock;
+	VkDeviceSize m_uniformUsed;
+	uint32_t m_uniformOffset;
+	TEXTURE_HANDLE m_texture;
+	// a descriptor set is needed for the current texture
+	bool m_bDescriptorsDirty;
+	// the dynamic offset changed since the set was bound
+	bool m_bOffsetDirty;
+	bool m_bOutOfSpace;
+
+	bool PrepareDraw();
+	// move on to the next uniform buffer, creating it when the
+	// recording has not needed it before
+	bool NextUniformBlock();
+	void WaitForSubmit();
+};
+
+/***********************************************************
+ *  VulkanRenderDevice
+ *
+ *  This class implements the device without a window, so it
+ *  runs on a CPU implementation such as lavapipe as well as
+ *  on a GPU.  Memory is managed by the device - resources are
+ *  placed in large blocks per memory type instead of one
+ *  allocation each, and textures are uploaded through a
+ *  staging buffer.  The viewport is flipped so the output
+ *  matches the OpenGL backend.
+ ***********************************************************/
+class VulkanRenderDevice : public RenderDevice
+{
+public:
+	// constructor
+	VulkanRenderDevice(bool bPreferCPU);
+	// destructor
+	~VulkanRenderDevice();
+
+	bool Initialize();
+	RENDER_BACKEND GetBackend() const { return RENDER_BACKEND_VULKAN; }
+	const char* GetDeviceName() const { return m_deviceName.c_str(); }
+
+	BUFFER_HANDLE CreateBuffer(BUFFER_USAGE usage, size_t size, const void* data);
+	void UpdateBuffer(BUFFER_HANDLE buffer, size_t offset, size_t size, const void* data);
+	void DestroyBuffer(BUFFER_HANDLE buffer);
+
+	TEXTURE_HANDLE CreateTexture(int width, int height, TEXTURE_FORMAT format, const void* pixels);
+	void DestroyTexture(TEXTURE_HANDLE texture);
+
+	PIPELINE_HANDLE CreatePipeline(const PIPELINE_DESC& desc);
+	void DestroyPipeline(PIPELINE_HANDLE pipeline);
+
+	RENDER_TARGET_HANDLE CreateRenderTarget(int width, int height);
+	void DestroyRenderTarget(RENDER_TARGET_HANDLE target);
+	bool ReadRenderTarget(RENDER_TARGET_HANDLE target, std::vector<unsigned char>& pixels);
+
+	RenderCommandBuffer* CreateCommandBuffer();
+	void DestroyCommandBuffer(RenderCommandBuffer* pCommandBuffer);
+	void Submit(RenderCommandBuffer* pCommandBuffer);
+	void WaitIdle();
+
+private:
+	friend class VulkanCommandBuffer;
+
+	// a range of a memory block
+	struct VK_ALLOCATION
+	{
+		VkDeviceMemory memory;
+		VkDeviceSize offset;
+		// NULL when the memory is not host visible
+		unsigned char* pMapped;
+	};
+
+	// one large allocation that resources are placed in one after
+	// the other - blocks are freed with the device
+	struct MEMORY_BLOCK
+	{
+		VkDeviceMemory memory;
+		uint32_t typeIndex;
+		VkDeviceSize size;
+		VkDeviceSize used;
+		unsigned char* pMapped;
+	};
+
+	struct VK_BUFFER
+	{
+		VkBuffer buffer;
+		VK_ALLOCATION allocation;
+		VkDeviceSize size;
+	};
+
+	struct VK_TEXTURE
+	{
+		VkImage image;
+		VkImageView view;
+		int bytes;
+	};
+
+	struct VK_RENDER_TARGET
+	{
+		VkImage colorImage;
+		VkImageView colorView;
+		VkImage depthImage;
+		VkImageView depthView;
+		VkFramebuffer framebuffer;
+		int width;
+		int height;
+	};
+
+	bool m_bPreferCPU;
+	std::string m_deviceName;
+	VkInstance m_instance;
+	VkPhysicalDevice m_physicalDevice;
+	VkDevice m_device;
+	VkQueue m_queue;
+	uint32_t m_queueFamily;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkDeviceSize m_uniformAlignment;
+	VkDeviceSize m_bufferImageGranularity;
+	// pool of the one time upload and readback commands
+	VkCommandPool m_uploadPool;
+	// every pipeline and target uses the same pass and layout
+	VkRenderPass m_renderPass;
+	VkDescriptorSetLayout m_descriptorSetLayout;
+	VkPipelineLayout m_pipelineLayout;
+	VkSampler m_sampler;
+	// bound when nothing else is, so every descriptor is valid
+	TEXTURE_HANDLE m_defaultTexture;
+
+	std::vector<MEMORY_BLOCK> m_memoryBlocks;
+	// destroyed resources leave a null entry so handles stay unique
+	std::vector<VK_BUFFER> m_buffers;
+	std::vector<VK_TEXTURE> m_textures;
+	std::vector<VkPipeline> m_pipelines;
+	std::vector<VK_RENDER_TARGET> m_renderTargets;
+
+	bool SelectPhysicalDevice();
+	bool CreateRenderPass();
+	bool CreateLayouts();
+
+	bool FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& typeIndex) const;
+	bool Allocate(
+		const VkMemoryRequirements& requirements,
+		VkMemoryPropertyFlags required,
+		VkMemoryPropertyFlags preferred,
+		VK_ALLOCATION& allocation);
+	// a buffer with its own host visible memory, for staging and uniforms
+	bool CreateHostBuffer(
+		VkDeviceSize size,
+		VkBufferUsageFlags usage,
+		VkBuffer& buffer,
+		VkDeviceMemory& memory,
+		unsigned char*& pMapped);
+	bool CreateImage(
+		int width,
+		int height,
+		VkFormat format,
+		VkImageUsageFlags usage,
+		VkImageAspectFlags aspect,
+		VkImage& image,
+		VkImageView& view);
+	VkShaderModule LoadShaderModule(const std::string& filename);
+
+	// record and run commands outside of a command buffer, waiting for them
+	VkCommandBuffer BeginImmediate();
+	void EndImmediate(VkCommandBuffer commandBuffer);
+	void TransitionImage(
+		VkCommandBuffer commandBuffer,
+		VkImage image,
+		VkImageLayout oldLayout,
+		VkImageLayout newLayout,
+		VkAccessFlags srcAccess,
+		VkAccessFlags dstAccess,
+		VkPipelineStageFlags srcStage,
+		VkPipelineStageFlags dstStage);
+};
+
+#endif // RHI_VULKAN
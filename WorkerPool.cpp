@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.cpp
+// ============
+// keep a set of worker threads alive between frames to run the same
+// piece of work on several threads at once
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerPool.h"
+
+/***********************************************************
+ *  WorkerPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WorkerPool::WorkerPool()
+{
+	m_pWork = NULL;
+	m_generation = 0;
+	m_helperCount = 0;
+	m_runningCount = 0;
+	m_bStop = false;
+}
+
+/***********************************************************
+ *  ~WorkerPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running the passed in function on
+ *  the calling thread and the first threadCount - 1 workers,
+ *  starting any of them that are not running yet, and
+ *  waiting for all of them to finish it.
+ ***********************************************************/
+void WorkerPool::Run(const std::function<void()>& work, int threadCount)
+{
+	int helperCount = threadCount - 1;
+	if (helperCount > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// a new worker starts at the current run, so it only
+		// takes part from the next one on
+		while ((int)m_workers.size() < helperCount)
+		{
+			m_workers.push_back(std::thread(&WorkerPool::WorkerLoop, this, (int)m_workers.size(), m_generation));
+		}
+		m_pWork = &work;
+		m_helperCount = helperCount;
+		m_runningCount = helperCount;
+		m_generation++;
+	}
+	if (helperCount > 0)
+	{
+		m_wake.notify_all();
+	}
+
+	work();
+
+	if (helperCount > 0)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return (0 == m_runningCount); });
+		m_pWork = NULL;
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running the runs a worker takes
+ *  part in, sleeping in between, until the pool is destroyed.
+ ***********************************************************/
+void WorkerPool::WorkerLoop(int workerIndex, unsigned long long generation)
+{
+	while (true)
+	{
+		const std::function<void()>* pWork = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, generation]() { return (m_bStop || (m_generation != generation)); });
+			if (m_bStop)
+			{
+				return;
+			}
+			generation = m_generation;
+			if (workerIndex >= m_helperCount)
+			{
+				continue;
+			}
+			pWork = m_pWork;
+		}
+
+		(*pWork)();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_runningCount--;
+		if (0 == m_runningCount)
+		{
+			m_done.notify_one();
+		}
+	}
+}
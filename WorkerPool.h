@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.h
+// ============
+// keep a set of worker threads alive between frames to run the same
+// piece of work on several threads at once
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  WorkerPool
+ *
+ *  This class runs one function on a number of threads at
+ *  once, the calling thread being one of them, and returns
+ *  once every thread has come back from it.  The workers are
+ *  started the first time they are needed and then sleep
+ *  between runs, so running work every frame costs a wake up
+ *  rather than creating and joining threads.
+ ***********************************************************/
+class WorkerPool
+{
+public:
+	// constructor
+	WorkerPool();
+	// destructor
+	~WorkerPool();
+
+	// run the passed in function on the passed in number of
+	// threads including the calling one - the function itself
+	// decides how the work is split between the calls
+	void Run(const std::function<void()>& work, int threadCount);
+
+	// workers started so far
+	int GetWorkerCount() const { return (int)m_workers.size(); }
+
+private:
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	// the function of the current run and the workers taking
+	// part in it, counted up every run so a worker sees each
+	// run once
+	const std::function<void()>* m_pWork;
+	unsigned long long m_generation;
+	int m_helperCount;
+	int m_runningCount;
+	bool m_bStop;
+
+	void WorkerLoop(int workerIndex, unsigned long long generation);
+};
@@ -0,0 +1,68 @@
+#version 460 core
+// deferredLightingFragmentShader.glsl
+// full screen lighting pass of the deferred path - reads the packed
+// G-buffer once per pixel and applies every scene light with the same
+// Phong model and material parameters as the forward shaders
+
+#include "phongLighting.glsl"
+
+#define MAX_MATERIALS 32
+
+in vec2 fragmentTextureCoordinate;
+
+out vec4 outFragmentColor;
+
+uniform sampler2D albedoTexture;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPosition;
+uniform Material materials[MAX_MATERIALS];
+uniform int materialCount;
+// the G-buffer is drawn at the origin, this pass in the viewport
+uniform vec2 viewportOrigin;
+
+vec2 SignNotZero(vec2 v)
+{
+	return(vec2((v.x >= 0.0) ? 1.0 : -1.0, (v.y >= 0.0) ? 1.0 : -1.0));
+}
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * SignNotZero(n.xy);
+	}
+
+	return(normalize(n));
+}
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy - viewportOrigin);
+	float depth = texelFetch(depthTexture, texel, 0).r;
+
+	// nothing was drawn here, keep the cleared background
+	if (depth >= 1.0)
+	{
+		discard;
+	}
+
+	vec4 albedoMaterial = texelFetch(albedoTexture, texel, 0);
+	int materialSlot = int(albedoMaterial.a * 255.0 + 0.5) - 1;
+	if ((materialSlot < 0) || (materialSlot >= materialCount))
+	{
+		outFragmentColor = vec4(albedoMaterial.rgb, 1.0);
+		return;
+	}
+
+	// rebuild the world position from the depth buffer
+	vec4 clipPosition = vec4(fragmentTextureCoordinate * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+	vec4 worldPosition = inverseViewProjection * clipPosition;
+	vec3 fragmentPosition = worldPosition.xyz / worldPosition.w;
+	vec3 normal = DecodeOctahedral(texelFetch(normalTexture, texel, 0).rg);
+
+	vec3 lit = CalcPhongLighting(materials[materialSlot], albedoMaterial.rgb, normal, fragmentPosition, viewPosition);
+	outFragmentColor = vec4(lit, 1.0);
+}
@@ -0,0 +1,7 @@
+#version 460 core
+// depthOnlyFragmentShader.glsl
+// no color output - the depth pre-pass only writes the depth buffer
+
+void main()
+{
+}
@@ -0,0 +1,20 @@
+#version 460 core
+// depthOnlyVertexShader.glsl
+// position only transform for the depth pre-pass - the expression
+// matches sceneVertexShader.glsl and both declare gl_Position
+// invariant, so the passes produce the same depth values
+
+layout (location = 0) in vec3 inVertexPosition;
+
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0);
+
+	gl_Position = projection * view * worldPosition;
+}
@@ -0,0 +1,14 @@
+#version 460 core
+// fullscreenVertexShader.glsl
+// one triangle covering the screen, generated from gl_VertexID so
+// no vertex buffer is needed - draw with glDrawArrays(GL_TRIANGLES, 0, 3)
+
+out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	fragmentTextureCoordinate = position;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
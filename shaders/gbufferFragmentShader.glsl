@@ -0,0 +1,50 @@
+#version 460 core
+// gbufferFragmentShader.glsl
+// writes the packed G-buffer of the deferred path - the albedo with
+// the material slot in alpha, and an octahedral encoded normal in two
+// 16 bit channels; the position is rebuilt from depth when lighting
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+layout (location = 0) out vec4 outAlbedoMaterial;
+layout (location = 1) out vec2 outNormal;
+
+uniform bool bUseTexture;
+uniform vec4 objectColor;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale;
+// index into the scene materials, -1 when no material was set
+uniform int materialIndex;
+
+vec2 SignNotZero(vec2 v)
+{
+	return(vec2((v.x >= 0.0) ? 1.0 : -1.0, (v.y >= 0.0) ? 1.0 : -1.0));
+}
+
+// map the unit normal onto the octahedron and fold the lower half
+vec2 EncodeOctahedral(vec3 n)
+{
+	n /= (abs(n.x) + abs(n.y) + abs(n.z));
+	vec2 encoded = n.xy;
+	if (n.z < 0.0)
+	{
+		encoded = (1.0 - abs(n.yx)) * SignNotZero(n.xy);
+	}
+
+	return(encoded);
+}
+
+void main()
+{
+	vec4 baseColor = objectColor;
+	if (bUseTexture)
+	{
+		baseColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+	}
+
+	// slot 0 is reserved for draws without a material
+	outAlbedoMaterial = vec4(baseColor.rgb, float(materialIndex + 1) / 255.0);
+	outNormal = EncodeOctahedral(normalize(fragmentVertexNormal));
+}
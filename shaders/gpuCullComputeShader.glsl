@@ -0,0 +1,157 @@
+#version 460 core
+// gpuCullComputeShader.glsl
+// one invocation per object - tests the world bounds against the view
+// frustum and optionally the depth pyramid of the last frame, and
+// appends a draw command for each object that survives
+
+layout (local_size_x = 64) in;
+
+// layouts match CULL_OBJECT, CULL_MESH and the GL indirect command
+struct CullObject
+{
+	mat4 model;
+	vec4 boundsMin;
+	vec4 boundsMax;
+	uvec4 mesh;
+};
+
+struct CullMesh
+{
+	uint indexCount;
+	uint firstIndex;
+	int baseVertex;
+	uint padding;
+};
+
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Objects
+{
+	CullObject objects[];
+};
+
+layout (std430, binding = 1) readonly buffer Meshes
+{
+	CullMesh meshes[];
+};
+
+layout (std430, binding = 2) writeonly buffer Commands
+{
+	DrawCommand commands[];
+};
+
+layout (std430, binding = 3) buffer DrawCount
+{
+	uint drawCount;
+};
+
+uniform uint objectCount;
+// inward facing (normal, distance) planes, as from ExtractFrustum()
+uniform vec4 frustumPlanes[6];
+
+uniform bool bOcclusion;
+// farthest depth of each texel, built from the depth of the last frame
+uniform sampler2D depthPyramid;
+uniform mat4 pyramidViewProjection;
+uniform vec2 pyramidSize;
+uniform int pyramidLevels;
+
+bool IsBoxInFrustum(vec3 boxMin, vec3 boxMax)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		vec4 plane = frustumPlanes[i];
+		// the box corner furthest along the plane normal
+		vec3 positive = mix(boxMin, boxMax, greaterThanEqual(plane.xyz, vec3(0.0)));
+		if (dot(plane.xyz, positive) + plane.w < 0.0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsBoxOccluded(vec3 boxMin, vec3 boxMax)
+{
+	vec2 minUV = vec2(1.0);
+	vec2 maxUV = vec2(0.0);
+	float nearestDepth = 1.0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		vec3 corner = vec3(
+			((i & 1) != 0) ? boxMax.x : boxMin.x,
+			((i & 2) != 0) ? boxMax.y : boxMin.y,
+			((i & 4) != 0) ? boxMax.z : boxMin.z);
+		vec4 clip = pyramidViewProjection * vec4(corner, 1.0);
+		// a box crossing the near plane has no screen rectangle
+		if (clip.w <= 0.0)
+		{
+			return false;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		vec2 uv = ndc.xy * 0.5 + 0.5;
+		minUV = min(minUV, uv);
+		maxUV = max(maxUV, uv);
+		nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+	}
+
+	minUV = clamp(minUV, vec2(0.0), vec2(1.0));
+	maxUV = clamp(maxUV, vec2(0.0), vec2(1.0));
+
+	// the level where the rectangle is at most one texel wide,
+	// so the four corner samples cover all of it
+	vec2 extent = (maxUV - minUV) * pyramidSize;
+	float level = ceil(log2(max(max(extent.x, extent.y), 1.0)));
+	level = clamp(level, 0.0, float(pyramidLevels - 1));
+
+	float farthestDepth = max(
+		max(textureLod(depthPyramid, minUV, level).r, textureLod(depthPyramid, vec2(maxUV.x, minUV.y), level).r),
+		max(textureLod(depthPyramid, vec2(minUV.x, maxUV.y), level).r, textureLod(depthPyramid, maxUV, level).r));
+
+	return nearestDepth > farthestDepth;
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= objectCount)
+	{
+		return;
+	}
+
+	CullObject object = objects[index];
+
+	// world space box enclosing the transformed object box
+	vec3 center = (object.boundsMin.xyz + object.boundsMax.xyz) * 0.5;
+	vec3 extent = (object.boundsMax.xyz - object.boundsMin.xyz) * 0.5;
+	vec3 worldCenter = vec3(object.model * vec4(center, 1.0));
+	vec3 worldExtent =
+		abs(object.model[0].xyz) * extent.x +
+		abs(object.model[1].xyz) * extent.y +
+		abs(object.model[2].xyz) * extent.z;
+	vec3 worldMin = worldCenter - worldExtent;
+	vec3 worldMax = worldCenter + worldExtent;
+
+	if (!IsBoxInFrustum(worldMin, worldMax))
+	{
+		return;
+	}
+	if (bOcclusion && IsBoxOccluded(worldMin, worldMax))
+	{
+		return;
+	}
+
+	// the object index goes in as the base instance, so the vertex
+	// shader finds the transform through gl_BaseInstance
+	CullMesh mesh = meshes[object.mesh.x];
+	uint slot = atomicAdd(drawCount, 1u);
+	commands[slot] = DrawCommand(mesh.indexCount, 1u, mesh.firstIndex, mesh.baseVertex, index);
+}
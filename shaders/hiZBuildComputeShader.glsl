@@ -0,0 +1,55 @@
+#version 460 core
+// hiZBuildComputeShader.glsl
+// builds one level of the depth pyramid - level 0 is a copy of the
+// depth texture, and each level above keeps the farthest depth of the
+// texels it covers in the level below
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// the depth texture for level 0, the pyramid itself above it
+uniform sampler2D sourceDepth;
+uniform int sourceLevel;
+uniform bool bCopy;
+
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+
+void main()
+{
+	ivec2 size = imageSize(destination);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if ((texel.x >= size.x) || (texel.y >= size.y))
+	{
+		return;
+	}
+
+	if (bCopy)
+	{
+		imageStore(destination, texel, vec4(texelFetch(sourceDepth, texel, 0).r));
+		return;
+	}
+
+	ivec2 sourceSize = textureSize(sourceDepth, sourceLevel);
+	ivec2 first = texel * 2;
+	ivec2 last = first + ivec2(1);
+	// the last texel of a level also covers the extra row or
+	// column of an odd sized level below
+	if (texel.x == size.x - 1)
+	{
+		last.x = sourceSize.x - 1;
+	}
+	if (texel.y == size.y - 1)
+	{
+		last.y = sourceSize.y - 1;
+	}
+	last = min(last, sourceSize - ivec2(1));
+
+	float farthestDepth = 0.0;
+	for (int y = first.y; y <= last.y; y++)
+	{
+		for (int x = first.x; x <= last.x; x++)
+		{
+			farthestDepth = max(farthestDepth, texelFetch(sourceDepth, ivec2(x, y), sourceLevel).r);
+		}
+	}
+	imageStore(destination, texel, vec4(farthestDepth));
+}
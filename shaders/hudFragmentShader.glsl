@@ -0,0 +1,29 @@
+#version 460 core
+// hudFragmentShader.glsl
+// looks up the glyph texel covering the fragment in the R8 atlas,
+// drawn with glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+
+// must match the glyph cell size of the atlas
+const ivec2 GLYPH_SIZE = ivec2(3, 5);
+
+in vec2 glyphCoordinate;
+flat in uint glyphIndex;
+flat in vec4 glyphColor;
+
+out vec4 outFragmentColor;
+
+uniform sampler2D glyphAtlas;
+
+void main()
+{
+	// the coordinate reaches the cell size on the far edges
+	ivec2 texel = min(ivec2(glyphCoordinate), GLYPH_SIZE - 1);
+	texel.x += int(glyphIndex) * GLYPH_SIZE.x;
+
+	if (texelFetch(glyphAtlas, texel, 0).r < 0.5)
+	{
+		discard;
+	}
+
+	outFragmentColor = glyphColor;
+}
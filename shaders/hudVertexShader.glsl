@@ -0,0 +1,30 @@
+#version 460 core
+// hudVertexShader.glsl
+// one screen space quad per instance for the performance overlay,
+// the corners come from gl_VertexID - draw with
+// glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances)
+
+// must match the glyph cell size of the atlas
+const vec2 GLYPH_SIZE = vec2(3.0, 5.0);
+
+// x, y, width, height in pixels from the top left of the viewport
+layout (location = 0) in vec4 inRectangle;
+layout (location = 1) in uint inGlyph;
+layout (location = 2) in vec4 inColor;
+
+out vec2 glyphCoordinate;
+flat out uint glyphIndex;
+flat out vec4 glyphColor;
+
+uniform vec2 screenSize;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 pixel = inRectangle.xy + corner * inRectangle.zw;
+
+	glyphCoordinate = corner * GLYPH_SIZE;
+	glyphIndex = inGlyph;
+	glyphColor = inColor;
+	gl_Position = vec4(pixel.x / screenSize.x * 2.0 - 1.0, 1.0 - pixel.y / screenSize.y * 2.0, 0.0, 1.0);
+}
@@ -0,0 +1,55 @@
+#version 460 core
+// impostorFragmentShader.glsl
+// shade an impostor from its baked color and depth, writing the depth of
+// the baked surface so the impostor intersects the scene correctly
+
+in vec2 atlasTextureCoordinate;
+in vec3 quadPosition;
+flat in vec3 frameDirection;
+flat in vec4 impostorParams;
+flat in float radius;
+
+out vec4 fragmentColor;
+
+uniform sampler2DArray colorAtlas;
+uniform sampler2DArray depthAtlas;
+uniform mat4 view;
+uniform mat4 projection;
+
+// 4x4 ordered dither thresholds for the crossfade
+const float DITHER[16] = float[16](
+	0.0, 8.0, 2.0, 10.0,
+	12.0, 4.0, 14.0, 6.0,
+	3.0, 11.0, 1.0, 9.0,
+	15.0, 7.0, 13.0, 5.0);
+
+void main()
+{
+	vec3 atlasCoordinate = vec3(atlasTextureCoordinate, impostorParams.x);
+	vec4 color = texture(colorAtlas, atlasCoordinate);
+	if (color.a < 0.5)
+	{
+		discard;
+	}
+
+	// while fading in, only the covered share of the pixels is drawn
+	// over the full geometry - no blending or sorting is needed
+	if (impostorParams.y < 1.0)
+	{
+		int index = (int(gl_FragCoord.x) & 3) + (int(gl_FragCoord.y) & 3) * 4;
+		if ((DITHER[index] + 0.5) / 16.0 > impostorParams.y)
+		{
+			discard;
+		}
+	}
+
+	// frames are baked orthographically from twice the radius with
+	// the near and far planes one radius either side of the centre,
+	// so the stored depth is linear across the bounding sphere
+	float depth = texture(depthAtlas, atlasCoordinate).r;
+	float offset = radius * (1.0 - 2.0 * depth) + impostorParams.z;
+	vec4 clipPosition = projection * view * vec4(quadPosition + frameDirection * offset, 1.0);
+	gl_FragDepth = (clipPosition.z / clipPosition.w) * 0.5 + 0.5;
+
+	fragmentColor = vec4(color.rgb, 1.0);
+}
@@ -0,0 +1,70 @@
+#version 460 core
+// impostorVertexShader.glsl
+// quad of an octahedral impostor, one instance per distant prop, placed
+// on the plane of the atlas frame baked nearest to the view direction -
+// draw with glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count)
+
+// world space bounding sphere of the prop
+layout (location = 0) in vec4 inCenterRadius;
+// atlas layer, crossfade coverage and depth bias toward the camera
+layout (location = 1) in vec4 inImpostorParams;
+
+out vec2 atlasTextureCoordinate;
+out vec3 quadPosition;
+flat out vec3 frameDirection;
+flat out vec4 impostorParams;
+flat out float radius;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPosition;
+uniform int framesPerSide;
+
+// map a unit direction onto the [0,1] square, with +Y at the centre
+vec2 OctahedralEncode(vec3 direction)
+{
+	direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+	vec2 square = direction.xz;
+	if (direction.y < 0.0)
+	{
+		vec2 signs = vec2(square.x >= 0.0 ? 1.0 : -1.0, square.y >= 0.0 ? 1.0 : -1.0);
+		square = (1.0 - abs(square.yx)) * signs;
+	}
+	return(square * 0.5 + 0.5);
+}
+
+// inverse of OctahedralEncode(), must match the baking in impostorrenderer.cpp
+vec3 OctahedralDecode(vec2 textureCoordinate)
+{
+	vec2 square = textureCoordinate * 2.0 - 1.0;
+	vec3 direction = vec3(square.x, 1.0 - abs(square.x) - abs(square.y), square.y);
+	if (direction.y < 0.0)
+	{
+		vec2 signs = vec2(direction.x >= 0.0 ? 1.0 : -1.0, direction.z >= 0.0 ? 1.0 : -1.0);
+		direction.xz = (1.0 - abs(direction.zx)) * signs;
+	}
+	return(normalize(direction));
+}
+
+void main()
+{
+	vec3 center = inCenterRadius.xyz;
+	radius = inCenterRadius.w;
+	impostorParams = inImpostorParams;
+
+	// the frame whose direction is closest to the camera
+	float frames = float(framesPerSide);
+	vec2 frame = clamp(floor(OctahedralEncode(normalize(viewPosition - center)) * frames), 0.0, frames - 1.0);
+	frameDirection = OctahedralDecode((frame + 0.5) / frames);
+
+	// the same basis as the lookAt() the frame was baked with
+	vec3 worldUp = (abs(frameDirection.y) > 0.99) ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+	vec3 right = normalize(cross(worldUp, frameDirection));
+	vec3 up = cross(frameDirection, right);
+
+	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0 - 1.0;
+	quadPosition = center + (corner.x * right + corner.y * up) * radius;
+	atlasTextureCoordinate = (frame + corner * 0.5 + 0.5) / frames;
+
+	gl_Position = projection * view * vec4(quadPosition, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 460 core
+// indirectFragmentShader.glsl
+// plain diffuse shading for the GPU culling benchmark, with a color
+// picked from the object index so neighbouring objects stand apart
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in uint fragmentObject;
+
+out vec4 outFragmentColor;
+
+uniform vec3 lightDirection;
+
+void main()
+{
+	vec3 color = vec3(
+		float(fragmentObject % 7u) / 6.0,
+		float(fragmentObject % 5u) / 4.0,
+		float(fragmentObject % 3u) / 2.0) * 0.6 + 0.4;
+	float diffuse = max(dot(normalize(fragmentVertexNormal), -lightDirection), 0.0);
+
+	outFragmentColor = vec4(color * (0.25 + 0.75 * diffuse), 1.0);
+}
@@ -0,0 +1,77 @@
+#version 460 core
+// indirectGBufferFragmentShader.glsl
+// writes the packed G-buffer for the draws appended by the GPU culling
+// pass - the same output as gbufferFragmentShader.glsl, with the color,
+// texture and material of each object read from the shading buffer
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in uint fragmentObject;
+
+layout (location = 0) out vec4 outAlbedoMaterial;
+layout (location = 1) out vec2 outNormal;
+
+// the scene textures are bound from unit 0, below the units the
+// G-buffer is sampled from
+#define MAX_SCENE_TEXTURES 11
+
+// matches DeferredRenderer::OBJECT_SHADING
+struct ObjectShading
+{
+	vec4 color;
+	vec2 UVscale;
+	// -1 for the flat color or no material
+	int textureSlot;
+	int materialIndex;
+};
+
+layout (std430, binding = 4) readonly buffer Shading
+{
+	ObjectShading shading[];
+};
+
+uniform sampler2D objectTextures[MAX_SCENE_TEXTURES];
+
+vec2 SignNotZero(vec2 v)
+{
+	return(vec2((v.x >= 0.0) ? 1.0 : -1.0, (v.y >= 0.0) ? 1.0 : -1.0));
+}
+
+// map the unit normal onto the octahedron and fold the lower half
+vec2 EncodeOctahedral(vec3 n)
+{
+	n /= (abs(n.x) + abs(n.y) + abs(n.z));
+	vec2 encoded = n.xy;
+	if (n.z < 0.0)
+	{
+		encoded = (1.0 - abs(n.yx)) * SignNotZero(n.xy);
+	}
+
+	return(encoded);
+}
+
+void main()
+{
+	ObjectShading object = shading[fragmentObject];
+
+	// the sampler is picked by the loop index, which is uniform,
+	// rather than by the slot of the object - the slot is the
+	// same over a quad, as a quad never spans two draws, but the
+	// derivatives are still taken outside the branch
+	vec2 uv = fragmentTextureCoordinate * object.UVscale;
+	vec2 uvDx = dFdx(uv);
+	vec2 uvDy = dFdy(uv);
+	vec4 baseColor = object.color;
+	for (int slot = 0; slot < MAX_SCENE_TEXTURES; slot++)
+	{
+		if (slot == object.textureSlot)
+		{
+			baseColor = textureGrad(objectTextures[slot], uv, uvDx, uvDy);
+		}
+	}
+
+	// slot 0 is reserved for draws without a material
+	outAlbedoMaterial = vec4(baseColor.rgb, float(object.materialIndex + 1) / 255.0);
+	outNormal = EncodeOctahedral(normalize(fragmentVertexNormal));
+}
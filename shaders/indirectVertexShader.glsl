@@ -0,0 +1,43 @@
+#version 460 core
+// indirectVertexShader.glsl
+// vertex shader for the draws appended by the GPU culling pass - the
+// model matrix is read from the object buffer at the base instance,
+// with the same attributes and outputs as sceneVertexShader.glsl
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// matches CULL_OBJECT
+struct CullObject
+{
+	mat4 model;
+	vec4 boundsMin;
+	vec4 boundsMax;
+	uvec4 mesh;
+};
+
+layout (std430, binding = 0) readonly buffer Objects
+{
+	CullObject objects[];
+};
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out uint fragmentObject;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	mat4 model = objects[gl_BaseInstance].model;
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0);
+
+	gl_Position = projection * view * worldPosition;
+	fragmentPosition = vec3(worldPosition);
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate;
+	fragmentObject = uint(gl_BaseInstance);
+}
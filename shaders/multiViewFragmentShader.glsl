@@ -0,0 +1,31 @@
+#version 460 core
+// multiViewFragmentShader.glsl
+// Phong shading for the multi-view pass, with the camera position
+// supplied per view by the geometry shader
+
+#include "phongLighting.glsl"
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in vec3 fragmentViewPosition;
+
+out vec4 outFragmentColor;
+
+uniform bool bUseTexture;
+uniform vec4 objectColor;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale;
+uniform Material material;
+
+void main()
+{
+	vec4 baseColor = objectColor;
+	if (bUseTexture)
+	{
+		baseColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+	}
+
+	vec3 lit = CalcPhongLighting(material, baseColor.rgb, fragmentVertexNormal, fragmentPosition, fragmentViewPosition);
+	outFragmentColor = vec4(lit, baseColor.a);
+}
@@ -0,0 +1,46 @@
+#version 460 core
+// multiViewGeometryShader.glsl
+// replicates every triangle into up to 32 views in one draw, with
+// one shader invocation per view writing to its own array layer
+
+#define MAX_BATCH_VIEWS 32
+
+layout (triangles, invocations = MAX_BATCH_VIEWS) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 vertexWorldPosition[];
+in vec3 vertexWorldNormal[];
+in vec2 vertexTextureCoordinate[];
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out vec3 fragmentViewPosition;
+
+uniform mat4 viewProjections[MAX_BATCH_VIEWS];
+uniform vec3 viewPositions[MAX_BATCH_VIEWS];
+uniform int viewCount;
+// array layer of the first view in this batch
+uniform int layerBase;
+// bit per view, cleared for views where the object was culled
+uniform uint viewMask;
+
+void main()
+{
+	if ((gl_InvocationID >= viewCount) || (((viewMask >> gl_InvocationID) & 1u) == 0u))
+	{
+		return;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		gl_Layer = layerBase + gl_InvocationID;
+		gl_Position = viewProjections[gl_InvocationID] * vec4(vertexWorldPosition[i], 1.0);
+		fragmentPosition = vertexWorldPosition[i];
+		fragmentVertexNormal = vertexWorldNormal[i];
+		fragmentTextureCoordinate = vertexTextureCoordinate[i];
+		fragmentViewPosition = viewPositions[gl_InvocationID];
+		EmitVertex();
+	}
+	EndPrimitive();
+}
@@ -0,0 +1,21 @@
+#version 460 core
+// multiViewVertexShader.glsl
+// transforms vertices to world space only - the geometry shader
+// projects each triangle once for every view in the batch
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 vertexWorldPosition;
+out vec3 vertexWorldNormal;
+out vec2 vertexTextureCoordinate;
+
+uniform mat4 model;
+
+void main()
+{
+	vertexWorldPosition = vec3(model * vec4(inVertexPosition, 1.0));
+	vertexWorldNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	vertexTextureCoordinate = inTextureCoordinate;
+}
@@ -0,0 +1,40 @@
+#version 460 core
+// oitAccumulateFragmentShader.glsl
+// weighted blended order independent transparency (McGuire and Bavoil
+// 2013) - accumulates depth weighted premultiplied color and the
+// product of the coverage into two targets, in any draw order
+
+#include "phongLighting.glsl"
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+layout (location = 0) out vec4 outAccumulation;
+layout (location = 1) out float outRevealage;
+
+uniform bool bUseTexture;
+uniform vec4 objectColor;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale;
+uniform vec3 viewPosition;
+uniform Material material;
+
+void main()
+{
+	vec4 baseColor = objectColor;
+	if (bUseTexture)
+	{
+		baseColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+	}
+
+	vec3 lit = CalcPhongLighting(material, baseColor.rgb, fragmentVertexNormal, fragmentPosition, viewPosition);
+	float alpha = baseColor.a * material.alpha;
+
+	// nearer and more opaque surfaces get a larger weight
+	float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 *
+		pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+	outAccumulation = vec4(lit * alpha, alpha) * weight;
+	outRevealage = alpha;
+}
@@ -0,0 +1,32 @@
+#version 460 core
+// oitCompositeFragmentShader.glsl
+// resolves the weighted blended accumulation over the opaque scene,
+// drawn with glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+
+out vec4 outFragmentColor;
+
+uniform sampler2D accumulationTexture;
+uniform sampler2D revealageTexture;
+// the accumulation is drawn at the origin, this pass in the viewport
+uniform vec2 viewportOrigin;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy - viewportOrigin);
+	float revealage = texelFetch(revealageTexture, texel, 0).r;
+
+	// nothing transparent covered this pixel
+	if (revealage >= 1.0)
+	{
+		discard;
+	}
+
+	vec4 accumulation = texelFetch(accumulationTexture, texel, 0);
+	if (isinf(max(max(abs(accumulation.r), abs(accumulation.g)), abs(accumulation.b))))
+	{
+		accumulation.rgb = vec3(accumulation.a);
+	}
+
+	vec3 averageColor = accumulation.rgb / max(accumulation.a, 0.00001);
+	outFragmentColor = vec4(averageColor, 1.0 - revealage);
+}
@@ -0,0 +1,63 @@
+// phongLighting.glsl
+// shared Phong lighting for the alternate shader programs, using the
+// same material and lightSources uniforms that SceneManager sets for
+// the main fragment shader
+
+#define TOTAL_LIGHTS 4
+
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float shininess;
+	float alpha;
+};
+
+struct LightSource
+{
+	vec3 position;
+	vec3 ambientColor;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float focalStrength;
+	float specularIntensity;
+};
+
+uniform LightSource lightSources[TOTAL_LIGHTS];
+uniform bool bUseLighting;
+
+// lighting from one light source for the passed in material
+vec3 CalcLightSource(LightSource light, Material mat, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+	vec3 lightDirection = normalize(light.position - fragPos);
+	vec3 reflectDir = reflect(-lightDirection, normal);
+
+	vec3 ambient = mat.ambientStrength * light.ambientColor * mat.ambientColor;
+	float impact = max(dot(normal, lightDirection), 0.0);
+	vec3 diffuse = impact * light.diffuseColor * mat.diffuseColor;
+	float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), max(light.focalStrength, 0.0001));
+	vec3 specular = light.specularIntensity * specularComponent * light.specularColor * mat.specularColor;
+
+	return(ambient + diffuse + specular);
+}
+
+// lighting from all light sources applied to the base color
+vec3 CalcPhongLighting(Material mat, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewPos)
+{
+	if (!bUseLighting)
+	{
+		return(baseColor);
+	}
+
+	vec3 norm = normalize(normal);
+	vec3 viewDir = normalize(viewPos - fragPos);
+	vec3 lighting = vec3(0.0);
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		lighting += CalcLightSource(lightSources[i], mat, norm, fragPos, viewDir);
+	}
+
+	return(lighting * baseColor);
+}
@@ -0,0 +1,181 @@
+#version 460 core
+// proceduralTextureComputeShader.glsl
+// generates one mip level of a wood, brick or speckled plastic texture -
+// every texel averages the pattern over the texels of level 0 it covers
+// in linear light, so each level is filtered as the CPU mip chain is,
+// and every pattern repeats exactly across the texture so it tiles
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// must match PROCEDURAL_PATTERN
+const int PATTERN_WOOD = 0;
+const int PATTERN_BRICK = 1;
+const int PATTERN_PLASTIC = 2;
+
+// the parameters of PROCEDURAL_TEXTURE, the colors in sRGB
+uniform int pattern;
+uniform vec3 baseColor;
+uniform vec3 detailColor;
+uniform float frequency;
+uniform float variation;
+uniform float detail;
+uniform uint seed;
+
+// texels of level 0 per side that one texel of this level covers
+uniform int footprint;
+
+layout (rgba8, binding = 0) uniform writeonly image2D destination;
+
+vec3 SrgbToLinear(vec3 color)
+{
+	return mix(color / 12.92, pow((color + 0.055) / 1.055, vec3(2.4)), step(0.04045, color));
+}
+
+vec3 LinearToSrgb(vec3 color)
+{
+	return mix(color * 12.92, 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055, step(0.0031308, color));
+}
+
+// a well mixed 32 bit hash of a lattice point and the seed
+float Hash(ivec2 cell)
+{
+	uint value = uint(cell.x) * 0x8da6b343u ^ uint(cell.y) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+	value ^= value >> 16;
+	value *= 0x7feb352du;
+	value ^= value >> 15;
+	value *= 0x846ca68bu;
+	value ^= value >> 16;
+	return float(value) / 4294967295.0;
+}
+
+// value noise over a lattice that wraps every period cells
+float PeriodicNoise(vec2 position, ivec2 period)
+{
+	ivec2 cell = ivec2(floor(position));
+	vec2 fraction = position - vec2(cell);
+	vec2 blend = fraction * fraction * (3.0 - 2.0 * fraction);
+
+	ivec2 cell0 = ((cell % period) + period) % period;
+	ivec2 cell1 = (cell0 + 1) % period;
+	float bottom = mix(Hash(cell0), Hash(ivec2(cell1.x, cell0.y)), blend.x);
+	float top = mix(Hash(ivec2(cell0.x, cell1.y)), Hash(cell1), blend.x);
+	return mix(bottom, top, blend.y);
+}
+
+// octaves of the noise, each twice the frequency of the last
+float PeriodicFbm(vec2 uv, ivec2 period)
+{
+	float sum = 0.0;
+	float amplitude = 0.5;
+	for (int octave = 0; octave < 4; octave++)
+	{
+		sum += amplitude * PeriodicNoise(uv * vec2(period), period);
+		period *= 2;
+		amplitude *= 0.5;
+	}
+	return sum / 0.9375;
+}
+
+// straight grain planks - the rings run along u, bent by the
+// noise, with fine streaks of grain along them
+vec3 Wood(vec2 uv, vec3 wood, vec3 ring)
+{
+	float rings = max(1.0, round(frequency));
+	float position = uv.y * rings + variation * PeriodicFbm(uv, ivec2(2, 4));
+	float band = pow(0.5 + 0.5 * sin(6.2831853 * position), 3.0);
+	float grain = PeriodicNoise(uv * vec2(8.0, 384.0), ivec2(8, 384)) - 0.5;
+	return mix(wood, ring, clamp(band + detail * grain, 0.0, 1.0));
+}
+
+// running bond of bricks twice as wide as they are tall, each a
+// little different in shade, in mortar of the passed in width
+vec3 Brick(vec2 uv, vec3 brick, vec3 mortar)
+{
+	float columns = max(1.0, round(frequency));
+	float rows = columns * 2.0;
+	vec2 position = vec2(uv.x * columns, uv.y * rows);
+	float row = floor(position.y);
+	position.x += 0.5 * mod(row, 2.0);
+
+	ivec2 cell = ivec2(floor(position));
+	vec2 fraction = position - vec2(cell);
+	cell.x = int(mod(float(cell.x), columns));
+
+	// distance to the nearest edge in brick heights
+	float edge = min(2.0 * min(fraction.x, 1.0 - fraction.x), min(fraction.y, 1.0 - fraction.y));
+	float inMortar = 1.0 - smoothstep(0.5 * detail, 0.5 * detail + 0.02, edge);
+
+	float shade = 1.0 + variation * (2.0 * Hash(cell) - 1.0);
+	float surface = 0.85 + 0.3 * PeriodicFbm(uv, ivec2(int(columns) * 4, int(rows) * 2));
+	vec3 brickColor = brick * shade * surface;
+	vec3 mortarColor = mortar * (0.9 + 0.2 * PeriodicNoise(uv * 64.0, ivec2(64)));
+	return mix(brickColor, mortarColor, inMortar);
+}
+
+// molded plastic mottled by the noise, with a speckle in the
+// passed in share of the cells
+vec3 Plastic(vec2 uv, vec3 plastic, vec3 speckle)
+{
+	vec3 color = plastic * (1.0 + variation * (2.0 * PeriodicFbm(uv, ivec2(4)) - 1.0));
+
+	int cells = max(1, int(round(frequency)));
+	vec2 position = uv * float(cells);
+	ivec2 cell = ivec2(floor(position));
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			ivec2 neighbor = cell + ivec2(x, y);
+			ivec2 wrapped = ((neighbor % cells) + cells) % cells;
+			if (Hash(wrapped) >= detail)
+			{
+				continue;
+			}
+			vec2 center = vec2(neighbor) + vec2(Hash(wrapped + ivec2(17, 0)), Hash(wrapped + ivec2(0, 31)));
+			float radius = 0.1 + 0.2 * Hash(wrapped + ivec2(53, 97));
+			float inSpeckle = 1.0 - smoothstep(radius - 0.05, radius, length(position - center));
+			color = mix(color, speckle, inSpeckle);
+		}
+	}
+	return color;
+}
+
+void main()
+{
+	ivec2 size = imageSize(destination);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if ((texel.x >= size.x) || (texel.y >= size.y))
+	{
+		return;
+	}
+
+	vec3 base = SrgbToLinear(baseColor);
+	vec3 other = SrgbToLinear(detailColor);
+
+	// a grid of samples over the covered texels, two per texel
+	// at level 0 to smooth the edges, up to 16 per side above
+	int samples = min(2 * footprint, 16);
+	vec3 sum = vec3(0.0);
+	for (int y = 0; y < samples; y++)
+	{
+		for (int x = 0; x < samples; x++)
+		{
+			vec2 uv = (vec2(texel) + (vec2(x, y) + 0.5) / float(samples)) / vec2(size);
+			if (pattern == PATTERN_WOOD)
+			{
+				sum += Wood(uv, base, other);
+			}
+			else if (pattern == PATTERN_BRICK)
+			{
+				sum += Brick(uv, base, other);
+			}
+			else
+			{
+				sum += Plastic(uv, base, other);
+			}
+		}
+	}
+
+	vec3 color = clamp(sum / float(samples * samples), 0.0, 1.0);
+	imageStore(destination, texel, vec4(LinearToSrgb(color), 1.0));
+}
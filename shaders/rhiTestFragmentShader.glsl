@@ -0,0 +1,19 @@
+#version 460 core
+// rhiTestFragmentShader.glsl
+// tints the texture of the render device test quads - the Vulkan
+// backend loads the checked in rhiTestFragmentShader.glsl.spv, rebuilt
+// after every change with
+// glslangValidator -V -S frag rhiTestFragmentShader.glsl -o rhiTestFragmentShader.glsl.spv
+
+layout (location = 0) in vec2 fragmentTextureCoordinate;
+layout (location = 1) in vec4 fragmentColor;
+
+layout (location = 0) out vec4 outFragmentColor;
+
+// RHI_TEXTURE_BINDING
+layout (binding = 9) uniform sampler2D baseTexture;
+
+void main()
+{
+	outFragmentColor = texture(baseTexture, fragmentTextureCoordinate) * fragmentColor;
+}
@@ -0,0 +1,27 @@
+#version 460 core
+// rhiTestVertexShader.glsl
+// textured quad placed by the per draw uniforms, written for both
+// render device backends - the Vulkan backend loads the checked in
+// rhiTestVertexShader.glsl.spv, rebuilt after every change with
+// glslangValidator -V -S vert rhiTestVertexShader.glsl -o rhiTestVertexShader.glsl.spv
+
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec2 inTextureCoordinate;
+
+// the uniforms passed to RenderCommandBuffer::SetUniforms()
+layout (std140, binding = 0) uniform DrawUniforms
+{
+	// xy offset and zw scale in clip space
+	vec4 offsetScale;
+	vec4 color;
+};
+
+layout (location = 0) out vec2 fragmentTextureCoordinate;
+layout (location = 1) out vec4 fragmentColor;
+
+void main()
+{
+	fragmentTextureCoordinate = inTextureCoordinate;
+	fragmentColor = color;
+	gl_Position = vec4(inPosition * offsetScale.zw + offsetScale.xy, 0.0, 1.0);
+}
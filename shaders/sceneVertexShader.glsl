@@ -0,0 +1,29 @@
+#version 460 core
+// sceneVertexShader.glsl
+// forward vertex shader shared by the alternate single view programs,
+// with the same attribute locations and uniforms as vertexShader.glsl
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+// matches depthOnlyVertexShader.glsl for the depth pre-pass
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	vec4 worldPosition = model * vec4(inVertexPosition, 1.0);
+
+	gl_Position = projection * view * worldPosition;
+	fragmentPosition = vec3(worldPosition);
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate;
+}
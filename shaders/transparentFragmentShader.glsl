@@ -0,0 +1,31 @@
+#version 460 core
+// transparentFragmentShader.glsl
+// Phong shading for the sorted transparent pass, with the material
+// alpha applied on top of the texture or object color alpha
+
+#include "phongLighting.glsl"
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+out vec4 outFragmentColor;
+
+uniform bool bUseTexture;
+uniform vec4 objectColor;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale;
+uniform vec3 viewPosition;
+uniform Material material;
+
+void main()
+{
+	vec4 baseColor = objectColor;
+	if (bUseTexture)
+	{
+		baseColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+	}
+
+	vec3 lit = CalcPhongLighting(material, baseColor.rgb, fragmentVertexNormal, fragmentPosition, viewPosition);
+	outFragmentColor = vec4(lit, baseColor.a * material.alpha);
+}
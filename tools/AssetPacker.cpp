@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpacker.cpp
+// ============
+// standalone tool that writes the listed asset files into one pack, stored
+// under the path they are listed by so the viewer finds them by the same
+// path it loads them with - run it from the viewer's working directory
+//
+// usage: AssetPacker <output.pak> <file> [file...]
+//
+// e.g.   AssetPacker assets.pak ./Source/brick.jpg ./Source/desk.jpg
+//            ./Source/wood.jpg ./Source/plastic.jpg ./Source/shaders/*.glsl
+//            basic_meshes.meshcache
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>          // EXIT_SUCCESS
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "../AssetPack.h"
+
+// declaration of global variables
+namespace
+{
+	// images that are already compressed, which LZ4 would only
+	// make slower to read
+	const char* const STORED_EXTENSIONS[] = { ".jpg", ".jpeg", ".png" };
+
+	/***********************************************************
+	 *  IsStoredUncompressed()
+	 *
+	 *  This function is used for checking whether a file keeps
+	 *  its bytes as they are in the pack.
+	 ***********************************************************/
+	bool IsStoredUncompressed(const std::string& filename)
+	{
+		for (size_t i = 0; i < sizeof(STORED_EXTENSIONS) / sizeof(STORED_EXTENSIONS[0]); i++)
+		{
+			size_t length = strlen(STORED_EXTENSIONS[i]);
+			if ((filename.size() >= length) &&
+				(filename.compare(filename.size() - length, length, STORED_EXTENSIONS[i]) == 0))
+			{
+				return(true);
+			}
+		}
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: AssetPacker <output.pak> <file> [file...]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	std::vector<ASSET_PACK_SOURCE> sources;
+	size_t totalBytes = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		std::ifstream file(argv[i], std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open asset file:" << argv[i] << std::endl;
+			return(EXIT_FAILURE);
+		}
+
+		ASSET_PACK_SOURCE source;
+		source.name = argv[i];
+		source.bCompress = !IsStoredUncompressed(source.name);
+		source.data.resize((size_t)file.tellg());
+		file.seekg(0);
+		file.read((char*)source.data.data(), source.data.size());
+		if (!file)
+		{
+			std::cout << "Could not read asset file:" << argv[i] << std::endl;
+			return(EXIT_FAILURE);
+		}
+
+		std::cout << AssetPack::NormalizeName(argv[i]) << ": " << source.data.size() << " bytes"
+			<< (source.bCompress ? ", LZ4" : ", stored") << std::endl;
+		totalBytes += source.data.size();
+		sources.push_back(source);
+	}
+
+	if (!AssetPack::Write(argv[1], sources))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	std::ifstream pack(argv[1], std::ios::binary | std::ios::ate);
+	std::cout << "Wrote " << sources.size() << " assets, " << totalBytes << " bytes into "
+		<< (long long)pack.tellg() << " bytes:" << argv[1] << std::endl;
+
+	return(EXIT_SUCCESS);
+}
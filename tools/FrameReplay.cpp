@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// framereplay.cpp
+// ============
+// standalone tool that replays a frame captured with F9 in a tight
+// loop and prints the driver cost of every GL call type
+//
+// usage: FrameReplay [capture file] [iterations]
+//
+// The capture carries the objects the frame uses and replays into
+// new ones, whatever names they get, so it runs from any directory.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE, atoi
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+#include "../FrameCapture.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// size of the hidden window, matching the viewer
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+	// replayed frames when no count is passed in
+	const int DEFAULT_ITERATIONS = 500;
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	const char* captureFile = (argc > 1) ? argv[1] : "frame_capture.glcap";
+	int iterations = (argc > 2) ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+	if (iterations <= 0)
+	{
+		iterations = DEFAULT_ITERATIONS;
+	}
+
+	// create a hidden window with the same context as the viewer
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "FrameReplay", NULL, NULL);
+	if (NULL == window)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	glfwMakeContextCurrent(window);
+	// do not wait for the display, only the submission is measured
+	glfwSwapInterval(0);
+
+	GLenum GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+
+	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+
+	FrameReplayer replayer;
+	int result = EXIT_FAILURE;
+	if (replayer.LoadCapture(captureFile))
+	{
+		replayer.Replay(iterations);
+		result = EXIT_SUCCESS;
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return(result);
+}
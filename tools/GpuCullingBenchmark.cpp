@@ -0,0 +1,430 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpucullingbenchmark.cpp
+// ============
+// standalone tool that draws a field of boxes with CPU culling and one
+// draw call per visible box, then with the GPU culling pass and a single
+// indirect multi-draw, with and without the depth pyramid test
+//
+// usage: GpuCullingBenchmark [objects]
+//
+// The field is drawn with a tenth and a hundredth of the objects too, so
+// the CPU cost of each path can be compared as the count grows.  Run it
+// from the viewer's working directory.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE, atoi
+#include <cstdio>           // printf
+#include <chrono>           // timing
+#include <algorithm>        // swap
+#include <cmath>            // sqrt, ceil
+#include <vector>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../GpuCuller.h"
+#include "../FrustumCulling.h"
+#include "../ResourceCache.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// size of the offscreen target
+	const int TARGET_SIZE = 512;
+	// objects when no count is passed in
+	const int DEFAULT_OBJECTS = 100000;
+	// frames drawn before and while timing
+	const int WARMUP_FRAMES = 3;
+	const int TIMED_FRAMES = 20;
+	// distance between the boxes of the field
+	const float FIELD_SPACING = 3.0f;
+
+	const char* g_VertexShader = "./Source/shaders/indirectVertexShader.glsl";
+	const char* g_FragmentShader = "./Source/shaders/indirectFragmentShader.glsl";
+
+	// position, normal and texture coordinate as in the scene meshes
+	struct MESH_VERTEX
+	{
+		float position[3];
+		float normal[3];
+		float uv[2];
+	};
+
+	// ways of culling and drawing the field
+	enum CULL_MODE
+	{
+		CULL_MODE_CPU,
+		CULL_MODE_GPU,
+		CULL_MODE_GPU_OCCLUSION,
+		CULL_MODE_COUNT
+	};
+
+	const char* g_CullModeNames[CULL_MODE_COUNT] = { "CPU cull, draw per object", "GPU frustum cull", "GPU frustum and Hi-Z" };
+
+	// cost of one mode at one object count
+	struct BENCHMARK_RESULT
+	{
+		double cpuMilliseconds;
+		double frameMilliseconds;
+		int visible;
+	};
+}
+
+/***********************************************************
+ *  AddFace()
+ *
+ *  This function is used for adding a flat shaded polygon
+ *  with the passed in corners to the mesh.
+ ***********************************************************/
+void AddFace(
+	std::vector<MESH_VERTEX>& vertices,
+	std::vector<GLuint>& indices,
+	const glm::vec3* corners,
+	int cornerCount)
+{
+	glm::vec3 normal = glm::normalize(glm::cross(corners[1] - corners[0], corners[2] - corners[0]));
+	GLuint first = (GLuint)vertices.size();
+
+	for (int i = 0; i < cornerCount; i++)
+	{
+		MESH_VERTEX vertex = { { corners[i].x, corners[i].y, corners[i].z }, { normal.x, normal.y, normal.z }, { 0.0f, 0.0f } };
+		vertices.push_back(vertex);
+	}
+	for (int i = 1; i + 1 < cornerCount; i++)
+	{
+		indices.push_back(first);
+		indices.push_back(first + i);
+		indices.push_back(first + i + 1);
+	}
+}
+
+/***********************************************************
+ *  BuildMeshes()
+ *
+ *  This function is used for building a unit box and a unit
+ *  octahedron into one vertex and index buffer, returning
+ *  the range of each.
+ ***********************************************************/
+void BuildMeshes(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices, std::vector<CULL_MESH>& meshes)
+{
+	// box faces, counter clockwise seen from outside
+	const glm::vec3 boxFaces[6][4] =
+	{
+		{ glm::vec3(-0.5f, -0.5f,  0.5f), glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3( 0.5f,  0.5f,  0.5f), glm::vec3(-0.5f,  0.5f,  0.5f) },
+		{ glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f,  0.5f, -0.5f), glm::vec3( 0.5f,  0.5f, -0.5f) },
+		{ glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3( 0.5f,  0.5f, -0.5f), glm::vec3( 0.5f,  0.5f,  0.5f) },
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f,  0.5f), glm::vec3(-0.5f,  0.5f,  0.5f), glm::vec3(-0.5f,  0.5f, -0.5f) },
+		{ glm::vec3(-0.5f,  0.5f,  0.5f), glm::vec3( 0.5f,  0.5f,  0.5f), glm::vec3( 0.5f,  0.5f, -0.5f), glm::vec3(-0.5f,  0.5f, -0.5f) },
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3( 0.5f, -0.5f, -0.5f), glm::vec3( 0.5f, -0.5f,  0.5f), glm::vec3(-0.5f, -0.5f,  0.5f) }
+	};
+
+	CULL_MESH box = { 0, (GLuint)indices.size(), (GLint)vertices.size(), 0 };
+	std::vector<GLuint> boxIndices;
+	std::vector<MESH_VERTEX> boxVertices;
+	for (int face = 0; face < 6; face++)
+	{
+		AddFace(boxVertices, boxIndices, boxFaces[face], 4);
+	}
+	box.indexCount = (GLuint)boxIndices.size();
+	vertices.insert(vertices.end(), boxVertices.begin(), boxVertices.end());
+	indices.insert(indices.end(), boxIndices.begin(), boxIndices.end());
+	meshes.push_back(box);
+
+	// the eight octahedron faces, one per octant
+	CULL_MESH octahedron = { 0, (GLuint)indices.size(), (GLint)vertices.size(), 0 };
+	std::vector<GLuint> octahedronIndices;
+	std::vector<MESH_VERTEX> octahedronVertices;
+	for (int octant = 0; octant < 8; octant++)
+	{
+		float x = (octant & 1) ? 0.5f : -0.5f;
+		float y = (octant & 2) ? 0.5f : -0.5f;
+		float z = (octant & 4) ? 0.5f : -0.5f;
+		glm::vec3 corners[3] = { glm::vec3(x, 0.0f, 0.0f), glm::vec3(0.0f, y, 0.0f), glm::vec3(0.0f, 0.0f, z) };
+		// keep the winding outward in every octant
+		if (x * y * z < 0.0f)
+		{
+			std::swap(corners[1], corners[2]);
+		}
+		AddFace(octahedronVertices, octahedronIndices, corners, 3);
+	}
+	octahedron.indexCount = (GLuint)octahedronIndices.size();
+	vertices.insert(vertices.end(), octahedronVertices.begin(), octahedronVertices.end());
+	indices.insert(indices.end(), octahedronIndices.begin(), octahedronIndices.end());
+	meshes.push_back(octahedron);
+}
+
+/***********************************************************
+ *  BuildField()
+ *
+ *  This function is used for placing the passed in number of
+ *  objects on a square grid, with a size, turn and mesh that
+ *  vary from object to object.
+ ***********************************************************/
+void BuildField(int count, std::vector<CULL_OBJECT>& objects)
+{
+	int columns = (int)ceil(sqrt((double)count));
+	float half = columns * FIELD_SPACING * 0.5f;
+
+	objects.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		float height = 1.0f + (float)((i * 7919) % 13) * 0.25f;
+		float width = 1.0f + (float)((i * 104729) % 5) * 0.2f;
+		glm::vec3 position(
+			-half + (i % columns) * FIELD_SPACING,
+			height * 0.5f,
+			-half + (i / columns) * FIELD_SPACING);
+
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+		model = glm::rotate(model, glm::radians((float)((i * 37) % 90)), glm::vec3(0.0f, 1.0f, 0.0f));
+		model = glm::scale(model, glm::vec3(width, height, width));
+
+		objects[i].model = model;
+		objects[i].boundsMin = glm::vec4(-0.5f, -0.5f, -0.5f, 0.0f);
+		objects[i].boundsMax = glm::vec4(0.5f, 0.5f, 0.5f, 0.0f);
+		objects[i].mesh = (unsigned int)(i % 3 == 0);
+		objects[i].padding[0] = objects[i].padding[1] = objects[i].padding[2] = 0;
+	}
+}
+
+/***********************************************************
+ *  RunMode()
+ *
+ *  This function is used for drawing the field a number of
+ *  times with the passed in mode, timing the CPU side up to
+ *  the last draw call and the whole frame up to glFinish().
+ ***********************************************************/
+BENCHMARK_RESULT RunMode(
+	CULL_MODE mode,
+	GpuCuller& culler,
+	const std::vector<CULL_OBJECT>& objects,
+	const std::vector<CULL_MESH>& meshes,
+	GLuint programID,
+	GLuint depthTexture,
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	BENCHMARK_RESULT result = { 0.0, 0.0, 0 };
+	glm::mat4 viewProjection = projection * view;
+	const BOUNDING_BOX unitBox = { glm::vec3(-0.5f), glm::vec3(0.5f) };
+
+	for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; ++frame)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		int visible = 0;
+		if (mode == CULL_MODE_CPU)
+		{
+			glUseProgram(programID);
+			FRUSTUM frustum = ExtractFrustum(viewProjection);
+			for (size_t i = 0; i < objects.size(); i++)
+			{
+				if (!IsBoxInFrustum(frustum, TransformBoundingBox(unitBox, objects[i].model)))
+				{
+					continue;
+				}
+				// the object index goes in as the base instance, the
+				// same as the GPU commands, so one program serves both
+				const CULL_MESH& mesh = meshes[objects[i].mesh];
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+					(void*)(mesh.firstIndex * sizeof(GLuint)), 1, mesh.baseVertex, (GLuint)i);
+				visible++;
+			}
+		}
+		else
+		{
+			culler.Cull(viewProjection, mode == CULL_MODE_GPU_OCCLUSION);
+			glUseProgram(programID);
+			culler.Draw(GL_TRIANGLES);
+			if (mode == CULL_MODE_GPU_OCCLUSION)
+			{
+				// the depth of this frame culls the next one
+				culler.BuildDepthPyramid(depthTexture, TARGET_SIZE, TARGET_SIZE, viewProjection);
+			}
+		}
+
+		std::chrono::high_resolution_clock::time_point submitted = std::chrono::high_resolution_clock::now();
+		glFinish();
+		std::chrono::high_resolution_clock::time_point finished = std::chrono::high_resolution_clock::now();
+
+		if (frame >= WARMUP_FRAMES)
+		{
+			result.cpuMilliseconds += std::chrono::duration<double, std::milli>(submitted - start).count();
+			result.frameMilliseconds += std::chrono::duration<double, std::milli>(finished - start).count();
+			result.visible = visible;
+		}
+	}
+
+	if (mode != CULL_MODE_CPU)
+	{
+		result.visible = culler.ReadDrawCount();
+	}
+	result.cpuMilliseconds /= TIMED_FRAMES;
+	result.frameMilliseconds /= TIMED_FRAMES;
+	return(result);
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int objectCount = (argc > 1) ? atoi(argv[1]) : DEFAULT_OBJECTS;
+	if (objectCount <= 0)
+	{
+		objectCount = DEFAULT_OBJECTS;
+	}
+
+	// create a hidden window for the context, drawing offscreen
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(64, 64, "GpuCullingBenchmark", NULL, NULL);
+	if (NULL == window)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	glfwMakeContextCurrent(window);
+
+	GLenum GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+
+	ResourceCache* pResourceCache = new ResourceCache();
+	GpuCuller* pCuller = new GpuCuller();
+	ResourceHandle program = pResourceCache->AcquireProgram(g_VertexShader, NULL, g_FragmentShader);
+	if ((!program.IsValid()) || (!pCuller->Initialize(pResourceCache)))
+	{
+		std::cout << "Failed to load the benchmark programs" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+
+	// offscreen target with a depth texture for the pyramid
+	GLuint framebuffer = 0;
+	GLuint colorBuffer = 0;
+	GLuint depthTexture = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &colorBuffer);
+	glGenTextures(1, &depthTexture);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, TARGET_SIZE, TARGET_SIZE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Failed to create the offscreen target" << std::endl;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+
+	// both meshes in one vertex and index buffer
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<GLuint> indices;
+	std::vector<CULL_MESH> meshes;
+	BuildMeshes(vertices, indices, meshes);
+	pCuller->SetMeshes(meshes);
+
+	GLuint vertexArray = 0;
+	GLuint buffers[2] = { 0, 0 };
+	glGenVertexArrays(1, &vertexArray);
+	glGenBuffers(2, buffers);
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MESH_VERTEX), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)(6 * sizeof(float)));
+
+	GLuint programID = program.GetID();
+	glUseProgram(programID);
+	glUniform3f(glGetUniformLocation(programID, "lightDirection"), -0.4f, -0.8f, -0.45f);
+
+	std::cout << "objects    mode                          CPU ms   frame ms   drawn" << std::endl;
+	bool bMatch = true;
+	for (int divisor = 100; divisor >= 1; divisor /= 10)
+	{
+		int count = objectCount / divisor;
+		if (count <= 0)
+		{
+			continue;
+		}
+
+		std::vector<CULL_OBJECT> objects;
+		BuildField(count, objects);
+		pCuller->SetObjects(objects);
+
+		// at eye height from one corner of the field, looking
+		// across it, so the near boxes hide many behind them
+		float half = (float)ceil(sqrt((double)count)) * FIELD_SPACING * 0.5f;
+		glm::vec3 eye(-half - 4.0f, 2.0f, -half - 4.0f);
+		glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, half * 4.0f);
+		glUseProgram(programID);
+		glUniformMatrix4fv(glGetUniformLocation(programID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+		glUniformMatrix4fv(glGetUniformLocation(programID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+		BENCHMARK_RESULT results[CULL_MODE_COUNT];
+		for (int mode = 0; mode < CULL_MODE_COUNT; mode++)
+		{
+			results[mode] = RunMode((CULL_MODE)mode, *pCuller, objects, meshes, programID, depthTexture, view, projection);
+			printf("%-10d %-28s %8.3f %10.3f %7d\n", count, g_CullModeNames[mode],
+				results[mode].cpuMilliseconds, results[mode].frameMilliseconds, results[mode].visible);
+		}
+
+		// the GPU frustum test is the same as the CPU one
+		if (results[CULL_MODE_GPU].visible != results[CULL_MODE_CPU].visible)
+		{
+			std::cout << "  GPU frustum culling drew " << results[CULL_MODE_GPU].visible << " objects, the CPU drew "
+				<< results[CULL_MODE_CPU].visible << std::endl;
+			bMatch = false;
+		}
+	}
+
+	glBindVertexArray(0);
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteBuffers(2, buffers);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteTextures(1, &depthTexture);
+
+	delete pCuller;
+	program.Release();
+	delete pResourceCache;
+	glfwTerminate();
+
+	return(bMatch ? EXIT_SUCCESS : EXIT_FAILURE);
+}
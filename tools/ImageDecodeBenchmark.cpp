@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagedecodebenchmark.cpp
+// ============
+// standalone tool that decodes a corpus of images with every decoder
+// compiled in and prints the MB/s and peak memory of each, per format
+//
+// usage: ImageDecodeBenchmark [-i iterations] <image> [image...]
+//
+// e.g.   ImageDecodeBenchmark -i 5 ./Source/*.jpg ./Source/*.png
+//
+// Build it with IMAGE_DECODER_LIBJPEG, IMAGE_DECODER_LIBPNG and
+// IMAGE_DECODER_LIBWEBP defined and linked to compare those libraries with
+// stb_image, the decoder marked with a * is the one the viewer uses.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>          // EXIT_SUCCESS, atoi
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../ImageDecoder.h"
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int iterations = 3;
+	std::vector<std::string> filenames;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc))
+		{
+			iterations = atoi(argv[++i]);
+		}
+		else
+		{
+			filenames.push_back(argv[i]);
+		}
+	}
+
+	if (filenames.empty() || (iterations <= 0))
+	{
+		std::cout << "usage: ImageDecodeBenchmark [-i iterations] <image> [image...]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	RunImageDecodeBenchmark(filenames, iterations);
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// imageprocessingbenchmark.cpp
+// ============
+// standalone tool that prints the throughput of the texture image
+// preparation steps in MB/s
+//
+// usage: ImageProcessingBenchmark [width] [height] [iterations]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>          // EXIT_SUCCESS, atoi
+
+#include "../ImageProcessing.h"
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int width = (argc > 1) ? atoi(argv[1]) : 2048;
+	int height = (argc > 2) ? atoi(argv[2]) : 2048;
+	int iterations = (argc > 3) ? atoi(argv[3]) : 10;
+
+	if ((width <= 0) || (height <= 0) || (iterations <= 0))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	RunImageProcessingBenchmark(width, height, iterations);
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,313 @@
+///////////////////////////////////////////////////////////////////////////////
+// rhismoketest.cpp
+// ============
+// standalone tool that draws the same grid of textured quads through
+// each render device backend, prints the CPU cost per draw and checks
+// that the backends produce the same image
+//
+// usage: RhiSmokeTest [gl|vulkan|both] [draws]
+//
+// Run it from the viewer's working directory.  The Vulkan backend needs
+// RHI_VULKAN and reads the .spv files checked in next to the test shaders,
+// and runs on lavapipe or SwiftShader when no GPU is present.  Each
+// backend writes its image to rhi_<backend>.ppm.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE, atoi
+#include <cstdio>           // image output
+#include <cstring>          // strcmp
+#include <chrono>           // timing
+#include <cmath>            // sqrt, ceil
+#include <algorithm>        // std::max
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+#include "../RenderDevice.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// size of the offscreen target
+	const int TARGET_SIZE = 256;
+	// draws per frame when no count is passed in
+	const int DEFAULT_DRAWS = 4096;
+	// frames recorded before and while timing
+	const int WARMUP_FRAMES = 5;
+	const int TIMED_FRAMES = 50;
+	// largest channel difference between the backends that still passes
+	const int PIXEL_TOLERANCE = 2;
+
+	const char* g_VertexShader = "./Source/shaders/rhiTestVertexShader.glsl";
+	const char* g_FragmentShader = "./Source/shaders/rhiTestFragmentShader.glsl";
+
+	// one quad corner
+	struct QUAD_VERTEX
+	{
+		float x;
+		float y;
+		float u;
+		float v;
+	};
+
+	// matches the DrawUniforms block of the test shader
+	struct DRAW_UNIFORMS
+	{
+		float offsetScale[4];
+		float color[4];
+	};
+}
+
+/***********************************************************
+ *  RenderWithDevice()
+ *
+ *  This function is used for drawing the test grid with the
+ *  passed in device, timing the recording and the submit,
+ *  and reading the image back.
+ ***********************************************************/
+bool RenderWithDevice(RenderDevice* pDevice, int draws, std::vector<unsigned char>& pixels)
+{
+	const QUAD_VERTEX vertices[4] =
+	{
+		{ 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 1.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 1.0f },
+		{ 1.0f, 1.0f, 1.0f, 1.0f }
+	};
+	const unsigned int indices[6] = { 0, 1, 2, 2, 1, 3 };
+	// 2x2 checker, filtered into a soft gradient across each quad
+	const unsigned char checker[16] =
+	{
+		255, 255, 255, 255,   96, 96, 96, 255,
+		96, 96, 96, 255,      255, 255, 255, 255
+	};
+
+	BUFFER_HANDLE vertexBuffer = pDevice->CreateBuffer(BUFFER_USAGE_VERTEX, sizeof(vertices), vertices);
+	BUFFER_HANDLE indexBuffer = pDevice->CreateBuffer(BUFFER_USAGE_INDEX, sizeof(indices), indices);
+	TEXTURE_HANDLE texture = pDevice->CreateTexture(2, 2, TEXTURE_FORMAT_RGBA8, checker);
+	RENDER_TARGET_HANDLE target = pDevice->CreateRenderTarget(TARGET_SIZE, TARGET_SIZE);
+
+	PIPELINE_DESC desc;
+	desc.vertexShaderFile = g_VertexShader;
+	desc.fragmentShaderFile = g_FragmentShader;
+	VERTEX_BINDING binding = { 0, sizeof(QUAD_VERTEX), false };
+	desc.bindings.push_back(binding);
+	VERTEX_ATTRIBUTE position = { 0, 0, VERTEX_FORMAT_FLOAT2, 0 };
+	VERTEX_ATTRIBUTE textureCoordinate = { 1, 0, VERTEX_FORMAT_FLOAT2, 2 * sizeof(float) };
+	desc.attributes.push_back(position);
+	desc.attributes.push_back(textureCoordinate);
+	desc.bDepthTest = false;
+	desc.bBlend = true;
+	PIPELINE_HANDLE pipeline = pDevice->CreatePipeline(desc);
+
+	RenderCommandBuffer* pCommandBuffer = pDevice->CreateCommandBuffer();
+	if ((0 == vertexBuffer) || (0 == indexBuffer) || (0 == texture) ||
+		(0 == target) || (0 == pipeline) || (NULL == pCommandBuffer))
+	{
+		std::cout << "Failed to create the test resources" << std::endl;
+		pDevice->DestroyCommandBuffer(pCommandBuffer);
+		return(false);
+	}
+
+	// square grid with one cell per draw, later draws blended over
+	// the earlier ones where the quads overlap; the cells cover an
+	// even number of pixels so every quad edge falls between pixels,
+	// and draws past the last cell start over at the first one
+	int cellPixels = std::max(2, (TARGET_SIZE / (int)ceil(sqrt((double)draws))) & ~1);
+	int columns = TARGET_SIZE / cellPixels;
+	float cell = 2.0f * cellPixels / TARGET_SIZE;
+
+	double recordMilliseconds = 0.0;
+	double frameMilliseconds = 0.0;
+	for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; ++frame)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		pCommandBuffer->Begin();
+		pCommandBuffer->BeginRenderPass(target, glm::vec4(0.1f, 0.1f, 0.2f, 1.0f));
+		pCommandBuffer->BindPipeline(pipeline);
+		pCommandBuffer->BindVertexBuffer(0, vertexBuffer, 0);
+		pCommandBuffer->BindIndexBuffer(indexBuffer, 0);
+		pCommandBuffer->BindTexture(texture);
+		for (int i = 0; i < draws; ++i)
+		{
+			DRAW_UNIFORMS uniforms;
+			int gridCell = i % (columns * columns);
+			uniforms.offsetScale[0] = -1.0f + (gridCell % columns) * cell;
+			uniforms.offsetScale[1] = -1.0f + (gridCell / columns) * cell;
+			uniforms.offsetScale[2] = cell * 1.5f;
+			uniforms.offsetScale[3] = cell * 1.5f;
+			uniforms.color[0] = (float)(i % 7) / 6.0f;
+			uniforms.color[1] = (float)(i % 5) / 4.0f;
+			uniforms.color[2] = (float)(i % 3) / 2.0f;
+			uniforms.color[3] = 0.75f;
+			pCommandBuffer->SetUniforms(&uniforms, sizeof(uniforms));
+			pCommandBuffer->DrawIndexed(6, 1, 0, 0, 0);
+		}
+		pCommandBuffer->EndRenderPass();
+		pCommandBuffer->End();
+
+		std::chrono::high_resolution_clock::time_point recorded = std::chrono::high_resolution_clock::now();
+		pDevice->Submit(pCommandBuffer);
+		pDevice->WaitIdle();
+		std::chrono::high_resolution_clock::time_point finished = std::chrono::high_resolution_clock::now();
+
+		if (frame >= WARMUP_FRAMES)
+		{
+			recordMilliseconds += std::chrono::duration<double, std::milli>(recorded - start).count();
+			frameMilliseconds += std::chrono::duration<double, std::milli>(finished - start).count();
+		}
+	}
+
+	std::cout << pDevice->GetDeviceName() << std::endl;
+	std::cout << "  recording: " << recordMilliseconds * 1000000.0 / ((double)TIMED_FRAMES * draws)
+		<< " ns per draw" << std::endl;
+	std::cout << "  frame:     " << frameMilliseconds / TIMED_FRAMES << " ms for " << draws
+		<< " draws, submit and wait included" << std::endl;
+
+	bool bRead = pDevice->ReadRenderTarget(target, pixels);
+
+	pDevice->DestroyCommandBuffer(pCommandBuffer);
+	pDevice->DestroyPipeline(pipeline);
+	pDevice->DestroyRenderTarget(target);
+	pDevice->DestroyTexture(texture);
+	pDevice->DestroyBuffer(indexBuffer);
+	pDevice->DestroyBuffer(vertexBuffer);
+	return(bRead);
+}
+
+/***********************************************************
+ *  WriteImage()
+ *
+ *  This function is used for saving RGBA8 pixels with the
+ *  top row first as a binary PPM file.
+ ***********************************************************/
+void WriteImage(const char* filename, const std::vector<unsigned char>& pixels)
+{
+	FILE* file = fopen(filename, "wb");
+	if (NULL == file)
+	{
+		return;
+	}
+
+	fprintf(file, "P6\n%d %d\n255\n", TARGET_SIZE, TARGET_SIZE);
+	for (size_t i = 0; i + 3 < pixels.size(); i += 4)
+	{
+		fwrite(&pixels[i], 1, 3, file);
+	}
+	fclose(file);
+}
+
+/***********************************************************
+ *  RunBackend()
+ *
+ *  This function is used for creating a device of the passed
+ *  in backend and drawing the test with it.
+ ***********************************************************/
+bool RunBackend(RENDER_BACKEND backend, int draws, std::vector<unsigned char>& pixels)
+{
+	RenderDevice* pDevice = CreateRenderDevice(backend, true);
+	if (NULL == pDevice)
+	{
+		return(false);
+	}
+
+	bool bResult = pDevice->Initialize() && RenderWithDevice(pDevice, draws, pixels);
+	delete pDevice;
+
+	if (bResult)
+	{
+		WriteImage((RENDER_BACKEND_OPENGL == backend) ? "rhi_gl.ppm" : "rhi_vulkan.ppm", pixels);
+	}
+	return(bResult);
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	const char* backendName = (argc > 1) ? argv[1] : "both";
+	int draws = (argc > 2) ? atoi(argv[2]) : DEFAULT_DRAWS;
+	if (draws <= 0)
+	{
+		draws = DEFAULT_DRAWS;
+	}
+
+	bool bRunGL = (0 == strcmp(backendName, "gl")) || (0 == strcmp(backendName, "both"));
+	bool bRunVulkan = (0 == strcmp(backendName, "vulkan")) || (0 == strcmp(backendName, "both"));
+
+	GLFWwindow* window = NULL;
+	if (bRunGL)
+	{
+		// the GL device draws offscreen, the window only holds the context
+		glfwInit();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+		window = glfwCreateWindow(TARGET_SIZE, TARGET_SIZE, "RhiSmokeTest", NULL, NULL);
+		if (NULL == window)
+		{
+			std::cout << "Failed to create GLFW window" << std::endl;
+			glfwTerminate();
+			return(EXIT_FAILURE);
+		}
+		glfwMakeContextCurrent(window);
+
+		GLenum GLEWInitResult = glewInit();
+		if (GLEW_OK != GLEWInitResult)
+		{
+			std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+			glfwTerminate();
+			return(EXIT_FAILURE);
+		}
+	}
+
+	std::vector<unsigned char> glPixels;
+	std::vector<unsigned char> vulkanPixels;
+	bool bPassed = true;
+	if (bRunGL)
+	{
+		bPassed = RunBackend(RENDER_BACKEND_OPENGL, draws, glPixels) && bPassed;
+	}
+	if (bRunVulkan)
+	{
+		bPassed = RunBackend(RENDER_BACKEND_VULKAN, draws, vulkanPixels) && bPassed;
+	}
+
+	if (bPassed && bRunGL && bRunVulkan)
+	{
+		// rasterization rules allow small differences between drivers
+		int differentPixels = 0;
+		for (size_t i = 0; (i < glPixels.size()) && (i < vulkanPixels.size()); i += 4)
+		{
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				if (abs((int)glPixels[i + channel] - (int)vulkanPixels[i + channel]) > PIXEL_TOLERANCE)
+				{
+					differentPixels++;
+					break;
+				}
+			}
+		}
+		std::cout << differentPixels << " of " << TARGET_SIZE * TARGET_SIZE
+			<< " pixels differ between the backends" << std::endl;
+		bPassed = (glPixels.size() == vulkanPixels.size()) &&
+			(differentPixels * 1000 <= TARGET_SIZE * TARGET_SIZE);
+	}
+
+	if (NULL != window)
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
+
+	std::cout << (bPassed ? "PASSED" : "FAILED") << std::endl;
+	return(bPassed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
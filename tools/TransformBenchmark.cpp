@@ -0,0 +1,33 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbenchmark.cpp
+// ============
+// standalone tool that compares the cost of building model matrices
+// with the mat4 Euler path and the TRS 3x4 affine path
+//
+// usage: TransformBenchmark [count] [iterations]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>          // EXIT_SUCCESS, atoi
+
+#include "../AffineTransform.h"
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the tool has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int count = (argc > 1) ? atoi(argv[1]) : 10000;
+	int iterations = (argc > 2) ? atoi(argv[2]) : 100;
+
+	if ((count <= 0) || (iterations <= 0))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	RunTransformBenchmark(count, iterations);
+
+	return(EXIT_SUCCESS);
+}